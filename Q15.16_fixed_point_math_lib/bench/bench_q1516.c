@@ -0,0 +1,866 @@
+#define _POSIX_C_SOURCE 199309L  // clock_gettime() under -std=c99
+
+#include "q1516.h"
+#include "q1516_batch.h"
+#include "q1516_math.h"
+#include "q1516_dsp.h"
+#include "q1516_fft.h"
+#include "q1516_matrix.h"
+#include "q1516_chars.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define BENCH_HAVE_TSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#endif
+
+/**
+ * @file bench_q1516.c
+ * @brief Microbenchmark suite for the Q15.16 library
+ *
+ * Built twice by `make bench`:
+ * - bench_q1516         every call goes through libq1516
+ * - bench_q1516_inline  same source compiled with -DQ1516_INLINE
+ * Comparing the two shows what the out-of-line call costs per sample.
+ *
+ * Covers every function in q1516.h except the printing ones, the batch
+ * kernels, the math functions, the DSP filters, the FFT, the matrix
+ * kernels, decimal formatting and parsing, and the float / libc
+ * operations they replace.
+ * Each benchmark runs one warm-up and BENCH_REPS timed repetitions and
+ * reports the mean, the spread between repetitions, the fastest one and
+ * the cost in time-stamp-counter cycles. The TSC ticks at a fixed rate
+ * close to the nominal clock, so cycles/op is only exact with turbo off.
+ *
+ * Usage: bench_q1516 [--filter TEXT] [--json FILE] [--baseline FILE] [--threshold PCT]
+ *   --filter     only run benchmarks whose name contains TEXT
+ *   --json       also write the results to FILE, one benchmark per line
+ *   --baseline   compare with an earlier --json file; exit code 1 when a
+ *                benchmark got slower by more than --threshold percent
+ *                (default 10)
+ */
+
+// =============================================================================
+// BENCHMARK UTILITIES
+// =============================================================================
+
+#define BENCH_SAMPLES 4096      // Working set: a few 16 KB arrays, stays in L1/L2
+#define BENCH_ROUNDS  200       // Passes over the working set per repetition
+#define BENCH_REPS    10        // Timed repetitions per benchmark
+#define BENCH_MAX_RESULTS 256
+
+static q1516_t     input_a[BENCH_SAMPLES];
+static q1516_t     input_b[BENCH_SAMPLES];
+static q1516_t     output[BENCH_SAMPLES];
+static q1516_acc_t output_acc[BENCH_SAMPLES];
+static int32_t     output_i[BENCH_SAMPLES];
+static double      input_d[BENCH_SAMPLES];
+static double      output_d[BENCH_SAMPLES];
+static float       input_f[BENCH_SAMPLES];
+static float       input_fb[BENCH_SAMPLES];
+static float       output_f[BENCH_SAMPLES];
+
+// Sink results so the optimizer cannot drop the loops
+static volatile int64_t checksum;
+
+typedef struct {
+    char name[48];
+    const char* group;
+    double ns_mean;         // Mean ns per element over the repetitions
+    double ns_stddev;       // Standard deviation between repetitions
+    double ns_min;          // Fastest repetition
+    double cycles;          // Mean TSC cycles per element (0 without a TSC)
+} bench_result_t;
+
+typedef struct {
+    double ns[BENCH_REPS];
+    double cycles[BENCH_REPS];
+    int count;
+    double start_ns;
+    uint64_t start_cycles;
+} bench_timer_t;
+
+static bench_result_t results[BENCH_MAX_RESULTS];
+static int result_count = 0;
+static const char* current_group = "";
+static const char* name_filter = NULL;
+
+static double now_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, counter;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&counter);
+    return (double)counter.QuadPart * 1e9 / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+#endif
+}
+
+static uint64_t now_cycles(void) {
+#ifdef BENCH_HAVE_TSC
+    return (uint64_t)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static void fill_inputs(void) {
+    srand(1516);
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        // Keep values in [-64, 64) so products and quotients stay in range
+        input_a[i] = (q1516_t)((rand() % (128 << 16)) - (64 << 16));
+        input_b[i] = (q1516_t)((rand() % (128 << 16)) - (64 << 16)) | 1;  // never zero
+        // Same values with bits below 2^-16, so conversions have to round
+        input_d[i] = ((double)input_a[i] + (double)(i % 7) / 7.0) / 65536.0;
+        input_f[i] = (float)input_d[i];
+        input_fb[i] = q1516_to_float(input_b[i]);
+    }
+}
+
+static void begin_group(const char* group, const char* title) {
+    current_group = group;
+    printf("\n%s:\n", title);
+}
+
+static int bench_enabled(const char* name) {
+    return name_filter == NULL || strstr(name, name_filter) != NULL;
+}
+
+static void timer_start(bench_timer_t* timer) {
+    timer->start_cycles = now_cycles();
+    timer->start_ns = now_ns();
+}
+
+static void timer_stop(bench_timer_t* timer, double elements) {
+    double ns = now_ns() - timer->start_ns;
+    double cycles = (double)(now_cycles() - timer->start_cycles);
+    timer->ns[timer->count] = ns / elements;
+    timer->cycles[timer->count] = cycles / elements;
+    timer->count++;
+}
+
+static void record(const char* name, const bench_timer_t* timer) {
+    double sum = 0.0, cycles = 0.0, min = timer->ns[0];
+    for (int i = 0; i < timer->count; i++) {
+        sum += timer->ns[i];
+        cycles += timer->cycles[i];
+        if (timer->ns[i] < min) min = timer->ns[i];
+    }
+    double mean = sum / timer->count;
+    double variance = 0.0;
+    for (int i = 0; i < timer->count; i++) {
+        variance += (timer->ns[i] - mean) * (timer->ns[i] - mean);
+    }
+    variance /= (timer->count > 1) ? timer->count - 1 : 1;
+
+    bench_result_t result;
+    snprintf(result.name, sizeof result.name, "%s", name);
+    result.group = current_group;
+    result.ns_mean = mean;
+    result.ns_stddev = sqrt(variance);
+    result.ns_min = min;
+    result.cycles = cycles / timer->count;
+
+    printf("  %-32s %8.3f %6.1f%% %8.3f", name, mean,
+           mean > 0 ? 100.0 * result.ns_stddev / mean : 0.0, min);
+    if (result.cycles > 0) {
+        printf(" %8.2f %8.3f\n", result.cycles, 1.0 / result.cycles);
+    } else {
+        printf(" %8s %8s\n", "n/a", "n/a");
+    }
+    if (result_count < BENCH_MAX_RESULTS) results[result_count++] = result;
+}
+
+// Run BODY (one pass over `elements` elements; may use `round`) ROUNDS
+// times per repetition: one warm-up repetition, then BENCH_REPS timed ones
+#define BENCH_RUN_ROUNDS(name, elements, ROUNDS, BODY) do { \
+    if (!bench_enabled(name)) break; \
+    bench_timer_t timer = {{0}, {0}, 0, 0.0, 0}; \
+    for (int rep = -1; rep < BENCH_REPS; rep++) { \
+        timer_start(&timer); \
+        for (int round = 0; round < (ROUNDS); round++) { \
+            BODY; \
+        } \
+        if (rep >= 0) timer_stop(&timer, (double)(elements) * (ROUNDS)); \
+    } \
+    record(name, &timer); \
+} while (0)
+
+#define BENCH_RUN(name, elements, BODY) BENCH_RUN_ROUNDS(name, elements, BENCH_ROUNDS, BODY)
+
+// Time one element-wise expression over the working set.
+// EXPR may use `i`, `input_a`, `input_b`, ...; it is stored into OUT[i].
+#define BENCH_LOOP(name, OUT, EXPR) BENCH_RUN(name, BENCH_SAMPLES, \
+    for (int i = 0; i < BENCH_SAMPLES; i++) { \
+        OUT[i] = (EXPR); \
+    } \
+    checksum += (int64_t)OUT[round & (BENCH_SAMPLES - 1)])
+
+// Time one batch call over the working set; reports per element
+#define BENCH_BATCH(name, CALL) BENCH_RUN(name, BENCH_SAMPLES, \
+    CALL; \
+    checksum += output[round & (BENCH_SAMPLES - 1)])
+
+// =============================================================================
+// BENCHMARKS
+// =============================================================================
+
+static void bench_conversions(void) {
+    begin_group("conversions", "Conversions");
+    BENCH_LOOP("q1516_from_int", output, q1516_from_int(input_a[i] >> 16));
+    BENCH_LOOP("q1516_to_int", output_i, q1516_to_int(input_a[i]));
+    BENCH_LOOP("q1516_from_float", output, q1516_from_float(input_f[i]));
+    BENCH_LOOP("q1516_to_float", output_f, q1516_to_float(input_a[i]));
+    BENCH_LOOP("q1516_from_double", output, q1516_from_double(input_d[i]));
+    BENCH_LOOP("q1516_to_double", output_d, q1516_to_double(input_a[i]));
+    BENCH_LOOP("  (q1516_t)(x * 65536) cast", output, (q1516_t)(input_f[i] * Q1516_SCALE));
+}
+
+static void bench_arithmetic(void) {
+    begin_group("arithmetic", "Arithmetic");
+    BENCH_LOOP("q1516_add", output, q1516_add(input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_subtract", output, q1516_subtract(input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_multiply", output, q1516_multiply(input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_divide", output, q1516_divide(input_a[i], input_b[i]));
+}
+
+static void bench_float_baseline(void) {
+    // The same operations on the same values, in float
+    begin_group("float", "Float baseline");
+    BENCH_LOOP("float add", output_f, input_f[i] + input_fb[i]);
+    BENCH_LOOP("float subtract", output_f, input_f[i] - input_fb[i]);
+    BENCH_LOOP("float multiply", output_f, input_f[i] * input_fb[i]);
+    BENCH_LOOP("float divide", output_f, input_f[i] / input_fb[i]);
+    BENCH_LOOP("float fabsf", output_f, fabsf(input_f[i]));
+}
+
+static void bench_division(void) {
+    begin_group("division", "Division (hardware vs division-free)");
+    q1516_divider_t divider = q1516_divider_init(input_b[0]);
+    BENCH_LOOP("q1516_divide_fast", output, q1516_divide_fast(input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_reciprocal", output, q1516_reciprocal(input_b[i]));
+    BENCH_LOOP("q1516_divide (constant)", output, q1516_divide(input_a[i], divider.divisor));
+    BENCH_LOOP("q1516_divide_by", output, q1516_divide_by(&divider, input_a[i]));
+    BENCH_BATCH("q1516_divide_by_n", q1516_divide_by_n(output, input_a, &divider, BENCH_SAMPLES));
+}
+
+static void bench_rounding(void) {
+    begin_group("rounding", "Rounding arithmetic");
+    BENCH_LOOP("q1516_multiply_round", output, q1516_multiply_round(input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_multiply_round_even", output, q1516_multiply_round_even(input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_multiply_rounded", output,
+               q1516_multiply_rounded(input_a[i], input_b[i], Q1516_ROUND_HALF_EVEN));
+    BENCH_LOOP("q1516_divide_round", output, q1516_divide_round(input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_divide_round_even", output, q1516_divide_round_even(input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_divide_rounded", output,
+               q1516_divide_rounded(input_a[i], input_b[i], Q1516_ROUND_HALF_EVEN));
+    BENCH_LOOP("q1516_mac", output_acc, q1516_mac((q1516_acc_t)input_b[i] << 16, input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_acc_round", output,
+               q1516_acc_round((q1516_acc_t)input_a[i] * input_b[i], Q1516_ROUND_NEAREST));
+}
+
+static void bench_saturating(void) {
+    begin_group("saturating", "Saturating arithmetic");
+    BENCH_LOOP("q1516_saturate_raw", output, q1516_saturate_raw((int64_t)input_a[i] * 1024));
+    BENCH_LOOP("q1516_add_sat", output, q1516_add_sat(input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_sub_sat", output, q1516_sub_sat(input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_mul_sat", output, q1516_mul_sat(input_a[i], input_b[i]));
+    BENCH_LOOP("q1516_div_sat", output, q1516_div_sat(input_a[i], input_b[i]));
+}
+
+static void bench_utilities(void) {
+    begin_group("utilities", "Utilities");
+    BENCH_LOOP("q1516_abs", output, q1516_abs(input_a[i]));
+    BENCH_LOOP("q1516_get_integer_part", output_i, q1516_get_integer_part(input_a[i]));
+    BENCH_LOOP("q1516_get_fractional_part", output, q1516_get_fractional_part(input_a[i]));
+    BENCH_LOOP("q1516_approximately_equal", output,
+               q1516_approximately_equal(input_a[i], input_b[i], Q1516_ONE));
+}
+
+// Each fixed-point function next to what it replaces: convert to float,
+// call libm, convert back
+#define VIA_LIBM(fn, x) q1516_from_float(fn(q1516_to_float(x)))
+
+static void bench_math(void) {
+    begin_group("math", "Transcendentals (q1516 vs float libm round trip)");
+    BENCH_LOOP("q1516_sqrt", output, q1516_sqrt(q1516_abs(input_a[i])));
+    BENCH_LOOP("  sqrtf", output, VIA_LIBM(sqrtf, q1516_abs(input_a[i])));
+    BENCH_LOOP("q1516_sin", output, q1516_sin(input_a[i]));
+    BENCH_LOOP("  sinf", output, VIA_LIBM(sinf, input_a[i]));
+    BENCH_LOOP("q1516_cos", output, q1516_cos(input_a[i]));
+    BENCH_LOOP("  cosf", output, VIA_LIBM(cosf, input_a[i]));
+    BENCH_LOOP("q1516_atan2", output, q1516_atan2(input_a[i], input_b[i]));
+    BENCH_LOOP("  atan2f", output, q1516_from_float(atan2f(q1516_to_float(input_a[i]),
+                                                           q1516_to_float(input_b[i]))));
+    BENCH_LOOP("q1516_exp", output, q1516_exp(input_a[i] >> 3));   // [-8, 8)
+    BENCH_LOOP("  expf", output, VIA_LIBM(expf, input_a[i] >> 3));
+    BENCH_LOOP("q1516_log", output, q1516_log(q1516_abs(input_a[i]) | 1));
+    BENCH_LOOP("  logf", output, VIA_LIBM(logf, q1516_abs(input_a[i]) | 1));
+}
+
+static void bench_filter(void) {
+    // The motivating case: a gain + offset stage, one multiply and one add
+    // per sample. Inlined, this loop vectorizes; through the library it cannot.
+    begin_group("filter", "Filter loop (gain * x + offset)");
+    const q1516_t gain = q1516_from_float(0.75f);
+    const q1516_t offset = q1516_from_float(0.125f);
+    BENCH_LOOP("multiply + add", output, q1516_add(q1516_multiply(input_a[i], gain), offset));
+    BENCH_LOOP("  float multiply + add", output_f, input_f[i] * 0.75f + 0.125f);
+}
+
+// Batch kernel names carry the ISA so every result has a unique name
+#define BENCH_BATCH_ISA(kernel, CALL) do { \
+    char name[48]; \
+    snprintf(name, sizeof name, "%s [%s]", kernel, isa_name); \
+    BENCH_BATCH(name, CALL); \
+} while (0)
+
+static void bench_batch(void) {
+    q1516_isa_t best = q1516_batch_isa();
+    for (int isa = Q1516_ISA_SCALAR; isa <= (int)best; isa++) {
+        const char* isa_name = q1516_isa_name((q1516_isa_t)isa);
+        char title[64];
+        q1516_batch_set_isa((q1516_isa_t)isa);
+        snprintf(title, sizeof title, "Batch kernels (%s, per element)", isa_name);
+        begin_group("batch", title);
+        BENCH_BATCH_ISA("q1516_add_n", q1516_add_n(output, input_a, input_b, BENCH_SAMPLES));
+        BENCH_BATCH_ISA("q1516_mul_n", q1516_mul_n(output, input_a, input_b, BENCH_SAMPLES));
+        BENCH_BATCH_ISA("q1516_mac_n", q1516_mac_n(output, input_a, input_b, BENCH_SAMPLES));
+        BENCH_BATCH_ISA("q1516_dot", output[0] = q1516_dot(input_a, input_b, BENCH_SAMPLES));
+        BENCH_BATCH_ISA("q1516_add_sat_n", q1516_add_sat_n(output, input_a, input_b, BENCH_SAMPLES));
+        BENCH_BATCH_ISA("q1516_sub_sat_n", q1516_sub_sat_n(output, input_a, input_b, BENCH_SAMPLES));
+        BENCH_BATCH_ISA("q1516_mul_sat_n", q1516_mul_sat_n(output, input_a, input_b, BENCH_SAMPLES));
+        BENCH_BATCH_ISA("q1516_from_float_n", q1516_from_float_n(output, input_f, BENCH_SAMPLES));
+        BENCH_BATCH_ISA("q1516_to_float_n", q1516_to_float_n(output_f, input_a, BENCH_SAMPLES));
+    }
+    q1516_batch_set_isa(best);
+
+    begin_group("batch", "Batch transcendentals (per element)");
+    BENCH_BATCH("q1516_sqrt_n", q1516_sqrt_n(output, input_b, BENCH_SAMPLES));
+    BENCH_BATCH("q1516_sin_n", q1516_sin_n(output, input_a, BENCH_SAMPLES));
+    BENCH_BATCH("q1516_cos_n", q1516_cos_n(output, input_a, BENCH_SAMPLES));
+    BENCH_BATCH("q1516_exp_n", q1516_exp_n(output, input_b, BENCH_SAMPLES));
+    BENCH_BATCH("q1516_log_n", q1516_log_n(output, input_b, BENCH_SAMPLES));
+    BENCH_BATCH("q1516_atan2_n", q1516_atan2_n(output, input_a, input_b, BENCH_SAMPLES));
+}
+
+// Float versions of the q1516_dsp.h filters, written the obvious way
+#define BENCH_FIR_TAPS 32
+#define BENCH_BIQUAD_STAGES 4
+#define BENCH_AVERAGE_LENGTH 16
+
+typedef struct {
+    float coeffs[BENCH_FIR_TAPS];
+    float history[BENCH_FIR_TAPS];      // Circular, newest at pos
+    int pos;
+} fir_float_t;
+
+static void fir_float_process(fir_float_t* fir, float* out, const float* in, int n) {
+    for (int i = 0; i < n; i++) {
+        fir->pos = (fir->pos + 1) % BENCH_FIR_TAPS;
+        fir->history[fir->pos] = in[i];
+        float acc = 0.0f;
+        int j = fir->pos;
+        for (int k = 0; k < BENCH_FIR_TAPS; k++) {
+            acc += fir->coeffs[k] * fir->history[j];
+            j = (j == 0) ? BENCH_FIR_TAPS - 1 : j - 1;
+        }
+        out[i] = acc;
+    }
+}
+
+static void biquad_float_process(const float (*coeffs)[5], float (*state)[4], float* out, const float* in, int n) {
+    for (int s = 0; s < BENCH_BIQUAD_STAGES; s++) {
+        const float* c = coeffs[s];
+        float x1 = state[s][0], x2 = state[s][1], y1 = state[s][2], y2 = state[s][3];
+        const float* src = (s == 0) ? in : out;
+        for (int i = 0; i < n; i++) {
+            float x0 = src[i];
+            float y0 = c[0] * x0 + c[1] * x1 + c[2] * x2 - c[3] * y1 - c[4] * y2;
+            x2 = x1; x1 = x0; y2 = y1; y1 = y0;
+            out[i] = y0;
+        }
+        state[s][0] = x1; state[s][1] = x2; state[s][2] = y1; state[s][3] = y2;
+    }
+}
+
+static void moving_average_float_process(float* window, float* sum, int* pos, float* out, const float* in, int n) {
+    for (int i = 0; i < n; i++) {
+        *sum += in[i] - window[*pos];
+        window[*pos] = in[i];
+        *pos = (*pos + 1) % BENCH_AVERAGE_LENGTH;
+        out[i] = *sum * (1.0f / BENCH_AVERAGE_LENGTH);
+    }
+}
+
+static const bench_result_t* find_result(const char* name) {
+    for (int i = 0; i < result_count; i++) {
+        if (strcmp(results[i].name, name) == 0) return &results[i];
+    }
+    return NULL;
+}
+
+static void print_throughput(const char* label, const char* fixed_name, const char* float_name) {
+    const bench_result_t* fixed = find_result(fixed_name);
+    const bench_result_t* flt = find_result(float_name);
+    if (fixed == NULL || flt == NULL) return;
+    printf("  %-32s %8.1f Msamples/s (float %.1f, %.2fx)\n", label, 1e3 / fixed->ns_mean,
+           1e3 / flt->ns_mean, flt->ns_mean / fixed->ns_mean);
+}
+
+static void bench_dsp(void) {
+    static q1516_t fir_state[Q1516_FIR_STATE_SIZE(BENCH_FIR_TAPS)];
+    static q1516_t biquad_state[Q1516_BIQUAD_STATE_SIZE(BENCH_BIQUAD_STAGES)];
+    static q1516_t average_window[BENCH_AVERAGE_LENGTH];
+    static fir_float_t fir_f;
+    static float biquad_state_f[BENCH_BIQUAD_STAGES][4];
+    static float average_window_f[BENCH_AVERAGE_LENGTH];
+    float average_sum_f = 0.0f;
+    int average_pos_f = 0;
+
+    // Windowed-sinc-ish low-pass taps summing to about 1
+    q1516_t fir_coeffs[BENCH_FIR_TAPS];
+    for (int k = 0; k < BENCH_FIR_TAPS; k++) {
+        double t = k - (BENCH_FIR_TAPS - 1) / 2.0;
+        double h = (0.54 - 0.46 * cos(6.283185307179586 * k / (BENCH_FIR_TAPS - 1))) *
+                   (t == 0.0 ? 0.25 : sin(0.25 * 3.141592653589793 * t) / (3.141592653589793 * t));
+        fir_coeffs[k] = q1516_from_double(h);
+        fir_f.coeffs[k] = (float)h;
+    }
+    // Four copies of a Butterworth low-pass section at fs/20
+    q1516_biquad_coeffs_t sections[BENCH_BIQUAD_STAGES];
+    float sections_f[BENCH_BIQUAD_STAGES][5];
+    const double lowpass[5] = {0.020083365564, 0.040166731128, 0.020083365564, -1.561018075801, 0.641351538058};
+    for (int s = 0; s < BENCH_BIQUAD_STAGES; s++) {
+        q1516_biquad_coeffs_t c = {Q1516_BIQUAD_COEFF(lowpass[0]), Q1516_BIQUAD_COEFF(lowpass[1]),
+                                   Q1516_BIQUAD_COEFF(lowpass[2]), Q1516_BIQUAD_COEFF(lowpass[3]),
+                                   Q1516_BIQUAD_COEFF(lowpass[4])};
+        sections[s] = c;
+        for (int j = 0; j < 5; j++) sections_f[s][j] = (float)lowpass[j];
+    }
+
+    q1516_fir_t fir;
+    q1516_biquad_t biquad;
+    q1516_moving_average_t average;
+    q1516_fir_init(&fir, fir_coeffs, BENCH_FIR_TAPS, fir_state);
+    q1516_biquad_init(&biquad, sections, BENCH_BIQUAD_STAGES, biquad_state);
+    q1516_moving_average_init(&average, average_window, BENCH_AVERAGE_LENGTH);
+
+    begin_group("dsp", "DSP filters (per sample, float reference below each)");
+    BENCH_BATCH("q1516_fir_process (32 taps)", q1516_fir_process(&fir, output, input_a, BENCH_SAMPLES));
+    BENCH_RUN("  float FIR (32 taps)", BENCH_SAMPLES,
+              fir_float_process(&fir_f, output_f, input_f, BENCH_SAMPLES);
+              checksum += (int64_t)output_f[round & (BENCH_SAMPLES - 1)]);
+    BENCH_BATCH("q1516_biquad_process (4 stages)", q1516_biquad_process(&biquad, output, input_a, BENCH_SAMPLES));
+    BENCH_RUN("  float biquad (4 stages)", BENCH_SAMPLES,
+              biquad_float_process((const float (*)[5])sections_f, biquad_state_f, output_f, input_f, BENCH_SAMPLES);
+              checksum += (int64_t)output_f[round & (BENCH_SAMPLES - 1)]);
+    BENCH_BATCH("q1516_moving_average (16)",
+                q1516_moving_average_process(&average, output, input_a, BENCH_SAMPLES));
+    BENCH_RUN("  float moving average (16)", BENCH_SAMPLES,
+              moving_average_float_process(average_window_f, &average_sum_f, &average_pos_f, output_f, input_f,
+                                           BENCH_SAMPLES);
+              checksum += (int64_t)output_f[round & (BENCH_SAMPLES - 1)]);
+
+    printf("\n");
+    print_throughput("FIR, 32 taps", "q1516_fir_process (32 taps)", "  float FIR (32 taps)");
+    print_throughput("biquad, 4 stages", "q1516_biquad_process (4 stages)", "  float biquad (4 stages)");
+    print_throughput("moving average, 16", "q1516_moving_average (16)", "  float moving average (16)");
+}
+
+// Float radix-2 FFT with a precomputed table, the baseline q1516_fft replaces
+#define BENCH_FFT_MAX 4096
+
+typedef struct {
+    float re, im;
+} complex_float_t;
+
+static void fft_float_forward(complex_float_t* data, const complex_float_t* twiddles, int n) {
+    for (int i = 1, j = 0; i < n; i++) {
+        int bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j |= bit;
+        if (i < j) {
+            complex_float_t swap = data[i];
+            data[i] = data[j];
+            data[j] = swap;
+        }
+    }
+    for (int length = 2; length <= n; length <<= 1) {
+        int half = length / 2, stride = n / length;
+        for (int group = 0; group < n; group += length) {
+            for (int k = 0; k < half; k++) {
+                complex_float_t w = twiddles[k * stride];
+                complex_float_t* a = &data[group + k];
+                complex_float_t* b = &data[group + k + half];
+                float re = b->re * w.re - b->im * w.im;
+                float im = b->re * w.im + b->im * w.re;
+                b->re = a->re - re;
+                b->im = a->im - im;
+                a->re += re;
+                a->im += im;
+            }
+        }
+    }
+}
+
+static void bench_fft(void) {
+    static q1516_twiddle_t twiddles[Q1516_FFT_TWIDDLE_SIZE(BENCH_FFT_MAX)];
+    static complex_float_t twiddles_f[BENCH_FFT_MAX / 2];
+    static q1516_complex_t signal[BENCH_FFT_MAX], data[BENCH_FFT_MAX];
+    static complex_float_t signal_f[BENCH_FFT_MAX], data_f[BENCH_FFT_MAX];
+    static const int sizes[3] = {256, 1024, 4096};
+
+    for (int i = 0; i < BENCH_FFT_MAX; i++) {
+        signal[i].re = input_a[i];
+        signal[i].im = input_b[i];
+        signal_f[i].re = q1516_to_float(input_a[i]);
+        signal_f[i].im = q1516_to_float(input_b[i]);
+    }
+
+    // Each pass copies the input back first, so every transform sees the same data
+    begin_group("fft", "FFT (per point, copy-in included; float radix-2 reference below each)");
+    q1516_isa_t best = q1516_batch_isa();
+    for (int s = 0; s < 3; s++) {
+        int n = sizes[s];
+        char name[48], label[48], fixed_name[48], float_name[48];
+        q1516_fft_t fft;
+        q1516_fft_init(&fft, (size_t)n, twiddles);
+        for (int k = 0; k < n / 2; k++) {
+            twiddles_f[k].re = (float)cos(6.283185307179586 * k / n);
+            twiddles_f[k].im = (float)-sin(6.283185307179586 * k / n);
+        }
+
+        snprintf(fixed_name, sizeof fixed_name, "q1516_fft_forward %d FIXED", n);
+        BENCH_RUN(fixed_name, n,
+                  memcpy(data, signal, (size_t)n * sizeof data[0]);
+                  q1516_fft_forward(&fft, data, Q1516_FFT_SCALE_FIXED);
+                  checksum += data[round & (n - 1)].re);
+        snprintf(name, sizeof name, "q1516_fft_forward %d DYNAMIC", n);
+        BENCH_RUN(name, n,
+                  memcpy(data, signal, (size_t)n * sizeof data[0]);
+                  checksum += q1516_fft_forward(&fft, data, Q1516_FFT_SCALE_DYNAMIC);
+                  checksum += data[round & (n - 1)].re);
+        snprintf(name, sizeof name, "q1516_fft_inverse %d FIXED", n);
+        BENCH_RUN(name, n,
+                  memcpy(data, signal, (size_t)n * sizeof data[0]);
+                  q1516_fft_inverse(&fft, data, Q1516_FFT_SCALE_FIXED);
+                  checksum += data[round & (n - 1)].re);
+        if (best != Q1516_ISA_SCALAR) {
+            q1516_batch_set_isa(Q1516_ISA_SCALAR);
+            snprintf(name, sizeof name, "q1516_fft_forward %d (scalar)", n);
+            BENCH_RUN(name, n,
+                      memcpy(data, signal, (size_t)n * sizeof data[0]);
+                      q1516_fft_forward(&fft, data, Q1516_FFT_SCALE_FIXED);
+                      checksum += data[round & (n - 1)].re);
+            q1516_batch_set_isa(best);
+        }
+        snprintf(float_name, sizeof float_name, "  float FFT %d", n);
+        BENCH_RUN(float_name, n,
+                  memcpy(data_f, signal_f, (size_t)n * sizeof data_f[0]);
+                  fft_float_forward(data_f, twiddles_f, n);
+                  checksum += (int64_t)data_f[round & (n - 1)].re);
+
+        const bench_result_t* fixed = find_result(fixed_name);
+        const bench_result_t* flt = find_result(float_name);
+        if (fixed != NULL && flt != NULL) {
+            snprintf(label, sizeof label, "FFT %d", n);
+            printf("  %-32s %8.2f us/transform (float %.2f, %.2fx)\n", label, fixed->ns_mean * n / 1e3,
+                   flt->ns_mean * n / 1e3, flt->ns_mean / fixed->ns_mean);
+        }
+    }
+}
+
+// Matrix products are timed per multiply-add. The nested loops below are
+// what the library replaces: one q1516_multiply + q1516_add per term.
+#define BENCH_MATRIX_MAX 256
+#define BENCH_MATRIX_ROUNDS 4   // Large products: a few per repetition
+
+static void mat_mul_nested(q1516_t* c, const q1516_t* a, const q1516_t* b, int m, int k, int n) {
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) {
+            q1516_t sum = 0;
+            for (int p = 0; p < k; p++) sum = q1516_add(sum, q1516_multiply(a[i * k + p], b[p * n + j]));
+            c[i * n + j] = sum;
+        }
+    }
+}
+
+static void mat_mul_float(float* c, const float* a, const float* b, int m, int k, int n) {
+    for (int i = 0; i < m; i++) {
+        for (int j = 0; j < n; j++) c[i * n + j] = 0.0f;
+        for (int p = 0; p < k; p++) {
+            float x = a[i * k + p];
+            for (int j = 0; j < n; j++) c[i * n + j] += x * b[p * n + j];
+        }
+    }
+}
+
+static void bench_matrix(void) {
+    enum { SIZE = BENCH_MATRIX_MAX, COUNT = SIZE * SIZE };
+    static q1516_t a[COUNT], b[COUNT], c[COUNT];
+    static float a_f[COUNT], b_f[COUNT], c_f[COUNT];
+    for (int i = 0; i < COUNT; i++) {
+        a[i] = input_a[i & (BENCH_SAMPLES - 1)] >> 6;   // |x| < 1: products of 256 terms stay in range
+        b[i] = input_b[(i * 7) & (BENCH_SAMPLES - 1)] >> 6;
+        a_f[i] = q1516_to_float(a[i]);
+        b_f[i] = q1516_to_float(b[i]);
+    }
+
+    begin_group("matrix", "Matrix kernels (per multiply-add; nested q1516_multiply/add and float below each)");
+
+    // Small matrices: a whole array of them per pass, like a bank of filters
+    BENCH_RUN("q1516_mat4_mul", BENCH_SAMPLES / 16 * 64,
+              for (int i = 0; i + 16 <= BENCH_SAMPLES; i += 16) q1516_mat4_mul(output + i, input_a + i, input_b + i);
+              checksum += output[round & (BENCH_SAMPLES - 1)]);
+    BENCH_RUN("  nested q1516_multiply 4x4", BENCH_SAMPLES / 16 * 64,
+              for (int i = 0; i + 16 <= BENCH_SAMPLES; i += 16) mat_mul_nested(output + i, input_a + i, input_b + i, 4, 4, 4);
+              checksum += output[round & (BENCH_SAMPLES - 1)]);
+    BENCH_RUN("q1516_mat8_mul", BENCH_SAMPLES / 64 * 512,
+              for (int i = 0; i + 64 <= BENCH_SAMPLES; i += 64) q1516_mat8_mul(output + i, input_a + i, input_b + i);
+              checksum += output[round & (BENCH_SAMPLES - 1)]);
+    BENCH_RUN("  nested q1516_multiply 8x8", BENCH_SAMPLES / 64 * 512,
+              for (int i = 0; i + 64 <= BENCH_SAMPLES; i += 64) mat_mul_nested(output + i, input_a + i, input_b + i, 8, 8, 8);
+              checksum += output[round & (BENCH_SAMPLES - 1)]);
+    BENCH_RUN("q1516_mat8_vec", BENCH_SAMPLES / 64 * 64,
+              for (int i = 0; i + 64 <= BENCH_SAMPLES; i += 64) q1516_mat8_vec(output + i, input_a + i, input_b + i);
+              checksum += output[round & (BENCH_SAMPLES - 1)]);
+
+    // 64x64 fits in cache; 256x256 does not
+    BENCH_RUN("q1516_mat_mul 64", 64 * 64 * 64,
+              q1516_mat_mul(c, a, b, 64, 64, 64);
+              checksum += c[round & 4095]);
+    BENCH_RUN("  float mat_mul 64", 64 * 64 * 64,
+              mat_mul_float(c_f, a_f, b_f, 64, 64, 64);
+              checksum += (int64_t)c_f[round & 4095]);
+    BENCH_RUN("q1516_mat_vec 256", COUNT,
+              q1516_mat_vec(c, a, b, SIZE, SIZE);
+              checksum += c[round & (SIZE - 1)]);
+
+    BENCH_RUN_ROUNDS("q1516_mat_mul 256", COUNT * SIZE, BENCH_MATRIX_ROUNDS,
+                     q1516_mat_mul(c, a, b, SIZE, SIZE, SIZE);
+                     checksum += c[round]);
+    q1516_isa_t best = q1516_batch_isa();
+    if (best != Q1516_ISA_SCALAR) {
+        q1516_batch_set_isa(Q1516_ISA_SCALAR);
+        BENCH_RUN_ROUNDS("q1516_mat_mul 256 (scalar)", COUNT * SIZE, BENCH_MATRIX_ROUNDS,
+                         q1516_mat_mul(c, a, b, SIZE, SIZE, SIZE);
+                         checksum += c[round]);
+        q1516_batch_set_isa(best);
+    }
+    int threads = 1;
+    BENCH_RUN_ROUNDS("q1516_mat_mul_parallel 256", COUNT * SIZE, BENCH_MATRIX_ROUNDS,
+                     threads = q1516_mat_mul_parallel(c, a, b, SIZE, SIZE, SIZE, 0);
+                     checksum += c[round]);
+    BENCH_RUN_ROUNDS("  nested q1516_multiply 256", COUNT * SIZE, BENCH_MATRIX_ROUNDS,
+                     mat_mul_nested(c, a, b, SIZE, SIZE, SIZE);
+                     checksum += c[round]);
+    BENCH_RUN_ROUNDS("  float mat_mul 256", COUNT * SIZE, BENCH_MATRIX_ROUNDS,
+                     mat_mul_float(c_f, a_f, b_f, SIZE, SIZE, SIZE);
+                     checksum += (int64_t)c_f[round]);
+
+    printf("\n");
+    const bench_result_t* lib = find_result("q1516_mat_mul 256");
+    const bench_result_t* parallel = find_result("q1516_mat_mul_parallel 256");
+    const bench_result_t* nested = find_result("  nested q1516_multiply 256");
+    const bench_result_t* flt = find_result("  float mat_mul 256");
+    if (lib != NULL && nested != NULL && flt != NULL) {
+        printf("  %-32s %8.2f GMAC/s (nested loops %.2f, float %.2f)\n", "mat_mul 256x256", 1.0 / lib->ns_mean,
+               1.0 / nested->ns_mean, 1.0 / flt->ns_mean);
+    }
+    if (lib != NULL && parallel != NULL) {
+        printf("  %-32s %8.2f GMAC/s on %d thread(s), %.2fx\n", "mat_mul_parallel 256x256",
+               1.0 / parallel->ns_mean, threads, lib->ns_mean / parallel->ns_mean);
+    }
+}
+
+// Decimal text, one value per call, against the libc route the print
+// functions used: snprintf of the float/double, strtod + q1516_from_double
+#define BENCH_TEXT_STRIDE 24
+
+static void bench_chars(void) {
+    static char texts[BENCH_SAMPLES][BENCH_TEXT_STRIDE];
+    static size_t lengths[BENCH_SAMPLES];
+    char buf[64];
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        lengths[i] = q1516_to_chars(texts[i], BENCH_TEXT_STRIDE, input_a[i]);
+    }
+
+    begin_group("chars", "Decimal text (per value; snprintf / strtod below each)");
+    BENCH_RUN("q1516_to_chars (exact)", BENCH_SAMPLES,
+              for (int i = 0; i < BENCH_SAMPLES; i++) checksum += (int64_t)q1516_to_chars(buf, sizeof buf, input_a[i]));
+    BENCH_RUN("  snprintf %.16f (exact)", BENCH_SAMPLES,
+              for (int i = 0; i < BENCH_SAMPLES; i++) checksum += snprintf(buf, sizeof buf, "%.16f", q1516_to_double(input_a[i])));
+    BENCH_RUN("q1516_to_chars_fixed (6)", BENCH_SAMPLES,
+              for (int i = 0; i < BENCH_SAMPLES; i++) checksum += (int64_t)q1516_to_chars_fixed(buf, sizeof buf, input_a[i], 6));
+    BENCH_RUN("  snprintf %.6f of to_float", BENCH_SAMPLES,
+              for (int i = 0; i < BENCH_SAMPLES; i++) checksum += snprintf(buf, sizeof buf, "%.6f", q1516_to_float(input_a[i])));
+    BENCH_RUN("q1516_from_chars", BENCH_SAMPLES,
+              for (int i = 0; i < BENCH_SAMPLES; i++) {
+                  q1516_t value = 0;
+                  q1516_from_chars(texts[i], lengths[i], &value);
+                  checksum += value;
+              });
+    BENCH_RUN("  strtod + q1516_from_double", BENCH_SAMPLES,
+              for (int i = 0; i < BENCH_SAMPLES; i++) checksum += q1516_from_double(strtod(texts[i], NULL)));
+
+    printf("\n");
+    static const char* pairs[3][3] = {
+        {"to_chars", "q1516_to_chars (exact)", "  snprintf %.16f (exact)"},
+        {"to_chars_fixed, 6 digits", "q1516_to_chars_fixed (6)", "  snprintf %.6f of to_float"},
+        {"from_chars", "q1516_from_chars", "  strtod + q1516_from_double"},
+    };
+    for (int p = 0; p < 3; p++) {
+        const bench_result_t* lib = find_result(pairs[p][1]);
+        const bench_result_t* libc = find_result(pairs[p][2]);
+        if (lib == NULL || libc == NULL) continue;
+        printf("  %-32s %8.1f Mvalues/s (libc %.1f, %.2fx)\n", pairs[p][0], 1e3 / lib->ns_mean,
+               1e3 / libc->ns_mean, libc->ns_mean / lib->ns_mean);
+    }
+}
+
+// =============================================================================
+// JSON OUTPUT / BASELINE COMPARISON
+// =============================================================================
+
+// One benchmark per line with a fixed key order, so two runs diff line by line
+static int write_json(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return 0;
+    }
+#ifdef Q1516_INLINE
+    const char* mode = "inline";
+#else
+    const char* mode = "library";
+#endif
+    fprintf(file, "{\n  \"suite\": \"q1516\", \"mode\": \"%s\",\n", mode);
+    fprintf(file, "  \"samples\": %d, \"rounds\": %d, \"reps\": %d,\n", BENCH_SAMPLES, BENCH_ROUNDS, BENCH_REPS);
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (int i = 0; i < result_count; i++) {
+        const bench_result_t* r = &results[i];
+        fprintf(file,
+                "    {\"group\": \"%s\", \"name\": \"%s\", \"ns_per_op\": %.4f, \"ns_stddev\": %.4f, "
+                "\"ns_min\": %.4f, \"cycles_per_op\": %.3f, \"ops_per_cycle\": %.4f}%s\n",
+                r->group, r->name, r->ns_mean, r->ns_stddev, r->ns_min, r->cycles,
+                r->cycles > 0 ? 1.0 / r->cycles : 0.0, (i + 1 < result_count) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    printf("\nResults written to %s\n", path);
+    return 1;
+}
+
+// Read back a file written by write_json() and compare the fastest
+// repetition of each benchmark, the least noisy of the figures.
+// Returns the number of benchmarks slower by more than threshold_pct, -1 on error.
+static int compare_baseline(const char* path, double threshold_pct) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Cannot read baseline %s\n", path);
+        return -1;
+    }
+    printf("\nCompared with %s (ns_min, + = slower, threshold %.1f%%):\n", path, threshold_pct);
+
+    int compared = 0, regressions = 0;
+    char line[512];
+    while (fgets(line, sizeof line, file) != NULL) {
+        char* name = strstr(line, "\"name\": \"");
+        char* min = strstr(line, "\"ns_min\": ");
+        if (name == NULL || min == NULL) continue;
+        name += strlen("\"name\": \"");
+        char* name_end = strchr(name, '"');
+        if (name_end == NULL) continue;
+        *name_end = '\0';
+        double old_ns = atof(min + strlen("\"ns_min\": "));
+
+        for (int i = 0; i < result_count; i++) {
+            if (strcmp(results[i].name, name) != 0 || old_ns <= 0) continue;
+            double delta = 100.0 * (results[i].ns_min - old_ns) / old_ns;
+            int regressed = delta > threshold_pct;
+            compared++;
+            regressions += regressed;
+            printf("  %-32s %8.3f -> %8.3f %+7.1f%%%s\n", name, old_ns, results[i].ns_min, delta,
+                   regressed ? "  REGRESSION" : "");
+        }
+    }
+    fclose(file);
+    printf("%d compared, %d regression(s)\n", compared, regressions);
+    return regressions;
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(int argc, char** argv) {
+    const char* json_path = NULL;
+    const char* baseline_path = NULL;
+    double threshold_pct = 10.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            name_filter = argv[++i];
+        } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold_pct = atof(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--filter TEXT] [--json FILE] [--baseline FILE] [--threshold PCT]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+#ifdef Q1516_INLINE
+    printf("Q15.16 benchmark - header-only mode (Q1516_INLINE)\n");
+#else
+    printf("Q15.16 benchmark - library calls (libq1516)\n");
+#endif
+    printf("%d samples x %d rounds, %d repetitions per benchmark\n", BENCH_SAMPLES, BENCH_ROUNDS, BENCH_REPS);
+#ifndef BENCH_HAVE_TSC
+    printf("(no time-stamp counter on this target: cycle columns are n/a)\n");
+#endif
+    printf("\n  %-32s %8s %7s %8s %8s %8s\n", "", "ns/op", "+/-", "min ns", "cyc/op", "ops/cyc");
+
+    fill_inputs();
+    bench_conversions();
+    bench_arithmetic();
+    bench_float_baseline();
+    bench_division();
+    bench_saturating();
+    bench_rounding();
+    bench_utilities();
+    bench_math();
+    bench_filter();
+    bench_batch();
+    bench_dsp();
+    bench_fft();
+    bench_matrix();
+    bench_chars();
+
+    printf("\n(checksum %lld)\n", (long long)checksum);
+
+    if (json_path != NULL && !write_json(json_path)) return 2;
+    if (baseline_path != NULL) {
+        int regressions = compare_baseline(baseline_path, threshold_pct);
+        if (regressions != 0) return regressions < 0 ? 2 : 1;
+    }
+    return 0;
+}
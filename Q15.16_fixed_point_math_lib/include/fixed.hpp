@@ -0,0 +1,294 @@
+#ifndef FIXED_HPP
+#define FIXED_HPP
+
+#include "q1516.h"
+#include <cstdint>
+#include <type_traits>
+
+/*
+ *   @file fixed.hpp
+ *   @brief C++14 generalization of q1516_t: fixed<IntBits, FracBits, Storage, Overflow>
+ *
+ *   IntBits counts integer bits *excluding* the sign bit, the same way
+ *   "Q15.16" is read for q1516_t: fixed<15, 16> is 1 + 15 + 16 = 32 bits.
+ *   The DSP format usually called Q1.15 (sign + 15 fraction bits, [-1, 1))
+ *   is therefore fixed<0, 15, int16_t>; see the aliases at the end.
+ *
+ *   Every operation is constexpr and is the same integer expression you
+ *   would write by hand (add, multiply in the wider type then >> FracBits,
+ *   ...), so fixed<15, 16> compiles to the same instructions as the inline
+ *   q1516 functions and produces the same bits.
+ *
+ *   The overflow policy is a template parameter:
+ *   - overflow::wrap      two's complement wrap-around (q1516_add, q1516_multiply)
+ *   - overflow::saturate  clamp to the format's range (q1516_add_sat, q1516_mul_sat)
+ *
+ *   64-bit storage needs a 128-bit intermediate (__int128, GCC/Clang).
+ */
+
+namespace fixed_point {
+
+namespace detail {
+
+// Type twice as wide as Storage, for products and shifted dividends
+template <class T> struct wider;
+template <> struct wider<int8_t>  { using type = int16_t; };
+template <> struct wider<int16_t> { using type = int32_t; };
+template <> struct wider<int32_t> { using type = int64_t; };
+#if defined(__SIZEOF_INT128__)
+template <> struct wider<int64_t> { using type = __int128; };
+#endif
+template <class T> using wider_t = typename wider<T>::type;
+
+// Smallest standard signed type with at least `Bits` bits
+template <int Bits>
+using storage_for = typename std::conditional<(Bits <= 8), int8_t,
+                    typename std::conditional<(Bits <= 16), int16_t,
+                    typename std::conditional<(Bits <= 32), int32_t, int64_t>::type>::type>::type;
+
+// Larger of two storage types
+template <class A, class B>
+using larger_t = typename std::conditional<(sizeof(A) >= sizeof(B)), A, B>::type;
+
+// value * 2^shift without left-shifting a negative number (undefined
+// before C++20 and rejected in constant expressions)
+template <class T>
+constexpr T scale_up(T value, int shift) {
+    return value * (static_cast<T>(1) << shift);
+}
+
+} // namespace detail
+
+// =============================================================================
+// OVERFLOW POLICIES
+// =============================================================================
+
+namespace overflow {
+
+// Keep the low Bits bits and sign-extend: what a plain cast does when the
+// format fills its storage type exactly
+struct wrap {
+    template <class Storage, int Bits, class Wide>
+    static constexpr Storage apply(Wide value) {
+        const uint64_t sign = uint64_t(1) << (Bits - 1);
+        uint64_t bits = static_cast<uint64_t>(value) & ((sign << 1) - 1);
+        return static_cast<Storage>(static_cast<int64_t>((bits ^ sign) - sign));
+    }
+};
+
+// Clamp to [lowest, highest] of the format
+struct saturate {
+    template <class Storage, int Bits, class Wide>
+    static constexpr Storage apply(Wide value) {
+        const Wide highest = static_cast<Wide>((uint64_t(1) << (Bits - 1)) - 1);
+        const Wide lowest = -highest - 1;
+        return static_cast<Storage>(value > highest ? highest : (value < lowest ? lowest : value));
+    }
+};
+
+} // namespace overflow
+
+// =============================================================================
+// FIXED-POINT TYPE
+// =============================================================================
+
+template <int IntBits, int FracBits,
+          class Storage = detail::storage_for<IntBits + FracBits + 1>,
+          class Overflow = overflow::wrap>
+class fixed {
+    static_assert(std::is_integral<Storage>::value && std::is_signed<Storage>::value,
+                  "Storage must be a signed integer type");
+    static_assert(IntBits >= 0 && FracBits >= 0, "bit counts cannot be negative");
+    static_assert(IntBits + FracBits + 1 <= int(sizeof(Storage) * 8),
+                  "sign + IntBits + FracBits must fit in Storage");
+
+public:
+    using storage_type = Storage;
+    using wide_type = detail::wider_t<Storage>;
+    using overflow_policy = Overflow;
+
+    static constexpr int integer_bits = IntBits;
+    static constexpr int fractional_bits = FracBits;
+    static constexpr int total_bits = IntBits + FracBits + 1;
+
+    // ---- Construction -------------------------------------------------------
+
+    constexpr fixed() : raw_(0) {}
+
+    // From an integer (implicit, like q1516_from_int); out-of-range values
+    // go through the overflow policy
+    template <class Int, typename std::enable_if<std::is_integral<Int>::value, int>::type = 0>
+    constexpr fixed(Int value)
+        : raw_(narrow(detail::scale_up(static_cast<wide_type>(value), FracBits))) {}
+
+    // From a floating-point value, rounded to nearest. Out-of-range values
+    // saturate whatever the policy (wrapping a double has no useful meaning)
+    explicit constexpr fixed(double value) : raw_(from_double(value)) {}
+
+    // Between formats: implicit when no bits can be lost, explicit otherwise.
+    // Dropping fractional bits floors (arithmetic shift), like q1516_multiply;
+    // integer overflow goes through this type's policy.
+    template <int I2, int F2, class S2, class O2,
+              typename std::enable_if<(I2 <= IntBits && F2 <= FracBits), int>::type = 0>
+    constexpr fixed(fixed<I2, F2, S2, O2> other) : raw_(convert_raw<F2, S2>(other.raw())) {}
+
+    template <int I2, int F2, class S2, class O2,
+              typename std::enable_if<!(I2 <= IntBits && F2 <= FracBits), int>::type = 0>
+    explicit constexpr fixed(fixed<I2, F2, S2, O2> other) : raw_(convert_raw<F2, S2>(other.raw())) {}
+
+    static constexpr fixed from_raw(Storage raw) {
+        fixed result;
+        result.raw_ = raw;
+        return result;
+    }
+
+    static constexpr fixed highest() { return from_raw(raw_highest()); }
+    static constexpr fixed lowest() { return from_raw(static_cast<Storage>(-raw_highest() - 1)); }
+    static constexpr fixed epsilon() { return from_raw(1); }
+
+    // ---- Access -------------------------------------------------------------
+
+    constexpr Storage raw() const { return raw_; }
+
+    // Integer part, rounded toward -infinity (same as q1516_to_int)
+    constexpr Storage to_int() const { return static_cast<Storage>(raw_ >> FracBits); }
+
+    constexpr double to_double() const {
+        return static_cast<double>(raw_) / static_cast<double>(detail::scale_up<wide_type>(1, FracBits));
+    }
+
+    explicit constexpr operator double() const { return to_double(); }
+
+    // ---- Arithmetic ---------------------------------------------------------
+
+    friend constexpr fixed operator+(fixed a, fixed b) {
+        return from_raw(narrow(static_cast<wide_type>(a.raw_) + b.raw_));
+    }
+
+    friend constexpr fixed operator-(fixed a, fixed b) {
+        return from_raw(narrow(static_cast<wide_type>(a.raw_) - b.raw_));
+    }
+
+    friend constexpr fixed operator-(fixed a) {
+        return from_raw(narrow(-static_cast<wide_type>(a.raw_)));
+    }
+
+    // Product in the wide type, then >> FracBits (floor)
+    friend constexpr fixed operator*(fixed a, fixed b) {
+        return from_raw(narrow((static_cast<wide_type>(a.raw_) * b.raw_) >> FracBits));
+    }
+
+    // Truncates toward zero; division by zero gives highest()/lowest() by the
+    // dividend's sign, as q1516_divide does
+    friend constexpr fixed operator/(fixed a, fixed b) {
+        return b.raw_ == 0 ? (a.raw_ >= 0 ? highest() : lowest())
+                           : from_raw(narrow(detail::scale_up(static_cast<wide_type>(a.raw_), FracBits) / b.raw_));
+    }
+
+    constexpr fixed& operator+=(fixed other) { return *this = *this + other; }
+    constexpr fixed& operator-=(fixed other) { return *this = *this - other; }
+    constexpr fixed& operator*=(fixed other) { return *this = *this * other; }
+    constexpr fixed& operator/=(fixed other) { return *this = *this / other; }
+
+    // ---- Comparison ---------------------------------------------------------
+
+    friend constexpr bool operator==(fixed a, fixed b) { return a.raw_ == b.raw_; }
+    friend constexpr bool operator!=(fixed a, fixed b) { return a.raw_ != b.raw_; }
+    friend constexpr bool operator<(fixed a, fixed b) { return a.raw_ < b.raw_; }
+    friend constexpr bool operator<=(fixed a, fixed b) { return a.raw_ <= b.raw_; }
+    friend constexpr bool operator>(fixed a, fixed b) { return a.raw_ > b.raw_; }
+    friend constexpr bool operator>=(fixed a, fixed b) { return a.raw_ >= b.raw_; }
+
+private:
+    Storage raw_;
+
+    static constexpr Storage raw_highest() {
+        return static_cast<Storage>((uint64_t(1) << (total_bits - 1)) - 1);
+    }
+
+    template <class Wide>
+    static constexpr Storage narrow(Wide value) {
+        return Overflow::template apply<Storage, total_bits>(value);
+    }
+
+    // Same steps as q1516_from_double: NaN -> 0, saturate, round half to even.
+    // Range checks come first, casting NaN or an out-of-range double is undefined.
+    static constexpr Storage from_double(double value) {
+        const double scaled = value * static_cast<double>(detail::scale_up<wide_type>(1, FracBits));
+        if (scaled != scaled) {
+            return 0;
+        }
+        // +-0.5 is lost for 64-bit storage, where every double that close is an integer anyway
+        if (scaled >= static_cast<double>(raw_highest()) + 0.5) {
+            return raw_highest();
+        }
+        if (scaled <= -static_cast<double>(raw_highest()) - 1.5) {
+            return static_cast<Storage>(-raw_highest() - 1);
+        }
+        int64_t whole = static_cast<int64_t>(scaled);           // toward zero
+        const double rest = scaled - static_cast<double>(whole);  // exact, in (-1, 1)
+        if (rest > 0.5 || (rest == 0.5 && (whole & 1))) {
+            whole++;
+        } else if (rest < -0.5 || (rest == -0.5 && (whole & 1))) {
+            whole--;
+        }
+        return static_cast<Storage>(whole);
+    }
+
+    // Re-scale a raw value from F2 fractional bits to FracBits
+    template <int F2, class S2>
+    static constexpr Storage convert_raw(S2 raw) {
+        using wide = detail::wider_t<detail::larger_t<Storage, S2>>;
+        return narrow(FracBits >= F2 ? detail::scale_up(static_cast<wide>(raw), FracBits - F2)
+                                     : static_cast<wide>(raw) >> (F2 - FracBits));
+    }
+};
+
+/*
+ * @brief Same format as F with another overflow policy
+ */
+template <class F, class Policy>
+using with_overflow = fixed<F::integer_bits, F::fractional_bits, typename F::storage_type, Policy>;
+
+/*
+ * @brief Explicit conversion to another format (fixed_cast<q7_24>(x))
+ */
+template <class To, int I, int F, class S, class O>
+constexpr To fixed_cast(fixed<I, F, S, O> value) {
+    return To(value);
+}
+
+// =============================================================================
+// COMMON FORMATS
+// =============================================================================
+
+using q1_15  = fixed<0, 15, int16_t>;    // [-1, 1), 2^-15 steps ("Q15" in DSP libraries)
+using q7_24  = fixed<7, 24, int32_t>;    // [-128, 128), 2^-24 steps
+using q15_16 = fixed<15, 16, int32_t>;   // Bit-identical to q1516_t
+using q31_32 = fixed<31, 32, int64_t>;   // [-2^31, 2^31), 2^-32 steps (needs __int128)
+
+using q15_16_sat = with_overflow<q15_16, overflow::saturate>;
+
+// =============================================================================
+// q1516_t INTEROP
+// =============================================================================
+
+// q15_16 has exactly q1516_t's bits, so existing C code can keep using
+// q1516_t and the q1516_* functions on values that C++ code produces.
+
+constexpr q15_16 from_q1516(q1516_t value) {
+    return q15_16::from_raw(value);
+}
+
+/*
+ * @brief Convert any format to q1516_t (dropping fractional bits floors,
+ *        integer overflow follows q15_16's wrap policy)
+ */
+template <int I, int F, class S, class O>
+constexpr q1516_t to_q1516(fixed<I, F, S, O> value) {
+    return q15_16(value).raw();
+}
+
+} // namespace fixed_point
+
+#endif /* FIXED_HPP */
@@ -31,6 +31,18 @@ extern "C" {        // Tells C++: "don't mangle these function names"
 
 // Create a new type name for clarity and maintainability
 typedef int32_t q1516_t;  // "q1516_t" is more descriptive than "int32_t"
+
+// Wide accumulator for sums of products: raw a * b values with 32
+// fractional bits, kept in 64 bits so a chain of multiply-adds rounds
+// only once, at the end (see q1516_mac / q1516_acc_round)
+typedef int64_t q1516_acc_t;
+
+// How a result with extra fractional bits is brought back to 16 bits
+typedef enum {
+    Q1516_ROUND_FLOOR = 0,   // Toward -infinity (plain >> 16, what q1516_multiply does)
+    Q1516_ROUND_NEAREST,     // To nearest, ties toward +infinity (add 0.5 ULP, then shift)
+    Q1516_ROUND_HALF_EVEN    // To nearest, ties to even (unbiased over long chains)
+} q1516_round_t;
 // =============================================================================
 // CONSTANTS
 // =============================================================================
@@ -47,6 +59,27 @@ typedef int32_t q1516_t;  // "q1516_t" is more descriptive than "int32_t"
 #define Q1516_MAX ((q1516_t)0x7FFFFFFF)
 #define Q1516_MIN ((q1516_t)0x80000000)
 // =============================================================================
+// HEADER-ONLY (INLINE) MODE
+// =============================================================================
+
+// By default every function below is an out-of-line call into libq1516.
+// Define Q1516_INLINE before including this header (or pass -DQ1516_INLINE)
+// to get static inline definitions instead, so hot loops can be inlined and
+// vectorized. C++14 and later also get constexpr versions.
+//
+// Both modes share one implementation (q1516_inline.h), which q1516.c also
+// compiles out-of-line, so the library ABI and results are identical.
+// The debugging functions are always out-of-line: link libq1516 for those.
+#ifdef Q1516_INLINE
+  #if defined(__cplusplus) && __cplusplus >= 201402L
+    #define Q1516_FN static inline constexpr
+  #else
+    #define Q1516_FN static inline
+  #endif
+#else
+  #define Q1516_FN
+#endif
+// =============================================================================
 // FUNCTION DECLARATIONS (not macros!)
 // =============================================================================
 
@@ -61,28 +94,43 @@ typedef int32_t q1516_t;  // "q1516_t" is more descriptive than "int32_t"
  * @param value Integer value to convert
  * @return Q15.16 fixed-point representation
  */
-q1516_t q1516_from_int(int32_t value);
+Q1516_FN q1516_t q1516_from_int(int32_t value);
 
 /*
  * @brief Convert Q15.16 fixed-point to integer (truncated)
  * @param fixed Q15.16 fixed-point value
  * @return Integer part (truncated)
  */
-int32_t q1516_to_int(q1516_t fixed);
+Q1516_FN int32_t q1516_to_int(q1516_t fixed);
+
+/*
+ * @brief Convert double to Q15.16 fixed-point, correctly rounded
+ * @param value Double value to convert
+ * @return Nearest Q15.16 value (ties to even); Q1516_MAX/Q1516_MIN when
+ *         out of range (including +/-infinity), 0 for NaN
+ */
+Q1516_FN q1516_t q1516_from_double(double value);
 
 /*
- * @brief Convert float to Q15.16 fixed-point
+ * @brief Convert float to Q15.16 fixed-point, correctly rounded
  * @param value Float value to convert
- * @return Q15.16 fixed-point representation
+ * @return Same as q1516_from_double(value)
  */
-q1516_t q1516_from_float(float value);
+Q1516_FN q1516_t q1516_from_float(float value);
 
 /*
  * @brief Convert Q15.16 fixed-point to float
  * @param fixed Q15.16 fixed-point value
- * @return Float representation
+ * @return Float representation (rounded to nearest when |fixed| > 2^24 raw)
+ */
+Q1516_FN float q1516_to_float(q1516_t fixed);
+
+/*
+ * @brief Convert Q15.16 fixed-point to double (always exact)
+ * @param fixed Q15.16 fixed-point value
+ * @return Double representation
  */
-float q1516_to_float(q1516_t fixed);
+Q1516_FN double q1516_to_double(q1516_t fixed);
 
 // =============================================================================
 // ARITHMETIC FUNCTIONS - DECLARATIONS ONLY
@@ -94,7 +142,7 @@ float q1516_to_float(q1516_t fixed);
  * @param b Second operand
  * @return Sum of a and b
  */
-q1516_t q1516_add(q1516_t a, q1516_t b);
+Q1516_FN q1516_t q1516_add(q1516_t a, q1516_t b);
 
 /*
  * @brief Subtract two Q15.16 fixed-point numbers
@@ -102,7 +150,7 @@ q1516_t q1516_add(q1516_t a, q1516_t b);
  * @param b Second operand (subtrahend)
  * @return Difference (a - b)
  */
-q1516_t q1516_subtract(q1516_t a, q1516_t b);
+Q1516_FN q1516_t q1516_subtract(q1516_t a, q1516_t b);
 
 /*
  * @brief Multiply two Q15.16 fixed-point numbers
@@ -110,7 +158,7 @@ q1516_t q1516_subtract(q1516_t a, q1516_t b);
  * @param b Second operand
  * @return Product of a and b
  */
-q1516_t q1516_multiply(q1516_t a, q1516_t b);
+Q1516_FN q1516_t q1516_multiply(q1516_t a, q1516_t b);
 
 /*
  * @brief Divide two Q15.16 fixed-point numbers
@@ -118,7 +166,109 @@ q1516_t q1516_multiply(q1516_t a, q1516_t b);
  * @param divisor Divisor (denominator)
  * @return Quotient (dividend / divisor)
  */
-q1516_t q1516_divide(q1516_t dividend, q1516_t divisor);
+Q1516_FN q1516_t q1516_divide(q1516_t dividend, q1516_t divisor);
+
+// =============================================================================
+// ROUNDING ARITHMETIC - DECLARATIONS ONLY
+// =============================================================================
+
+// q1516_multiply and q1516_divide truncate, which biases results downward
+// by half an ULP on average. These variants round instead. Like the plain
+// versions they wrap (not clamp) if the result does not fit.
+
+/*
+ * @brief Multiply, rounding to nearest (ties toward +infinity)
+ * @return a * b
+ */
+Q1516_FN q1516_t q1516_multiply_round(q1516_t a, q1516_t b);
+
+/*
+ * @brief Multiply with an explicit rounding mode
+ * @param mode Q1516_ROUND_FLOOR gives exactly q1516_multiply
+ * @return a * b
+ */
+Q1516_FN q1516_t q1516_multiply_rounded(q1516_t a, q1516_t b, q1516_round_t mode);
+
+/*
+ * @brief Multiply, rounding to nearest with ties to even
+ * @return a * b
+ */
+Q1516_FN q1516_t q1516_multiply_round_even(q1516_t a, q1516_t b);
+
+/*
+ * @brief Divide, rounding to nearest (ties toward +infinity)
+ * @return dividend / divisor; division by zero behaves like q1516_divide
+ */
+Q1516_FN q1516_t q1516_divide_round(q1516_t dividend, q1516_t divisor);
+
+/*
+ * @brief Divide, rounding to nearest with ties to even
+ * @return dividend / divisor; division by zero behaves like q1516_divide
+ */
+Q1516_FN q1516_t q1516_divide_round_even(q1516_t dividend, q1516_t divisor);
+
+/*
+ * @brief Divide with an explicit rounding mode
+ * @param mode Q1516_ROUND_FLOOR rounds toward -infinity
+ *             (q1516_divide itself truncates toward zero)
+ * @return dividend / divisor; division by zero behaves like q1516_divide
+ */
+Q1516_FN q1516_t q1516_divide_rounded(q1516_t dividend, q1516_t divisor, q1516_round_t mode);
+
+/*
+ * @brief Multiply-accumulate into a wide accumulator (no rounding)
+ * @param acc Running sum (start from 0)
+ * @return acc + a * b, exact while the sum fits in 64 bits
+ */
+Q1516_FN q1516_acc_t q1516_mac(q1516_acc_t acc, q1516_t a, q1516_t b);
+
+/*
+ * @brief Round an accumulator back to Q15.16
+ * @param acc Sum built with q1516_mac or q1516_dot_acc
+ * @param mode Rounding mode
+ * @return Rounded value, clamped to [Q1516_MIN, Q1516_MAX]
+ */
+Q1516_FN q1516_t q1516_acc_round(q1516_acc_t acc, q1516_round_t mode);
+
+// =============================================================================
+// SATURATING ARITHMETIC - DECLARATIONS ONLY
+// =============================================================================
+
+// Same operations as above, but results that do not fit clamp to
+// Q1516_MAX / Q1516_MIN instead of wrapping. All are branch-free
+// (mask arithmetic), so they cost a few extra ALU ops and no mispredicts.
+
+/*
+ * @brief Clamp a wide raw value into the Q15.16 range
+ * @param raw Raw value with 16 fractional bits (e.g. a shifted 64-bit product)
+ * @return raw, or Q1516_MAX / Q1516_MIN if it does not fit in 32 bits
+ */
+Q1516_FN q1516_t q1516_saturate_raw(int64_t raw);
+
+/*
+ * @brief Saturating addition
+ * @return a + b, clamped to [Q1516_MIN, Q1516_MAX]
+ */
+Q1516_FN q1516_t q1516_add_sat(q1516_t a, q1516_t b);
+
+/*
+ * @brief Saturating subtraction
+ * @return a - b, clamped to [Q1516_MIN, Q1516_MAX]
+ */
+Q1516_FN q1516_t q1516_sub_sat(q1516_t a, q1516_t b);
+
+/*
+ * @brief Saturating multiplication
+ * @return a * b (truncated like q1516_multiply), clamped to [Q1516_MIN, Q1516_MAX]
+ */
+Q1516_FN q1516_t q1516_mul_sat(q1516_t a, q1516_t b);
+
+/*
+ * @brief Saturating division
+ * @return dividend / divisor, clamped to [Q1516_MIN, Q1516_MAX].
+ *         Division by zero returns Q1516_MAX or Q1516_MIN like q1516_divide.
+ */
+Q1516_FN q1516_t q1516_div_sat(q1516_t dividend, q1516_t divisor);
 
 // =============================================================================
 // UTILITY FUNCTIONS - DECLARATIONS ONLY
@@ -129,21 +279,21 @@ q1516_t q1516_divide(q1516_t dividend, q1516_t divisor);
  * @param value Input value
  * @return Absolute value
  */
-q1516_t q1516_abs(q1516_t value);
+Q1516_FN q1516_t q1516_abs(q1516_t value);
 
 /*
  * @brief Get the integer part of a Q15.16 fixed-point number
  * @param fixed Q15.16 fixed-point value
  * @return Integer part only
  */
-int32_t q1516_get_integer_part(q1516_t fixed);
+Q1516_FN int32_t q1516_get_integer_part(q1516_t fixed);
 
 /*
  * @brief Get the fractional part of a Q15.16 fixed-point number
  * @param fixed Q15.16 fixed-point value
  * @return Fractional part as Q15.16 format
  */
-q1516_t q1516_get_fractional_part(q1516_t fixed);
+Q1516_FN q1516_t q1516_get_fractional_part(q1516_t fixed);
 
 /*
  * @brief Check if two Q15.16 numbers are approximately equal
@@ -152,7 +302,7 @@ q1516_t q1516_get_fractional_part(q1516_t fixed);
  * @param tolerance Tolerance for comparison (in Q15.16 format)
  * @return true if |a - b| <= tolerance
  */
-bool q1516_approximately_equal(q1516_t a, q1516_t b, q1516_t tolerance);
+Q1516_FN bool q1516_approximately_equal(q1516_t a, q1516_t b, q1516_t tolerance);
 
 // =============================================================================
 // DEBUGGING FUNCTIONS - DECLARATIONS ONLY
@@ -177,6 +327,11 @@ void q1516_print_detailed(const char* label, q1516_t fixed);
 }
 #endif
 
+// Pull in the definitions when running header-only
+#ifdef Q1516_INLINE
+#include "q1516_inline.h"
+#endif
+
 #endif /* Q1516_H */
 
 /*
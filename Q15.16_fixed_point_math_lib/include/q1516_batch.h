@@ -0,0 +1,125 @@
+#ifndef Q1516_BATCH_H
+#define Q1516_BATCH_H
+
+#include "q1516.h"
+#include <stddef.h>
+
+/*
+ *   @file q1516_batch.h
+ *   @brief Array (batch) operations on Q15.16 buffers
+ *
+ *   Each function applies the matching scalar operation from q1516.h to
+ *   n elements. The kernels use SSE4.1 or AVX2 when the CPU has them; the
+ *   choice is made once at runtime via CPUID, with a portable scalar loop
+ *   as fallback. Every path is bit-exact against the scalar functions.
+ *
+ *   Output buffers may alias inputs (element i is read before it is written).
+ *   No alignment is required.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// INSTRUCTION SET SELECTION
+// =============================================================================
+
+typedef enum {
+    Q1516_ISA_SCALAR = 0,   // Portable C loop
+    Q1516_ISA_SSE41,        // 4 lanes, x86 SSE4.1
+    Q1516_ISA_AVX2          // 8 lanes, x86 AVX2
+} q1516_isa_t;
+
+/*
+ * @brief Get the instruction set the batch functions currently use
+ * @return Active ISA (best supported one unless overridden)
+ */
+q1516_isa_t q1516_batch_isa(void);
+
+/*
+ * @brief Force the batch functions onto a given instruction set
+ * @param isa Requested ISA; clamped down to the best one the CPU supports
+ * @return The ISA actually selected
+ * @note Meant for tests and benchmarks. Must not run while another thread calls
+ *       a batch kernel or this function; the lazy selection made by the first
+ *       kernel call is thread-safe.
+ */
+q1516_isa_t q1516_batch_set_isa(q1516_isa_t isa);
+
+/*
+ * @brief Human-readable ISA name ("scalar", "sse4.1", "avx2")
+ */
+const char* q1516_isa_name(q1516_isa_t isa);
+
+// =============================================================================
+// ARITHMETIC
+// =============================================================================
+
+/*
+ * @brief out[i] = q1516_add(a[i], b[i])
+ */
+void q1516_add_n(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n);
+
+/*
+ * @brief out[i] = q1516_multiply(a[i], b[i])
+ */
+void q1516_mul_n(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n);
+
+/*
+ * @brief acc[i] = q1516_add(acc[i], q1516_multiply(a[i], b[i]))
+ */
+void q1516_mac_n(q1516_t* acc, const q1516_t* a, const q1516_t* b, size_t n);
+
+/*
+ * @brief Exact dot product in a wide accumulator (no rounding)
+ * @return Sum of (int64_t)a[i] * b[i], 32 fractional bits; wraps modulo 2^64
+ */
+q1516_acc_t q1516_dot_acc(const q1516_t* a, const q1516_t* b, size_t n);
+
+/*
+ * @brief Dot product, rounded once at the end
+ * @return q1516_acc_round(q1516_dot_acc(a, b, n), Q1516_ROUND_NEAREST)
+ * @note Error is at most 0.5 ULP, versus up to n ULP for a chain of
+ *       q1516_multiply + q1516_add
+ */
+q1516_t q1516_dot(const q1516_t* a, const q1516_t* b, size_t n);
+
+// =============================================================================
+// SATURATING ARITHMETIC
+// =============================================================================
+
+/*
+ * @brief out[i] = q1516_add_sat(a[i], b[i])
+ */
+void q1516_add_sat_n(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n);
+
+/*
+ * @brief out[i] = q1516_sub_sat(a[i], b[i])
+ */
+void q1516_sub_sat_n(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n);
+
+/*
+ * @brief out[i] = q1516_mul_sat(a[i], b[i])
+ */
+void q1516_mul_sat_n(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n);
+
+// =============================================================================
+// CONVERSIONS
+// =============================================================================
+
+/*
+ * @brief out[i] = q1516_from_float(in[i])
+ */
+void q1516_from_float_n(q1516_t* out, const float* in, size_t n);
+
+/*
+ * @brief out[i] = q1516_to_float(in[i])
+ */
+void q1516_to_float_n(float* out, const q1516_t* in, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Q1516_BATCH_H */
@@ -0,0 +1,67 @@
+#ifndef Q1516_CHARS_H
+#define Q1516_CHARS_H
+
+#include "q1516.h"
+#include <stddef.h>
+
+/*
+ *   @file q1516_chars.h
+ *   @brief Decimal text to and from Q15.16, without floating point
+ *
+ *   Every Q15.16 value is k / 65536, which has an exact decimal expansion
+ *   of at most 16 fractional digits. The functions here work on those
+ *   digits directly from the integer bits: no float or double, no locale,
+ *   no allocation, and the same output on every platform.
+ *
+ *   q1516_from_chars(q1516_to_chars(x)) == x for every x.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * @brief Buffer size that fits any q1516_to_chars or q1516_to_chars_fixed
+ *        output plus the terminating NUL ("-32767.9999847412109375")
+ */
+#define Q1516_CHARS_MAX 24
+
+/*
+ * @brief Exact, shortest decimal form: "3.14159393310546875", "-0.5", "7"
+ * @param buf Output, NUL-terminated
+ * @param size Size of buf; Q1516_CHARS_MAX is always enough
+ * @param value Value to format
+ * @return Number of characters written, without the NUL; 0 if buf is too
+ *         small (buf is then left as an empty string when size > 0)
+ */
+size_t q1516_to_chars(char* buf, size_t size, q1516_t value);
+
+/*
+ * @brief Decimal form with exactly `digits` fractional digits, like
+ *        printf("%.*f", digits, q1516_to_double(value))
+ * @param digits Fractional digits, 0..16 (clamped); 16 is always exact
+ * @return As q1516_to_chars
+ * @note Rounds the exact value to nearest, ties to even, as glibc printf
+ *       does. A negative value that rounds to zero keeps its sign ("-0.00").
+ */
+size_t q1516_to_chars_fixed(char* buf, size_t size, q1516_t value, int digits);
+
+/*
+ * @brief Parse a decimal number: optional sign, digits, optional '.' and
+ *        more digits ("12", "-0.5", "+3.", ".25")
+ * @param text Input; need not be NUL-terminated
+ * @param length Number of characters available in text
+ * @param value Result, rounded to nearest (ties to even) from however many
+ *        digits are given, saturated to [Q1516_MIN, Q1516_MAX]
+ * @return Number of characters consumed, 0 if text does not start with a
+ *         number (value is then left untouched)
+ * @note No whitespace skipping and no exponents; parsing stops at the first
+ *       character that cannot continue the number
+ */
+size_t q1516_from_chars(const char* text, size_t length, q1516_t* value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Q1516_CHARS_H */
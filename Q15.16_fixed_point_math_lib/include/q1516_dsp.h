@@ -0,0 +1,173 @@
+#ifndef Q1516_DSP_H
+#define Q1516_DSP_H
+
+#include "q1516.h"
+#include <stddef.h>
+
+/*
+ *   @file q1516_dsp.h
+ *   @brief Block-processing filters on Q15.16 samples: FIR, biquad cascade,
+ *          moving average
+ *
+ *   All filters keep their state in memory the caller provides (no malloc)
+ *   and process any number of samples per call; splitting a signal into
+ *   blocks of any size gives exactly the same output as one big block.
+ *   `out` may be the same buffer as `in`.
+ *
+ *   Sums of products are accumulated exactly in 64 bits (q1516_acc_t) and
+ *   rounded to nearest once per output sample, saturating to
+ *   Q1516_MAX/Q1516_MIN, so a filter never wraps around on overflow.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// FIR FILTER
+// =============================================================================
+
+/*
+ * @brief Number of q1516_t the caller provides as FIR state
+ * @param num_taps Filter length
+ */
+#define Q1516_FIR_STATE_SIZE(num_taps) (3 * (num_taps))
+
+typedef struct {
+    q1516_t* reversed;      // Coefficients, last to first (contiguous dot products)
+    q1516_t* history;       // Last num_taps - 1 inputs, oldest first
+    q1516_t* next_history;  // Scratch: history after the current block
+    size_t num_taps;
+} q1516_fir_t;
+
+/*
+ * @brief Set up an FIR filter y[n] = sum(coeffs[k] * x[n - k])
+ * @param fir Filter to initialize
+ * @param coeffs num_taps coefficients (copied; coeffs[0] weights the newest sample)
+ * @param num_taps Filter length, at least 1
+ * @param state Q1516_FIR_STATE_SIZE(num_taps) values, owned by the filter
+ * @note The filter starts from silence (past inputs are 0)
+ */
+void q1516_fir_init(q1516_fir_t* fir, const q1516_t* coeffs, size_t num_taps, q1516_t* state);
+
+/*
+ * @brief Filter n samples
+ * @param fir Initialized filter
+ * @param out Output samples (may be in)
+ * @param in Input samples
+ * @param n Number of samples
+ * @note The dot products run on the q1516_dot_acc SIMD kernels
+ */
+void q1516_fir_process(q1516_fir_t* fir, q1516_t* out, const q1516_t* in, size_t n);
+
+/*
+ * @brief Forget past inputs (back to silence)
+ */
+void q1516_fir_reset(q1516_fir_t* fir);
+
+// =============================================================================
+// BIQUAD CASCADE
+// =============================================================================
+
+// Biquad coefficients need more fraction bits than Q15.16 offers: a pole
+// close to the unit circle (low cutoff, high Q) is only stable if it is
+// represented precisely. They are Q2.30, range [-2, 2).
+#define Q1516_BIQUAD_FRACTIONAL_BITS 30
+
+/*
+ * @brief Q2.30 coefficient from a constant, e.g. Q1516_BIQUAD_COEFF(-1.8996)
+ */
+#define Q1516_BIQUAD_COEFF(x) \
+    ((int32_t)((x) * 1073741824.0 + ((x) >= 0 ? 0.5 : -0.5)))
+
+/*
+ * @brief One second-order section, normalized so that a0 = 1:
+ *        y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+ *        (a1 and a2 with the sign of the transfer function denominator,
+ *        as filter design tools print them)
+ */
+typedef struct {
+    int32_t b0, b1, b2;     // Q2.30
+    int32_t a1, a2;         // Q2.30
+} q1516_biquad_coeffs_t;
+
+/*
+ * @brief Number of q1516_t the caller provides as cascade state
+ */
+#define Q1516_BIQUAD_STATE_SIZE(num_stages) (4 * (num_stages))
+
+typedef struct {
+    const q1516_biquad_coeffs_t* coeffs;    // num_stages sections (not copied)
+    q1516_t* state;                         // x[n-1], x[n-2], y[n-1], y[n-2] per stage
+    size_t num_stages;
+} q1516_biquad_t;
+
+/*
+ * @brief Set up a cascade of second-order sections (Direct Form I)
+ * @param biquad Cascade to initialize
+ * @param coeffs num_stages sections, applied in order; must outlive the cascade
+ * @param num_stages Number of sections, at least 1
+ * @param state Q1516_BIQUAD_STATE_SIZE(num_stages) values, owned by the cascade
+ * @note Direct Form I keeps only inputs and outputs as state, so the state
+ *       itself cannot overflow; each section's output saturates. The 64-bit
+ *       accumulator holds five Q15.16 x Q2.30 products, which is exact as
+ *       long as |samples| stay below about 8192.
+ */
+void q1516_biquad_init(q1516_biquad_t* biquad, const q1516_biquad_coeffs_t* coeffs, size_t num_stages,
+                       q1516_t* state);
+
+/*
+ * @brief Filter n samples through every section
+ * @param biquad Initialized cascade
+ * @param out Output samples (may be in)
+ * @param in Input samples
+ * @param n Number of samples
+ */
+void q1516_biquad_process(q1516_biquad_t* biquad, q1516_t* out, const q1516_t* in, size_t n);
+
+/*
+ * @brief Clear the state of every section (back to silence)
+ */
+void q1516_biquad_reset(q1516_biquad_t* biquad);
+
+// =============================================================================
+// MOVING AVERAGE
+// =============================================================================
+
+typedef struct {
+    q1516_t* window;        // Last `length` inputs, circular
+    q1516_acc_t sum;        // Exact sum of the window (raw units)
+    size_t length;
+    size_t pos;             // Oldest entry of the window
+    int shift;              // log2(length) when it is a power of two (no division), else -1
+} q1516_moving_average_t;
+
+/*
+ * @brief Set up a moving average over `length` samples
+ * @param avg Filter to initialize
+ * @param window `length` values, owned by the filter
+ * @param length Window length, at least 1
+ * @note Starts from silence: the first length - 1 outputs average in zeros
+ */
+void q1516_moving_average_init(q1516_moving_average_t* avg, q1516_t* window, size_t length);
+
+/*
+ * @brief Filter n samples: out[i] = mean of the last `length` inputs,
+ *        rounded to nearest
+ * @param avg Initialized filter
+ * @param out Output samples (may be in)
+ * @param in Input samples
+ * @param n Number of samples
+ */
+void q1516_moving_average_process(q1516_moving_average_t* avg, q1516_t* out, const q1516_t* in, size_t n);
+
+/*
+ * @brief Forget past inputs (back to silence)
+ */
+void q1516_moving_average_reset(q1516_moving_average_t* avg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Q1516_DSP_H */
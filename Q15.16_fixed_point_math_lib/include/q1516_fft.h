@@ -0,0 +1,113 @@
+#ifndef Q1516_FFT_H
+#define Q1516_FFT_H
+
+#include "q1516.h"
+#include <stddef.h>
+
+/*
+ *   @file q1516_fft.h
+ *   @brief In-place FFT/IFFT on complex Q15.16 arrays
+ *
+ *   Radix-4 decimation-in-frequency passes, plus one radix-2 pass when
+ *   log2(n) is odd, then a bit-reversal so the output is in natural order.
+ *   Twiddle factors are Q1.30 (30 fraction bits) and computed once at init
+ *   with integer arithmetic only, so results are identical on every
+ *   platform. With AVX2 the radix-4 butterflies run four at a time;
+ *   the output is bit-identical to the scalar path.
+ *
+ *   A DFT of n points grows values by up to n, so each pass can shift its
+ *   inputs down (rounding) first. The scaling mode picks how much:
+ *
+ *   | Mode                      | Shift per pass            | Output         |
+ *   |---------------------------|---------------------------|----------------|
+ *   | Q1516_FFT_SCALE_FIXED     | 2 (radix-4), 1 (radix-2)  | DFT / n        |
+ *   | Q1516_FFT_SCALE_DYNAMIC   | only what the data needs  | DFT / 2^shift  |
+ *   | Q1516_FFT_SCALE_NONE      | 0                         | DFT            |
+ *
+ *   FIXED lands within a few ULP of DFT / n, so it never overflows for
+ *   inputs of magnitude |re + i im| <= 32767.99; a tone at the very edge
+ *   of the range (radius INT32_MAX) can round past it and wrap.
+ *   DYNAMIC (block floating point) never overflows and keeps the most
+ *   precision for small signals. NONE wraps around if any intermediate
+ *   value leaves the Q15.16 range; use it for small inputs or inverse
+ *   transforms of already scaled spectra.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// TYPES
+// =============================================================================
+
+typedef struct {
+    q1516_t re;
+    q1516_t im;
+} q1516_complex_t;
+
+// exp(-2*pi*i*k/n) in Q1.30
+typedef struct {
+    int32_t re;
+    int32_t im;
+} q1516_twiddle_t;
+
+typedef enum {
+    Q1516_FFT_SCALE_NONE = 0,
+    Q1516_FFT_SCALE_FIXED,
+    Q1516_FFT_SCALE_DYNAMIC
+} q1516_fft_scale_t;
+
+#define Q1516_FFT_MIN_SIZE 2
+#define Q1516_FFT_MAX_SIZE 65536
+
+/*
+ * @brief Number of q1516_twiddle_t the caller provides for an n-point plan
+ */
+#define Q1516_FFT_TWIDDLE_SIZE(n) (n)
+
+typedef struct {
+    q1516_twiddle_t* twiddles;  // Per radix-4 pass: W^j, W^2j, W^3j blocks
+    size_t n;
+    int log2n;
+} q1516_fft_t;
+
+// =============================================================================
+// TRANSFORMS
+// =============================================================================
+
+/*
+ * @brief Prepare an n-point transform
+ * @param fft Plan to initialize
+ * @param n Transform size: a power of two in [Q1516_FFT_MIN_SIZE, Q1516_FFT_MAX_SIZE]
+ * @param twiddles Q1516_FFT_TWIDDLE_SIZE(n) entries, filled here and owned by the plan
+ * @return 0 on success, -1 if n is not a supported size (plan left untouched)
+ * @note A plan is read-only after init: several threads may share it
+ */
+int q1516_fft_init(q1516_fft_t* fft, size_t n, q1516_twiddle_t* twiddles);
+
+/*
+ * @brief Forward transform in place: X[k] = sum(x[j] * exp(-2*pi*i*j*k/n))
+ * @param fft Initialized plan
+ * @param data n complex values, replaced by the spectrum in natural order
+ * @param scale Scaling mode (see table above)
+ * @return Total right shift applied: data holds X / 2^shift
+ */
+int q1516_fft_forward(const q1516_fft_t* fft, q1516_complex_t* data, q1516_fft_scale_t scale);
+
+/*
+ * @brief Inverse transform in place: x[j] = sum(X[k] * exp(+2*pi*i*j*k/n))
+ * @param fft Initialized plan
+ * @param data n complex values, replaced by the signal in natural order
+ * @param scale Scaling mode (see table above)
+ * @return Total right shift applied: data holds x / 2^shift
+ * @note No 1/n factor beyond the scaling: a forward FIXED transform is
+ *       undone by an inverse NONE transform, and vice versa
+ */
+int q1516_fft_inverse(const q1516_fft_t* fft, q1516_complex_t* data, q1516_fft_scale_t scale);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Q1516_FFT_H */
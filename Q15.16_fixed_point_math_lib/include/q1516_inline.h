@@ -0,0 +1,263 @@
+#ifndef Q1516_INLINE_H
+#define Q1516_INLINE_H
+
+#include "q1516.h"
+
+/*
+ *   @file q1516_inline.h
+ *   @brief Shared implementation of the Q15.16 conversion/arithmetic/utility functions
+ *
+ *   Do not include this file directly. It is pulled in two ways:
+ *   - by q1516.h when Q1516_INLINE is defined (Q1516_FN = static inline)
+ *   - by q1516.c to build libq1516 (Q1516_FN = nothing, external linkage)
+ *
+ *   Keeping a single copy of every body guarantees the header-only mode and
+ *   the library return bit-identical results.
+ */
+
+//=========================================
+// CONVERSION FUNCTIONS
+//=========================================
+
+Q1516_FN q1516_t q1516_from_int(int32_t value){
+    // Shift as unsigned: left-shifting a negative int is undefined in C
+    // (and rejected in C++ constant expressions). Same instruction either way.
+    return (q1516_t)((uint32_t)value << Q1516_FRACTIONAL_BITS);
+}
+
+Q1516_FN int32_t q1516_to_int(q1516_t fixed){
+    return (int32_t)(fixed >> Q1516_FRACTIONAL_BITS);
+}
+
+Q1516_FN q1516_t q1516_from_double(double value){
+    // Scaling by 2^16 is exact, so the rounding below is the only one.
+    // Range checks come first: casting an out-of-range double (or NaN) to
+    // an integer is undefined behaviour.
+    double scaled = value * Q1516_SCALE;
+    if (scaled != scaled) {
+        return 0;
+    }
+    if (scaled >= 2147483647.5) {                 // rounds to 2^31 or more
+        return Q1516_MAX;
+    }
+    if (scaled <= -2147483648.5) {
+        return Q1516_MIN;
+    }
+    // Round to nearest, ties to even, without depending on the FPU rounding
+    // mode (and usable in constant expressions). `rest` is exact.
+    int64_t whole = (int64_t)scaled;              // toward zero
+    double rest = scaled - (double)whole;         // in (-1, 1)
+    if (rest > 0.5 || (rest == 0.5 && (whole & 1))) {
+        whole++;
+    } else if (rest < -0.5 || (rest == -0.5 && (whole & 1))) {
+        whole--;
+    }
+    return (q1516_t)whole;
+}
+
+Q1516_FN q1516_t q1516_from_float(float value){
+    // Every float is exactly representable as a double
+    return q1516_from_double((double)value);
+}
+
+Q1516_FN float q1516_to_float(q1516_t fixed){
+    // CORRECTION: original was: return fixed / Q1516_SCALE;
+    // PROBLEM: Integer division! This truncates the result
+    // BETTER: Cast to float first to get proper division
+    return (float)fixed / Q1516_SCALE;
+}
+
+Q1516_FN double q1516_to_double(q1516_t fixed){
+    return (double)fixed / Q1516_SCALE;
+}
+
+//=========================================
+// Arithmetic FUNCTIONS
+//=========================================
+
+// Add/subtract wrap on overflow. Going through uint32_t makes the wrap
+// defined behaviour (and legal in C++ constant expressions); same instruction.
+Q1516_FN q1516_t q1516_add(q1516_t a, q1516_t b){
+    return (q1516_t)((uint32_t)a + (uint32_t)b);
+}
+
+Q1516_FN q1516_t q1516_subtract(q1516_t a, q1516_t b){
+    return (q1516_t)((uint32_t)a - (uint32_t)b);
+}
+
+Q1516_FN q1516_t q1516_multiply(q1516_t a, q1516_t b){
+    int64_t temp = (int64_t)a * (int64_t)b;
+    return (q1516_t)(temp >> Q1516_FRACTIONAL_BITS);
+}
+
+Q1516_FN q1516_t q1516_divide(q1516_t dividend, q1516_t divisor){
+    if (divisor == 0){
+        return (dividend >= 0) ? Q1516_MAX : Q1516_MIN;
+    }
+    // Multiply rather than shift: left-shifting a negative value is undefined
+    // (and rejected in constant expressions); the compiler emits the shift anyway
+    int64_t temp = ((int64_t)dividend * Q1516_SCALE) / divisor;
+    return (q1516_t)temp;
+}
+
+//=========================================
+// Saturating FUNCTIONS
+//=========================================
+
+// All of these select results with masks built from comparisons
+// (setcc/sbb), never with data-dependent branches. The unsigned casts
+// keep the wrapping arithmetic well defined.
+
+Q1516_FN q1516_t q1516_saturate_raw(int64_t raw){
+    int64_t over  = -(int64_t)(raw > Q1516_MAX);     // all ones if too big
+    int64_t under = -(int64_t)(raw < Q1516_MIN);     // all ones if too small
+    int64_t keep  = ~(over | under);
+    return (q1516_t)((raw & keep) | ((int64_t)Q1516_MAX & over) | ((int64_t)Q1516_MIN & under));
+}
+
+Q1516_FN q1516_t q1516_add_sat(q1516_t a, q1516_t b){
+    uint32_t ua = (uint32_t)a;
+    uint32_t ub = (uint32_t)b;
+    uint32_t sum = ua + ub;
+    // Overflow iff a and b share a sign and the sum's sign differs from it
+    uint32_t overflow = (~(ua ^ ub) & (ua ^ sum)) >> 31;
+    // Q1516_MAX when a >= 0, Q1516_MIN (MAX + 1) when a < 0
+    uint32_t limit = (uint32_t)Q1516_MAX + (ua >> 31);
+    uint32_t mask = 0u - overflow;
+    return (q1516_t)((sum & ~mask) | (limit & mask));
+}
+
+Q1516_FN q1516_t q1516_sub_sat(q1516_t a, q1516_t b){
+    uint32_t ua = (uint32_t)a;
+    uint32_t ub = (uint32_t)b;
+    uint32_t diff = ua - ub;
+    // Overflow iff a and b differ in sign and the result's sign differs from a
+    uint32_t overflow = ((ua ^ ub) & (ua ^ diff)) >> 31;
+    uint32_t limit = (uint32_t)Q1516_MAX + (ua >> 31);
+    uint32_t mask = 0u - overflow;
+    return (q1516_t)((diff & ~mask) | (limit & mask));
+}
+
+Q1516_FN q1516_t q1516_mul_sat(q1516_t a, q1516_t b){
+    int64_t temp = (int64_t)a * (int64_t)b;
+    return q1516_saturate_raw(temp >> Q1516_FRACTIONAL_BITS);
+}
+
+Q1516_FN q1516_t q1516_div_sat(q1516_t dividend, q1516_t divisor){
+    // Divide by 1 instead of 0 (no trap), then swap in the "infinity"
+    // result for that case with a mask, as q1516_divide does with a branch
+    int64_t by_zero = -(int64_t)(divisor == 0);
+    int64_t safe_divisor = (int64_t)divisor + (by_zero & 1);
+    int64_t temp = ((int64_t)dividend * Q1516_SCALE) / safe_divisor;
+    int64_t infinity = (q1516_t)((uint32_t)Q1516_MAX + ((uint32_t)dividend >> 31));
+    return q1516_saturate_raw((temp & ~by_zero) | (infinity & by_zero));
+}
+
+//=========================================
+// Rounding FUNCTIONS
+//=========================================
+
+// Every mode is "floor, then maybe add one": the decision only looks at
+// the bits that the plain shift would have dropped.
+
+Q1516_FN q1516_t q1516_multiply_rounded(q1516_t a, q1516_t b, q1516_round_t mode){
+    int64_t temp = (int64_t)a * (int64_t)b;
+    int64_t floor_part = temp >> Q1516_FRACTIONAL_BITS;
+    int64_t dropped = temp & (Q1516_SCALE - 1);   // Always in [0, 1) ULP
+    int64_t up = (mode == Q1516_ROUND_NEAREST)   ? (dropped >= Q1516_HALF)
+               : (mode == Q1516_ROUND_HALF_EVEN) ? ((dropped > Q1516_HALF) |
+                                                    ((dropped == Q1516_HALF) & floor_part & 1))
+               : 0;
+    return (q1516_t)(floor_part + up);
+}
+
+Q1516_FN q1516_t q1516_multiply_round(q1516_t a, q1516_t b){
+    return q1516_multiply_rounded(a, b, Q1516_ROUND_NEAREST);
+}
+
+Q1516_FN q1516_t q1516_multiply_round_even(q1516_t a, q1516_t b){
+    return q1516_multiply_rounded(a, b, Q1516_ROUND_HALF_EVEN);
+}
+
+Q1516_FN q1516_t q1516_divide_rounded(q1516_t dividend, q1516_t divisor, q1516_round_t mode){
+    if (divisor == 0){
+        return (dividend >= 0) ? Q1516_MAX : Q1516_MIN;
+    }
+    int64_t numerator = (int64_t)dividend * Q1516_SCALE;
+    int64_t quotient = numerator / divisor;
+    int64_t remainder = numerator % divisor;
+    // C division truncates toward zero. Move to floor division so that
+    // remainder / divisor is the dropped fraction, in [0, 1)
+    if (remainder != 0 && ((remainder < 0) != (divisor < 0))) {
+        quotient -= 1;
+        remainder += divisor;
+    }
+    // Compare the dropped fraction with 1/2 as 2 * |remainder| vs |divisor|
+    int64_t twice = 2 * (remainder < 0 ? -remainder : remainder);
+    int64_t magnitude = (divisor < 0) ? -(int64_t)divisor : (int64_t)divisor;
+    int64_t up = (mode == Q1516_ROUND_NEAREST)   ? (twice >= magnitude)
+               : (mode == Q1516_ROUND_HALF_EVEN) ? ((twice > magnitude) |
+                                                    ((twice == magnitude) & quotient & 1))
+               : 0;
+    return (q1516_t)(quotient + up);
+}
+
+Q1516_FN q1516_t q1516_divide_round(q1516_t dividend, q1516_t divisor){
+    return q1516_divide_rounded(dividend, divisor, Q1516_ROUND_NEAREST);
+}
+
+Q1516_FN q1516_t q1516_divide_round_even(q1516_t dividend, q1516_t divisor){
+    return q1516_divide_rounded(dividend, divisor, Q1516_ROUND_HALF_EVEN);
+}
+
+Q1516_FN q1516_acc_t q1516_mac(q1516_acc_t acc, q1516_t a, q1516_t b){
+    return acc + (int64_t)a * (int64_t)b;
+}
+
+Q1516_FN q1516_t q1516_acc_round(q1516_acc_t acc, q1516_round_t mode){
+    // Same decision as q1516_multiply_rounded, but the result saturates:
+    // long accumulations are where out-of-range sums actually happen
+    int64_t floor_part = acc >> Q1516_FRACTIONAL_BITS;
+    int64_t dropped = acc & (Q1516_SCALE - 1);
+    int64_t up = (mode == Q1516_ROUND_NEAREST)   ? (dropped >= Q1516_HALF)
+               : (mode == Q1516_ROUND_HALF_EVEN) ? ((dropped > Q1516_HALF) |
+                                                    ((dropped == Q1516_HALF) & floor_part & 1))
+               : 0;
+    return q1516_saturate_raw(floor_part + up);
+}
+
+//=========================================
+// Utility FUNCTIONS
+//=========================================
+
+Q1516_FN q1516_t q1516_abs(q1516_t fixed){
+    if(fixed == Q1516_MIN){
+        return Q1516_MAX;
+    }
+    return (fixed > 0) ? fixed : -fixed;
+}
+
+Q1516_FN q1516_t q1516_get_fractional_part(q1516_t fixed){
+    if(fixed < 0) {fixed = -fixed;}
+    return fixed & ((1L << Q1516_FRACTIONAL_BITS) - 1);
+}
+
+Q1516_FN int32_t q1516_get_integer_part(q1516_t fixed){
+    int32_t result = fixed >> Q1516_FRACTIONAL_BITS;
+    if (fixed < 0 && (fixed & ((1 << Q1516_FRACTIONAL_BITS) - 1))) {
+        // If negative and had fractional part, add 1 to cancel floor rounding
+        result += 1;
+    }
+    return result;
+}
+
+Q1516_FN bool q1516_approximately_equal(q1516_t a, q1516_t b, q1516_t tolerance){
+    // In 64 bits: a - b overflows int32_t when a and b are far apart
+    int64_t difference = (int64_t)a - (int64_t)b;
+    if (difference < 0) {
+        difference = -difference;
+    }
+    return difference <= tolerance;
+}
+
+#endif /* Q1516_INLINE_H */
@@ -0,0 +1,169 @@
+#ifndef Q1516_MATH_H
+#define Q1516_MATH_H
+
+#include "q1516.h"
+#include <stddef.h>
+
+/*
+ *   @file q1516_math.h
+ *   @brief Elementary functions on Q15.16 values, integer-only
+ *
+ *   None of these touch float or libm: each one is a small table, Newton
+ *   steps or a short polynomial evaluated in 32/64-bit integers, so results
+ *   are identical on every platform.
+ *
+ *   Accuracy is given in ULP of the Q15.16 result (1 ULP = 2^-16). The
+ *   figures below are the worst case measured over every one of the 2^32
+ *   inputs (2^24 random pairs for atan2) against a double-precision
+ *   reference; 0.5 ULP would be a correctly rounded result.
+ *
+ *   | Function     | Method                                      | Max error |
+ *   |--------------|---------------------------------------------|-----------|
+ *   | q1516_sqrt   | rsqrt table + Newton, exact final fix-up    | 0.50 ULP  |
+ *   | q1516_sin    | 256-step quarter-wave table, linear interp  | 0.81 ULP  |
+ *   | q1516_cos    | same table, phase + 1/4 turn                | 0.81 ULP  |
+ *   | q1516_atan2  | octant fold + 256-step atan table, interp   | 0.59 ULP  |
+ *   | q1516_exp    | 2^(j/32) table + degree-5 Taylor, Q62       | 0.51 ULP  |
+ *   | q1516_log    | normalize to [sqrt(1/2), sqrt(2)) + atanh   | 0.51 ULP  |
+ *
+ *   These functions always go through the library; Q1516_INLINE does not
+ *   affect them (the tables live in q1516_math.c).
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// CONSTANTS
+// =============================================================================
+
+#define Q1516_PI      ((q1516_t)205887)   // 3.14159 (pi, rounded to nearest)
+#define Q1516_HALF_PI ((q1516_t)102944)   // 1.57080
+#define Q1516_TWO_PI  ((q1516_t)411775)   // 6.28319
+#define Q1516_E       ((q1516_t)178145)   // 2.71828
+
+// =============================================================================
+// SCALAR FUNCTIONS
+// =============================================================================
+
+/*
+ * @brief Square root, correctly rounded
+ * @param x Value (negative input returns 0)
+ * @return sqrt(x)
+ */
+q1516_t q1516_sqrt(q1516_t x);
+
+/*
+ * @brief Sine of an angle in radians
+ * @param x Angle in radians, any value (reduced modulo 2*pi internally)
+ * @return sin(x), in [-1, 1]
+ */
+q1516_t q1516_sin(q1516_t x);
+
+/*
+ * @brief Cosine of an angle in radians
+ * @param x Angle in radians, any value (reduced modulo 2*pi internally)
+ * @return cos(x), in [-1, 1]
+ */
+q1516_t q1516_cos(q1516_t x);
+
+/*
+ * @brief Angle of the vector (x, y)
+ * @param y Y component
+ * @param x X component
+ * @return atan2(y, x) in radians, in [-pi, pi]; 0 when x == y == 0
+ */
+q1516_t q1516_atan2(q1516_t y, q1516_t x);
+
+/*
+ * @brief Natural exponential
+ * @param x Exponent
+ * @return e^x; saturates to Q1516_MAX above ln(32768) ~ 10.397
+ */
+q1516_t q1516_exp(q1516_t x);
+
+/*
+ * @brief Natural logarithm
+ * @param x Argument
+ * @return ln(x); Q1516_MIN when x <= 0
+ */
+q1516_t q1516_log(q1516_t x);
+
+// =============================================================================
+// RECIPROCAL / DIVISION
+// =============================================================================
+
+// q1516_divide spends most of its time in a 64-bit hardware division. These
+// replace it with multiplications and return exactly the same results
+// (including the Q1516_MAX/Q1516_MIN division-by-zero convention and the
+// wrap-around for out-of-range quotients).
+
+/*
+ * @brief Reciprocal 1/x, without a hardware division
+ * @param x Value
+ * @return Same as q1516_divide(Q1516_ONE, x)
+ */
+q1516_t q1516_reciprocal(q1516_t x);
+
+/*
+ * @brief Division through a table + Newton-Raphson reciprocal
+ * @param dividend Number to divide
+ * @param divisor Number to divide by
+ * @return Same as q1516_divide(dividend, divisor)
+ */
+q1516_t q1516_divide_fast(q1516_t dividend, q1516_t divisor);
+
+/*
+ * @brief Precomputed "multiply + shift" form of a fixed divisor
+ */
+typedef struct {
+    uint64_t magic;     // floor(2^(48+shift) / |divisor|) + 1
+    int32_t shift;      // ceil(log2(|divisor|))
+    q1516_t divisor;    // Original divisor (sign, division by zero)
+} q1516_divider_t;
+
+/*
+ * @brief Prepare repeated division by the same value
+ * @param divisor Number to divide by (0 is allowed)
+ * @return Divider for q1516_divide_by / q1516_divide_by_n
+ * @note Costs two hardware divisions; pays off from the second use on
+ */
+q1516_divider_t q1516_divider_init(q1516_t divisor);
+
+/*
+ * @brief Divide by a precomputed divisor: one multiply and one shift
+ * @param divider Result of q1516_divider_init
+ * @param dividend Number to divide
+ * @return Same as q1516_divide(dividend, divisor)
+ */
+q1516_t q1516_divide_by(const q1516_divider_t* divider, q1516_t dividend);
+
+// =============================================================================
+// BATCH FUNCTIONS
+// =============================================================================
+
+// out[i] = f(in[i]); bit-exact with the scalar functions. Output buffers may
+// alias inputs.
+
+void q1516_sqrt_n(q1516_t* out, const q1516_t* in, size_t n);
+void q1516_sin_n(q1516_t* out, const q1516_t* in, size_t n);
+void q1516_cos_n(q1516_t* out, const q1516_t* in, size_t n);
+void q1516_exp_n(q1516_t* out, const q1516_t* in, size_t n);
+void q1516_log_n(q1516_t* out, const q1516_t* in, size_t n);
+
+/*
+ * @brief out[i] = q1516_divide_by(divider, in[i])
+ */
+void q1516_divide_by_n(q1516_t* out, const q1516_t* in, const q1516_divider_t* divider, size_t n);
+
+/*
+ * @brief out[i] = q1516_atan2(y[i], x[i])
+ */
+void q1516_atan2_n(q1516_t* out, const q1516_t* y, const q1516_t* x, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Q1516_MATH_H */
@@ -0,0 +1,93 @@
+#ifndef Q1516_MATRIX_H
+#define Q1516_MATRIX_H
+
+#include "q1516.h"
+#include <stddef.h>
+
+/*
+ *   @file q1516_matrix.h
+ *   @brief Matrix and matrix-vector products on Q15.16 data
+ *
+ *   Matrices are dense and row-major: element (i, j) of an m x n matrix
+ *   is at index i * n + j.
+ *
+ *   Every output element is an exact 64-bit sum of products (q1516_acc_t,
+ *   wrapping modulo 2^64 like q1516_dot_acc) rounded to nearest once and
+ *   saturated, i.e. q1516_dot of a row and a column. That is at most
+ *   0.5 ULP from the true result, and it is the same bits on every path:
+ *   scalar or AVX2, any blocking, any number of threads.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// =============================================================================
+// GENERAL SIZES
+// =============================================================================
+
+/*
+ * @brief C = A * B
+ * @param c m x n result; must not overlap a or b
+ * @param a m x k matrix
+ * @param b k x n matrix
+ * @note Cache-blocked, with AVX2 kernels when the CPU has them
+ *       (see q1516_batch_isa)
+ */
+void q1516_mat_mul(q1516_t* c, const q1516_t* a, const q1516_t* b, size_t m, size_t k, size_t n);
+
+/*
+ * @brief C = A * B, with the rows of C split across threads
+ * @param threads Number of threads; 0 picks one per online CPU, but fewer
+ *        when the product is too small to pay for starting them
+ * @return Number of threads actually used (1 means it ran on the caller)
+ * @note Same result as q1516_mat_mul, bit for bit. Threads are created and
+ *       joined on every call, so use this for large matrices only.
+ */
+int q1516_mat_mul_parallel(q1516_t* c, const q1516_t* a, const q1516_t* b, size_t m, size_t k, size_t n,
+                           int threads);
+
+/*
+ * @brief y = A * x
+ * @param y m results; must not overlap x
+ * @param a m x n matrix
+ * @param x n values
+ * @note Each row is one q1516_dot call, so it runs on the SSE4.1/AVX2 kernels
+ */
+void q1516_mat_vec(q1516_t* y, const q1516_t* a, const q1516_t* x, size_t m, size_t n);
+
+// =============================================================================
+// SMALL SQUARE MATRICES (2x2 .. 8x8)
+// =============================================================================
+
+/*
+ * Fixed-size versions for the small matrices of Kalman filters and
+ * controllers: the size is a compile-time constant in each one, so the
+ * loops unroll, with no blocking or dispatch.
+ * Same rounding as above. The output may be one of the inputs
+ * (e.g. q1516_mat4_mul(p, f, p)).
+ *
+ *   q1516_matN_mul(c, a, b)   c = a * b, all N x N
+ *   q1516_matN_vec(y, a, x)   y = a * x, a is N x N, x and y have N values
+ */
+void q1516_mat2_mul(q1516_t* c, const q1516_t* a, const q1516_t* b);
+void q1516_mat3_mul(q1516_t* c, const q1516_t* a, const q1516_t* b);
+void q1516_mat4_mul(q1516_t* c, const q1516_t* a, const q1516_t* b);
+void q1516_mat5_mul(q1516_t* c, const q1516_t* a, const q1516_t* b);
+void q1516_mat6_mul(q1516_t* c, const q1516_t* a, const q1516_t* b);
+void q1516_mat7_mul(q1516_t* c, const q1516_t* a, const q1516_t* b);
+void q1516_mat8_mul(q1516_t* c, const q1516_t* a, const q1516_t* b);
+
+void q1516_mat2_vec(q1516_t* y, const q1516_t* a, const q1516_t* x);
+void q1516_mat3_vec(q1516_t* y, const q1516_t* a, const q1516_t* x);
+void q1516_mat4_vec(q1516_t* y, const q1516_t* a, const q1516_t* x);
+void q1516_mat5_vec(q1516_t* y, const q1516_t* a, const q1516_t* x);
+void q1516_mat6_vec(q1516_t* y, const q1516_t* a, const q1516_t* x);
+void q1516_mat7_vec(q1516_t* y, const q1516_t* a, const q1516_t* x);
+void q1516_mat8_vec(q1516_t* y, const q1516_t* a, const q1516_t* x);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Q1516_MATRIX_H */
@@ -0,0 +1,520 @@
+// Scalar fallbacks and loop tails use the header-only definitions so they
+// inline instead of calling back into the library.
+#define Q1516_INLINE
+#include "q1516_batch.h"
+
+/*
+ * @file q1516_batch.c
+ * @brief Batch (array) operations: scalar, SSE4.1 and AVX2 kernels
+ *
+ * The SIMD kernels are compiled with per-function target attributes, so the
+ * library itself needs no -msse4.1/-mavx2 flags and still runs on any x86.
+ * Which kernel set runs is decided once, at the first call, through CPUID.
+ */
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define Q1516_BATCH_X86 1
+#include <immintrin.h>
+#define Q1516_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define Q1516_TARGET_AVX2  __attribute__((target("avx2")))
+#endif
+
+//=========================================
+// DISPATCH TABLE
+//=========================================
+
+typedef struct {
+    void (*add_n)(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n);
+    void (*mul_n)(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n);
+    void (*mac_n)(q1516_t* acc, const q1516_t* a, const q1516_t* b, size_t n);
+    q1516_acc_t (*dot_acc)(const q1516_t* a, const q1516_t* b, size_t n);
+    void (*add_sat_n)(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n);
+    void (*sub_sat_n)(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n);
+    void (*mul_sat_n)(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n);
+    void (*from_float_n)(q1516_t* out, const float* in, size_t n);
+    void (*to_float_n)(float* out, const q1516_t* in, size_t n);
+} batch_ops_t;
+
+//=========================================
+// SCALAR KERNELS (portable fallback)
+//=========================================
+
+static void add_n_scalar(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_add(a[i], b[i]);
+}
+
+static void mul_n_scalar(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_multiply(a[i], b[i]);
+}
+
+static void mac_n_scalar(q1516_t* acc, const q1516_t* a, const q1516_t* b, size_t n){
+    for (size_t i = 0; i < n; i++) acc[i] = q1516_add(acc[i], q1516_multiply(a[i], b[i]));
+}
+
+static q1516_acc_t dot_acc_scalar(const q1516_t* a, const q1516_t* b, size_t n){
+    // Unsigned sum: wraps modulo 2^64 like the SIMD lanes, instead of overflowing
+    uint64_t sum = 0;
+    for (size_t i = 0; i < n; i++) sum += (uint64_t)((int64_t)a[i] * (int64_t)b[i]);
+    return (q1516_acc_t)sum;
+}
+
+static void add_sat_n_scalar(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_add_sat(a[i], b[i]);
+}
+
+static void sub_sat_n_scalar(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_sub_sat(a[i], b[i]);
+}
+
+static void mul_sat_n_scalar(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_mul_sat(a[i], b[i]);
+}
+
+static void from_float_n_scalar(q1516_t* out, const float* in, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_from_float(in[i]);
+}
+
+static void to_float_n_scalar(float* out, const q1516_t* in, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_to_float(in[i]);
+}
+
+static const batch_ops_t scalar_ops = {
+    add_n_scalar, mul_n_scalar, mac_n_scalar, dot_acc_scalar,
+    add_sat_n_scalar, sub_sat_n_scalar, mul_sat_n_scalar,
+    from_float_n_scalar, to_float_n_scalar
+};
+
+#ifdef Q1516_BATCH_X86
+
+//=========================================
+// SSE4.1 KERNELS (4 lanes)
+//=========================================
+
+// q1516_multiply on 4 lanes. _mm_mul_epi32 only multiplies the even lanes
+// (32x32->64 signed), so the odd lanes are shifted down and done separately.
+// Only bits 16..47 of each 64-bit product survive ">> 16" plus the
+// truncation to 32 bits, so logical 64-bit shifts give the same bits as the
+// scalar arithmetic shift (SSE/AVX2 have no 64-bit arithmetic shift).
+Q1516_TARGET_SSE41 static inline __m128i mul_q16_sse41(__m128i a, __m128i b){
+    __m128i even = _mm_mul_epi32(a, b);
+    __m128i odd  = _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    even = _mm_srli_epi64(even, Q1516_FRACTIONAL_BITS);        // bits 16..47 -> low half
+    odd  = _mm_slli_epi64(odd, 32 - Q1516_FRACTIONAL_BITS);    // bits 16..47 -> high half
+    return _mm_blend_epi16(even, odd, 0xCC);
+}
+
+// Saturating variants. SSE/AVX2 only have saturating adds and packs for
+// 8/16-bit lanes, so 32-bit saturation is done with the scalar bit tricks:
+// build an overflow mask, then blend in the limit value.
+
+// Q1516_MAX for lanes where a >= 0, Q1516_MIN for lanes where a < 0
+Q1516_TARGET_SSE41 static inline __m128i limit_for_sign_sse41(__m128i a){
+    return _mm_add_epi32(_mm_srli_epi32(a, 31), _mm_set1_epi32(Q1516_MAX));
+}
+
+// Lanes whose sign bit is set in `overflow` take `limit`
+Q1516_TARGET_SSE41 static inline __m128i select_sign_sse41(__m128i value, __m128i limit, __m128i overflow){
+    return _mm_castps_si128(_mm_blendv_ps(_mm_castsi128_ps(value), _mm_castsi128_ps(limit),
+                                          _mm_castsi128_ps(overflow)));
+}
+
+// q1516_mul_sat on 4 lanes. The high 32 bits of each 64-bit product decide
+// the clamp: (p >> 16) exceeds Q1516_MAX iff hi32(p) > 0x7FFF and falls
+// below Q1516_MIN iff hi32(p) < -0x8000.
+Q1516_TARGET_SSE41 static inline __m128i mul_sat_q16_sse41(__m128i a, __m128i b){
+    __m128i even = _mm_mul_epi32(a, b);
+    __m128i odd  = _mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    __m128i result = _mm_blend_epi16(_mm_srli_epi64(even, Q1516_FRACTIONAL_BITS),
+                                     _mm_slli_epi64(odd, 32 - Q1516_FRACTIONAL_BITS), 0xCC);
+    __m128i high = _mm_blend_epi16(_mm_srli_epi64(even, 32), odd, 0xCC);
+    __m128i too_big   = _mm_cmpgt_epi32(high, _mm_set1_epi32(0x7FFF));
+    __m128i too_small = _mm_cmpgt_epi32(_mm_set1_epi32(-0x8000), high);
+    result = _mm_blendv_epi8(result, _mm_set1_epi32(Q1516_MAX), too_big);
+    return _mm_blendv_epi8(result, _mm_set1_epi32(Q1516_MIN), too_small);
+}
+
+Q1516_TARGET_SSE41 static void add_n_sse41(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi32(va, vb));
+    }
+    add_n_scalar(out + i, a + i, b + i, n - i);
+}
+
+Q1516_TARGET_SSE41 static void mul_n_sse41(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(out + i), mul_q16_sse41(va, vb));
+    }
+    mul_n_scalar(out + i, a + i, b + i, n - i);
+}
+
+Q1516_TARGET_SSE41 static void mac_n_sse41(q1516_t* acc, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i vacc = _mm_loadu_si128((const __m128i*)(acc + i));
+        _mm_storeu_si128((__m128i*)(acc + i), _mm_add_epi32(vacc, mul_q16_sse41(va, vb)));
+    }
+    mac_n_scalar(acc + i, a + i, b + i, n - i);
+}
+
+Q1516_TARGET_SSE41 static q1516_acc_t dot_acc_sse41(const q1516_t* a, const q1516_t* b, size_t n){
+    // Two 64-bit lanes per register; even and odd products accumulate separately
+    __m128i sum_even = _mm_setzero_si128();
+    __m128i sum_odd = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        sum_even = _mm_add_epi64(sum_even, _mm_mul_epi32(va, vb));
+        sum_odd = _mm_add_epi64(sum_odd, _mm_mul_epi32(_mm_srli_epi64(va, 32), _mm_srli_epi64(vb, 32)));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, _mm_add_epi64(sum_even, sum_odd));
+    return (q1516_acc_t)(lanes[0] + lanes[1] + (uint64_t)dot_acc_scalar(a + i, b + i, n - i));
+}
+
+Q1516_TARGET_SSE41 static void add_sat_n_sse41(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i sum = _mm_add_epi32(va, vb);
+        __m128i overflow = _mm_andnot_si128(_mm_xor_si128(va, vb), _mm_xor_si128(va, sum));
+        _mm_storeu_si128((__m128i*)(out + i), select_sign_sse41(sum, limit_for_sign_sse41(va), overflow));
+    }
+    add_sat_n_scalar(out + i, a + i, b + i, n - i);
+}
+
+Q1516_TARGET_SSE41 static void sub_sat_n_sse41(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i diff = _mm_sub_epi32(va, vb);
+        __m128i overflow = _mm_and_si128(_mm_xor_si128(va, vb), _mm_xor_si128(va, diff));
+        _mm_storeu_si128((__m128i*)(out + i), select_sign_sse41(diff, limit_for_sign_sse41(va), overflow));
+    }
+    sub_sat_n_scalar(out + i, a + i, b + i, n - i);
+}
+
+Q1516_TARGET_SSE41 static void mul_sat_n_sse41(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+        _mm_storeu_si128((__m128i*)(out + i), mul_sat_q16_sse41(va, vb));
+    }
+    mul_sat_n_scalar(out + i, a + i, b + i, n - i);
+}
+
+// Round to nearest even and saturate, like q1516_from_double:
+// - roundps rounds explicitly, so the result does not depend on MXCSR and
+//   the conversion after it is exact;
+// - cvtps2dq returns 0x80000000 for anything outside int32 (and NaN), which
+//   is already right for negative overflow; positive overflow is flipped to
+//   0x7FFFFFFF with an XOR, and NaN lanes are cleared to 0.
+Q1516_TARGET_SSE41 static __m128i from_float_q16_sse41(__m128 value){
+    const __m128 scale = _mm_set1_ps((float)Q1516_SCALE);
+    const __m128 two_31 = _mm_set1_ps(2147483648.0f);
+    __m128 scaled = _mm_mul_ps(value, scale);                 // exact
+    __m128 rounded = _mm_round_ps(scaled, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m128i result = _mm_cvtps_epi32(rounded);
+    __m128i too_big = _mm_castps_si128(_mm_cmpge_ps(rounded, two_31));
+    __m128i is_nan = _mm_castps_si128(_mm_cmpunord_ps(scaled, scaled));
+    return _mm_andnot_si128(is_nan, _mm_xor_si128(result, too_big));
+}
+
+Q1516_TARGET_SSE41 static void from_float_n_sse41(q1516_t* out, const float* in, size_t n){
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_si128((__m128i*)(out + i), from_float_q16_sse41(_mm_loadu_ps(in + i)));
+    }
+    from_float_n_scalar(out + i, in + i, n - i);
+}
+
+Q1516_TARGET_SSE41 static void to_float_n_sse41(float* out, const q1516_t* in, size_t n){
+    // Multiplying by 2^-16 is exact, so this matches the scalar "/ Q1516_SCALE"
+    const __m128 inv_scale = _mm_set1_ps(1.0f / (float)Q1516_SCALE);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(in + i)));
+        _mm_storeu_ps(out + i, _mm_mul_ps(v, inv_scale));
+    }
+    to_float_n_scalar(out + i, in + i, n - i);
+}
+
+static const batch_ops_t sse41_ops = {
+    add_n_sse41, mul_n_sse41, mac_n_sse41, dot_acc_sse41,
+    add_sat_n_sse41, sub_sat_n_sse41, mul_sat_n_sse41,
+    from_float_n_sse41, to_float_n_sse41
+};
+
+//=========================================
+// AVX2 KERNELS (8 lanes)
+//=========================================
+
+// Same trick as mul_q16_sse41, on 8 lanes
+Q1516_TARGET_AVX2 static inline __m256i mul_q16_avx2(__m256i a, __m256i b){
+    __m256i even = _mm256_mul_epi32(a, b);
+    __m256i odd  = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    even = _mm256_srli_epi64(even, Q1516_FRACTIONAL_BITS);
+    odd  = _mm256_slli_epi64(odd, 32 - Q1516_FRACTIONAL_BITS);
+    return _mm256_blend_epi32(even, odd, 0xAA);
+}
+
+Q1516_TARGET_AVX2 static inline __m256i limit_for_sign_avx2(__m256i a){
+    return _mm256_add_epi32(_mm256_srli_epi32(a, 31), _mm256_set1_epi32(Q1516_MAX));
+}
+
+Q1516_TARGET_AVX2 static inline __m256i select_sign_avx2(__m256i value, __m256i limit, __m256i overflow){
+    return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(value), _mm256_castsi256_ps(limit),
+                                                _mm256_castsi256_ps(overflow)));
+}
+
+// Same clamp as mul_sat_q16_sse41, on 8 lanes
+Q1516_TARGET_AVX2 static inline __m256i mul_sat_q16_avx2(__m256i a, __m256i b){
+    __m256i even = _mm256_mul_epi32(a, b);
+    __m256i odd  = _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32));
+    __m256i result = _mm256_blend_epi32(_mm256_srli_epi64(even, Q1516_FRACTIONAL_BITS),
+                                        _mm256_slli_epi64(odd, 32 - Q1516_FRACTIONAL_BITS), 0xAA);
+    __m256i high = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+    __m256i too_big   = _mm256_cmpgt_epi32(high, _mm256_set1_epi32(0x7FFF));
+    __m256i too_small = _mm256_cmpgt_epi32(_mm256_set1_epi32(-0x8000), high);
+    result = _mm256_blendv_epi8(result, _mm256_set1_epi32(Q1516_MAX), too_big);
+    return _mm256_blendv_epi8(result, _mm256_set1_epi32(Q1516_MIN), too_small);
+}
+
+Q1516_TARGET_AVX2 static void add_n_avx2(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_add_epi32(va, vb));
+    }
+    add_n_scalar(out + i, a + i, b + i, n - i);
+}
+
+Q1516_TARGET_AVX2 static void mul_n_avx2(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(out + i), mul_q16_avx2(va, vb));
+    }
+    mul_n_scalar(out + i, a + i, b + i, n - i);
+}
+
+Q1516_TARGET_AVX2 static void mac_n_avx2(q1516_t* acc, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i vacc = _mm256_loadu_si256((const __m256i*)(acc + i));
+        _mm256_storeu_si256((__m256i*)(acc + i), _mm256_add_epi32(vacc, mul_q16_avx2(va, vb)));
+    }
+    mac_n_scalar(acc + i, a + i, b + i, n - i);
+}
+
+Q1516_TARGET_AVX2 static q1516_acc_t dot_acc_avx2(const q1516_t* a, const q1516_t* b, size_t n){
+    __m256i sum_even = _mm256_setzero_si256();
+    __m256i sum_odd = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        sum_even = _mm256_add_epi64(sum_even, _mm256_mul_epi32(va, vb));
+        sum_odd = _mm256_add_epi64(sum_odd, _mm256_mul_epi32(_mm256_srli_epi64(va, 32),
+                                                             _mm256_srli_epi64(vb, 32)));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(sum_even, sum_odd));
+    return (q1516_acc_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+                         (uint64_t)dot_acc_scalar(a + i, b + i, n - i));
+}
+
+Q1516_TARGET_AVX2 static void add_sat_n_avx2(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i sum = _mm256_add_epi32(va, vb);
+        __m256i overflow = _mm256_andnot_si256(_mm256_xor_si256(va, vb), _mm256_xor_si256(va, sum));
+        _mm256_storeu_si256((__m256i*)(out + i), select_sign_avx2(sum, limit_for_sign_avx2(va), overflow));
+    }
+    add_sat_n_scalar(out + i, a + i, b + i, n - i);
+}
+
+Q1516_TARGET_AVX2 static void sub_sat_n_avx2(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        __m256i diff = _mm256_sub_epi32(va, vb);
+        __m256i overflow = _mm256_and_si256(_mm256_xor_si256(va, vb), _mm256_xor_si256(va, diff));
+        _mm256_storeu_si256((__m256i*)(out + i), select_sign_avx2(diff, limit_for_sign_avx2(va), overflow));
+    }
+    sub_sat_n_scalar(out + i, a + i, b + i, n - i);
+}
+
+Q1516_TARGET_AVX2 static void mul_sat_n_avx2(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+        _mm256_storeu_si256((__m256i*)(out + i), mul_sat_q16_avx2(va, vb));
+    }
+    mul_sat_n_scalar(out + i, a + i, b + i, n - i);
+}
+
+// Same steps as from_float_q16_sse41
+Q1516_TARGET_AVX2 static __m256i from_float_q16_avx2(__m256 value){
+    const __m256 scale = _mm256_set1_ps((float)Q1516_SCALE);
+    const __m256 two_31 = _mm256_set1_ps(2147483648.0f);
+    __m256 scaled = _mm256_mul_ps(value, scale);
+    __m256 rounded = _mm256_round_ps(scaled, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256i result = _mm256_cvtps_epi32(rounded);
+    __m256i too_big = _mm256_castps_si256(_mm256_cmp_ps(rounded, two_31, _CMP_GE_OQ));
+    __m256i is_nan = _mm256_castps_si256(_mm256_cmp_ps(scaled, scaled, _CMP_UNORD_Q));
+    return _mm256_andnot_si256(is_nan, _mm256_xor_si256(result, too_big));
+}
+
+Q1516_TARGET_AVX2 static void from_float_n_avx2(q1516_t* out, const float* in, size_t n){
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_si256((__m256i*)(out + i), from_float_q16_avx2(_mm256_loadu_ps(in + i)));
+    }
+    from_float_n_scalar(out + i, in + i, n - i);
+}
+
+Q1516_TARGET_AVX2 static void to_float_n_avx2(float* out, const q1516_t* in, size_t n){
+    const __m256 inv_scale = _mm256_set1_ps(1.0f / (float)Q1516_SCALE);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(v, inv_scale));
+    }
+    to_float_n_scalar(out + i, in + i, n - i);
+}
+
+static const batch_ops_t avx2_ops = {
+    add_n_avx2, mul_n_avx2, mac_n_avx2, dot_acc_avx2,
+    add_sat_n_avx2, sub_sat_n_avx2, mul_sat_n_avx2,
+    from_float_n_avx2, to_float_n_avx2
+};
+
+#endif /* Q1516_BATCH_X86 */
+
+//=========================================
+// RUNTIME SELECTION
+//=========================================
+
+// Read by every thread calling a kernel, so accessed with atomics: active_isa
+// is stored first and active_ops released after it, so a thread that
+// acquires active_ops also sees the ISA that goes with it.
+static const batch_ops_t* active_ops = NULL;
+static q1516_isa_t active_isa = Q1516_ISA_SCALAR;
+
+static q1516_isa_t detect_isa(void){
+#ifdef Q1516_BATCH_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))   return Q1516_ISA_AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return Q1516_ISA_SSE41;
+#endif
+    return Q1516_ISA_SCALAR;
+}
+
+q1516_isa_t q1516_batch_set_isa(q1516_isa_t isa){
+    q1516_isa_t best = detect_isa();
+    if (isa > best) isa = best;
+
+    const batch_ops_t* selected;
+    switch (isa) {
+#ifdef Q1516_BATCH_X86
+        case Q1516_ISA_AVX2:  selected = &avx2_ops;  break;
+        case Q1516_ISA_SSE41: selected = &sse41_ops; break;
+#endif
+        default:
+            isa = Q1516_ISA_SCALAR;
+            selected = &scalar_ops;
+            break;
+    }
+    __atomic_store_n(&active_isa, isa, __ATOMIC_RELAXED);
+    __atomic_store_n(&active_ops, selected, __ATOMIC_RELEASE);
+    return isa;
+}
+
+// First call picks the best ISA. Racing first calls all store the same
+// values through the atomics above, so no locking is needed.
+static const batch_ops_t* ops(void){
+    const batch_ops_t* selected = __atomic_load_n(&active_ops, __ATOMIC_ACQUIRE);
+    if (selected == NULL) {
+        q1516_batch_set_isa(Q1516_ISA_AVX2);
+        selected = __atomic_load_n(&active_ops, __ATOMIC_ACQUIRE);
+    }
+    return selected;
+}
+
+q1516_isa_t q1516_batch_isa(void){
+    ops();
+    return __atomic_load_n(&active_isa, __ATOMIC_RELAXED);
+}
+
+const char* q1516_isa_name(q1516_isa_t isa){
+    switch (isa) {
+        case Q1516_ISA_SCALAR: return "scalar";
+        case Q1516_ISA_SSE41:  return "sse4.1";
+        case Q1516_ISA_AVX2:   return "avx2";
+        default:               return "unknown";
+    }
+}
+
+//=========================================
+// PUBLIC ENTRY POINTS
+//=========================================
+
+void q1516_add_n(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    ops()->add_n(out, a, b, n);
+}
+
+void q1516_mul_n(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    ops()->mul_n(out, a, b, n);
+}
+
+void q1516_mac_n(q1516_t* acc, const q1516_t* a, const q1516_t* b, size_t n){
+    ops()->mac_n(acc, a, b, n);
+}
+
+q1516_acc_t q1516_dot_acc(const q1516_t* a, const q1516_t* b, size_t n){
+    return ops()->dot_acc(a, b, n);
+}
+
+q1516_t q1516_dot(const q1516_t* a, const q1516_t* b, size_t n){
+    return q1516_acc_round(ops()->dot_acc(a, b, n), Q1516_ROUND_NEAREST);
+}
+
+void q1516_add_sat_n(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    ops()->add_sat_n(out, a, b, n);
+}
+
+void q1516_sub_sat_n(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    ops()->sub_sat_n(out, a, b, n);
+}
+
+void q1516_mul_sat_n(q1516_t* out, const q1516_t* a, const q1516_t* b, size_t n){
+    ops()->mul_sat_n(out, a, b, n);
+}
+
+void q1516_from_float_n(q1516_t* out, const float* in, size_t n){
+    ops()->from_float_n(out, in, n);
+}
+
+void q1516_to_float_n(float* out, const q1516_t* in, size_t n){
+    ops()->to_float_n(out, in, n);
+}
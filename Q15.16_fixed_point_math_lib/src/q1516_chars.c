@@ -0,0 +1,186 @@
+#include "q1516_chars.h"
+
+/*
+ * @file q1516_chars.c
+ * @brief Exact decimal formatting and parsing of Q15.16 values
+ *
+ * The fraction f (16 bits) of a Q15.16 value is f / 2^16 = f * 5^16 / 10^16,
+ * so its 16 decimal digits are the integer f * 5^16, which fits in 54 bits.
+ * Formatting prints that integer; parsing reverses it with one 64-bit
+ * division by 5^16. Neither needs more than uint64_t.
+ */
+
+#define FRACTION_DIGITS 16
+#define FIVE_POW_16 152587890625ULL     // 5^16: one fraction ULP is 5^16 / 10^16
+
+static const uint64_t powers_of_10[FRACTION_DIGITS + 1] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL,
+    1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+    100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL
+};
+
+static const uint64_t powers_of_5[FRACTION_DIGITS + 1] = {
+    1ULL, 5ULL, 25ULL, 125ULL, 625ULL, 3125ULL, 15625ULL, 78125ULL, 390625ULL, 1953125ULL,
+    9765625ULL, 48828125ULL, 244140625ULL, 1220703125ULL, 6103515625ULL, 30517578125ULL, 152587890625ULL
+};
+
+// "00" "01" ... "99": two digits per division
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+//=========================================
+// FORMATTING
+//=========================================
+
+static int count_digits(uint32_t v){
+    int n = 1;
+    while (v >= 10) {
+        v /= 10;
+        n++;
+    }
+    return n;
+}
+
+// Exactly `count` digits of v, with leading zeros, ending just before `end`
+static void write_digits(char* end, uint64_t v, int count){
+    while (count >= 2) {
+        const char* pair = &digit_pairs[(v % 100) * 2];
+        v /= 100;
+        *--end = pair[1];
+        *--end = pair[0];
+        count -= 2;
+    }
+    if (count) *--end = (char)('0' + v % 10);
+}
+
+// [-]integer[.fraction], fraction given as `digits` digits (none if 0)
+static size_t write_number(char* buf, size_t size, int negative, uint32_t integer, uint64_t fraction,
+                           int digits){
+    int integer_digits = count_digits(integer);
+    size_t length = (size_t)negative + (size_t)integer_digits + (digits > 0 ? 1 + (size_t)digits : 0);
+    if (length >= size) {
+        if (size > 0) buf[0] = '\0';
+        return 0;
+    }
+
+    char* p = buf;
+    if (negative) *p++ = '-';
+    write_digits(p + integer_digits, integer, integer_digits);
+    p += integer_digits;
+    if (digits > 0) {
+        *p++ = '.';
+        write_digits(p + digits, fraction, digits);
+        p += digits;
+    }
+    *p = '\0';
+    return length;
+}
+
+size_t q1516_to_chars(char* buf, size_t size, q1516_t value){
+    uint32_t magnitude = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+    uint32_t fraction = magnitude & 0xFFFFu;
+    int digits = 0;
+
+    // f / 2^16 with f = m * 2^z (m odd) is m / 2^(16 - z): exactly 16 - z
+    // decimal digits, which are m * 5^(16 - z)
+    if (fraction != 0) {
+#if defined(__GNUC__) || defined(__clang__)
+        int zeros = __builtin_ctz(fraction);
+#else
+        int zeros = 0;
+        while (((fraction >> zeros) & 1u) == 0) zeros++;
+#endif
+        fraction >>= zeros;
+        digits = FRACTION_DIGITS - zeros;
+    }
+    return write_number(buf, size, value < 0, magnitude >> Q1516_FRACTIONAL_BITS,
+                        (uint64_t)fraction * powers_of_5[digits], digits);
+}
+
+size_t q1516_to_chars_fixed(char* buf, size_t size, q1516_t value, int digits){
+    if (digits < 0) digits = 0;
+    if (digits > FRACTION_DIGITS) digits = FRACTION_DIGITS;
+
+    uint32_t magnitude = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+    uint32_t integer = magnitude >> Q1516_FRACTIONAL_BITS;
+    uint64_t fraction = (uint64_t)(magnitude & 0xFFFFu) * FIVE_POW_16;   // 16 digits
+
+    if (digits < FRACTION_DIGITS) {
+        uint64_t unit = powers_of_10[FRACTION_DIGITS - digits];
+        uint64_t kept = fraction / unit;
+        uint64_t dropped = fraction % unit;
+        uint64_t last = (digits > 0) ? kept : integer;   // Parity decides ties
+        if (dropped > unit / 2 || (dropped == unit / 2 && (last & 1u))) kept++;
+        if (kept == powers_of_10[digits]) {
+            kept = 0;
+            integer++;                                    // e.g. 1.996 -> "2.00"
+        }
+        fraction = kept;
+    }
+    return write_number(buf, size, value < 0, integer, fraction, digits);
+}
+
+//=========================================
+// PARSING
+//=========================================
+
+size_t q1516_from_chars(const char* text, size_t length, q1516_t* value){
+    size_t i = 0;
+    int negative = 0;
+    if (i < length && (text[i] == '-' || text[i] == '+')) {
+        negative = text[i] == '-';
+        i++;
+    }
+
+    // Integer part, capped: anything from 32769 up saturates anyway
+    uint32_t integer = 0;
+    size_t digits_seen = 0;
+    for (; i < length && text[i] >= '0' && text[i] <= '9'; i++, digits_seen++) {
+        if (integer < 65536u) integer = integer * 10u + (uint32_t)(text[i] - '0');
+    }
+
+    // Fraction: the first 16 digits exactly, then only what rounding needs,
+    // i.e. how the rest compares with one half of the 16th digit
+    uint64_t fraction = 0;
+    int fraction_digits = 0;
+    int tail = 0;                   // Digits after the 16th: 0 none, 1 < half, 2 = half, 3 > half
+    if (i < length && text[i] == '.') {
+        size_t point = i++;
+        for (; i < length && text[i] >= '0' && text[i] <= '9'; i++, digits_seen++) {
+            int d = text[i] - '0';
+            if (fraction_digits < FRACTION_DIGITS) {
+                fraction = fraction * 10u + (uint64_t)d;
+                fraction_digits++;
+            } else if (fraction_digits == FRACTION_DIGITS) {
+                tail = (d > 5) ? 3 : (d == 5) ? 2 : (d > 0) ? 1 : 0;
+                fraction_digits++;
+            } else if (d != 0 && tail != 3) {
+                tail = (tail == 2) ? 3 : 1;
+            }
+        }
+        if (digits_seen == 0) i = point;
+    }
+    if (digits_seen == 0) return 0;
+
+    if (fraction_digits < FRACTION_DIGITS) fraction *= powers_of_10[FRACTION_DIGITS - fraction_digits];
+
+    // fraction / 5^16 is the value in ULP. 5^16 is odd, so the remainder
+    // alone decides unless it sits just below one half; then the tail does.
+    uint64_t ulps = fraction / FIVE_POW_16;
+    uint64_t twice_remainder = 2 * (fraction % FIVE_POW_16);
+    uint64_t raw = ((uint64_t)integer << Q1516_FRACTIONAL_BITS) + ulps;
+    if (twice_remainder > FIVE_POW_16 - 1) {
+        raw++;
+    } else if (twice_remainder == FIVE_POW_16 - 1) {
+        if (tail == 3 || (tail == 2 && (raw & 1u))) raw++;
+    }
+
+    if (negative) {
+        *value = (raw > (uint64_t)1 << 31) ? Q1516_MIN : (q1516_t)(0 - (int64_t)raw);
+    } else {
+        *value = (raw > (uint64_t)Q1516_MAX) ? Q1516_MAX : (q1516_t)raw;
+    }
+    return i;
+}
@@ -0,0 +1,171 @@
+// Per-sample rounding and saturation use the header-only definitions so
+// they inline into the filter loops.
+#define Q1516_INLINE
+#include "q1516_dsp.h"
+#include "q1516_batch.h"
+#include <string.h>
+
+/*
+ * @file q1516_dsp.c
+ * @brief FIR, biquad cascade and moving-average filters on Q15.16 blocks
+ *
+ * The FIR inner loop is q1516_dot_acc, so it runs on the SSE4.1/AVX2
+ * kernels picked at run time. Biquads and the moving average are
+ * recursive (each output needs the previous one) and stay scalar; they
+ * avoid per-sample function calls and keep their state in registers for
+ * the whole block instead.
+ */
+
+//=========================================
+// HELPERS
+//=========================================
+
+// Wrapping 64-bit add: q1516_dot_acc already wraps modulo 2^64
+static q1516_acc_t acc_add(q1516_acc_t a, q1516_acc_t b){
+    return (q1516_acc_t)((uint64_t)a + (uint64_t)b);
+}
+
+//=========================================
+// FIR FILTER
+//=========================================
+
+void q1516_fir_init(q1516_fir_t* fir, const q1516_t* coeffs, size_t num_taps, q1516_t* state){
+    fir->num_taps = num_taps;
+    fir->reversed = state;
+    fir->history = state + num_taps;
+    fir->next_history = fir->history + (num_taps - 1);
+    for (size_t k = 0; k < num_taps; k++) {
+        fir->reversed[k] = coeffs[num_taps - 1 - k];
+    }
+    q1516_fir_reset(fir);
+}
+
+void q1516_fir_reset(q1516_fir_t* fir){
+    memset(fir->history, 0, (fir->num_taps - 1) * sizeof(q1516_t));
+}
+
+void q1516_fir_process(q1516_fir_t* fir, q1516_t* out, const q1516_t* in, size_t n){
+    const q1516_t* h = fir->reversed;
+    const q1516_t* history = fir->history;
+    size_t taps = fir->num_taps;
+    size_t keep = taps - 1;
+
+    // History for the next call, saved before `out` can overwrite `in`
+    if (n >= keep) {
+        memcpy(fir->next_history, in + n - keep, keep * sizeof(q1516_t));
+    } else {
+        memcpy(fir->next_history, history + n, (keep - n) * sizeof(q1516_t));
+        memcpy(fir->next_history + keep - n, in, n * sizeof(q1516_t));
+    }
+
+    // Last output first: out[i] reads in[0..i] only, so out == in is safe.
+    // The window of out[i] is in[i - keep .. i]; where that reaches before
+    // the block, its head comes from the history instead.
+    for (size_t i = n; i-- > 0;) {
+        q1516_acc_t acc;
+        if (i >= keep) {
+            acc = q1516_dot_acc(h, in + i - keep, taps);
+        } else {
+            acc = acc_add(q1516_dot_acc(h, history + i, keep - i),
+                          q1516_dot_acc(h + keep - i, in, i + 1));
+        }
+        out[i] = q1516_acc_round(acc, Q1516_ROUND_NEAREST);
+    }
+
+    q1516_t* swap = fir->history;
+    fir->history = fir->next_history;
+    fir->next_history = swap;
+}
+
+//=========================================
+// BIQUAD CASCADE
+//=========================================
+
+void q1516_biquad_init(q1516_biquad_t* biquad, const q1516_biquad_coeffs_t* coeffs, size_t num_stages,
+                       q1516_t* state){
+    biquad->coeffs = coeffs;
+    biquad->state = state;
+    biquad->num_stages = num_stages;
+    q1516_biquad_reset(biquad);
+}
+
+void q1516_biquad_reset(q1516_biquad_t* biquad){
+    memset(biquad->state, 0, Q1516_BIQUAD_STATE_SIZE(biquad->num_stages) * sizeof(q1516_t));
+}
+
+void q1516_biquad_process(q1516_biquad_t* biquad, q1516_t* out, const q1516_t* in, size_t n){
+    const int64_t half = (int64_t)1 << (Q1516_BIQUAD_FRACTIONAL_BITS - 1);
+
+    // One section at a time over the whole block: each stage's output is
+    // the next stage's input, filtered in place in `out`
+    for (size_t s = 0; s < biquad->num_stages; s++) {
+        const q1516_biquad_coeffs_t c = biquad->coeffs[s];
+        q1516_t* state = biquad->state + 4 * s;
+        int64_t x1 = state[0], x2 = state[1], y1 = state[2], y2 = state[3];
+        const q1516_t* src = (s == 0) ? in : out;
+
+        for (size_t i = 0; i < n; i++) {
+            int64_t x0 = src[i];
+            int64_t acc = c.b0 * x0 + c.b1 * x1 + c.b2 * x2 - c.a1 * y1 - c.a2 * y2;
+            q1516_t y0 = q1516_saturate_raw((acc + half) >> Q1516_BIQUAD_FRACTIONAL_BITS);
+            x2 = x1;
+            x1 = x0;
+            y2 = y1;
+            y1 = y0;
+            out[i] = y0;
+        }
+
+        state[0] = (q1516_t)x1;
+        state[1] = (q1516_t)x2;
+        state[2] = (q1516_t)y1;
+        state[3] = (q1516_t)y2;
+    }
+}
+
+//=========================================
+// MOVING AVERAGE
+//=========================================
+
+void q1516_moving_average_init(q1516_moving_average_t* avg, q1516_t* window, size_t length){
+    avg->window = window;
+    avg->length = length;
+    avg->shift = -1;
+    if ((length & (length - 1)) == 0) {
+        avg->shift = 0;
+        while (((size_t)1 << avg->shift) < length) avg->shift++;
+    }
+    q1516_moving_average_reset(avg);
+}
+
+void q1516_moving_average_reset(q1516_moving_average_t* avg){
+    memset(avg->window, 0, avg->length * sizeof(q1516_t));
+    avg->sum = 0;
+    avg->pos = 0;
+}
+
+void q1516_moving_average_process(q1516_moving_average_t* avg, q1516_t* out, const q1516_t* in, size_t n){
+    q1516_t* window = avg->window;
+    q1516_acc_t sum = avg->sum;
+    size_t pos = avg->pos;
+    const size_t length = avg->length;
+    const int64_t divisor = (int64_t)length;
+
+    for (size_t i = 0; i < n; i++) {
+        q1516_t x = in[i];
+        sum += (q1516_acc_t)x - window[pos];
+        window[pos] = x;
+        pos = (pos + 1 == length) ? 0 : pos + 1;
+
+        // Round to nearest (ties up): floor((sum + length / 2) / length)
+        if (avg->shift >= 0) {
+            out[i] = (q1516_t)((sum + (divisor >> 1)) >> avg->shift);
+        } else {
+            int64_t num = 2 * sum + divisor;
+            int64_t q = num / (2 * divisor);
+            out[i] = (q1516_t)((num % (2 * divisor) < 0) ? q - 1 : q);
+        }
+    }
+
+    avg->sum = sum;
+    avg->pos = pos;
+}
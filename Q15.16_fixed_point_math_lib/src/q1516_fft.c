@@ -0,0 +1,331 @@
+#include "q1516_fft.h"
+#include "q1516_batch.h"
+
+/*
+ * @file q1516_fft.c
+ * @brief Radix-4/radix-2 decimation-in-frequency FFT on Q15.16 data
+ *
+ * A radix-4 DIF butterfly with its two middle outputs swapped is exactly
+ * two radix-2 DIF passes, so radix-4 passes and a final radix-2 pass
+ * compose into the plain radix-2 ordering: one bit-reversal at the end
+ * puts the spectrum in natural order.
+ *
+ * Sums wrap modulo 2^32 (only reachable with Q1516_FFT_SCALE_NONE) and
+ * twiddle products keep the low 32 bits of the rounded 64-bit result; the
+ * AVX2 butterflies do the same, so both paths give identical bits.
+ */
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define Q1516_FFT_X86 1
+#include <immintrin.h>
+#define Q1516_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#define TWIDDLE_BITS 30
+#define TWIDDLE_ONE  ((int64_t)1 << TWIDDLE_BITS)
+#define TWIDDLE_HALF ((int64_t)1 << (TWIDDLE_BITS - 1))
+
+// round(pi/2 * 2^32): radians (Q30) per 2^-32 turn
+#define HALF_PI_Q32 6746518852LL
+
+//=========================================
+// TWIDDLE FACTORS
+//=========================================
+
+// sin(x) and cos(x) for x in [0, pi/4], both Q30. Taylor series up to
+// x^13 / x^14 (truncation error below 2^-40), Horner form in int64.
+static int64_t sin_q30(int64_t x){
+    int64_t x2 = (x * x + TWIDDLE_HALF) >> TWIDDLE_BITS;
+    int64_t t = TWIDDLE_ONE;
+    for (int k = 12; k >= 2; k -= 2) {
+        t = TWIDDLE_ONE - ((x2 * t / (k * (k + 1)) + TWIDDLE_HALF) >> TWIDDLE_BITS);
+    }
+    return (x * t + TWIDDLE_HALF) >> TWIDDLE_BITS;
+}
+
+static int64_t cos_q30(int64_t x){
+    int64_t x2 = (x * x + TWIDDLE_HALF) >> TWIDDLE_BITS;
+    int64_t t = TWIDDLE_ONE;
+    for (int k = 13; k >= 1; k -= 2) {
+        t = TWIDDLE_ONE - ((x2 * t / (k * (k + 1)) + TWIDDLE_HALF) >> TWIDDLE_BITS);
+    }
+    return t;
+}
+
+// exp(-2*pi*i * phase / 2^32): fold into the first octant, then rotate back
+static q1516_twiddle_t unit_root(uint32_t phase){
+    uint32_t quadrant = phase >> 30;
+    uint32_t offset = phase & 0x3FFFFFFFu;
+    int mirrored = offset > 0x20000000u;        // Past 1/8 turn: use the complement
+    if (mirrored) offset = 0x40000000u - offset;
+
+    int64_t angle = ((int64_t)offset * HALF_PI_Q32 + ((int64_t)1 << 31)) >> 32;
+    int64_t c = cos_q30(angle), s = sin_q30(angle);
+    if (mirrored) {
+        int64_t swap = c;
+        c = s;
+        s = swap;
+    }
+
+    int64_t cos_value, sin_value;
+    switch (quadrant) {
+        case 0:  cos_value = c;  sin_value = s;  break;
+        case 1:  cos_value = -s; sin_value = c;  break;
+        case 2:  cos_value = -c; sin_value = -s; break;
+        default: cos_value = s;  sin_value = -c; break;
+    }
+    q1516_twiddle_t w = {(int32_t)cos_value, (int32_t)-sin_value};
+    return w;
+}
+
+int q1516_fft_init(q1516_fft_t* fft, size_t n, q1516_twiddle_t* twiddles){
+    if (n < Q1516_FFT_MIN_SIZE || n > Q1516_FFT_MAX_SIZE || (n & (n - 1)) != 0) return -1;
+
+    int log2n = 0;
+    while (((size_t)1 << log2n) < n) log2n++;
+
+    // One W^j, W^2j, W^3j block per radix-4 pass, W = exp(-2*pi*i/length)
+    q1516_twiddle_t* tw = twiddles;
+    for (size_t length = n; length >= 4; length >>= 2) {
+        size_t q = length / 4;
+        int shift = 32 - log2n;
+        size_t stride = n / length;
+        for (size_t j = 0; j < q; j++) {
+            tw[j] = unit_root((uint32_t)((j * stride) << shift));
+            tw[q + j] = unit_root((uint32_t)((2 * j * stride) << shift));
+            tw[2 * q + j] = unit_root((uint32_t)((3 * j * stride) << shift));
+        }
+        tw += 3 * q;
+    }
+
+    fft->twiddles = twiddles;
+    fft->n = n;
+    fft->log2n = log2n;
+    return 0;
+}
+
+//=========================================
+// SCALAR BUTTERFLIES
+//=========================================
+
+static inline int32_t add_wrap(int32_t a, int32_t b){
+    return (int32_t)((uint32_t)a + (uint32_t)b);
+}
+
+static inline int32_t sub_wrap(int32_t a, int32_t b){
+    return (int32_t)((uint32_t)a - (uint32_t)b);
+}
+
+// x / 2^shift, rounded to nearest (ties up), then capped at INT32_MAX >> shift:
+// values just below 2^31 would otherwise round up to 2^(31 - shift), and four
+// of those summed in a radix-4 butterfly reach 2^31 and wrap
+static inline int32_t round_down(int32_t x, int shift){
+    if (shift == 0) return x;
+    int32_t rounded = (x >> shift) + ((x >> (shift - 1)) & 1);
+    return rounded > (INT32_MAX >> shift) ? (INT32_MAX >> shift) : rounded;
+}
+
+static inline q1516_complex_t c_load(const q1516_complex_t* p, int shift){
+    q1516_complex_t v = {round_down(p->re, shift), round_down(p->im, shift)};
+    return v;
+}
+
+static inline q1516_complex_t c_add(q1516_complex_t a, q1516_complex_t b){
+    q1516_complex_t v = {add_wrap(a.re, b.re), add_wrap(a.im, b.im)};
+    return v;
+}
+
+static inline q1516_complex_t c_sub(q1516_complex_t a, q1516_complex_t b){
+    q1516_complex_t v = {sub_wrap(a.re, b.re), sub_wrap(a.im, b.im)};
+    return v;
+}
+
+// -i * a
+static inline q1516_complex_t c_mul_minus_i(q1516_complex_t a){
+    q1516_complex_t v = {a.im, sub_wrap(0, a.re)};
+    return v;
+}
+
+static inline q1516_complex_t c_twiddle(q1516_complex_t x, q1516_twiddle_t w){
+    int64_t re = (int64_t)x.re * w.re - (int64_t)x.im * w.im + TWIDDLE_HALF;
+    int64_t im = (int64_t)x.re * w.im + (int64_t)x.im * w.re + TWIDDLE_HALF;
+    q1516_complex_t v = {(int32_t)(re >> TWIDDLE_BITS), (int32_t)(im >> TWIDDLE_BITS)};
+    return v;
+}
+
+// Butterflies j = j_start .. q-1 of every group of 4q values
+static void radix4_pass_scalar(q1516_complex_t* data, size_t n, size_t q, size_t j_start,
+                               const q1516_twiddle_t* tw, int shift){
+    for (size_t group = 0; group < n; group += 4 * q) {
+        q1516_complex_t* p = data + group;
+        for (size_t j = j_start; j < q; j++) {
+            q1516_complex_t x0 = c_load(p + j, shift);
+            q1516_complex_t x1 = c_load(p + j + q, shift);
+            q1516_complex_t x2 = c_load(p + j + 2 * q, shift);
+            q1516_complex_t x3 = c_load(p + j + 3 * q, shift);
+            q1516_complex_t t0 = c_add(x0, x2), t1 = c_sub(x0, x2);
+            q1516_complex_t t2 = c_add(x1, x3), t3 = c_mul_minus_i(c_sub(x1, x3));
+            p[j] = c_add(t0, t2);
+            p[j + q] = c_twiddle(c_sub(t0, t2), tw[q + j]);
+            p[j + 2 * q] = c_twiddle(c_add(t1, t3), tw[j]);
+            p[j + 3 * q] = c_twiddle(c_sub(t1, t3), tw[2 * q + j]);
+        }
+    }
+}
+
+static void radix2_pass(q1516_complex_t* data, size_t n, int shift){
+    for (size_t i = 0; i < n; i += 2) {
+        q1516_complex_t a = c_load(data + i, shift);
+        q1516_complex_t b = c_load(data + i + 1, shift);
+        data[i] = c_add(a, b);
+        data[i + 1] = c_sub(a, b);
+    }
+}
+
+//=========================================
+// AVX2 BUTTERFLIES
+//=========================================
+
+#ifdef Q1516_FFT_X86
+
+// Four complex values per register, interleaved re, im, re, im, ...
+Q1516_TARGET_AVX2 static inline __m256i load_avx2(const q1516_complex_t* p, __m128i shift, __m128i shift_minus_1,
+                                                  int rounding){
+    __m256i x = _mm256_loadu_si256((const __m256i*)p);
+    if (!rounding) return x;
+    __m256i bit = _mm256_and_si256(_mm256_sra_epi32(x, shift_minus_1), _mm256_set1_epi32(1));
+    __m256i rounded = _mm256_add_epi32(_mm256_sra_epi32(x, shift), bit);
+    return _mm256_min_epi32(rounded, _mm256_srl_epi32(_mm256_set1_epi32(INT32_MAX), shift));
+}
+
+Q1516_TARGET_AVX2 static inline __m256i mul_minus_i_avx2(__m256i a){
+    __m256i swapped = _mm256_shuffle_epi32(a, _MM_SHUFFLE(2, 3, 0, 1));
+    return _mm256_sign_epi32(swapped, _mm256_setr_epi32(1, -1, 1, -1, 1, -1, 1, -1));
+}
+
+// The rounded 64-bit products are shifted by 30 logically: the low 32 bits
+// match an arithmetic shift, which AVX2 lacks for 64-bit lanes
+Q1516_TARGET_AVX2 static inline __m256i twiddle_avx2(__m256i x, const q1516_twiddle_t* w_ptr){
+    const __m256i half = _mm256_set1_epi64x(TWIDDLE_HALF);
+    __m256i w = _mm256_loadu_si256((const __m256i*)w_ptr);
+    __m256i x_im = _mm256_srli_epi64(x, 32);
+    __m256i w_im = _mm256_srli_epi64(w, 32);
+    __m256i re = _mm256_sub_epi64(_mm256_mul_epi32(x, w), _mm256_mul_epi32(x_im, w_im));
+    __m256i im = _mm256_add_epi64(_mm256_mul_epi32(x, w_im), _mm256_mul_epi32(x_im, w));
+    re = _mm256_srli_epi64(_mm256_add_epi64(re, half), TWIDDLE_BITS);
+    im = _mm256_slli_epi64(_mm256_add_epi64(im, half), 32 - TWIDDLE_BITS);
+    return _mm256_blend_epi32(re, im, 0xAA);
+}
+
+Q1516_TARGET_AVX2 static void radix4_pass_avx2(q1516_complex_t* data, size_t n, size_t q,
+                                               const q1516_twiddle_t* tw, int shift){
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    const __m128i count_minus_1 = _mm_cvtsi32_si128(shift > 0 ? shift - 1 : 0);
+    const int rounding = shift > 0;
+
+    for (size_t group = 0; group < n; group += 4 * q) {
+        q1516_complex_t* p = data + group;
+        for (size_t j = 0; j + 4 <= q; j += 4) {
+            __m256i x0 = load_avx2(p + j, count, count_minus_1, rounding);
+            __m256i x1 = load_avx2(p + j + q, count, count_minus_1, rounding);
+            __m256i x2 = load_avx2(p + j + 2 * q, count, count_minus_1, rounding);
+            __m256i x3 = load_avx2(p + j + 3 * q, count, count_minus_1, rounding);
+            __m256i t0 = _mm256_add_epi32(x0, x2), t1 = _mm256_sub_epi32(x0, x2);
+            __m256i t2 = _mm256_add_epi32(x1, x3);
+            __m256i t3 = mul_minus_i_avx2(_mm256_sub_epi32(x1, x3));
+            _mm256_storeu_si256((__m256i*)(p + j), _mm256_add_epi32(t0, t2));
+            _mm256_storeu_si256((__m256i*)(p + j + q), twiddle_avx2(_mm256_sub_epi32(t0, t2), tw + q + j));
+            _mm256_storeu_si256((__m256i*)(p + j + 2 * q), twiddle_avx2(_mm256_add_epi32(t1, t3), tw + j));
+            _mm256_storeu_si256((__m256i*)(p + j + 3 * q), twiddle_avx2(_mm256_sub_epi32(t1, t3), tw + 2 * q + j));
+        }
+    }
+}
+
+#endif
+
+//=========================================
+// TRANSFORM
+//=========================================
+
+// How far a pass shifts its inputs. DYNAMIC keeps every component below
+// 2^(30 - radix_bits) first: a radix-4 butterfly grows a component by at
+// most 4*sqrt(2), a radix-2 one by 2*sqrt(2), so the outputs stay in range.
+static int pass_shift(const q1516_complex_t* data, size_t n, q1516_fft_scale_t scale, int radix_bits){
+    if (scale == Q1516_FFT_SCALE_FIXED) return radix_bits;
+    if (scale != Q1516_FFT_SCALE_DYNAMIC) return 0;
+
+    uint32_t bits = 0;      // OR of |component| (one's complement for negatives)
+    for (size_t i = 0; i < n; i++) {
+        bits |= (uint32_t)(data[i].re ^ (data[i].re >> 31));
+        bits |= (uint32_t)(data[i].im ^ (data[i].im >> 31));
+    }
+    int shift = 0;
+    while ((bits >> shift) >= (1u << (30 - radix_bits))) shift++;
+    return shift;
+}
+
+static void bit_reverse(q1516_complex_t* data, size_t n){
+    size_t j = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i < j) {
+            q1516_complex_t swap = data[i];
+            data[i] = data[j];
+            data[j] = swap;
+        }
+        size_t bit = n >> 1;
+        while (j & bit) {
+            j ^= bit;
+            bit >>= 1;
+        }
+        j |= bit;
+    }
+}
+
+static int transform(const q1516_fft_t* fft, q1516_complex_t* data, q1516_fft_scale_t scale){
+    const size_t n = fft->n;
+    const q1516_twiddle_t* tw = fft->twiddles;
+    int total_shift = 0;
+#ifdef Q1516_FFT_X86
+    const int use_avx2 = q1516_batch_isa() == Q1516_ISA_AVX2;
+#endif
+
+    size_t length = n;
+    for (; length >= 4; length >>= 2) {
+        size_t q = length / 4;
+        int shift = pass_shift(data, n, scale, 2);
+        size_t done = 0;
+#ifdef Q1516_FFT_X86
+        if (use_avx2 && q >= 4) {
+            radix4_pass_avx2(data, n, q, tw, shift);
+            done = q;
+        }
+#endif
+        radix4_pass_scalar(data, n, q, done, tw, shift);
+        tw += 3 * q;
+        total_shift += shift;
+    }
+    if (length == 2) {
+        int shift = pass_shift(data, n, scale, 1);
+        radix2_pass(data, n, shift);
+        total_shift += shift;
+    }
+
+    bit_reverse(data, n);
+    return total_shift;
+}
+
+static void conjugate(q1516_complex_t* data, size_t n){
+    for (size_t i = 0; i < n; i++) data[i].im = sub_wrap(0, data[i].im);
+}
+
+int q1516_fft_forward(const q1516_fft_t* fft, q1516_complex_t* data, q1516_fft_scale_t scale){
+    return transform(fft, data, scale);
+}
+
+// inverse(x) = conj(forward(conj(x)))
+int q1516_fft_inverse(const q1516_fft_t* fft, q1516_complex_t* data, q1516_fft_scale_t scale){
+    conjugate(data, fft->n);
+    int shift = transform(fft, data, scale);
+    conjugate(data, fft->n);
+    return shift;
+}
@@ -0,0 +1,476 @@
+#include "q1516_math.h"
+
+/*
+ * @file q1516_math.c
+ * @brief Integer-only sqrt, sin, cos, atan2, exp and log for Q15.16
+ *
+ * Intermediate values carry 30+ fractional bits so that the only error that
+ * matters is the final rounding back to 16 bits. Error bounds are listed in
+ * q1516_math.h.
+ */
+
+//=========================================
+// TABLES
+//=========================================
+
+// sin(i * (pi/2) / 256) in Q2.30, i = 0..256. The extra last entry mirrors
+// entry 255 so interpolation at exactly pi/2 can read index 257 safely.
+static const int32_t sin_table[258] = {
+    0, 6588356, 13176464, 19764076, 26350943, 32936819,
+    39521455, 46104602, 52686014, 59265442, 65842639, 72417357,
+    78989349, 85558366, 92124163, 98686491, 105245103, 111799753,
+    118350194, 124896179, 131437462, 137973796, 144504935, 151030634,
+    157550647, 164064728, 170572633, 177074115, 183568930, 190056834,
+    196537583, 203010932, 209476638, 215934457, 222384147, 228825464,
+    235258165, 241682010, 248096755, 254502159, 260897982, 267283981,
+    273659918, 280025552, 286380643, 292724951, 299058239, 305380268,
+    311690799, 317989595, 324276419, 330551034, 336813204, 343062693,
+    349299266, 355522689, 361732726, 367929144, 374111709, 380280190,
+    386434353, 392573967, 398698801, 404808624, 410903207, 416982319,
+    423045732, 429093217, 435124548, 441139496, 447137835, 453119340,
+    459083786, 465030947, 470960600, 476872522, 482766489, 488642281,
+    494499676, 500338453, 506158392, 511959275, 517740883, 523502998,
+    529245404, 534967884, 540670223, 546352205, 552013618, 557654248,
+    563273883, 568872310, 574449320, 580004702, 585538248, 591049748,
+    596538995, 602005783, 607449906, 612871159, 618269338, 623644239,
+    628995660, 634323400, 639627258, 644907034, 650162530, 655393548,
+    660599890, 665781362, 670937767, 676068911, 681174602, 686254647,
+    691308855, 696337036, 701339000, 706314559, 711263525, 716185713,
+    721080937, 725949013, 730789757, 735602987, 740388522, 745146182,
+    749875788, 754577161, 759250125, 763894504, 768510122, 773096806,
+    777654384, 782182683, 786681534, 791150767, 795590213, 799999706,
+    804379079, 808728167, 813046808, 817334838, 821592095, 825818421,
+    830013654, 834177638, 838310216, 842411232, 846480531, 850517961,
+    854523370, 858496606, 862437520, 866345964, 870221790, 874064853,
+    877875009, 881652112, 885396022, 889106597, 892783698, 896427186,
+    900036924, 903612776, 907154608, 910662286, 914135678, 917574653,
+    920979082, 924348837, 927683790, 930983817, 934248793, 937478595,
+    940673101, 943832191, 946955747, 950043650, 953095785, 956112036,
+    959092290, 962036435, 964944360, 967815955, 970651112, 973449725,
+    976211688, 978936898, 981625251, 984276646, 986890984, 989468165,
+    992008094, 994510675, 996975812, 999403415, 1001793390, 1004145648,
+    1006460100, 1008736660, 1010975242, 1013175761, 1015338134, 1017462281,
+    1019548121, 1021595575, 1023604567, 1025575020, 1027506862, 1029400018,
+    1031254418, 1033069992, 1034846671, 1036584389, 1038283080, 1039942680,
+    1041563127, 1043144360, 1044686319, 1046188946, 1047652185, 1049075980,
+    1050460278, 1051805027, 1053110176, 1054375676, 1055601479, 1056787540,
+    1057933813, 1059040255, 1060106826, 1061133483, 1062120190, 1063066909,
+    1063973603, 1064840240, 1065666786, 1066453210, 1067199483, 1067905576,
+    1068571464, 1069197120, 1069782521, 1070327646, 1070832474, 1071296985,
+    1071721163, 1072104991, 1072448455, 1072751542, 1073014240, 1073236540,
+    1073418433, 1073559913, 1073660973, 1073721611, 1073741824, 1073721611,
+};
+
+// 2^(j/32) in Q62, j = 0..31
+static const uint64_t exp2_table[32] = {
+    0x4000000000000000ULL, 0x4166C34C5615D0ECULL, 0x42D561B3E6243D8AULL,
+    0x444C0740496D4294ULL, 0x45CAE0F1F545EB73ULL, 0x47521CC5A2E6A9E0ULL,
+    0x48E1E9B9D588E19BULL, 0x4A7A77D47F7B84B1ULL, 0x4C1BF828C6DC54B8ULL,
+    0x4DC69CDCEAA72A9CULL, 0x4F7A993048D088D7ULL, 0x513821818624B40CULL,
+    0x52FF6B54D8A89C75ULL, 0x54D0AD5A753E077CULL, 0x56AC1F752150A563ULL,
+    0x5891FAC0E95612C8ULL, 0x5A827999FCEF3242ULL, 0x5C7DD7A3B17DCF75ULL,
+    0x5E8451CFAC061B5FULL, 0x6096266533384A2BULL, 0x62B39508AA836D6FULL,
+    0x64DCDEC3371793D1ULL, 0x6712460A8FC24072ULL, 0x69540EC8F895722DULL,
+    0x6BA27E656B4EB57AULL, 0x6DFDDBCBED791BABULL, 0x70666F76154A7089ULL,
+    0x72DC8373BE41A454ULL, 0x75606373EE921C97ULL, 0x77F25CCDEE6D7AE6ULL,
+    0x7A92BE8A92436616ULL, 0x7D41D96DB915019DULL,
+};
+
+// 1/sqrt(m) in Q31 at the middle of each 1/16 step of m in [1, 4)
+static const uint32_t rsqrt_table[48] = {
+    2114695713, 2053387115, 1997119227, 1945237133, 1897199172, 1852552937, 1810917218, 1771968208,
+    1735428857, 1701060526, 1668656406, 1638036256, 1609042172, 1581535151, 1555392273, 1530504391,
+    1506774204, 1484114654, 1462447584, 1441702596, 1421816090, 1402730445, 1384393311, 1366757007,
+    1349778000, 1333416450, 1317635818, 1302402522, 1287685637, 1273456629, 1259689126, 1246358707,
+    1233442724, 1220920139, 1208771378, 1196978204, 1185523604, 1174391680, 1163567563, 1153037323,
+    1142787899, 1132807028, 1123083182, 1113605518, 1104363818, 1095348453, 1086550331, 1077960865,
+};
+
+// 1/d in Q31 at the middle of each 1/128 step of d in [0.5, 1)
+static const uint32_t recip_table[64] = {
+    4261672976, 4196609266, 4133502360, 4072265288, 4012816160, 3955077798, 3898977403, 3844446251,
+    3791419406, 3739835469, 3689636335, 3640766979, 3593175254, 3546811703, 3501629388, 3457583735,
+    3414632384, 3372735055, 3331853418, 3291950981, 3252992982, 3214946280, 3177779271, 3141461794,
+    3105965050, 3071261530, 3037324939, 3004130131, 2971653048, 2939870663, 2908760920, 2878302691,
+    2848475720, 2819260584, 2790638649, 2762592030, 2735103552, 2708156719, 2681735678, 2655825188,
+    2630410593, 2605477791, 2581013211, 2557003786, 2533436930, 2510300520, 2487582868, 2465272708,
+    2443359173, 2421831779, 2400680410, 2379895298, 2359467012, 2339386442, 2319644784, 2300233531,
+    2281144456, 2262369604, 2243901281, 2225732040, 2207854674, 2190262207, 2172947881, 2155905153,
+};
+
+// atan(i / 256) in Q2.30 radians, i = 0..256, padded like sin_table
+static const int32_t atan_table[258] = {
+    0, 4194283, 8388437, 12582336, 16775851, 20968854, 25161218,
+    29352814, 33543516, 37733196, 41921726, 46108981, 50294833, 54479155,
+    58661822, 62842708, 67021687, 71198634, 75373424, 79545932, 83716036,
+    87883610, 92048532, 96210679, 100369930, 104526161, 108679253, 112829084,
+    116975536, 121118487, 125257820, 129393416, 133525159, 137652930, 141776614,
+    145896097, 150011262, 154121996, 158228185, 162329719, 166426484, 170518371,
+    174605269, 178687069, 182763663, 186834944, 190900805, 194961140, 199015846,
+    203064818, 207107953, 211145151, 215176309, 219201328, 223220110, 227232556,
+    231238569, 235238055, 239230917, 243217063, 247196400, 251168835, 255134279,
+    259092643, 263043837, 266987774, 270924369, 274853536, 278775192, 282689253,
+    286595638, 290494267, 294385059, 298267937, 302142824, 306009643, 309868320,
+    313718782, 317560955, 321394768, 325220151, 329037035, 332845353, 336645037,
+    340436023, 344218245, 347991640, 351756148, 355511705, 359258254, 362995735,
+    366724092, 370443267, 374153206, 377853855, 381545162, 385227074, 388899541,
+    392562515, 396215946, 399859787, 403493994, 407118521, 410733324, 414338361,
+    417933591, 421518973, 425094468, 428660037, 432215645, 435761254, 439296830,
+    442822340, 446337750, 449843028, 453338145, 456823070, 460297774, 463762232,
+    467216414, 470660297, 474093856, 477517067, 480929907, 484332355, 487724391,
+    491105994, 494477146, 497837829, 501188027, 504527723, 507856902, 511175551,
+    514483656, 517781204, 521068185, 524344587, 527610402, 530865619, 534110231,
+    537344232, 540567613, 543780370, 546982499, 550173994, 553354853, 556525073,
+    559684652, 562833591, 565971887, 569099543, 572216558, 575322936, 578418678,
+    581503788, 584578271, 587642129, 590695370, 593737999, 596770023, 599791448,
+    602802283, 605802536, 608792216, 611771334, 614739898, 617697921, 620645413,
+    623582386, 626508854, 629424828, 632330323, 635225352, 638109930, 640984073,
+    643847795, 646701114, 649544044, 652376604, 655198810, 658010682, 660812236,
+    663603492, 666384468, 669155185, 671915663, 674665921, 677405981, 680135863,
+    682855589, 685565182, 688264663, 690954054, 693633380, 696302662, 698961924,
+    701611191, 704250487, 706879836, 709499262, 712108791, 714708448, 717298260,
+    719878250, 722448447, 725008876, 727559563, 730100536, 732631822, 735153448,
+    737665442, 740167831, 742660643, 745143906, 747617650, 750081902, 752536690,
+    754982045, 757417995, 759844569, 762261796, 764669707, 767068330, 769457696,
+    771837835, 774208776, 776570551, 778923188, 781266719, 783601175, 785926586,
+    788242982, 790550395, 792848855, 795138394, 797419043, 799690833, 801953796,
+    804207961, 806453363, 808690030, 810917996, 813137292, 815347949, 817549999,
+    819743474, 821928406, 824104826, 826272767, 828432260, 830583337, 832726030,
+    834860371, 836986393, 839104126, 841213603, 843314857, 843314857,
+};
+
+//=========================================
+// CONSTANTS
+//=========================================
+
+#define TURN_PER_RADIAN_Q64  0x28BE60DB9391054AULL  // 2^64 / (2*pi)
+#define PI_Q30               3373259426LL           // pi in Q30
+#define HALF_PI_Q30          1686629713LL           // pi/2 in Q30
+#define LOG2E_Q42            6345039891169LL        // log2(e) in Q42
+#define LN2_Q62              0x2C5C85FDF473DE6BULL  // ln(2) in Q62
+#define LN2_Q31              1488522236LL           // ln(2) in Q31
+#define SQRT2_Q32            6074001000ULL          // sqrt(2) in Q32
+
+// exp() input range that does not saturate / underflow
+#define EXP_INPUT_MAX        ((q1516_t)(11 * Q1516_SCALE))    // e^11 > Q1516_MAX
+#define EXP_INPUT_MIN        ((q1516_t)(-12 * Q1516_SCALE))   // e^-12 < 0.5 ULP
+
+//=========================================
+// HELPERS
+//=========================================
+
+// Index of the highest set bit (x != 0)
+static inline int highest_bit(uint64_t x){
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(x);
+#else
+    int bit = 0;
+    while (x >>= 1) bit++;
+    return bit;
+#endif
+}
+
+// Round a signed value with `shift` extra fractional bits to nearest
+static inline int64_t round_shift(int64_t value, int shift){
+    return (value + ((int64_t)1 << (shift - 1))) >> shift;
+}
+
+// Full 64 x 64 -> 128-bit product, split in two words. Uses the compiler's
+// 128-bit type when there is one; the portable path gives the same bits.
+static inline void mul_64x64(uint64_t a, uint64_t b, uint64_t* high, uint64_t* low){
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 product = (unsigned __int128)a * b;
+    *high = (uint64_t)(product >> 64);
+    *low = (uint64_t)product;
+#else
+    uint64_t a_lo = a & 0xFFFFFFFFu, a_hi = a >> 32;
+    uint64_t b_lo = b & 0xFFFFFFFFu, b_hi = b >> 32;
+    uint64_t ll = a_lo * b_lo;
+    uint64_t mid1 = a_hi * b_lo;
+    uint64_t mid2 = a_lo * b_hi;
+    uint64_t carry = ((ll >> 32) + (mid1 & 0xFFFFFFFFu) + (mid2 & 0xFFFFFFFFu)) >> 32;
+    *high = a_hi * b_hi + (mid1 >> 32) + (mid2 >> 32) + carry;
+    *low = a * b;                                // Wrapping low 64 bits
+#endif
+}
+
+// (a * b) >> 64
+static inline uint64_t mul_hi64(uint64_t a, uint64_t b){
+    uint64_t high, low;
+    mul_64x64(a, b, &high, &low);
+    return high;
+}
+
+// (a * b) >> 62, for products below 2^126
+static inline uint64_t mul_q62(uint64_t a, uint64_t b){
+    uint64_t high, low;
+    mul_64x64(a, b, &high, &low);
+    return (high << 2) | (low >> 62);
+}
+
+// Angle in radians (Q15.16) -> phase in turns (Q32, wraps modulo one turn).
+// 2^64/(2*pi) is split in two 32-bit halves so that every product fits in
+// 64 bits and the reduction stays exact even for |x| near 32768 rad.
+static inline uint32_t radians_to_phase(q1516_t x){
+    int64_t hi = (int64_t)x * (int64_t)(TURN_PER_RADIAN_Q64 >> 32);
+    int64_t lo = (int64_t)x * (int64_t)(TURN_PER_RADIAN_Q64 & 0xFFFFFFFFu);
+    int64_t scaled = hi + (lo >> 32);          // floor(x * C / 2^32)
+    return (uint32_t)(uint64_t)(scaled >> 16);
+}
+
+// sin(2*pi * phase / 2^32) in Q30
+static inline int32_t sin_phase_q30(uint32_t phase){
+    uint32_t quadrant = phase >> 30;
+    uint32_t offset = phase & 0x3FFFFFFFu;       // Position inside the quadrant, Q30
+    if (quadrant & 1) offset = 0x40000000u - offset;   // Falling quarter: mirror
+    uint32_t index = offset >> 22;               // 256 segments per quarter
+    int64_t frac = offset & 0x3FFFFFu;           // 22-bit position inside the segment
+    int64_t base = sin_table[index];
+    int64_t value = base + (((sin_table[index + 1] - base) * frac) >> 22);
+    return (int32_t)((quadrant & 2) ? -value : value);
+}
+
+//=========================================
+// SQUARE ROOT
+//=========================================
+
+q1516_t q1516_sqrt(q1516_t x){
+    if (x <= 0) return 0;
+    // sqrt(x / 2^16) * 2^16 = sqrt(x * 2^16): integer square root of a 47-bit value
+    uint64_t value = (uint64_t)x << Q1516_FRACTIONAL_BITS;
+
+    // value = m * 4^half with m in [1, 4), kept in Q30
+    int even = highest_bit(value) & ~1;
+    uint64_t m = (even <= 30) ? value << (30 - even) : value >> (even - 30);
+
+    // 1/sqrt(m): table seed (~6 bits) and three Newton steps
+    // y' = y * (3 - m*y^2) / 2, each doubling the correct bits (~26 at the end)
+    uint64_t y = rsqrt_table[(m >> 26) - 16];   // Q31
+    for (int i = 0; i < 3; i++) {
+        uint64_t my2 = (m * ((y * y) >> 31)) >> 30;           // Q31, ~1.0
+        y = (y * ((3ULL << 31) - my2)) >> 32;
+    }
+
+    // sqrt(value) = m * (1/sqrt(m)) * 2^(even/2), then fix the last bit exactly
+    uint64_t root = (m * y) >> (61 - even / 2);
+    root -= (root * root > value);
+    root += ((root + 1) * (root + 1) <= value);
+    // Round up when value - root^2 exceeds (root + 0.5)^2 - root^2
+    root += (value - root * root > root);
+    return (q1516_t)root;
+}
+
+//=========================================
+// SINE / COSINE
+//=========================================
+
+q1516_t q1516_sin(q1516_t x){
+    return (q1516_t)round_shift(sin_phase_q30(radians_to_phase(x)), 14);
+}
+
+q1516_t q1516_cos(q1516_t x){
+    return (q1516_t)round_shift(sin_phase_q30(radians_to_phase(x) + 0x40000000u), 14);
+}
+
+//=========================================
+// ATAN2
+//=========================================
+
+q1516_t q1516_atan2(q1516_t y, q1516_t x){
+    if (x == 0 && y == 0) return 0;
+
+    // Fold into the first octant: angle = atan(small / large), in [0, pi/4]
+    // (64-bit so that |Q1516_MIN| = 2^31 is representable)
+    uint64_t abs_x = (uint64_t)((x < 0) ? -(int64_t)x : (int64_t)x);
+    uint64_t abs_y = (uint64_t)((y < 0) ? -(int64_t)y : (int64_t)y);
+    int steep = abs_y > abs_x;
+    uint64_t small = steep ? abs_x : abs_y;
+    uint64_t large = steep ? abs_y : abs_x;
+    uint64_t ratio = (small << 32) / large;      // Q32, [0, 1]
+
+    // Table lookup with linear interpolation (256 segments on [0, 1])
+    uint32_t index = (uint32_t)(ratio >> 24);
+    int64_t frac = (int64_t)(ratio & 0xFFFFFFu);
+    int64_t base = atan_table[index];
+    int64_t angle = base + (((atan_table[index + 1] - base) * frac) >> 24);   // Q30
+
+    // Unfold: swap axes, then mirror for x < 0 and y < 0
+    if (steep) angle = HALF_PI_Q30 - angle;
+    if (x < 0) angle = PI_Q30 - angle;
+    if (y < 0) angle = -angle;
+    return (q1516_t)round_shift(angle, 14);
+}
+
+//=========================================
+// EXPONENTIAL / LOGARITHM
+//=========================================
+
+q1516_t q1516_exp(q1516_t x){
+    if (x >= EXP_INPUT_MAX) return Q1516_MAX;
+    if (x <= EXP_INPUT_MIN) return 0;
+
+    // e^x = 2^t with t = x * log2(e) = k + j/32 + r, r in [0, 1/32)
+    int64_t t = (int64_t)x * LOG2E_Q42;          // Q58, |x| < 2^20 so no overflow
+    int k = (int)(t >> 58);
+    uint64_t frac = (uint64_t)t & (((uint64_t)1 << 58) - 1);
+    int j = (int)(frac >> 53);
+    uint64_t r = (frac & (((uint64_t)1 << 53) - 1)) << 4;    // Q62
+
+    // 2^r = e^w with w = r * ln2 < 0.022. Results near Q1516_MAX need ~32
+    // significant bits, hence Q62 and five Taylor terms (error < 2^-40)
+    const uint64_t one = 1ULL << 62;
+    uint64_t w = mul_q62(r, LN2_Q62);
+    // e^w - 1 = w*(1 + w/2*(1 + w/3*(1 + w/4*(1 + w/5)))), innermost first
+    uint64_t poly = mul_q62(w, one + w / 5);
+    poly = mul_q62(w, one + poly / 4);
+    poly = mul_q62(w, one + poly / 3);
+    poly = mul_q62(w, one + poly / 2);
+    uint64_t mantissa = exp2_table[j] + mul_q62(exp2_table[j], poly);    // Q62, [1, 2)
+
+    // Result = mantissa * 2^k, rescaled from Q62 to Q16
+    int shift = 62 - Q1516_FRACTIONAL_BITS - k;  // k in [-18, 15], so shift in [31, 64]
+    if (shift >= 64) return 0;
+    uint64_t result = (mantissa + ((uint64_t)1 << (shift - 1))) >> shift;
+    return (result > (uint64_t)Q1516_MAX) ? Q1516_MAX : (q1516_t)result;
+}
+
+q1516_t q1516_log(q1516_t x){
+    if (x <= 0) return Q1516_MIN;
+
+    // x = 2^e * m, m in [sqrt(1/2), sqrt(2)); ln(x) = (e - 16)*ln2 + ln(m)
+    int e = highest_bit((uint64_t)x);
+    uint64_t m = (uint64_t)x << (32 - e);        // Q32, [1, 2)
+    uint64_t one = 1ULL << 32;
+    if (m >= SQRT2_Q32) {
+        e++;
+        one <<= 1;                               // m/2 relative to the new exponent
+    }
+
+    // ln(m) = 2*atanh(s), s = (m-1)/(m+1), |s| < 0.172: 7 terms reach 2^-36
+    int64_t s = (((int64_t)m - (int64_t)one) * (1LL << 31)) / (int64_t)(m + one);   // Q31
+    int64_t s2 = (s * s) >> 31;
+    int64_t series = 165191050;                  // Horner on 1/13, 1/11, ..., 1/3, 1 (Q31)
+    series = 195225786 + ((s2 * series) >> 31);
+    series = 238609294 + ((s2 * series) >> 31);
+    series = 306783378 + ((s2 * series) >> 31);
+    series = 429496730 + ((s2 * series) >> 31);
+    series = 715827883 + ((s2 * series) >> 31);
+    series = 2147483648LL + ((s2 * series) >> 31);
+    int64_t ln_m = 2 * ((s * series) >> 31);     // Q31
+
+    int64_t result = (int64_t)(e - Q1516_FRACTIONAL_BITS) * LN2_Q31 + ln_m;
+    return (q1516_t)round_shift(result, 15);
+}
+
+//=========================================
+// RECIPROCAL / DIVISION
+//=========================================
+
+// All three produce exactly what q1516_divide produces: the 64-bit quotient
+// truncated toward zero, then cast to q1516_t. They are drop-in replacements.
+
+q1516_t q1516_divide_fast(q1516_t dividend, q1516_t divisor){
+    if (divisor == 0){
+        return (dividend >= 0) ? Q1516_MAX : Q1516_MIN;
+    }
+    uint64_t abs_divisor = (uint64_t)((divisor < 0) ? -(int64_t)divisor : (int64_t)divisor);
+    uint64_t numerator = (uint64_t)((dividend < 0) ? -(int64_t)dividend : (int64_t)dividend)
+                         << Q1516_FRACTIONAL_BITS;       // <= 2^47
+
+    // |divisor| = d * 2^(top+1) with d in [0.5, 1), in Q62
+    int top = highest_bit(abs_divisor);
+    uint64_t d = abs_divisor << (61 - top);
+
+    // 1/d: table seed (~7 bits), then Newton steps r' = r * (2 - d*r), each
+    // doubling the correct bits. The first two fit in 64-bit products (Q31,
+    // ~29 bits); only the last one needs the 128-bit product (Q62, ~56 bits)
+    uint64_t d31 = d >> 31;
+    uint64_t r31 = recip_table[(d >> 55) - 64];
+    r31 = (r31 * ((2ULL << 31) - ((d31 * r31) >> 31))) >> 31;
+    r31 = (r31 * ((2ULL << 31) - ((d31 * r31) >> 31))) >> 31;
+    uint64_t r = r31 << 31;                              // Q62
+    r = mul_q62(r, (2ULL << 62) - mul_q62(d, r));
+
+    // numerator / |divisor| = numerator * (1/d) / 2^(top+1), off by at most
+    // one; the remainder says which way to fix it
+    uint64_t quotient = mul_q62(numerator, r) >> (top + 1);
+    int64_t remainder = (int64_t)numerator - (int64_t)(quotient * abs_divisor);
+    int64_t too_big = -(int64_t)(remainder < 0);
+    quotient += (uint64_t)too_big;
+    remainder += (int64_t)abs_divisor & too_big;
+    quotient += (remainder >= (int64_t)abs_divisor);
+
+    int64_t result = ((dividend < 0) != (divisor < 0)) ? -(int64_t)quotient : (int64_t)quotient;
+    return (q1516_t)result;
+}
+
+q1516_t q1516_reciprocal(q1516_t x){
+    return q1516_divide_fast(Q1516_ONE, x);
+}
+
+q1516_divider_t q1516_divider_init(q1516_t divisor){
+    q1516_divider_t divider = {0, 0, divisor};
+    if (divisor == 0) return divider;
+
+    // Granlund-Montgomery: with 2^(l-1) < |divisor| <= 2^l and
+    // magic = floor(2^(48+l) / |divisor|) + 1, floor(n * magic / 2^(48+l))
+    // equals n / |divisor| for every n < 2^48 (all |dividend| * 2^16 fit)
+    uint64_t abs_divisor = (uint64_t)((divisor < 0) ? -(int64_t)divisor : (int64_t)divisor);
+    int l = highest_bit(abs_divisor);
+    if ((abs_divisor & (abs_divisor - 1)) != 0) l++;     // ceil(log2)
+
+    // 2^(48+l) does not fit in 64 bits: divide 2^(32+l) first, then the rest
+    uint64_t high = ((uint64_t)1 << (32 + l)) / abs_divisor;
+    uint64_t rest = ((uint64_t)1 << (32 + l)) % abs_divisor;
+    divider.magic = (high << 16) + (rest << 16) / abs_divisor + 1;   // < 2^49
+    divider.shift = l;
+    return divider;
+}
+
+q1516_t q1516_divide_by(const q1516_divider_t* divider, q1516_t dividend){
+    if (divider->divisor == 0){
+        return (dividend >= 0) ? Q1516_MAX : Q1516_MIN;
+    }
+    uint64_t numerator = (uint64_t)((dividend < 0) ? -(int64_t)dividend : (int64_t)dividend)
+                         << Q1516_FRACTIONAL_BITS;
+    // n * magic / 2^(48+l) = ((n << 16) * magic / 2^64) >> l
+    uint64_t quotient = mul_hi64(numerator << 16, divider->magic) >> divider->shift;
+    int64_t result = ((dividend < 0) != (divider->divisor < 0)) ? -(int64_t)quotient
+                                                                 : (int64_t)quotient;
+    return (q1516_t)result;
+}
+
+//=========================================
+// BATCH FUNCTIONS
+//=========================================
+
+void q1516_sqrt_n(q1516_t* out, const q1516_t* in, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_sqrt(in[i]);
+}
+
+void q1516_sin_n(q1516_t* out, const q1516_t* in, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_sin(in[i]);
+}
+
+void q1516_cos_n(q1516_t* out, const q1516_t* in, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_cos(in[i]);
+}
+
+void q1516_exp_n(q1516_t* out, const q1516_t* in, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_exp(in[i]);
+}
+
+void q1516_log_n(q1516_t* out, const q1516_t* in, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_log(in[i]);
+}
+
+void q1516_divide_by_n(q1516_t* out, const q1516_t* in, const q1516_divider_t* divider, size_t n){
+    // Copy the magic numbers out: `out` may alias `in`, and the compiler
+    // cannot prove it does not alias *divider either
+    q1516_divider_t local = *divider;
+    for (size_t i = 0; i < n; i++) out[i] = q1516_divide_by(&local, in[i]);
+}
+
+void q1516_atan2_n(q1516_t* out, const q1516_t* y, const q1516_t* x, size_t n){
+    for (size_t i = 0; i < n; i++) out[i] = q1516_atan2(y[i], x[i]);
+}
@@ -0,0 +1,272 @@
+#define _POSIX_C_SOURCE 200809L  // sysconf() under -std=c99
+
+// Rounding and saturation use the header-only definitions so they inline
+// into the output loops.
+#define Q1516_INLINE
+#include "q1516_matrix.h"
+#include "q1516_batch.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/*
+ * @file q1516_matrix.c
+ * @brief Blocked matrix multiply, matrix-vector product, small fixed sizes
+ *
+ * q1516_mat_mul works on tiles of C: a TILE_M x TILE_N block of 64-bit
+ * accumulators is filled from TILE_K-deep slices of A and B, so the slice
+ * of B being reused stays in cache while every row of the tile walks it.
+ * Sums are exact and wrap modulo 2^64, so the order in which the tiles,
+ * kernels and threads add them up does not change a single bit.
+ */
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define Q1516_MATRIX_X86 1
+#include <immintrin.h>
+#define Q1516_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+#define TILE_M 16               // Rows of C per tile
+#define TILE_N 64               // Columns of C per tile (8 KB of accumulators)
+#define TILE_K 256              // Depth per slice: 64 KB of B, stays in L2
+
+// Below this many multiply-adds per thread, starting a thread costs more
+// than it saves
+#define MIN_WORK_PER_THREAD ((size_t)1 << 20)
+
+//=========================================
+// TILE KERNELS
+//=========================================
+
+// acc[i][j] += sum over k of a[i][k] * b[k][j], for a rows x cols tile.
+// a and b point at the tile's first row/column; lda/ldb are row strides.
+typedef void (*tile_kernel_t)(uint64_t (*acc)[TILE_N], const q1516_t* a, size_t lda, const q1516_t* b,
+                              size_t ldb, size_t rows, size_t depth, size_t cols);
+
+// Columns j_start .. cols-1 of the tile
+static void columns_scalar(uint64_t (*acc)[TILE_N], const q1516_t* a, size_t lda, const q1516_t* b, size_t ldb,
+                           size_t rows, size_t depth, size_t j_start, size_t cols){
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t k = 0; k < depth; k++) {
+            int64_t x = a[i * lda + k];
+            const q1516_t* b_row = b + k * ldb;
+            for (size_t j = j_start; j < cols; j++) acc[i][j] += (uint64_t)(x * b_row[j]);
+        }
+    }
+}
+
+static void tile_scalar(uint64_t (*acc)[TILE_N], const q1516_t* a, size_t lda, const q1516_t* b, size_t ldb,
+                        size_t rows, size_t depth, size_t cols){
+    columns_scalar(acc, a, lda, b, ldb, rows, depth, 0, cols);
+}
+
+#ifdef Q1516_MATRIX_X86
+
+// Add 8 columns of products, kept as even (0, 2, 4, 6) and odd (1, 3, 5, 7)
+// lanes by _mm256_mul_epi32, to 8 accumulators in column order
+Q1516_TARGET_AVX2 static inline void store_columns_avx2(uint64_t* acc, __m256i even, __m256i odd){
+    __m256i low = _mm256_unpacklo_epi64(even, odd);     // Columns 0, 1, 4, 5
+    __m256i high = _mm256_unpackhi_epi64(even, odd);    // Columns 2, 3, 6, 7
+    __m256i first = _mm256_permute2x128_si256(low, high, 0x20);
+    __m256i second = _mm256_permute2x128_si256(low, high, 0x31);
+    _mm256_storeu_si256((__m256i*)acc, _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)acc), first));
+    _mm256_storeu_si256((__m256i*)(acc + 4), _mm256_add_epi64(_mm256_loadu_si256((const __m256i*)(acc + 4)), second));
+}
+
+// Each row of the tile runs 16 columns at a time through the whole slice
+// with four accumulator registers, then 8, then the scalar kernel
+Q1516_TARGET_AVX2 static void tile_avx2(uint64_t (*acc)[TILE_N], const q1516_t* a, size_t lda, const q1516_t* b,
+                                        size_t ldb, size_t rows, size_t depth, size_t cols){
+    size_t j = 0;
+    for (; j + 16 <= cols; j += 16) {
+        for (size_t i = 0; i < rows; i++) {
+            __m256i even0 = _mm256_setzero_si256(), odd0 = _mm256_setzero_si256();
+            __m256i even1 = _mm256_setzero_si256(), odd1 = _mm256_setzero_si256();
+            const q1516_t* a_row = a + i * lda;
+            for (size_t k = 0; k < depth; k++) {
+                __m256i x = _mm256_set1_epi32(a_row[k]);
+                __m256i b0 = _mm256_loadu_si256((const __m256i*)(b + k * ldb + j));
+                __m256i b1 = _mm256_loadu_si256((const __m256i*)(b + k * ldb + j + 8));
+                even0 = _mm256_add_epi64(even0, _mm256_mul_epi32(x, b0));
+                odd0 = _mm256_add_epi64(odd0, _mm256_mul_epi32(x, _mm256_srli_epi64(b0, 32)));
+                even1 = _mm256_add_epi64(even1, _mm256_mul_epi32(x, b1));
+                odd1 = _mm256_add_epi64(odd1, _mm256_mul_epi32(x, _mm256_srli_epi64(b1, 32)));
+            }
+            store_columns_avx2(&acc[i][j], even0, odd0);
+            store_columns_avx2(&acc[i][j + 8], even1, odd1);
+        }
+    }
+    for (; j + 8 <= cols; j += 8) {
+        for (size_t i = 0; i < rows; i++) {
+            __m256i even = _mm256_setzero_si256(), odd = _mm256_setzero_si256();
+            const q1516_t* a_row = a + i * lda;
+            for (size_t k = 0; k < depth; k++) {
+                __m256i x = _mm256_set1_epi32(a_row[k]);
+                __m256i b0 = _mm256_loadu_si256((const __m256i*)(b + k * ldb + j));
+                even = _mm256_add_epi64(even, _mm256_mul_epi32(x, b0));
+                odd = _mm256_add_epi64(odd, _mm256_mul_epi32(x, _mm256_srli_epi64(b0, 32)));
+            }
+            store_columns_avx2(&acc[i][j], even, odd);
+        }
+    }
+    columns_scalar(acc, a, lda, b, ldb, rows, depth, j, cols);
+}
+
+#endif /* Q1516_MATRIX_X86 */
+
+static tile_kernel_t select_kernel(void){
+#ifdef Q1516_MATRIX_X86
+    if (q1516_batch_isa() == Q1516_ISA_AVX2) return tile_avx2;
+#endif
+    return tile_scalar;
+}
+
+//=========================================
+// GENERAL SIZES
+//=========================================
+
+// Rows [0, m) of C = A * B; a and c point at the first of those rows
+static void mat_mul_rows(q1516_t* c, const q1516_t* a, const q1516_t* b, size_t m, size_t k, size_t n,
+                         tile_kernel_t kernel){
+    uint64_t acc[TILE_M][TILE_N];
+
+    for (size_t i0 = 0; i0 < m; i0 += TILE_M) {
+        size_t rows = (m - i0 < TILE_M) ? m - i0 : TILE_M;
+        for (size_t j0 = 0; j0 < n; j0 += TILE_N) {
+            size_t cols = (n - j0 < TILE_N) ? n - j0 : TILE_N;
+            memset(acc, 0, sizeof acc);
+            for (size_t k0 = 0; k0 < k; k0 += TILE_K) {
+                size_t depth = (k - k0 < TILE_K) ? k - k0 : TILE_K;
+                kernel(acc, a + i0 * k + k0, k, b + k0 * n + j0, n, rows, depth, cols);
+            }
+            for (size_t i = 0; i < rows; i++) {
+                q1516_t* c_row = c + (i0 + i) * n + j0;
+                for (size_t j = 0; j < cols; j++) {
+                    c_row[j] = q1516_acc_round((q1516_acc_t)acc[i][j], Q1516_ROUND_NEAREST);
+                }
+            }
+        }
+    }
+}
+
+void q1516_mat_mul(q1516_t* c, const q1516_t* a, const q1516_t* b, size_t m, size_t k, size_t n){
+    mat_mul_rows(c, a, b, m, k, n, select_kernel());
+}
+
+typedef struct {
+    q1516_t* c;
+    const q1516_t* a;
+    const q1516_t* b;
+    size_t m, k, n;
+    tile_kernel_t kernel;
+} mat_mul_band_t;
+
+static void* mat_mul_worker(void* arg){
+    const mat_mul_band_t* band = (const mat_mul_band_t*)arg;
+    mat_mul_rows(band->c, band->a, band->b, band->m, band->k, band->n, band->kernel);
+    return NULL;
+}
+
+static int online_cpus(void){
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+#endif
+}
+
+#define MAX_THREADS 256
+
+int q1516_mat_mul_parallel(q1516_t* c, const q1516_t* a, const q1516_t* b, size_t m, size_t k, size_t n,
+                           int threads){
+    if (threads <= 0) {
+        size_t work = m * k * n / MIN_WORK_PER_THREAD;
+        threads = online_cpus();
+        if ((size_t)threads > work) threads = work > 0 ? (int)work : 1;
+    }
+    if (threads > MAX_THREADS) threads = MAX_THREADS;
+    if ((size_t)threads > m) threads = m > 0 ? (int)m : 1;
+
+    tile_kernel_t kernel = select_kernel();
+    if (threads == 1) {
+        mat_mul_rows(c, a, b, m, k, n, kernel);
+        return 1;
+    }
+
+    // One contiguous band of rows per thread; the caller runs the last one.
+    // A band whose thread cannot be started runs on the caller as well.
+    mat_mul_band_t bands[MAX_THREADS];
+    pthread_t ids[MAX_THREADS];
+    int started[MAX_THREADS];
+    int used = 1;
+    for (int t = 0; t < threads; t++) {
+        size_t first = m / (size_t)threads * (size_t)t;
+        size_t last = (t == threads - 1) ? m : m / (size_t)threads * (size_t)(t + 1);
+        mat_mul_band_t band = {c + first * n, a + first * k, b, last - first, k, n, kernel};
+        bands[t] = band;
+        started[t] = (t < threads - 1) && pthread_create(&ids[t], NULL, mat_mul_worker, &bands[t]) == 0;
+        used += started[t];
+    }
+    for (int t = 0; t < threads; t++) {
+        if (!started[t]) mat_mul_worker(&bands[t]);
+    }
+    for (int t = 0; t < threads; t++) {
+        if (started[t]) pthread_join(ids[t], NULL);
+    }
+    return used;
+}
+
+void q1516_mat_vec(q1516_t* y, const q1516_t* a, const q1516_t* x, size_t m, size_t n){
+    for (size_t i = 0; i < m; i++) y[i] = q1516_dot(a + i * n, x, n);
+}
+
+//=========================================
+// SMALL SQUARE MATRICES
+//=========================================
+
+// `size` is a constant in every caller below, so each instance compiles to
+// straight-line code. Results go to a local first: the output may alias.
+static inline void square_mul(q1516_t* c, const q1516_t* a, const q1516_t* b, const size_t size){
+    q1516_t result[64];
+    for (size_t i = 0; i < size; i++) {
+        for (size_t j = 0; j < size; j++) {
+            uint64_t acc = 0;
+#pragma GCC unroll 8
+            for (size_t k = 0; k < size; k++) acc += (uint64_t)((int64_t)a[i * size + k] * b[k * size + j]);
+            result[i * size + j] = q1516_acc_round((q1516_acc_t)acc, Q1516_ROUND_NEAREST);
+        }
+    }
+    memcpy(c, result, size * size * sizeof(q1516_t));
+}
+
+static inline void square_vec(q1516_t* y, const q1516_t* a, const q1516_t* x, const size_t size){
+    q1516_t result[8];
+    for (size_t i = 0; i < size; i++) {
+        uint64_t acc = 0;
+#pragma GCC unroll 8
+        for (size_t k = 0; k < size; k++) acc += (uint64_t)((int64_t)a[i * size + k] * x[k]);
+        result[i] = q1516_acc_round((q1516_acc_t)acc, Q1516_ROUND_NEAREST);
+    }
+    memcpy(y, result, size * sizeof(q1516_t));
+}
+
+#define DEFINE_SQUARE(N) \
+    void q1516_mat##N##_mul(q1516_t* c, const q1516_t* a, const q1516_t* b){ square_mul(c, a, b, N); } \
+    void q1516_mat##N##_vec(q1516_t* y, const q1516_t* a, const q1516_t* x){ square_vec(y, a, x, N); }
+
+DEFINE_SQUARE(2)
+DEFINE_SQUARE(3)
+DEFINE_SQUARE(4)
+DEFINE_SQUARE(5)
+DEFINE_SQUARE(6)
+DEFINE_SQUARE(7)
+DEFINE_SQUARE(8)
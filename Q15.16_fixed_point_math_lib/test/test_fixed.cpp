@@ -0,0 +1,188 @@
+#define Q1516_INLINE   // constexpr q1516_* functions, usable in static_assert
+#include "fixed.hpp"
+#include <cstdio>
+#include <cmath>
+#include <limits>
+
+/**
+ * @file test_fixed.cpp
+ * @brief Tests for the fixed<IntBits, FracBits, Storage, Overflow> C++ template
+ *
+ * The static_asserts run at compile time: if this file builds, every
+ * operator is usable in constant expressions and q15_16 matches the
+ * q1516_* functions bit for bit on those values.
+ */
+
+using namespace fixed_point;
+
+// =============================================================================
+// TEST UTILITIES
+// =============================================================================
+
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST_ASSERT(condition, test_name) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("✓ PASS: %s\n", test_name); \
+    } else { \
+        tests_failed++; \
+        printf("✗ FAIL: %s\n", test_name); \
+    } \
+} while(0)
+
+static void print_section(const char* section_name) {
+    printf("\n=== %s ===\n", section_name);
+}
+
+// Same xorshift32 generator as test_q1516.c
+static uint32_t test_rand_state = 0x1516u;
+static int32_t random_raw() {
+    test_rand_state ^= test_rand_state << 13;
+    test_rand_state ^= test_rand_state >> 17;
+    test_rand_state ^= test_rand_state << 5;
+    return static_cast<int32_t>(test_rand_state);
+}
+
+// =============================================================================
+// COMPILE-TIME CHECKS
+// =============================================================================
+
+static_assert(sizeof(q15_16) == sizeof(q1516_t), "q15_16 is a plain int32_t");
+static_assert(sizeof(q1_15) == 2 && sizeof(q7_24) == 4 && sizeof(q31_32) == 8, "storage sizes");
+static_assert(std::is_same<fixed<15, 16>::storage_type, int32_t>::value, "default storage picks int32_t");
+static_assert(std::is_same<fixed<3, 4>::storage_type, int8_t>::value, "default storage picks int8_t");
+
+// Constant evaluation of every operator, checked against the q1516 functions
+static_assert(q15_16(3).raw() == q1516_from_int(3), "int construction");
+static_assert(q15_16(2.5).raw() == 163840, "double construction");
+static_assert((q15_16(2.5) + q15_16(1)).raw() == q1516_add(163840, Q1516_ONE), "constexpr +");
+static_assert((q15_16(2.5) - q15_16(4)).raw() == q1516_subtract(163840, 4 * Q1516_ONE), "constexpr -");
+static_assert((q15_16(-2.5) * q15_16(0.75)).raw() == q1516_multiply(-163840, 49152), "constexpr *");
+static_assert((q15_16(7) / q15_16(-3)).raw() == q1516_divide(7 * Q1516_ONE, -3 * Q1516_ONE), "constexpr /");
+static_assert((q15_16(1) / q15_16(0)) == q15_16::highest(), "x / 0 = highest");
+static_assert((q15_16_sat(30000) + q15_16_sat(30000)) == q15_16_sat::highest(), "saturating +");
+static_assert((q15_16(30000) + q15_16(30000)).raw() == q1516_add(30000 * Q1516_ONE, 30000 * Q1516_ONE),
+              "wrapping + matches q1516_add");
+static_assert(q7_24(q15_16(1.5)).raw() == (3 << 23), "Q15.16 -> Q7.24 at compile time");
+static_assert(q31_32(q15_16(-1.5)).raw() == -(int64_t(3) << 31), "Q15.16 -> Q31.32 (implicit widening)");
+static_assert(to_q1516(q1_15(0.5)) == Q1516_HALF, "Q1.15 -> q1516_t");
+static_assert(q1516_from_double(2.5 / 65536) == 2 && q1516_from_double(1e9) == Q1516_MAX,
+              "q1516_from_double is constexpr (ties to even, saturation)");
+static_assert(q1516_divide(-7 * Q1516_ONE, 2 * Q1516_ONE) == -7 * Q1516_HALF &&
+              q1516_divide(Q1516_MIN, -2 * Q1516_ONE) == 16384 * Q1516_ONE,
+              "q1516_divide of negative values is a constant expression");
+static_assert(!q1516_approximately_equal(Q1516_MAX, Q1516_MIN, Q1516_ONE), "|MAX - MIN| computed in 64 bits");
+static_assert(q15_16(2.5 / 65536).raw() == 2 && q15_16(3.5 / 65536).raw() == 4 &&
+              q15_16(-2.5 / 65536).raw() == -2 && q15_16(-3.5 / 65536).raw() == -4,
+              "double construction rounds ties to even, like q1516_from_double");
+static_assert(q15_16(std::numeric_limits<double>::quiet_NaN()).raw() == 0 &&
+              q31_32(std::numeric_limits<double>::quiet_NaN()).raw() == 0, "NaN converts to 0");
+static_assert(q15_16(1e9) == q15_16::highest() && q15_16(-1e9) == q15_16::lowest() &&
+              q31_32(1e30) == q31_32::highest() && q31_32(-1e30) == q31_32::lowest(), "double construction saturates");
+
+// =============================================================================
+// Q15.16 EQUIVALENCE
+// =============================================================================
+
+static void test_q1516_equivalence() {
+    print_section("Q15.16 EQUIVALENCE");
+
+    bool add_ok = true, sub_ok = true, mul_ok = true, div_ok = true, sat_ok = true;
+    for (int i = 0; i < 200000; i++) {
+        int32_t a = random_raw() >> (i & 15);
+        int32_t b = random_raw() >> ((i >> 4) & 15);
+        q15_16 x = from_q1516(a), y = from_q1516(b);
+        add_ok = add_ok && (x + y).raw() == q1516_add(a, b);
+        sub_ok = sub_ok && (x - y).raw() == q1516_subtract(a, b);
+        mul_ok = mul_ok && (x * y).raw() == q1516_multiply(a, b);
+        div_ok = div_ok && (x / y).raw() == q1516_divide(a, b);
+        q15_16_sat sx = q15_16_sat::from_raw(a), sy = q15_16_sat::from_raw(b);
+        sat_ok = sat_ok && (sx + sy).raw() == q1516_add_sat(a, b) && (sx - sy).raw() == q1516_sub_sat(a, b) &&
+                 (sx * sy).raw() == q1516_mul_sat(a, b);
+    }
+    TEST_ASSERT(add_ok, "q15_16 + matches q1516_add (200k random)");
+    TEST_ASSERT(sub_ok, "q15_16 - matches q1516_subtract (200k random)");
+    TEST_ASSERT(mul_ok, "q15_16 * matches q1516_multiply (200k random)");
+    TEST_ASSERT(div_ok, "q15_16 / matches q1516_divide (200k random)");
+    TEST_ASSERT(sat_ok, "q15_16_sat matches q1516_*_sat (200k random)");
+
+    bool double_ok = true;
+    for (int i = 0; i < 200000; i++) {
+        // Halfway between two raw values, exactly on one, and somewhere in between
+        double raw = static_cast<double>(random_raw() >> (i & 15));
+        double offset = (i % 3 == 0) ? 0.5 : (i % 3 == 1) ? 0.0 : (i & 0xff) / 256.0 - 0.5;
+        double value = (raw + offset) / 65536.0;
+        double_ok = double_ok && q15_16(value).raw() == q1516_from_double(value);
+    }
+    TEST_ASSERT(double_ok, "q15_16(double) matches q1516_from_double, halfway values included (200k random)");
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    TEST_ASSERT(q15_16(nan).raw() == 0 && q15_16(nan).raw() == q1516_from_double(nan), "q15_16(NaN) is 0");
+    TEST_ASSERT(q15_16(32768.0) == q15_16::highest() && q15_16(-32769.0) == q15_16::lowest(),
+                "q15_16(double) saturates at both ends");
+
+    q1516_t legacy = q1516_from_float(3.25f);
+    TEST_ASSERT(to_q1516(from_q1516(legacy)) == legacy, "q1516_t round trip");
+    TEST_ASSERT(from_q1516(legacy).to_int() == q1516_to_int(legacy), "to_int matches q1516_to_int");
+    TEST_ASSERT(from_q1516(-legacy).to_int() == q1516_to_int(-legacy), "to_int floors like q1516_to_int");
+}
+
+// =============================================================================
+// OTHER FORMATS
+// =============================================================================
+
+static void test_formats() {
+    print_section("OTHER FORMATS");
+
+    // Q1.15: [-1, 1)
+    q1_15 half(0.5), quarter(0.25);
+    TEST_ASSERT((half * half) == quarter, "Q1.15: 0.5 * 0.5 = 0.25");
+    TEST_ASSERT(q1_15::highest().raw() == 32767 && q1_15::lowest().raw() == -32768, "Q1.15 range");
+    TEST_ASSERT(q1_15(1.0) == q1_15::highest(), "Q1.15: 1.0 saturates to highest()");
+    using q1_15_sat = with_overflow<q1_15, overflow::saturate>;
+    TEST_ASSERT((q1_15_sat(-1.0) * q1_15_sat(-1.0)) == q1_15_sat::highest(), "Q1.15 sat: -1 * -1 = highest()");
+    TEST_ASSERT((q1_15(-1.0) * q1_15(-1.0)) == q1_15::lowest(), "Q1.15 wrap: -1 * -1 wraps to -1");
+
+    // Q7.24
+    q7_24 pi(3.14159265358979);
+    TEST_ASSERT(std::fabs(pi.to_double() - 3.14159265358979) < 1.0 / (1 << 24), "Q7.24 holds pi to 2^-24");
+    TEST_ASSERT(std::fabs((pi * pi).to_double() - 9.8696044) < 1e-6, "Q7.24: pi * pi");
+    TEST_ASSERT(q7_24(100) + q7_24(100) == q7_24(-56), "Q7.24 wraps at 128");
+
+    // Q31.32 (64-bit storage, 128-bit products)
+    q31_32 big(1000000), tiny(1.0 / 4294967296.0);
+    TEST_ASSERT(tiny.raw() == 1, "Q31.32: epsilon is 2^-32");
+    TEST_ASSERT((q31_32(40000) * q31_32(50000)).to_int() == 2000000000, "Q31.32: product computed in 128 bits");
+    TEST_ASSERT((big / q31_32(3)).to_int() == 333333, "Q31.32: 1e6 / 3");
+    TEST_ASSERT(std::fabs((q31_32(2.0) / q31_32(3.0)).to_double() - 2.0 / 3.0) < 1e-9, "Q31.32: 2/3 to 1e-9");
+
+    // Format conversions
+    q15_16 x(-1.75);
+    TEST_ASSERT(q15_16(q31_32(x)) == x, "Q15.16 -> Q31.32 -> Q15.16 is lossless");
+    TEST_ASSERT(fixed_cast<q1_15>(q15_16(0.5)) == half, "fixed_cast<Q1.15>(0.5)");
+    TEST_ASSERT(q15_16(q7_24::from_raw(-1)).raw() == -1, "dropping fraction bits floors (-2^-24 -> -2^-16)");
+    using q15_16_sat_local = with_overflow<q15_16, overflow::saturate>;
+    TEST_ASSERT(q15_16_sat_local(q31_32(100000)) == q15_16_sat_local::highest(),
+                "narrowing conversion saturates under overflow::saturate");
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main() {
+    printf("fixed<IntBits, FracBits, Storage, Overflow> - C++ Test Suite\n");
+    printf("=============================================================\n");
+
+    test_q1516_equivalence();
+    test_formats();
+
+    print_section("TEST RESULTS");
+    printf("Tests run: %d\n", tests_run);
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    return tests_failed == 0 ? 0 : 1;
+}
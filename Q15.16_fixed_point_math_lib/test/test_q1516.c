@@ -1,4 +1,12 @@
 #include "q1516.h"
+#include "q1516_batch.h"
+#include "q1516_math.h"
+#include "q1516_dsp.h"
+#include "q1516_fft.h"
+#include "q1516_matrix.h"
+#include "q1516_chars.h"
+#include <stdlib.h>
+#include <string.h>
 #include <stdio.h>
 #include <math.h>
 #include <assert.h>
@@ -43,6 +51,15 @@ void print_section(const char* section_name) {
     printf("\n=== %s ===\n", section_name);
 }
 
+// Deterministic pseudo-random raw values (xorshift32), full 32-bit range
+static uint32_t test_rand_state = 0x1516u;
+static q1516_t random_raw(void) {
+    test_rand_state ^= test_rand_state << 13;
+    test_rand_state ^= test_rand_state >> 17;
+    test_rand_state ^= test_rand_state << 5;
+    return (q1516_t)test_rand_state;
+}
+
 // =============================================================================
 // CONVERSION TESTS
 // =============================================================================
@@ -68,6 +85,24 @@ void test_conversions() {
     TEST_ASSERT(fabs(q1516_to_float(fixed_neg) - (-2.5f)) < 0.0001f, "Float conversion: -2.5");
     TEST_ASSERT(fabs(q1516_to_float(fixed_small) - 0.125f) < 0.0001f, "Float conversion: 0.125");
     
+    // Correct rounding (nearest, ties to even) and saturation
+    const double ulp = 1.0 / 65536.0;
+    TEST_ASSERT(q1516_from_double(0.7 * ulp) == 1, "from_double rounds up (0.7 ULP -> 1)");
+    TEST_ASSERT(q1516_from_double(-0.7 * ulp) == -1, "from_double rounds negative values symmetrically");
+    TEST_ASSERT(q1516_from_double(0.5 * ulp) == 0 && q1516_from_double(1.5 * ulp) == 2,
+                "from_double ties to even (0.5 -> 0, 1.5 -> 2)");
+    TEST_ASSERT(q1516_from_double(-2.5 * ulp) == -2, "from_double ties to even (-2.5 -> -2)");
+    TEST_ASSERT(q1516_from_float(0.1f) == 6554, "from_float(0.1) rounds to nearest (6553.6 -> 6554)");
+    TEST_ASSERT(q1516_from_float(40000.0f) == Q1516_MAX && q1516_from_float(-40000.0f) == Q1516_MIN,
+                "from_float saturates out-of-range values");
+    TEST_ASSERT(q1516_from_double(32767.99999) == Q1516_MAX, "from_double: just below 2^15 rounds up to MAX");
+    TEST_ASSERT(q1516_from_double(-32768.0) == Q1516_MIN, "from_double(-32768) = MIN exactly");
+    TEST_ASSERT(q1516_from_float(INFINITY) == Q1516_MAX && q1516_from_float(-INFINITY) == Q1516_MIN,
+                "from_float saturates infinities");
+    TEST_ASSERT(q1516_from_float(NAN) == 0 && q1516_from_double(NAN) == 0, "NaN converts to 0");
+    TEST_ASSERT(q1516_to_double(Q1516_MIN + 1) == -32768.0 + ulp, "to_double is exact");
+    TEST_ASSERT(q1516_from_double(q1516_to_double(-123456789)) == -123456789, "double round trip");
+    
     // Edge cases
     q1516_t max_int = q1516_from_int(32767);  // Maximum integer that fits
     q1516_t min_int = q1516_from_int(-32768); // Minimum integer that fits
@@ -179,6 +214,9 @@ void test_utilities() {
     TEST_ASSERT(q1516_approximately_equal(val1, val2, small_tolerance), "Approximate equality: close values");
     TEST_ASSERT(!q1516_approximately_equal(val1, val3, small_tolerance), "Approximate equality: distant values (small tolerance)");
     TEST_ASSERT(q1516_approximately_equal(val1, val3, large_tolerance), "Approximate equality: distant values (large tolerance)");
+    // MAX - MIN overflows 32 bits; a wrapped difference would come out as -1
+    TEST_ASSERT(!q1516_approximately_equal(Q1516_MAX, Q1516_MIN, Q1516_ONE), "Approximate equality: MAX vs MIN");
+    TEST_ASSERT(!q1516_approximately_equal(Q1516_MIN, Q1516_ONE, Q1516_MAX), "Approximate equality: MIN vs 1.0");
 }
 
 // =============================================================================
@@ -213,6 +251,984 @@ void test_edge_cases() {
     TEST_ASSERT(q1516_to_float(eighth) == 0.125f, "Exact fractional representation");
 }
 
+// =============================================================================
+// SATURATING ARITHMETIC TESTS
+// =============================================================================
+
+// Straightforward (branchy) reference for the branch-free implementations
+static q1516_t clamp_reference(int64_t raw) {
+    if (raw > Q1516_MAX) return Q1516_MAX;
+    if (raw < Q1516_MIN) return Q1516_MIN;
+    return (q1516_t)raw;
+}
+
+void test_saturating() {
+    print_section("SATURATING ARITHMETIC TESTS");
+
+    q1516_t big = q1516_from_int(30000);
+    q1516_t neg_big = q1516_from_int(-30000);
+    q1516_t two = q1516_from_int(2);
+
+    // In-range results match the wrapping functions
+    q1516_t a = q1516_from_float(5.75f);
+    q1516_t b = q1516_from_float(-2.25f);
+    TEST_ASSERT(q1516_add_sat(a, b) == q1516_add(a, b), "add_sat: in range = add");
+    TEST_ASSERT(q1516_sub_sat(a, b) == q1516_subtract(a, b), "sub_sat: in range = subtract");
+    TEST_ASSERT(q1516_mul_sat(a, b) == q1516_multiply(a, b), "mul_sat: in range = multiply");
+    TEST_ASSERT(q1516_div_sat(a, b) == q1516_divide(a, b), "div_sat: in range = divide");
+
+    // Overflow clamps instead of wrapping
+    TEST_ASSERT(q1516_add_sat(big, big) == Q1516_MAX, "add_sat: 30000 + 30000 -> MAX");
+    TEST_ASSERT(q1516_add_sat(neg_big, neg_big) == Q1516_MIN, "add_sat: -30000 + -30000 -> MIN");
+    TEST_ASSERT(q1516_add_sat(Q1516_MAX, 1) == Q1516_MAX, "add_sat: MAX + 1 raw -> MAX");
+    TEST_ASSERT(q1516_sub_sat(Q1516_MIN, 1) == Q1516_MIN, "sub_sat: MIN - 1 raw -> MIN");
+    TEST_ASSERT(q1516_sub_sat(big, neg_big) == Q1516_MAX, "sub_sat: 30000 - (-30000) -> MAX");
+    TEST_ASSERT(q1516_sub_sat(0, Q1516_MIN) == Q1516_MAX, "sub_sat: 0 - MIN -> MAX");
+    TEST_ASSERT(q1516_mul_sat(big, two) == Q1516_MAX, "mul_sat: 30000 * 2 -> MAX");
+    TEST_ASSERT(q1516_mul_sat(neg_big, two) == Q1516_MIN, "mul_sat: -30000 * 2 -> MIN");
+    TEST_ASSERT(q1516_mul_sat(Q1516_MIN, Q1516_MIN) == Q1516_MAX, "mul_sat: MIN * MIN -> MAX");
+    TEST_ASSERT(q1516_div_sat(big, q1516_from_float(0.5f)) == Q1516_MAX, "div_sat: 30000 / 0.5 -> MAX");
+    TEST_ASSERT(q1516_div_sat(Q1516_MIN, -1) == Q1516_MAX, "div_sat: MIN / -1 raw -> MAX");
+    TEST_ASSERT(q1516_div_sat(a, 0) == Q1516_MAX, "div_sat: positive / 0 -> MAX");
+    TEST_ASSERT(q1516_div_sat(b, 0) == Q1516_MIN, "div_sat: negative / 0 -> MIN");
+    TEST_ASSERT(q1516_div_sat(0, 0) == Q1516_MAX, "div_sat: 0 / 0 -> MAX (like divide)");
+    TEST_ASSERT(q1516_saturate_raw((int64_t)Q1516_MAX + 1) == Q1516_MAX, "saturate_raw: MAX + 1");
+    TEST_ASSERT(q1516_saturate_raw((int64_t)Q1516_MIN - 1) == Q1516_MIN, "saturate_raw: MIN - 1");
+
+    // Random sweep against the branchy reference
+    bool add_ok = true, sub_ok = true, mul_ok = true, div_ok = true;
+    for (int i = 0; i < 100000; i++) {
+        q1516_t x = random_raw();
+        q1516_t y = random_raw();
+        add_ok = add_ok && q1516_add_sat(x, y) == clamp_reference((int64_t)x + y);
+        sub_ok = sub_ok && q1516_sub_sat(x, y) == clamp_reference((int64_t)x - y);
+        mul_ok = mul_ok && q1516_mul_sat(x, y) == clamp_reference(((int64_t)x * y) >> 16);
+        if (y != 0) {
+            div_ok = div_ok && q1516_div_sat(x, y) == clamp_reference(((int64_t)x * 65536) / y);
+        }
+    }
+    TEST_ASSERT(add_ok, "add_sat: 100k random pairs match reference");
+    TEST_ASSERT(sub_ok, "sub_sat: 100k random pairs match reference");
+    TEST_ASSERT(mul_ok, "mul_sat: 100k random pairs match reference");
+    TEST_ASSERT(div_ok, "div_sat: 100k random pairs match reference");
+}
+
+// =============================================================================
+// ROUNDING TESTS
+// =============================================================================
+
+// Reference rounding of an exact long double value (x86 long double has a
+// 64-bit mantissa, enough for every product and in-range quotient here)
+static int64_t round_reference(long double exact, q1516_round_t mode) {
+    switch (mode) {
+        case Q1516_ROUND_NEAREST:   return (int64_t)floorl(exact + 0.5L);
+        case Q1516_ROUND_HALF_EVEN: return (int64_t)nearbyintl(exact);  // default FE_TONEAREST
+        default:                    return (int64_t)floorl(exact);
+    }
+}
+
+void test_rounding() {
+    print_section("ROUNDING TESTS");
+
+    // Exact ties: 1 raw * 0.5 = 0.5 raw, 3 raw * 0.5 = 1.5 raw
+    TEST_ASSERT(q1516_multiply(1, Q1516_HALF) == 0, "multiply: 0.5 ULP truncates to 0");
+    TEST_ASSERT(q1516_multiply_round(1, Q1516_HALF) == 1, "multiply_round: 0.5 ULP -> 1");
+    TEST_ASSERT(q1516_multiply_round_even(1, Q1516_HALF) == 0, "multiply_round_even: 0.5 ULP -> 0");
+    TEST_ASSERT(q1516_multiply_round_even(3, Q1516_HALF) == 2, "multiply_round_even: 1.5 ULP -> 2");
+    TEST_ASSERT(q1516_multiply_round(-1, Q1516_HALF) == 0, "multiply_round: -0.5 ULP -> 0");
+    TEST_ASSERT(q1516_multiply_round_even(-3, Q1516_HALF) == -2, "multiply_round_even: -1.5 ULP -> -2");
+    TEST_ASSERT(q1516_multiply_rounded(5, Q1516_HALF, Q1516_ROUND_FLOOR) == q1516_multiply(5, Q1516_HALF),
+                "multiply_rounded FLOOR = multiply");
+
+    // Division ties: 1 raw / 2.0 = 0.5 raw, -3 raw / 2.0 = -1.5 raw
+    q1516_t two = q1516_from_int(2);
+    TEST_ASSERT(q1516_divide_round(1, two) == 1, "divide_round: 0.5 ULP -> 1");
+    TEST_ASSERT(q1516_divide_round_even(1, two) == 0, "divide_round_even: 0.5 ULP -> 0");
+    TEST_ASSERT(q1516_divide_round(-3, two) == -1, "divide_round: -1.5 ULP -> -1");
+    TEST_ASSERT(q1516_divide_round_even(-3, two) == -2, "divide_round_even: -1.5 ULP -> -2");
+    TEST_ASSERT(q1516_divide_round(q1516_from_int(2), q1516_from_int(3)) == 43691,
+                "divide_round: 2/3 -> 43691 (truncation gives 43690)");
+    TEST_ASSERT(q1516_divide_round(q1516_from_int(1), 0) == Q1516_MAX, "divide_round: x / 0 -> MAX");
+
+    // Random sweep against the long double reference, all three modes
+    bool mul_ok = true, div_ok = true;
+    for (int i = 0; i < 100000; i++) {
+        q1516_t x = random_raw();
+        q1516_t y = random_raw() >> (i & 15);  // mix of large and small divisors
+        for (int mode = Q1516_ROUND_FLOOR; mode <= Q1516_ROUND_HALF_EVEN; mode++) {
+            long double product = (long double)x * (long double)y / 65536.0L;
+            mul_ok = mul_ok && q1516_multiply_rounded(x, y, (q1516_round_t)mode) ==
+                               (q1516_t)round_reference(product, (q1516_round_t)mode);
+            if (y == 0) continue;
+            long double quotient = (long double)x * 65536.0L / (long double)y;
+            if (fabsl(quotient) >= 2147483647.0L) continue;  // only in-range results are exact
+            div_ok = div_ok && q1516_divide_rounded(x, y, (q1516_round_t)mode) ==
+                               (q1516_t)round_reference(quotient, (q1516_round_t)mode);
+        }
+    }
+    TEST_ASSERT(mul_ok, "multiply_rounded: 100k random pairs x 3 modes match reference");
+    TEST_ASSERT(div_ok, "divide_rounded: 100k random pairs x 3 modes match reference");
+
+    // Accumulator: one rounding at the end beats rounding every product
+    q1516_acc_t acc = 0;
+    q1516_t chained = 0;
+    q1516_t tenth = q1516_from_float(0.1f);
+    for (int i = 0; i < 1000; i++) {
+        acc = q1516_mac(acc, tenth, tenth);
+        chained = q1516_add(chained, q1516_multiply(tenth, tenth));
+    }
+    long double exact = 1000.0L * (long double)tenth * (long double)tenth / 65536.0L;
+    q1516_t rounded = q1516_acc_round(acc, Q1516_ROUND_NEAREST);
+    TEST_ASSERT(fabsl((long double)rounded - exact) <= 0.5L, "mac + acc_round: within 0.5 ULP after 1000 terms");
+    TEST_ASSERT(fabsl((long double)chained - exact) > 0.5L, "chained multiply drifts (why mac exists)");
+    TEST_ASSERT(q1516_acc_round((q1516_acc_t)1 << 62, Q1516_ROUND_NEAREST) == Q1516_MAX,
+                "acc_round: saturates large sums");
+}
+
+// =============================================================================
+// TRANSCENDENTAL FUNCTION TESTS
+// =============================================================================
+
+#define MATH_TEST_SAMPLES 200000
+
+// Worst error in ULP of f against a double reference over random inputs.
+// `lo`/`hi` bound the raw input; results are compared after clamping the
+// reference to the Q15.16 range.
+static double max_ulp_error(q1516_t (*f)(q1516_t), double (*ref)(double), int64_t lo, int64_t hi) {
+    double worst = 0.0;
+    uint64_t span = (uint64_t)(hi - lo) + 1;
+    for (int i = 0; i < MATH_TEST_SAMPLES; i++) {
+        uint64_t r = ((uint64_t)(uint32_t)random_raw() << 32) | (uint32_t)random_raw();
+        q1516_t x = (q1516_t)(lo + (int64_t)(r % span));
+        double expected = ref((double)x / 65536.0) * 65536.0;
+        if (expected > (double)Q1516_MAX) expected = (double)Q1516_MAX;
+        double error = fabs((double)f(x) - expected);
+        if (error > worst) worst = error;
+    }
+    return worst;
+}
+
+void test_math() {
+    print_section("TRANSCENDENTAL FUNCTION TESTS");
+
+    // Exact and well-known values
+    TEST_ASSERT(q1516_sqrt(q1516_from_int(4)) == q1516_from_int(2), "sqrt(4) = 2");
+    TEST_ASSERT(q1516_sqrt(Q1516_ONE) == Q1516_ONE, "sqrt(1) = 1");
+    TEST_ASSERT(q1516_sqrt(0) == 0 && q1516_sqrt(-Q1516_ONE) == 0, "sqrt(0) = sqrt(-1) = 0");
+    TEST_ASSERT(q1516_sqrt(Q1516_MAX) == 11863283, "sqrt(MAX) = 181.019...");
+    TEST_ASSERT(q1516_sin(0) == 0 && q1516_cos(0) == Q1516_ONE, "sin(0) = 0, cos(0) = 1");
+    TEST_ASSERT(q1516_sin(Q1516_HALF_PI) == Q1516_ONE, "sin(pi/2) = 1");
+    TEST_ASSERT(q1516_cos(Q1516_PI) == -Q1516_ONE, "cos(pi) = -1");
+    TEST_ASSERT(q1516_approximately_equal(q1516_sin(-Q1516_PI / 6), -Q1516_HALF, 1), "sin(-pi/6) = -0.5");
+    TEST_ASSERT(q1516_atan2(Q1516_ONE, Q1516_ONE) == 51472, "atan2(1, 1) = pi/4 (0.785400)");
+    TEST_ASSERT(q1516_atan2(0, -Q1516_ONE) == Q1516_PI, "atan2(0, -1) = pi");
+    TEST_ASSERT(q1516_atan2(-Q1516_ONE, 0) == -Q1516_HALF_PI, "atan2(-1, 0) = -pi/2");
+    TEST_ASSERT(q1516_atan2(0, 0) == 0, "atan2(0, 0) = 0");
+    TEST_ASSERT(q1516_exp(0) == Q1516_ONE, "exp(0) = 1");
+    TEST_ASSERT(q1516_exp(Q1516_ONE) == Q1516_E, "exp(1) = e");
+    TEST_ASSERT(q1516_exp(q1516_from_int(11)) == Q1516_MAX, "exp(11) saturates");
+    TEST_ASSERT(q1516_exp(q1516_from_int(-20)) == 0, "exp(-20) underflows to 0");
+    TEST_ASSERT(q1516_log(Q1516_ONE) == 0, "log(1) = 0");
+    TEST_ASSERT(q1516_log(Q1516_E) == Q1516_ONE, "log(e) = 1");
+    TEST_ASSERT(q1516_log(0) == Q1516_MIN && q1516_log(-1) == Q1516_MIN, "log(x <= 0) = MIN");
+
+    // Documented error bounds (q1516_math.h), on random inputs
+    double err;
+    err = max_ulp_error(q1516_sqrt, sqrt, 1, Q1516_MAX);
+    printf("sqrt max error: %.3f ULP\n", err);
+    TEST_ASSERT(err <= 0.5, "sqrt: <= 0.5 ULP");
+    err = max_ulp_error(q1516_sin, sin, Q1516_MIN, Q1516_MAX);
+    printf("sin max error:  %.3f ULP\n", err);
+    TEST_ASSERT(err <= 0.81, "sin: <= 0.81 ULP over the full input range");
+    err = max_ulp_error(q1516_cos, cos, Q1516_MIN, Q1516_MAX);
+    printf("cos max error:  %.3f ULP\n", err);
+    TEST_ASSERT(err <= 0.81, "cos: <= 0.81 ULP over the full input range");
+    err = max_ulp_error(q1516_exp, exp, -13 * Q1516_SCALE, 12 * Q1516_SCALE);
+    printf("exp max error:  %.3f ULP\n", err);
+    TEST_ASSERT(err <= 0.51, "exp: <= 0.51 ULP");
+    err = max_ulp_error(q1516_log, log, 1, Q1516_MAX);
+    printf("log max error:  %.3f ULP\n", err);
+    TEST_ASSERT(err <= 0.51, "log: <= 0.51 ULP");
+
+    double worst = 0.0;
+    for (int i = 0; i < MATH_TEST_SAMPLES; i++) {
+        q1516_t y = random_raw() >> (i & 31);   // Mix of magnitudes
+        q1516_t x = random_raw() >> ((i >> 5) & 31);
+        double error = fabs((double)q1516_atan2(y, x) - atan2((double)y, (double)x) * 65536.0);
+        if (error > worst) worst = error;
+    }
+    printf("atan2 max error: %.3f ULP\n", worst);
+    TEST_ASSERT(worst <= 0.59, "atan2: <= 0.59 ULP");
+
+    // Batch versions are plain loops over the scalar ones
+    q1516_t in[64], y[64], out[64];
+    bool ok = true;
+    for (int i = 0; i < 64; i++) { in[i] = random_raw() >> 8; y[i] = random_raw() >> 8; }
+    q1516_sin_n(out, in, 64);
+    for (int i = 0; i < 64; i++) ok = ok && out[i] == q1516_sin(in[i]);
+    q1516_atan2_n(out, y, in, 64);
+    for (int i = 0; i < 64; i++) ok = ok && out[i] == q1516_atan2(y[i], in[i]);
+    q1516_exp_n(out, in, 64);
+    for (int i = 0; i < 64; i++) ok = ok && out[i] == q1516_exp(in[i]);
+    TEST_ASSERT(ok, "batch math functions match scalar");
+}
+
+// =============================================================================
+// RECIPROCAL / FAST DIVISION TESTS
+// =============================================================================
+
+void test_fast_division() {
+    print_section("RECIPROCAL / FAST DIVISION TESTS");
+
+    TEST_ASSERT(q1516_reciprocal(q1516_from_int(4)) == q1516_from_float(0.25f), "reciprocal(4) = 0.25");
+    TEST_ASSERT(q1516_reciprocal(-Q1516_HALF) == q1516_from_int(-2), "reciprocal(-0.5) = -2");
+    TEST_ASSERT(q1516_reciprocal(q1516_from_int(3)) == q1516_divide(Q1516_ONE, q1516_from_int(3)),
+                "reciprocal(3) = divide(1, 3)");
+    TEST_ASSERT(q1516_divide_fast(q1516_from_int(7), q1516_from_int(2)) == q1516_from_float(3.5f),
+                "divide_fast(7, 2) = 3.5");
+    TEST_ASSERT(q1516_divide_fast(Q1516_ONE, 0) == Q1516_MAX, "divide_fast(1, 0) = MAX");
+    TEST_ASSERT(q1516_divide_fast(-Q1516_ONE, 0) == Q1516_MIN, "divide_fast(-1, 0) = MIN");
+
+    q1516_divider_t by_three = q1516_divider_init(q1516_from_int(3));
+    TEST_ASSERT(q1516_divide_by(&by_three, q1516_from_int(9)) == q1516_from_int(3), "divide_by(9, 3) = 3");
+    TEST_ASSERT(q1516_divide_by(&by_three, q1516_from_int(-1)) == q1516_divide(q1516_from_int(-1), q1516_from_int(3)),
+                "divide_by(-1, 3) = divide(-1, 3)");
+    q1516_divider_t by_zero = q1516_divider_init(0);
+    TEST_ASSERT(q1516_divide_by(&by_zero, Q1516_ONE) == Q1516_MAX, "divide_by(1, 0) = MAX");
+
+    // Bit-exact against q1516_divide: boundary pairs, then random ones with
+    // every magnitude of dividend and divisor
+    const q1516_t edges[] = {0, 1, -1, 2, -2, 3, Q1516_HALF, Q1516_ONE, -Q1516_ONE, Q1516_ONE + 1,
+                             Q1516_MAX, Q1516_MIN, 0x40000000, -0x40000000, 0x00100001};
+    const int edge_count = (int)(sizeof edges / sizeof edges[0]);
+    bool fast_ok = true, by_ok = true;
+    for (int i = 0; i < edge_count; i++) {
+        for (int j = 0; j < edge_count; j++) {
+            q1516_divider_t divider = q1516_divider_init(edges[j]);
+            q1516_t expected = q1516_divide(edges[i], edges[j]);
+            fast_ok = fast_ok && q1516_divide_fast(edges[i], edges[j]) == expected;
+            by_ok = by_ok && q1516_divide_by(&divider, edges[i]) == expected;
+        }
+    }
+    for (int i = 0; i < 200000; i++) {
+        q1516_t a = random_raw() >> (i & 31);
+        q1516_t b = random_raw() >> ((i >> 5) & 31);
+        q1516_divider_t divider = q1516_divider_init(b);
+        q1516_t expected = q1516_divide(a, b);
+        fast_ok = fast_ok && q1516_divide_fast(a, b) == expected;
+        by_ok = by_ok && q1516_divide_by(&divider, a) == expected;
+    }
+    TEST_ASSERT(fast_ok, "divide_fast bit-exact with divide (edges + 200k random)");
+    TEST_ASSERT(by_ok, "divide_by bit-exact with divide (edges + 200k random)");
+
+    q1516_t in[37], out[37];
+    bool batch_ok = true;
+    for (int i = 0; i < 37; i++) in[i] = random_raw();
+    q1516_divide_by_n(out, in, &by_three, 37);
+    for (int i = 0; i < 37; i++) batch_ok = batch_ok && out[i] == q1516_divide(in[i], q1516_from_int(3));
+    TEST_ASSERT(batch_ok, "divide_by_n matches divide");
+}
+
+// =============================================================================
+// BATCH (SIMD) TESTS
+// =============================================================================
+
+// Odd length so every kernel also runs its scalar tail
+#define BATCH_TEST_LENGTH 1003
+
+void test_batch() {
+    print_section("BATCH (SIMD) TESTS");
+
+    static q1516_t a[BATCH_TEST_LENGTH], b[BATCH_TEST_LENGTH];
+    static q1516_t out[BATCH_TEST_LENGTH], acc[BATCH_TEST_LENGTH], acc_start[BATCH_TEST_LENGTH];
+    static float in_f[BATCH_TEST_LENGTH], out_f[BATCH_TEST_LENGTH];
+
+    for (int i = 0; i < BATCH_TEST_LENGTH; i++) {
+        a[i] = random_raw();
+        b[i] = random_raw();
+        acc_start[i] = random_raw();
+        // Floats inside the Q15.16 range, with fractional bits
+        in_f[i] = (float)(random_raw() >> 1) / 65536.0f - 16384.0f;
+    }
+    // Ties, out-of-range values and non-numbers, which SIMD has to clamp
+    const float special_f[] = {0.5f / 65536.0f, 1.5f / 65536.0f, -2.5f / 65536.0f, 32767.99f, 32768.0f,
+                               -32768.0f, -32769.0f, 1e10f, -1e10f, INFINITY, -INFINITY, NAN, -0.0f};
+    for (int i = 0; i < (int)(sizeof special_f / sizeof special_f[0]); i++) in_f[i * 3] = special_f[i];
+    // Boundary values at the front
+    a[0] = Q1516_MAX; b[0] = Q1516_MAX;
+    a[1] = Q1516_MIN; b[1] = Q1516_MIN;
+    a[2] = Q1516_MIN; b[2] = Q1516_MAX;
+    a[3] = -1;        b[3] = 1;
+
+    q1516_isa_t best = q1516_batch_isa();
+    printf("Best supported ISA: %s\n", q1516_isa_name(best));
+
+    for (int isa = Q1516_ISA_SCALAR; isa <= (int)best; isa++) {
+        char name[96];
+        q1516_batch_set_isa((q1516_isa_t)isa);
+        const char* isa_name = q1516_isa_name((q1516_isa_t)isa);
+        bool ok;
+
+        q1516_add_n(out, a, b, BATCH_TEST_LENGTH);
+        ok = true;
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) ok = ok && out[i] == q1516_add(a[i], b[i]);
+        snprintf(name, sizeof name, "q1516_add_n bit-exact (%s)", isa_name);
+        TEST_ASSERT(ok, name);
+
+        q1516_mul_n(out, a, b, BATCH_TEST_LENGTH);
+        ok = true;
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) ok = ok && out[i] == q1516_multiply(a[i], b[i]);
+        snprintf(name, sizeof name, "q1516_mul_n bit-exact (%s)", isa_name);
+        TEST_ASSERT(ok, name);
+
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) acc[i] = acc_start[i];
+        q1516_mac_n(acc, a, b, BATCH_TEST_LENGTH);
+        ok = true;
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) {
+            ok = ok && acc[i] == q1516_add(acc_start[i], q1516_multiply(a[i], b[i]));
+        }
+        snprintf(name, sizeof name, "q1516_mac_n bit-exact (%s)", isa_name);
+        TEST_ASSERT(ok, name);
+
+        q1516_from_float_n(out, in_f, BATCH_TEST_LENGTH);
+        ok = true;
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) ok = ok && out[i] == q1516_from_float(in_f[i]);
+        snprintf(name, sizeof name, "q1516_from_float_n bit-exact (%s)", isa_name);
+        TEST_ASSERT(ok, name);
+
+        q1516_to_float_n(out_f, a, BATCH_TEST_LENGTH);
+        ok = true;
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) ok = ok && out_f[i] == q1516_to_float(a[i]);
+        snprintf(name, sizeof name, "q1516_to_float_n bit-exact (%s)", isa_name);
+        TEST_ASSERT(ok, name);
+
+        q1516_add_sat_n(out, a, b, BATCH_TEST_LENGTH);
+        ok = true;
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) ok = ok && out[i] == q1516_add_sat(a[i], b[i]);
+        snprintf(name, sizeof name, "q1516_add_sat_n bit-exact (%s)", isa_name);
+        TEST_ASSERT(ok, name);
+
+        q1516_sub_sat_n(out, a, b, BATCH_TEST_LENGTH);
+        ok = true;
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) ok = ok && out[i] == q1516_sub_sat(a[i], b[i]);
+        snprintf(name, sizeof name, "q1516_sub_sat_n bit-exact (%s)", isa_name);
+        TEST_ASSERT(ok, name);
+
+        q1516_mul_sat_n(out, a, b, BATCH_TEST_LENGTH);
+        ok = true;
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) ok = ok && out[i] == q1516_mul_sat(a[i], b[i]);
+        snprintf(name, sizeof name, "q1516_mul_sat_n bit-exact (%s)", isa_name);
+        TEST_ASSERT(ok, name);
+
+        uint64_t expected_dot = 0;
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) expected_dot += (uint64_t)((int64_t)a[i] * b[i]);
+        snprintf(name, sizeof name, "q1516_dot_acc bit-exact (%s)", isa_name);
+        TEST_ASSERT(q1516_dot_acc(a, b, BATCH_TEST_LENGTH) == (q1516_acc_t)expected_dot, name);
+        snprintf(name, sizeof name, "q1516_dot = acc_round(dot_acc) (%s)", isa_name);
+        TEST_ASSERT(q1516_dot(a + 4, b + 4, 100) ==
+                    q1516_acc_round(q1516_dot_acc(a + 4, b + 4, 100), Q1516_ROUND_NEAREST), name);
+
+        // In-place use: output aliasing the first input
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) out[i] = a[i];
+        q1516_mul_n(out, out, b, BATCH_TEST_LENGTH);
+        ok = true;
+        for (int i = 0; i < BATCH_TEST_LENGTH; i++) ok = ok && out[i] == q1516_multiply(a[i], b[i]);
+        snprintf(name, sizeof name, "q1516_mul_n in-place (%s)", isa_name);
+        TEST_ASSERT(ok, name);
+    }
+
+    // Restore the automatic choice for anything that runs afterwards
+    q1516_batch_set_isa(best);
+}
+
+// =============================================================================
+// DSP FILTER TESTS
+// =============================================================================
+
+#define DSP_TEST_LENGTH 1003
+#define DSP_FIR_TAPS 17
+
+// Feed `in` through a filter in uneven blocks (1, 2, 3, ... samples, then
+// the rest) so every block-boundary case of the history handling runs
+#define DSP_PROCESS_IN_BLOCKS(PROCESS, filter, out, in, n) do { \
+    size_t done_ = 0, block_ = 1; \
+    while (done_ < (n)) { \
+        size_t len_ = (block_ < (n) - done_) ? block_ : (n) - done_; \
+        PROCESS(filter, (out) + done_, (in) + done_, len_); \
+        done_ += len_; \
+        block_ = (block_ < 40) ? block_ + 1 : 100; \
+    } \
+} while (0)
+
+void test_dsp() {
+    print_section("DSP FILTER TESTS");
+
+    static q1516_t in[DSP_TEST_LENGTH], out[DSP_TEST_LENGTH], expected[DSP_TEST_LENGTH];
+    for (int i = 0; i < DSP_TEST_LENGTH; i++) in[i] = random_raw() >> 4;  // |x| < 2048
+    bool ok;
+
+    // --- FIR ---
+    q1516_t coeffs[DSP_FIR_TAPS];
+    for (int k = 0; k < DSP_FIR_TAPS; k++) coeffs[k] = random_raw() >> 12;  // |h| < 8
+    q1516_t fir_state[Q1516_FIR_STATE_SIZE(DSP_FIR_TAPS)];
+    q1516_fir_t fir;
+
+    q1516_t impulse[DSP_FIR_TAPS + 3] = {Q1516_ONE};
+    q1516_fir_init(&fir, coeffs, DSP_FIR_TAPS, fir_state);
+    q1516_fir_process(&fir, out, impulse, DSP_FIR_TAPS + 3);
+    ok = true;
+    for (int i = 0; i < DSP_FIR_TAPS + 3; i++) ok = ok && out[i] == (i < DSP_FIR_TAPS ? coeffs[i] : 0);
+    TEST_ASSERT(ok, "FIR impulse response equals coefficients");
+
+    for (int i = 0; i < DSP_TEST_LENGTH; i++) {
+        q1516_acc_t acc = 0;
+        for (int k = 0; k < DSP_FIR_TAPS && k <= i; k++) acc = q1516_mac(acc, coeffs[k], in[i - k]);
+        expected[i] = q1516_acc_round(acc, Q1516_ROUND_NEAREST);
+    }
+
+    q1516_isa_t best = q1516_batch_isa();
+    for (int isa = Q1516_ISA_SCALAR; isa <= (int)best; isa++) {
+        char name[96];
+        q1516_batch_set_isa((q1516_isa_t)isa);
+
+        q1516_fir_init(&fir, coeffs, DSP_FIR_TAPS, fir_state);
+        q1516_fir_process(&fir, out, in, DSP_TEST_LENGTH);
+        ok = true;
+        for (int i = 0; i < DSP_TEST_LENGTH; i++) ok = ok && out[i] == expected[i];
+        snprintf(name, sizeof name, "FIR matches direct convolution (%s)", q1516_isa_name((q1516_isa_t)isa));
+        TEST_ASSERT(ok, name);
+    }
+    q1516_batch_set_isa(best);
+
+    q1516_fir_init(&fir, coeffs, DSP_FIR_TAPS, fir_state);
+    DSP_PROCESS_IN_BLOCKS(q1516_fir_process, &fir, out, in, (size_t)DSP_TEST_LENGTH);
+    ok = true;
+    for (int i = 0; i < DSP_TEST_LENGTH; i++) ok = ok && out[i] == expected[i];
+    TEST_ASSERT(ok, "FIR in uneven blocks matches one block");
+
+    for (int i = 0; i < DSP_TEST_LENGTH; i++) out[i] = in[i];
+    q1516_fir_init(&fir, coeffs, DSP_FIR_TAPS, fir_state);
+    DSP_PROCESS_IN_BLOCKS(q1516_fir_process, &fir, out, out, (size_t)DSP_TEST_LENGTH);
+    ok = true;
+    for (int i = 0; i < DSP_TEST_LENGTH; i++) ok = ok && out[i] == expected[i];
+    TEST_ASSERT(ok, "FIR in-place");
+
+    q1516_fir_reset(&fir);
+    q1516_fir_process(&fir, out, impulse, DSP_FIR_TAPS);
+    TEST_ASSERT(out[0] == coeffs[0] && out[DSP_FIR_TAPS - 1] == coeffs[DSP_FIR_TAPS - 1], "FIR reset");
+
+    // --- Biquad: 2nd-order Butterworth low-pass at fs/20, then a high-pass at fs/100 ---
+    static const q1516_biquad_coeffs_t sections[2] = {
+        {Q1516_BIQUAD_COEFF(0.020083365564), Q1516_BIQUAD_COEFF(0.040166731128),
+         Q1516_BIQUAD_COEFF(0.020083365564), Q1516_BIQUAD_COEFF(-1.561018075801),
+         Q1516_BIQUAD_COEFF(0.641351538058)},
+        {Q1516_BIQUAD_COEFF(0.956543225556), Q1516_BIQUAD_COEFF(-1.913086451112),
+         Q1516_BIQUAD_COEFF(0.956543225556), Q1516_BIQUAD_COEFF(-1.911197067426),
+         Q1516_BIQUAD_COEFF(0.914975834798)},
+    };
+    q1516_t biquad_state[Q1516_BIQUAD_STATE_SIZE(2)];
+    q1516_biquad_t biquad;
+
+    q1516_t step[400];
+    for (int i = 0; i < 400; i++) step[i] = Q1516_ONE;
+    q1516_biquad_init(&biquad, sections, 1, biquad_state);
+    q1516_biquad_process(&biquad, out, step, 400);
+    TEST_ASSERT(fixed_point_equal(out[399], Q1516_ONE, q1516_from_float(0.001f)), "Biquad low-pass DC gain is 1");
+
+    // Same coefficients in double precision
+    double ref_state[2][4] = {{0}};
+    double max_error = 0.0;
+    for (int i = 0; i < DSP_TEST_LENGTH; i++) {
+        double x = in[i] / 65536.0;
+        for (int s = 0; s < 2; s++) {
+            const q1516_biquad_coeffs_t* c = &sections[s];
+            double* st = ref_state[s];
+            double y = (c->b0 * x + c->b1 * st[0] + c->b2 * st[1] - c->a1 * st[2] - c->a2 * st[3]) / 1073741824.0;
+            st[1] = st[0]; st[0] = x; st[3] = st[2]; st[2] = y;
+            x = y;
+        }
+        expected[i] = q1516_from_double(x);
+    }
+    q1516_biquad_init(&biquad, sections, 2, biquad_state);
+    q1516_biquad_process(&biquad, out, in, DSP_TEST_LENGTH);
+    for (int i = 0; i < DSP_TEST_LENGTH; i++) {
+        double error = fabs((double)out[i] - (double)expected[i]);
+        if (error > max_error) max_error = error;
+    }
+    printf("Biquad cascade max error vs double: %.1f ULP\n", max_error);
+    TEST_ASSERT(max_error <= 64.0, "Biquad cascade tracks double reference");
+
+    for (int i = 0; i < DSP_TEST_LENGTH; i++) expected[i] = out[i];
+    for (int i = 0; i < DSP_TEST_LENGTH; i++) out[i] = in[i];
+    q1516_biquad_reset(&biquad);
+    DSP_PROCESS_IN_BLOCKS(q1516_biquad_process, &biquad, out, out, (size_t)DSP_TEST_LENGTH);
+    ok = true;
+    for (int i = 0; i < DSP_TEST_LENGTH; i++) ok = ok && out[i] == expected[i];
+    TEST_ASSERT(ok, "Biquad in uneven blocks, in-place, after reset");
+
+    // --- Moving average: power-of-two length (shift) and not (division) ---
+    const size_t lengths[2] = {16, 7};
+    for (int l = 0; l < 2; l++) {
+        char name[96];
+        size_t length = lengths[l];
+        q1516_t window[16];
+        q1516_moving_average_t avg;
+
+        for (int i = 0; i < DSP_TEST_LENGTH; i++) {
+            int64_t sum = 0;
+            for (int k = 0; k < (int)length && k <= i; k++) sum += in[i - k];
+            // Round half up: floor((2 * sum + length) / (2 * length))
+            int64_t num = 2 * sum + (int64_t)length, den = 2 * (int64_t)length;
+            expected[i] = (q1516_t)(num / den - (num % den < 0));
+        }
+
+        q1516_moving_average_init(&avg, window, length);
+        for (int i = 0; i < DSP_TEST_LENGTH; i++) out[i] = in[i];
+        DSP_PROCESS_IN_BLOCKS(q1516_moving_average_process, &avg, out, out, (size_t)DSP_TEST_LENGTH);
+        ok = true;
+        for (int i = 0; i < DSP_TEST_LENGTH; i++) ok = ok && out[i] == expected[i];
+        snprintf(name, sizeof name, "Moving average (length %zu) exact, in blocks, in-place", length);
+        TEST_ASSERT(ok, name);
+
+        q1516_moving_average_reset(&avg);
+        q1516_moving_average_process(&avg, out, step, length);
+        snprintf(name, sizeof name, "Moving average (length %zu) step response reaches 1", length);
+        TEST_ASSERT(out[length - 1] == Q1516_ONE && out[0] < Q1516_ONE, name);
+    }
+}
+
+// =============================================================================
+// FFT TESTS
+// =============================================================================
+
+#define FFT_TEST_MAX 4096
+
+// Largest |fft_out - dft(in) / 2^shift| over all components, in ULP,
+// against a double-precision DFT. `sign` is -1 for forward, +1 for inverse.
+static double fft_max_error(const q1516_complex_t* in, const q1516_complex_t* fft_out, size_t n,
+                            int shift, int sign) {
+    const double two_pi = 6.283185307179586;
+    double max_error = 0.0;
+    for (size_t k = 0; k < n; k++) {
+        double re = 0.0, im = 0.0;
+        for (size_t j = 0; j < n; j++) {
+            double angle = sign * two_pi * (double)((j * k) % n) / (double)n;
+            double c = cos(angle), s = sin(angle);
+            re += in[j].re * c - in[j].im * s;
+            im += in[j].re * s + in[j].im * c;
+        }
+        re = ldexp(re, -shift);
+        im = ldexp(im, -shift);
+        double error = fmax(fabs(fft_out[k].re - re), fabs(fft_out[k].im - im));
+        if (error > max_error) max_error = error;
+    }
+    return max_error;
+}
+
+void test_fft() {
+    print_section("FFT TESTS");
+
+    static q1516_twiddle_t twiddles[Q1516_FFT_TWIDDLE_SIZE(FFT_TEST_MAX)];
+    static q1516_complex_t in[FFT_TEST_MAX], data[FFT_TEST_MAX], expected[FFT_TEST_MAX];
+    q1516_fft_t fft;
+    char name[96];
+    bool ok;
+
+    TEST_ASSERT(q1516_fft_init(&fft, 0, twiddles) == -1 && q1516_fft_init(&fft, 1, twiddles) == -1 &&
+                q1516_fft_init(&fft, 48, twiddles) == -1, "FFT rejects sizes that are not powers of two >= 2");
+
+    // Every size from 2 to 1024 (odd and even log2: radix-2 pass or not),
+    // FIXED scaling, against a double DFT
+    for (size_t n = 2; n <= 1024; n *= 2) {
+        for (size_t i = 0; i < n; i++) {
+            in[i].re = random_raw() >> 4;  // |x| < 2048
+            in[i].im = random_raw() >> 4;
+            data[i] = in[i];
+        }
+        q1516_fft_init(&fft, n, twiddles);
+        int shift = q1516_fft_forward(&fft, data, Q1516_FFT_SCALE_FIXED);
+        double error = fft_max_error(in, data, n, shift, -1);
+        snprintf(name, sizeof name, "FFT %zu points, FIXED: shift %d, %.1f ULP from DFT / n", n, shift, error);
+        TEST_ASSERT((1u << shift) == n && error <= 4.0, name);
+    }
+
+    // Impulse at 0 -> flat spectrum, exactly
+    q1516_fft_init(&fft, 256, twiddles);
+    for (size_t i = 0; i < 256; i++) data[i].re = data[i].im = 0;
+    data[0].re = Q1516_ONE;
+    q1516_fft_forward(&fft, data, Q1516_FFT_SCALE_NONE);
+    ok = true;
+    for (size_t i = 0; i < 256; i++) ok = ok && data[i].re == Q1516_ONE && data[i].im == 0;
+    TEST_ASSERT(ok, "FFT of an impulse is flat (NONE)");
+
+    // A pure tone lands in one bin
+    for (size_t i = 0; i < 256; i++) {
+        data[i].re = q1516_from_double(100.0 * cos(6.283185307179586 * 5.0 * i / 256.0));
+        data[i].im = q1516_from_double(100.0 * sin(6.283185307179586 * 5.0 * i / 256.0));
+    }
+    q1516_fft_forward(&fft, data, Q1516_FFT_SCALE_FIXED);
+    ok = fixed_point_equal(data[5].re, q1516_from_int(100), q1516_from_float(0.001f));
+    for (size_t i = 0; i < 256; i++) {
+        if (i != 5) ok = ok && abs(data[i].re) < 64 && abs(data[i].im) < 64;
+    }
+    TEST_ASSERT(ok, "FFT of a complex tone is a single bin");
+
+    // Large inputs: FIXED and DYNAMIC must not overflow
+    const q1516_fft_scale_t large_modes[2] = {Q1516_FFT_SCALE_FIXED, Q1516_FFT_SCALE_DYNAMIC};
+    for (int m = 0; m < 2; m++) {
+        const char* mode = (m == 0) ? "FIXED" : "DYNAMIC";
+
+        // DC: all the growth ends up in bin 0
+        q1516_fft_init(&fft, FFT_TEST_MAX, twiddles);
+        for (size_t i = 0; i < FFT_TEST_MAX; i++) data[i].re = data[i].im = 0x5A000000;  // 23040 + 23040i
+        int shift = q1516_fft_forward(&fft, data, large_modes[m]);
+        double bin0 = ldexp((double)0x5A000000 * FFT_TEST_MAX, -shift);
+        ok = fabs(data[0].re - bin0) <= 8.0 && fabs(data[0].im - bin0) <= 8.0;
+        for (size_t i = 1; i < FFT_TEST_MAX; i++) ok = ok && abs(data[i].re) <= 8 && abs(data[i].im) <= 8;
+        snprintf(name, sizeof name, "FFT %d points, full-scale DC, %s: no overflow", FFT_TEST_MAX, mode);
+        TEST_ASSERT(ok, name);
+
+        // Random full-scale data
+        q1516_fft_init(&fft, 1024, twiddles);
+        for (size_t i = 0; i < 1024; i++) {
+            in[i].re = random_raw() / 3 * 2;  // |x| < 21846
+            in[i].im = random_raw() / 3 * 2;
+            data[i] = in[i];
+        }
+        shift = q1516_fft_forward(&fft, data, large_modes[m]);
+        double error = ldexp(fft_max_error(in, data, 1024, shift, -1), shift - 10);
+        snprintf(name, sizeof name, "FFT 1024 points, full-scale random, %s: shift %d, %.1f ULP of DFT / n",
+                 mode, shift, error);
+        TEST_ASSERT(error <= 6.0, name);
+    }
+
+    // Range limits, on both butterfly paths: constants at INT32_MAX / INT32_MIN
+    // in every sign combination (DFT / n is the input itself, in bin 0), and
+    // tones of magnitude 32767.99 at phases in all four quadrants
+    q1516_isa_t best = q1516_batch_isa();
+    const q1516_isa_t extreme_isas[2] = {Q1516_ISA_SCALAR, best};
+    const int32_t extremes[3] = {INT32_MAX, INT32_MIN, 0};
+    const size_t extreme_sizes[4] = {2, 4, 8, 1024};
+    for (int isa = 0; isa < 2; isa++) {
+        q1516_batch_set_isa(extreme_isas[isa]);
+        for (int m = 0; m < 2; m++) {
+            const char* mode = (m == 0) ? "FIXED" : "DYNAMIC";
+            ok = true;
+            for (int s = 0; s < 4; s++) {
+                size_t n = extreme_sizes[s];
+                q1516_fft_init(&fft, n, twiddles);
+                for (int a = 0; a < 3; a++) {
+                    for (int b = 0; b < 3; b++) {
+                        for (size_t i = 0; i < n; i++) {
+                            data[i].re = extremes[a];
+                            data[i].im = extremes[b];
+                        }
+                        int shift = q1516_fft_forward(&fft, data, large_modes[m]);
+                        ok = ok && fabs(data[0].re - ldexp((double)extremes[a] * n, -shift)) <= 4.0 &&
+                             fabs(data[0].im - ldexp((double)extremes[b] * n, -shift)) <= 4.0;
+                        for (size_t i = 1; i < n; i++) ok = ok && abs(data[i].re) <= 4 && abs(data[i].im) <= 4;
+                    }
+                }
+            }
+            snprintf(name, sizeof name, "FFT %s, constant INT32_MAX / INT32_MIN, %s: no overflow",
+                     q1516_isa_name(extreme_isas[isa]), mode);
+            TEST_ASSERT(ok, name);
+
+            double worst = 0.0;
+            q1516_fft_init(&fft, 1024, twiddles);
+            for (int quadrant = 0; quadrant < 4; quadrant++) {
+                const double radius = 32767.99 * Q1516_ONE;
+                double phase = 0.785398163397448 + quadrant * 1.570796326794897;  // pi/4 + quadrant * pi/2
+                for (size_t i = 0; i < 1024; i++) {
+                    double angle = 6.283185307179586 * (double)((i * 37) % 1024) / 1024.0 + phase;
+                    in[i].re = (int32_t)(radius * cos(angle));
+                    in[i].im = (int32_t)(radius * sin(angle));
+                    data[i] = in[i];
+                }
+                int shift = q1516_fft_forward(&fft, data, large_modes[m]);
+                worst = fmax(worst, ldexp(fft_max_error(in, data, 1024, shift, -1), shift - 10));
+            }
+            snprintf(name, sizeof name, "FFT %s, tones of magnitude 32767.99, %s: %.1f ULP of DFT / n",
+                     q1516_isa_name(extreme_isas[isa]), mode, worst);
+            TEST_ASSERT(worst <= 6.0, name);
+        }
+    }
+    q1516_batch_set_isa(best);
+
+    // DYNAMIC only shifts as much as the data needs: small signals keep their
+    // precision. Errors are compared in units of DFT / n, where FIXED lands.
+    q1516_fft_init(&fft, 1024, twiddles);
+    for (size_t i = 0; i < 1024; i++) {
+        in[i].re = random_raw() >> 20;  // |x| < 1/32
+        in[i].im = random_raw() >> 20;
+        data[i] = in[i];
+    }
+    int dynamic_shift = q1516_fft_forward(&fft, data, Q1516_FFT_SCALE_DYNAMIC);
+    double dynamic_error = ldexp(fft_max_error(in, data, 1024, dynamic_shift, -1), dynamic_shift - 10);
+    snprintf(name, sizeof name, "FFT DYNAMIC on a small signal: shift %d, %.3f ULP of DFT / n", dynamic_shift,
+             dynamic_error);
+    TEST_ASSERT(dynamic_shift < 10 && dynamic_error <= 0.5, name);
+
+    // Inverse: against the DFT, and FIXED forward + NONE inverse round trip
+    for (size_t i = 0; i < 1024; i++) {
+        in[i].re = random_raw() >> 4;
+        in[i].im = random_raw() >> 4;
+        data[i] = in[i];
+    }
+    int inverse_shift = q1516_fft_inverse(&fft, data, Q1516_FFT_SCALE_FIXED);
+    double inverse_error = fft_max_error(in, data, 1024, inverse_shift, +1);
+    snprintf(name, sizeof name, "IFFT 1024 points, FIXED: %.1f ULP from IDFT / n", inverse_error);
+    TEST_ASSERT(inverse_shift == 10 && inverse_error <= 4.0, name);
+
+    for (size_t i = 0; i < 1024; i++) data[i] = in[i];
+    q1516_fft_forward(&fft, data, Q1516_FFT_SCALE_FIXED);
+    q1516_fft_inverse(&fft, data, Q1516_FFT_SCALE_NONE);
+    ok = true;
+    for (size_t i = 0; i < 1024; i++) {
+        ok = ok && abs(data[i].re - in[i].re) <= 1024 && abs(data[i].im - in[i].im) <= 1024;
+    }
+    TEST_ASSERT(ok, "FFT FIXED then IFFT NONE restores the signal");
+
+    // SIMD butterflies: bit-identical to scalar for every size and mode
+    const q1516_fft_scale_t modes[3] = {Q1516_FFT_SCALE_NONE, Q1516_FFT_SCALE_FIXED, Q1516_FFT_SCALE_DYNAMIC};
+    for (size_t i = 0; i < FFT_TEST_MAX; i++) {
+        in[i].re = random_raw() >> 8;
+        in[i].im = random_raw() >> 8;
+    }
+    ok = true;
+    for (size_t n = 2; n <= FFT_TEST_MAX; n *= 2) {
+        q1516_fft_init(&fft, n, twiddles);
+        for (int m = 0; m < 3; m++) {
+            q1516_batch_set_isa(Q1516_ISA_SCALAR);
+            for (size_t i = 0; i < n; i++) expected[i] = in[i];
+            int expected_shift = q1516_fft_forward(&fft, expected, modes[m]);
+            q1516_batch_set_isa(best);
+            for (size_t i = 0; i < n; i++) data[i] = in[i];
+            ok = ok && q1516_fft_forward(&fft, data, modes[m]) == expected_shift;
+            for (size_t i = 0; i < n; i++) {
+                ok = ok && data[i].re == expected[i].re && data[i].im == expected[i].im;
+            }
+        }
+    }
+    snprintf(name, sizeof name, "FFT %s matches scalar bit for bit (2..%d points, all modes)",
+             q1516_isa_name(best), FFT_TEST_MAX);
+    TEST_ASSERT(ok, name);
+}
+
+// =============================================================================
+// MATRIX TESTS
+// =============================================================================
+
+#define MAT_TEST_MAX 20000
+
+// c[i][j] = q1516_dot(row i of a, column j of b), one element at a time
+static void mat_mul_reference(q1516_t* c, const q1516_t* a, const q1516_t* b, size_t m, size_t k, size_t n) {
+    for (size_t i = 0; i < m; i++) {
+        for (size_t j = 0; j < n; j++) {
+            q1516_acc_t acc = 0;
+            for (size_t p = 0; p < k; p++) acc = q1516_mac(acc, a[i * k + p], b[p * n + j]);
+            c[i * n + j] = q1516_acc_round(acc, Q1516_ROUND_NEAREST);
+        }
+    }
+}
+
+static bool raw_equal(const q1516_t* a, const q1516_t* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        if (a[i] != b[i]) return false;
+    }
+    return true;
+}
+
+void test_matrix() {
+    print_section("MATRIX TESTS");
+
+    static q1516_t a[MAT_TEST_MAX], b[MAT_TEST_MAX], c[MAT_TEST_MAX], expected[MAT_TEST_MAX];
+    char name[96];
+    bool ok;
+
+    for (int i = 0; i < MAT_TEST_MAX; i++) {
+        a[i] = random_raw() >> 10;  // |x| < 32
+        b[i] = random_raw() >> 10;
+    }
+
+    // Shapes with tails in every direction: tile rows (16), tile columns (64),
+    // slice depth (256), AVX2 column groups (16 and 8)
+    static const size_t shapes[][3] = {
+        {1, 1, 1}, {3, 5, 7}, {16, 64, 64}, {17, 300, 61}, {33, 40, 129}, {5, 513, 24}, {2, 3, 8}
+    };
+    q1516_isa_t best = q1516_batch_isa();
+    for (int s = 0; s < (int)(sizeof shapes / sizeof shapes[0]); s++) {
+        size_t m = shapes[s][0], k = shapes[s][1], n = shapes[s][2];
+        mat_mul_reference(expected, a, b, m, k, n);
+        ok = true;
+        for (int isa = Q1516_ISA_SCALAR; isa <= (int)best; isa++) {
+            q1516_batch_set_isa((q1516_isa_t)isa);
+            q1516_mat_mul(c, a, b, m, k, n);
+            ok = ok && raw_equal(c, expected, m * n);
+        }
+        q1516_batch_set_isa(best);
+        snprintf(name, sizeof name, "mat_mul %zux%zu * %zux%zu bit-exact on every ISA", m, k, k, n);
+        TEST_ASSERT(ok, name);
+    }
+
+    // Saturation and the 0.5 ULP bound
+    q1516_t big[4] = {q1516_from_int(300), q1516_from_int(300), q1516_from_int(-300), q1516_from_int(300)};
+    q1516_t column[2] = {q1516_from_int(100), q1516_from_int(100)};
+    q1516_mat_mul(c, big, column, 2, 2, 1);
+    TEST_ASSERT(c[0] == Q1516_MAX && c[1] == 0, "mat_mul saturates instead of wrapping");
+
+    q1516_t third[4] = {21845, 21845, 21845, 21845};  // About 1/3
+    q1516_mat_mul(c, third, third, 2, 2, 2);
+    TEST_ASSERT(c[0] == 14563, "mat_mul rounds once: 2 * (21845/65536)^2 -> 14563");
+
+    // Parallel path: any thread count gives the same bits
+    size_t m = 97, k = 150, n = 120;
+    mat_mul_reference(expected, a, b, m, k, n);
+    const int thread_counts[4] = {1, 3, 8, 0};
+    for (int t = 0; t < 4; t++) {
+        for (size_t i = 0; i < m * n; i++) c[i] = 0;
+        int used = q1516_mat_mul_parallel(c, a, b, m, k, n, thread_counts[t]);
+        snprintf(name, sizeof name, "mat_mul_parallel %zux%zu * %zux%zu, %d thread(s) asked, %d used",
+                 m, k, k, n, thread_counts[t], used);
+        TEST_ASSERT(raw_equal(c, expected, m * n) && used >= 1, name);
+    }
+    TEST_ASSERT(q1516_mat_mul_parallel(c, a, b, 2, 2, 2, 0) == 1, "mat_mul_parallel runs tiny products inline");
+
+    // Matrix-vector
+    mat_mul_reference(expected, a, b, 37, 45, 1);
+    q1516_mat_vec(c, a, b, 37, 45);
+    TEST_ASSERT(raw_equal(c, expected, 37), "mat_vec matches mat_mul with one column");
+
+    // Small sizes against the general path, with the output aliasing an input
+    typedef void (*square_fn)(q1516_t*, const q1516_t*, const q1516_t*);
+    static const square_fn muls[7] = {q1516_mat2_mul, q1516_mat3_mul, q1516_mat4_mul, q1516_mat5_mul,
+                                      q1516_mat6_mul, q1516_mat7_mul, q1516_mat8_mul};
+    static const square_fn vecs[7] = {q1516_mat2_vec, q1516_mat3_vec, q1516_mat4_vec, q1516_mat5_vec,
+                                      q1516_mat6_vec, q1516_mat7_vec, q1516_mat8_vec};
+    for (size_t size = 2; size <= 8; size++) {
+        q1516_t p[64], v[8];
+        size_t count = size * size;
+
+        mat_mul_reference(expected, a, b, size, size, size);
+        muls[size - 2](c, a, b);
+        ok = raw_equal(c, expected, count);
+        for (size_t i = 0; i < count; i++) p[i] = b[i];
+        muls[size - 2](p, a, p);
+        ok = ok && raw_equal(p, expected, count);
+
+        mat_mul_reference(expected, a, b, size, size, 1);
+        vecs[size - 2](c, a, b);
+        ok = ok && raw_equal(c, expected, size);
+        for (size_t i = 0; i < size; i++) v[i] = b[i];
+        vecs[size - 2](v, a, v);
+        ok = ok && raw_equal(v, expected, size);
+
+        snprintf(name, sizeof name, "mat%zu_mul / mat%zu_vec match the general path, in place", size, size);
+        TEST_ASSERT(ok, name);
+    }
+}
+
+// =============================================================================
+// DECIMAL TEXT TESTS
+// =============================================================================
+
+// Exact decimal of a raw value through printf: x / 65536 is exact in a
+// double, and 16 fractional digits print it without rounding
+static void exact_decimal(char* out, size_t size, q1516_t x) {
+    snprintf(out, size, "%.16f", q1516_to_double(x));
+    char* end = out + strlen(out);
+    while (end[-1] == '0') *--end = '\0';
+    if (end[-1] == '.') end[-1] = '\0';
+}
+
+static bool parses_to(const char* text, size_t expected_length, q1516_t expected) {
+    q1516_t value = 12345;
+    size_t length = q1516_from_chars(text, strlen(text), &value);
+    return length == expected_length && (expected_length == 0 ? value == 12345 : value == expected);
+}
+
+void test_chars() {
+    print_section("DECIMAL TEXT TESTS");
+
+    char text[Q1516_CHARS_MAX], reference[64];
+    bool ok;
+
+    q1516_to_chars(text, sizeof text, Q1516_MIN);
+    TEST_ASSERT(strcmp(text, "-32768") == 0, "to_chars(MIN) = \"-32768\"");
+    q1516_to_chars(text, sizeof text, -Q1516_MAX);
+    TEST_ASSERT(strcmp(text, "-32767.9999847412109375") == 0, "to_chars(-MAX) uses all 23 characters");
+    q1516_to_chars(text, sizeof text, q1516_from_float(-0.5f));
+    TEST_ASSERT(strcmp(text, "-0.5") == 0, "to_chars(-0.5) = \"-0.5\"");
+    q1516_to_chars(text, sizeof text, 1);
+    TEST_ASSERT(strcmp(text, "0.0000152587890625") == 0, "to_chars(1 ULP) is exact");
+    TEST_ASSERT(q1516_to_chars(text, 5, q1516_from_int(1234)) == 4 &&
+                q1516_to_chars(text, 4, q1516_from_int(1234)) == 0 && text[0] == '\0',
+                "to_chars needs room for the NUL, returns 0 otherwise");
+
+    ok = true;
+    for (int i = 0; i < 200000 && ok; i++) {
+        q1516_t x = (i < 65536) ? (q1516_t)(i * 32771) : random_raw();
+        size_t length = q1516_to_chars(text, sizeof text, x);
+        exact_decimal(reference, sizeof reference, x);
+        q1516_t back = 0;
+        ok = strcmp(text, reference) == 0 && length == strlen(reference) &&
+             q1516_from_chars(text, length, &back) == length && back == x;
+        if (!ok) printf("  raw %d: \"%s\", expected \"%s\"\n", x, text, reference);
+    }
+    TEST_ASSERT(ok, "to_chars matches exact printf and round-trips (200k values)");
+
+    ok = true;
+    for (int i = 0; i < 100000 && ok; i++) {
+        q1516_t x = random_raw();
+        int digits = i % 17;
+        q1516_to_chars_fixed(text, sizeof text, x, digits);
+        snprintf(reference, sizeof reference, "%.*f", digits, q1516_to_double(x));
+        ok = strcmp(text, reference) == 0;
+        if (!ok) printf("  raw %d, %d digits: \"%s\", printf \"%s\"\n", x, digits, text, reference);
+    }
+    TEST_ASSERT(ok, "to_chars_fixed matches printf(\"%.*f\") (100k values, 0..16 digits)");
+
+    q1516_to_chars_fixed(text, sizeof text, q1516_from_float(2.5f), 0);
+    q1516_to_chars_fixed(reference, sizeof reference, q1516_from_float(0.125f), 2);
+    TEST_ASSERT(strcmp(text, "2") == 0 && strcmp(reference, "0.12") == 0, "to_chars_fixed ties to even");
+    q1516_to_chars_fixed(text, sizeof text, -Q1516_MAX, 3);
+    TEST_ASSERT(strcmp(text, "-32768.000") == 0, "to_chars_fixed carries into the integer part");
+    q1516_to_chars_fixed(text, sizeof text, -1, 2);
+    TEST_ASSERT(strcmp(text, "-0.00") == 0, "to_chars_fixed keeps the sign of tiny negatives like printf");
+
+    // Parsing: rounding from arbitrarily many digits
+    TEST_ASSERT(parses_to("0.00000762939453125", 19, 0) && parses_to("0.0000228881835937500", 21, 2),
+                "from_chars: exact half ULP ties to even");
+    TEST_ASSERT(parses_to("0.000007629394531250000001", 26, 1) && parses_to("0.00000762939453124999", 22, 0),
+                "from_chars: digits far past the 16th decide near-ties");
+    TEST_ASSERT(parses_to("-0.00000762939453125001", 23, -1), "from_chars: negative values round symmetrically");
+    TEST_ASSERT(parses_to("32767.99999", 11, Q1516_MAX) && parses_to("32768", 5, Q1516_MAX) &&
+                parses_to("99999999999", 11, Q1516_MAX) && parses_to("-32768", 6, Q1516_MIN) &&
+                parses_to("-40000.5", 8, Q1516_MIN), "from_chars saturates out-of-range values");
+    TEST_ASSERT(parses_to("+3.", 3, q1516_from_int(3)) && parses_to(".25", 3, Q1516_ONE / 4) &&
+                parses_to("-0", 2, 0) && parses_to("12abc", 2, q1516_from_int(12)) &&
+                parses_to("1e5", 1, Q1516_ONE) && parses_to("7.x", 2, q1516_from_int(7)),
+                "from_chars accepts signs and bare points, stops at the first non-digit");
+    TEST_ASSERT(parses_to("", 0, 0) && parses_to("-", 0, 0) && parses_to(".", 0, 0) &&
+                parses_to("+.", 0, 0) && parses_to(" 1", 0, 0) && parses_to("abc", 0, 0),
+                "from_chars rejects text without digits");
+    q1516_t value = 0;
+    TEST_ASSERT(q1516_from_chars("1.5", 1, &value) == 1 && value == Q1516_ONE,
+                "from_chars reads no further than length");
+
+    // Random decimal strings against strtod + from_double (both round to nearest)
+    ok = true;
+    for (int i = 0; i < 100000 && ok; i++) {
+        snprintf(reference, sizeof reference, "%s%u.%0*u", (i & 1) ? "-" : "", (unsigned)random_raw() % 40000u,
+                 1 + i % 9, (unsigned)random_raw() % 1000000000u);
+        value = 0;
+        size_t length = q1516_from_chars(reference, strlen(reference), &value);
+        ok = length == strlen(reference) && value == q1516_from_double(strtod(reference, NULL));
+        if (!ok) printf("  \"%s\" -> raw %d\n", reference, value);
+    }
+    TEST_ASSERT(ok, "from_chars matches strtod + from_double (100k random decimals)");
+}
+
 // =============================================================================
 // PERFORMANCE DEMONSTRATION
 // =============================================================================
@@ -279,6 +1295,15 @@ int main() {
     test_arithmetic();
     test_utilities();
     test_edge_cases();
+    test_saturating();
+    test_rounding();
+    test_math();
+    test_fast_division();
+    test_batch();
+    test_dsp();
+    test_fft();
+    test_matrix();
+    test_chars();
     test_performance();
     demonstrate_library();
     
@@ -305,6 +1330,7 @@ int main() {
  * 1. CONVERSION TESTING:
  *    - Integer ↔ Fixed-point conversions
  *    - Float ↔ Fixed-point conversions  
+ *    - Round-to-nearest-even, saturation, infinities and NaN
  *    - Edge cases (max/min values)
  * 
  * 2. ARITHMETIC TESTING:
@@ -323,11 +1349,54 @@ int main() {
  *    - Large numbers (range limits)
  *    - Exact fractional representations
  * 
- * 5. PERFORMANCE TESTING:
+ * 5. SATURATING ARITHMETIC TESTING:
+ *    - Clamping at both ends for add/sub/mul/div
+ *    - Random sweep against a branchy reference
+ * 
+ * 6. ROUNDING TESTING:
+ *    - Tie cases for nearest and half-even multiply/divide
+ *    - Random sweep against a long double reference
+ *    - Accumulator error versus chained multiply + add
+ * 
+ * 7. TRANSCENDENTAL FUNCTION TESTING:
+ *    - Exact values (sqrt(4), sin(pi/2), log(e), ...) and edge inputs
+ *    - Random sweep checking the max-ULP figures documented in q1516_math.h
+ * 
+ * 8. RECIPROCAL / FAST DIVISION TESTING:
+ *    - q1516_reciprocal, q1516_divide_fast and q1516_divide_by
+ *    - Bit-exact against q1516_divide on edge and random pairs
+ * 
+ * 9. BATCH (SIMD) TESTING:
+ *    - Every array kernel, on every ISA the CPU supports
+ *    - Bit-exact against the scalar functions, including tails and aliasing
+ * 
+ * 10. DSP FILTER TESTING:
+ *    - FIR bit-exact against direct convolution on every ISA
+ *    - Biquad cascade against a double-precision reference
+ *    - Moving average exact for shift and division paths
+ *    - Uneven block sizes, in-place buffers and reset
+ * 
+ * 11. FFT TESTING:
+ *    - Every size against a double-precision DFT, forward and inverse
+ *    - Full-scale inputs under FIXED and DYNAMIC scaling (no overflow)
+ *    - AVX2 butterflies bit-exact against scalar
+ * 
+ * 12. MATRIX TESTING:
+ *    - mat_mul bit-exact against per-element dot products on every ISA,
+ *      with tails in every tile dimension
+ *    - Parallel path with several thread counts, saturation, rounding
+ *    - 2x2..8x8 specializations, including in-place use
+ * 
+ * 13. DECIMAL TEXT TESTING:
+ *    - to_chars against exact printf output, and round trips
+ *    - to_chars_fixed against printf("%.*f") for every digit count
+ *    - from_chars ties, long tails, saturation and malformed input
+ * 
+ * 14. PERFORMANCE TESTING:
  *    - Million-operation benchmark
  *    - Demonstrates speed of fixed-point math
  * 
- * 6. DEMONSTRATION:
+ * 15. DEMONSTRATION:
  *    - Shows library usage with real constants
  *    - Pretty-printed output examples
  */
\ No newline at end of file
@@ -0,0 +1,674 @@
+#define _POSIX_C_SOURCE 200809L  // clock_gettime(), sysconf() under -std=c99
+
+#include "q1516.h"
+#include "q1516_batch.h"
+#include "q1516_math.h"
+#include "q1516_chars.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @file verify_q1516.c
+ * @brief Exhaustive / randomized accuracy verification for the Q15.16 library
+ *
+ * test_q1516.c checks chosen values; this program checks whole input spaces
+ * so that optimized kernels can be trusted:
+ * - functions of one q1516_t (or float) are run on every one of the 2^32
+ *   inputs;
+ * - functions of two values are run on every pair of a set of edge values,
+ *   then on random pairs (2^28 by default) with random magnitudes.
+ *
+ * Each result is compared with an independent reference:
+ * - exact integer arithmetic for the rational operations (products and
+ *   shifted dividends are exact in 64 bits, rounding is decided on the
+ *   exact remainder), which must match bit for bit;
+ * - double-precision libm for the transcendental functions. A double
+ *   carries 53 bits for a 31-bit result, so the reference is off by less
+ *   than 2^-20 ULP and the measured error is the function's own.
+ *
+ * Work is split into contiguous shards, one per thread. For every function
+ * the report gives the maximum error in ULP of the output format, a
+ * histogram of |error|, and the first input (in sweep order) beyond the
+ * tolerance. Inputs are derived from their index, so any failure can be
+ * reproduced from the printed values alone.
+ *
+ * Usage: verify_q1516 [--quick] [--samples N] [--threads N] [--filter TEXT] [--seed S]
+ *   --quick     2^24 random inputs per function instead of the full sweep
+ *   --samples   random inputs per function (replaces the full sweep too)
+ *   --threads   worker threads (default: one per online CPU)
+ *   --filter    only verify functions whose name contains TEXT
+ *   --seed      seed for the random inputs (default 1516)
+ * Exit code is 1 when any function exceeds its tolerance.
+ */
+
+// =============================================================================
+// FUNCTIONS UNDER TEST
+// =============================================================================
+
+typedef void (*unary_block_t)(int32_t* out, const int32_t* in, size_t n);
+typedef void (*binary_block_t)(int32_t* out, const int32_t* a, const int32_t* b, size_t n);
+typedef double (*unary_ref_t)(int32_t x);
+typedef double (*binary_ref_t)(int32_t a, int32_t b);
+typedef int (*domain_t)(int32_t x);
+
+typedef struct {
+    const char* name;
+    unary_block_t unary;        // Exactly one of unary / binary is set
+    binary_block_t binary;
+    unary_ref_t unary_ref;      // Exact result, in ULP of the output
+    binary_ref_t binary_ref;
+    domain_t domain;            // Valid inputs of a unary function (NULL: all)
+    double tolerance;           // Max |error| in ULP; 0 = bit-exact
+    int per_isa;                // Batch kernel: verify once per supported ISA
+} verify_op_t;
+
+// Wrap a scalar expression of `x` (or `a`, `b`) into a block function
+#define UNARY_BLOCK(fn, EXPR) \
+    static void fn(int32_t* out, const int32_t* in, size_t n) { \
+        for (size_t i = 0; i < n; i++) { int32_t x = in[i]; out[i] = (int32_t)(EXPR); } \
+    }
+#define BINARY_BLOCK(fn, EXPR) \
+    static void fn(int32_t* out, const int32_t* in_a, const int32_t* in_b, size_t n) { \
+        for (size_t i = 0; i < n; i++) { int32_t a = in_a[i], b = in_b[i]; out[i] = (int32_t)(EXPR); } \
+    }
+
+// Float values travel through the engine as their bit patterns
+static float bits_to_float(int32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof value);
+    return value;
+}
+
+static int32_t float_to_bits(float value) {
+    int32_t bits;
+    memcpy(&bits, &value, sizeof bits);
+    return bits;
+}
+
+UNARY_BLOCK(run_from_int, q1516_from_int(x))
+UNARY_BLOCK(run_to_int, q1516_to_int(x))
+UNARY_BLOCK(run_from_float, q1516_from_float(bits_to_float(x)))
+UNARY_BLOCK(run_from_fine_double, q1516_from_double(ldexp((double)x, -18)))
+UNARY_BLOCK(run_to_float, float_to_bits(q1516_to_float(x)))
+UNARY_BLOCK(run_abs, q1516_abs(x))
+UNARY_BLOCK(run_integer_part, q1516_get_integer_part(x))
+UNARY_BLOCK(run_fractional_part, q1516_get_fractional_part(x))
+UNARY_BLOCK(run_sqrt, q1516_sqrt(x))
+UNARY_BLOCK(run_sin, q1516_sin(x))
+UNARY_BLOCK(run_cos, q1516_cos(x))
+UNARY_BLOCK(run_exp, q1516_exp(x))
+UNARY_BLOCK(run_log, q1516_log(x))
+UNARY_BLOCK(run_reciprocal, q1516_reciprocal(x))
+
+BINARY_BLOCK(run_add, q1516_add(a, b))
+BINARY_BLOCK(run_subtract, q1516_subtract(a, b))
+BINARY_BLOCK(run_multiply, q1516_multiply(a, b))
+BINARY_BLOCK(run_divide, q1516_divide(a, b))
+BINARY_BLOCK(run_add_sat, q1516_add_sat(a, b))
+BINARY_BLOCK(run_sub_sat, q1516_sub_sat(a, b))
+BINARY_BLOCK(run_mul_sat, q1516_mul_sat(a, b))
+BINARY_BLOCK(run_div_sat, q1516_div_sat(a, b))
+BINARY_BLOCK(run_multiply_round, q1516_multiply_round(a, b))
+BINARY_BLOCK(run_multiply_round_even, q1516_multiply_round_even(a, b))
+BINARY_BLOCK(run_divide_round, q1516_divide_round(a, b))
+BINARY_BLOCK(run_divide_round_even, q1516_divide_round_even(a, b))
+BINARY_BLOCK(run_acc_round, q1516_acc_round(q1516_mac(0, a, b), Q1516_ROUND_HALF_EVEN))
+BINARY_BLOCK(run_approximately_equal, q1516_approximately_equal(a, b, Q1516_ONE))
+BINARY_BLOCK(run_divide_fast, q1516_divide_fast(a, b))
+BINARY_BLOCK(run_atan2, q1516_atan2(a, b))
+
+static void run_divide_by(int32_t* out, const int32_t* a, const int32_t* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        q1516_divider_t divider = q1516_divider_init(b[i]);
+        out[i] = q1516_divide_by(&divider, a[i]);
+    }
+}
+
+// acc[i] += a[i] * b[i], starting from acc = a
+static void run_mac_n(int32_t* out, const int32_t* a, const int32_t* b, size_t n) {
+    memcpy(out, a, n * sizeof *out);
+    q1516_mac_n(out, a, b, n);
+}
+
+static void run_from_float_n(int32_t* out, const int32_t* in, size_t n) {
+    // in[] already holds float bit patterns
+    float values[1024];
+    for (size_t start = 0; start < n; start += 1024) {
+        size_t count = (n - start < 1024) ? n - start : 1024;
+        memcpy(values, in + start, count * sizeof *values);
+        q1516_from_float_n(out + start, values, count);
+    }
+}
+
+static void run_to_float_n(int32_t* out, const int32_t* in, size_t n) {
+    // float and int32_t have the same size: convert in place, reinterpret
+    float values[1024];
+    for (size_t start = 0; start < n; start += 1024) {
+        size_t count = (n - start < 1024) ? n - start : 1024;
+        q1516_to_float_n(values, in + start, count);
+        memcpy(out + start, values, count * sizeof *values);
+    }
+}
+
+// q1516_to_chars then q1516_from_chars: must give x back
+static void run_chars_round_trip(int32_t* out, const int32_t* in, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        char text[Q1516_CHARS_MAX];
+        size_t length = q1516_to_chars(text, sizeof text, in[i]);
+        q1516_t value = Q1516_MIN;
+        out[i] = (q1516_from_chars(text, length, &value) == length) ? value : (int32_t)~in[i];
+    }
+}
+
+// x / 2^18 written out exactly (18 fractional digits: x * 5^18 / 10^18),
+// then parsed: every tie and quarter point, like q1516_from_double above
+static void run_from_chars_fine(int32_t* out, const int32_t* in, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        uint32_t magnitude = in[i] < 0 ? 0u - (uint32_t)in[i] : (uint32_t)in[i];
+        char text[40];
+        int length = snprintf(text, sizeof text, "%s%u.%018llu", in[i] < 0 ? "-" : "", magnitude >> 18,
+                              (unsigned long long)(magnitude & 0x3FFFFu) * 3814697265625ULL);
+        q1516_t value = 0;
+        q1516_from_chars(text, (size_t)length, &value);
+        out[i] = value;
+    }
+}
+
+// =============================================================================
+// REFERENCES
+// =============================================================================
+
+// Two's complement wrap to 32 bits, as the non-saturating functions do
+static double wrap32(int64_t value) {
+    return (double)(int32_t)(uint32_t)(uint64_t)value;
+}
+
+static double clamp32(int64_t value) {
+    return value > Q1516_MAX ? (double)Q1516_MAX : value < Q1516_MIN ? (double)Q1516_MIN : (double)value;
+}
+
+// Floor division (C division truncates toward zero)
+static int64_t floor_div(int64_t num, int64_t den) {
+    int64_t q = num / den;
+    return (num % den != 0 && ((num < 0) != (den < 0))) ? q - 1 : q;
+}
+
+// num / den rounded to nearest: ties up (+inf) or to even
+static int64_t round_div(int64_t num, int64_t den, int ties_to_even) {
+    if (den < 0) { num = -num; den = -den; }
+    int64_t q = floor_div(num, den);
+    int64_t twice_rem = 2 * (num - q * den);     // in [0, 2 * den)
+    if (twice_rem > den || (twice_rem == den && (!ties_to_even || (q & 1)))) q++;
+    return q;
+}
+
+static double divide_by_zero(int32_t dividend) {
+    return dividend >= 0 ? (double)Q1516_MAX : (double)Q1516_MIN;
+}
+
+static double ref_from_int(int32_t x)    { return wrap32((int64_t)x * 65536); }
+static double ref_to_int(int32_t x)      { return (double)floor_div(x, 65536); }
+static double ref_identity(int32_t x)    { return (double)x; }
+static double ref_abs(int32_t x)         { return clamp32(llabs((long long)x)); }
+static double ref_integer_part(int32_t x) { return (double)((int64_t)x / 65536); }   // toward zero
+static double ref_fractional_part(int32_t x) { return (double)(llabs((long long)x) % 65536); }
+
+// nearbyint() rounds to nearest even in the default rounding mode
+static double ref_from_double(double value) {
+    double scaled = value * 65536.0;
+    if (isnan(scaled)) return 0.0;
+    scaled = nearbyint(scaled);
+    return scaled > Q1516_MAX ? (double)Q1516_MAX : scaled < Q1516_MIN ? (double)Q1516_MIN : scaled;
+}
+
+static double ref_from_float(int32_t bits) { return ref_from_double((double)bits_to_float(bits)); }
+
+// Inputs with 18 fractional bits: every tie and quarter point in +-8192
+static double ref_from_fine_double(int32_t x) { return ref_from_double(ldexp((double)x, -18)); }
+
+// x / 65536 is exact in double; the single rounding to float is the answer
+static double ref_to_float(int32_t x) {
+    return (double)float_to_bits((float)((double)x / 65536.0));
+}
+
+static double ref_sqrt(int32_t x) {
+    return x <= 0 ? 0.0 : sqrt((double)x * 65536.0);
+}
+
+static double ref_sin(int32_t x) { return sin((double)x / 65536.0) * 65536.0; }
+static double ref_cos(int32_t x) { return cos((double)x / 65536.0) * 65536.0; }
+
+static double ref_exp(int32_t x) {
+    double value = exp((double)x / 65536.0) * 65536.0;
+    return value > (double)Q1516_MAX ? (double)Q1516_MAX : value;
+}
+
+static double ref_log(int32_t x) {
+    return x <= 0 ? (double)Q1516_MIN : log((double)x / 65536.0) * 65536.0;
+}
+
+static double ref_reciprocal(int32_t x) {
+    return x == 0 ? (double)Q1516_MAX : wrap32(((int64_t)1 << 32) / x);
+}
+
+static double ref_add(int32_t a, int32_t b)      { return wrap32((int64_t)a + b); }
+static double ref_subtract(int32_t a, int32_t b) { return wrap32((int64_t)a - b); }
+static double ref_multiply(int32_t a, int32_t b) { return wrap32(floor_div((int64_t)a * b, 65536)); }
+static double ref_add_sat(int32_t a, int32_t b)  { return clamp32((int64_t)a + b); }
+static double ref_sub_sat(int32_t a, int32_t b)  { return clamp32((int64_t)a - b); }
+static double ref_mul_sat(int32_t a, int32_t b)  { return clamp32(floor_div((int64_t)a * b, 65536)); }
+
+static double ref_divide(int32_t a, int32_t b) {
+    return b == 0 ? divide_by_zero(a) : wrap32((int64_t)a * 65536 / b);
+}
+
+static double ref_div_sat(int32_t a, int32_t b) {
+    return b == 0 ? divide_by_zero(a) : clamp32((int64_t)a * 65536 / b);
+}
+
+static double ref_multiply_round(int32_t a, int32_t b) {
+    return wrap32(round_div((int64_t)a * b, 65536, 0));
+}
+
+static double ref_multiply_round_even(int32_t a, int32_t b) {
+    return wrap32(round_div((int64_t)a * b, 65536, 1));
+}
+
+static double ref_divide_round(int32_t a, int32_t b) {
+    return b == 0 ? divide_by_zero(a) : wrap32(round_div((int64_t)a * 65536, b, 0));
+}
+
+static double ref_divide_round_even(int32_t a, int32_t b) {
+    return b == 0 ? divide_by_zero(a) : wrap32(round_div((int64_t)a * 65536, b, 1));
+}
+
+static double ref_acc_round(int32_t a, int32_t b) {
+    return clamp32(round_div((int64_t)a * b, 65536, 1));
+}
+
+static double ref_approximately_equal(int32_t a, int32_t b) {
+    return llabs((int64_t)a - (int64_t)b) <= Q1516_ONE;
+}
+
+static double ref_mac(int32_t a, int32_t b) {
+    return wrap32((int64_t)a + (int64_t)ref_multiply(a, b));
+}
+
+static double ref_atan2(int32_t a, int32_t b) {
+    return (a == 0 && b == 0) ? 0.0 : atan2((double)a, (double)b) * 65536.0;
+}
+
+static const verify_op_t ops[] = {
+    // Unary: full 2^32 sweep
+    {"q1516_from_int", run_from_int, NULL, ref_from_int, NULL, NULL, 0, 0},
+    {"q1516_to_int", run_to_int, NULL, ref_to_int, NULL, NULL, 0, 0},
+    {"q1516_from_float", run_from_float, NULL, ref_from_float, NULL, NULL, 0, 0},
+    {"q1516_from_double (x / 2^18)", run_from_fine_double, NULL, ref_from_fine_double, NULL, NULL, 0, 0},
+    {"q1516_to_float", run_to_float, NULL, ref_to_float, NULL, NULL, 0, 0},
+    {"q1516_abs", run_abs, NULL, ref_abs, NULL, NULL, 0, 0},
+    {"q1516_get_integer_part", run_integer_part, NULL, ref_integer_part, NULL, NULL, 0, 0},
+    {"q1516_get_fractional_part", run_fractional_part, NULL, ref_fractional_part, NULL, NULL, 0, 0},
+    {"q1516_sqrt", run_sqrt, NULL, ref_sqrt, NULL, NULL, 0.5, 0},
+    {"q1516_sin", run_sin, NULL, ref_sin, NULL, NULL, 0.81, 0},
+    {"q1516_cos", run_cos, NULL, ref_cos, NULL, NULL, 0.81, 0},
+    {"q1516_exp", run_exp, NULL, ref_exp, NULL, NULL, 0.51, 0},
+    {"q1516_log", run_log, NULL, ref_log, NULL, NULL, 0.51, 0},
+    {"q1516_reciprocal", run_reciprocal, NULL, ref_reciprocal, NULL, NULL, 0, 0},
+    {"q1516_to_chars + from_chars", run_chars_round_trip, NULL, ref_identity, NULL, NULL, 0, 0},
+    {"q1516_from_chars (x / 2^18)", run_from_chars_fine, NULL, ref_from_fine_double, NULL, NULL, 0, 0},
+    {"q1516_from_float_n", run_from_float_n, NULL, ref_from_float, NULL, NULL, 0, 1},
+    {"q1516_to_float_n", run_to_float_n, NULL, ref_to_float, NULL, NULL, 0, 1},
+
+    // Binary: edge pairs + random pairs
+    {"q1516_add", NULL, run_add, NULL, ref_add, NULL, 0, 0},
+    {"q1516_subtract", NULL, run_subtract, NULL, ref_subtract, NULL, 0, 0},
+    {"q1516_multiply", NULL, run_multiply, NULL, ref_multiply, NULL, 0, 0},
+    {"q1516_divide", NULL, run_divide, NULL, ref_divide, NULL, 0, 0},
+    {"q1516_add_sat", NULL, run_add_sat, NULL, ref_add_sat, NULL, 0, 0},
+    {"q1516_sub_sat", NULL, run_sub_sat, NULL, ref_sub_sat, NULL, 0, 0},
+    {"q1516_mul_sat", NULL, run_mul_sat, NULL, ref_mul_sat, NULL, 0, 0},
+    {"q1516_div_sat", NULL, run_div_sat, NULL, ref_div_sat, NULL, 0, 0},
+    {"q1516_multiply_round", NULL, run_multiply_round, NULL, ref_multiply_round, NULL, 0, 0},
+    {"q1516_multiply_round_even", NULL, run_multiply_round_even, NULL, ref_multiply_round_even, NULL, 0, 0},
+    {"q1516_divide_round", NULL, run_divide_round, NULL, ref_divide_round, NULL, 0, 0},
+    {"q1516_divide_round_even", NULL, run_divide_round_even, NULL, ref_divide_round_even, NULL, 0, 0},
+    {"q1516_mac + q1516_acc_round", NULL, run_acc_round, NULL, ref_acc_round, NULL, 0, 0},
+    {"q1516_approximately_equal", NULL, run_approximately_equal, NULL, ref_approximately_equal, NULL, 0, 0},
+    {"q1516_divide_fast", NULL, run_divide_fast, NULL, ref_divide, NULL, 0, 0},
+    {"q1516_divide_by", NULL, run_divide_by, NULL, ref_divide, NULL, 0, 0},
+    {"q1516_atan2", NULL, run_atan2, NULL, ref_atan2, NULL, 0.59, 0},
+    {"q1516_add_n", NULL, q1516_add_n, NULL, ref_add, NULL, 0, 1},
+    {"q1516_mul_n", NULL, q1516_mul_n, NULL, ref_multiply, NULL, 0, 1},
+    {"q1516_mac_n", NULL, run_mac_n, NULL, ref_mac, NULL, 0, 1},
+    {"q1516_add_sat_n", NULL, q1516_add_sat_n, NULL, ref_add_sat, NULL, 0, 1},
+    {"q1516_sub_sat_n", NULL, q1516_sub_sat_n, NULL, ref_sub_sat, NULL, 0, 1},
+    {"q1516_mul_sat_n", NULL, q1516_mul_sat_n, NULL, ref_mul_sat, NULL, 0, 1},
+};
+
+#define OP_COUNT (sizeof ops / sizeof ops[0])
+
+// =============================================================================
+// INPUT GENERATION
+// =============================================================================
+
+// Values where fixed-point code usually goes wrong; binary functions see
+// every pair of these first
+static const int32_t edge_values[] = {
+    0, 1, -1, 2, -2, 0x7FFF, 0x8000, -0x8000, 0xFFFF, Q1516_ONE, -Q1516_ONE,
+    Q1516_ONE + 1, Q1516_ONE - 1, -Q1516_ONE - 1, 3 * Q1516_HALF, -3 * Q1516_HALF,
+    46340 << 8, 46341 << 8, 181 * Q1516_ONE, 182 * Q1516_ONE, -181 * Q1516_ONE,
+    0x7FFF0000, -0x7FFF0000, Q1516_MAX, Q1516_MAX - 1, Q1516_MIN, Q1516_MIN + 1,
+};
+
+#define EDGE_COUNT (sizeof edge_values / sizeof edge_values[0])
+#define EDGE_PAIRS ((uint64_t)EDGE_COUNT * EDGE_COUNT)
+
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+static uint64_t seed = 1516;
+
+// Random raw value with a random magnitude: uniform bits, then shifted
+// right by 0..23 so small values are as common as large ones
+static int32_t random_value(uint64_t index, uint64_t stream) {
+    uint64_t h = splitmix64(seed ^ splitmix64(index * 2 + stream));
+    return (int32_t)(uint32_t)h >> ((h >> 32) % 24);
+}
+
+static void make_unary_inputs(int32_t* in, uint64_t first, size_t n, int exhaustive) {
+    for (size_t i = 0; i < n; i++) {
+        uint64_t index = first + i;
+        // Uniform bits for the random unary case: float patterns need them
+        in[i] = exhaustive ? (int32_t)(uint32_t)index : (int32_t)(uint32_t)splitmix64(seed ^ index);
+    }
+}
+
+static void make_binary_inputs(int32_t* a, int32_t* b, uint64_t first, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        uint64_t index = first + i;
+        if (index < EDGE_PAIRS) {
+            a[i] = edge_values[index / EDGE_COUNT];
+            b[i] = edge_values[index % EDGE_COUNT];
+        } else {
+            a[i] = random_value(index, 0);
+            b[i] = random_value(index, 1);
+        }
+    }
+}
+
+// =============================================================================
+// VERIFICATION ENGINE
+// =============================================================================
+
+#define BLOCK_SIZE 4096
+#define NO_FAILURE UINT64_MAX
+
+// |error| buckets, in ULP
+static const double bucket_limits[] = {0.0, 0.25, 0.5, 0.75, 1.0, 2.0, 4.0, 16.0};
+static const char* bucket_names[] = {"0", "<=1/4", "<=1/2", "<=3/4", "<=1", "<=2", "<=4", "<=16", ">16"};
+#define BUCKETS (sizeof bucket_names / sizeof bucket_names[0])
+
+typedef struct {
+    uint64_t checked;
+    uint64_t skipped;           // Outside the function's domain
+    uint64_t failures;
+    uint64_t histogram[BUCKETS];
+    double max_error;
+    int32_t max_a, max_b;
+    uint64_t first_failure;     // Index in sweep order, NO_FAILURE if none
+    int32_t fail_a, fail_b, fail_got;
+    double fail_expected;
+} verify_stats_t;
+
+typedef struct {
+    const verify_op_t* op;
+    uint64_t begin, end;        // Shard [begin, end) of the input indices
+    int exhaustive;
+    verify_stats_t stats;
+} verify_shard_t;
+
+static void stats_init(verify_stats_t* stats) {
+    memset(stats, 0, sizeof *stats);
+    stats->first_failure = NO_FAILURE;
+}
+
+static void check_block(verify_shard_t* shard, const int32_t* a, const int32_t* b, const int32_t* got,
+                        const unsigned char* skip, uint64_t first, size_t n) {
+    const verify_op_t* op = shard->op;
+    verify_stats_t* stats = &shard->stats;
+
+    for (size_t i = 0; i < n; i++) {
+        if (skip[i]) {
+            stats->skipped++;
+            continue;
+        }
+        double expected = op->unary ? op->unary_ref(a[i]) : op->binary_ref(a[i], b[i]);
+        double error = fabs((double)got[i] - expected);
+
+        size_t bucket = 0;
+        while (bucket < BUCKETS - 1 && error > bucket_limits[bucket]) bucket++;
+        stats->histogram[bucket]++;
+        stats->checked++;
+
+        if (error > stats->max_error) {
+            stats->max_error = error;
+            stats->max_a = a[i];
+            stats->max_b = op->unary ? 0 : b[i];
+        }
+        if (error > op->tolerance) {
+            stats->failures++;
+            if (stats->first_failure == NO_FAILURE) {
+                stats->first_failure = first + i;
+                stats->fail_a = a[i];
+                stats->fail_b = op->unary ? 0 : b[i];
+                stats->fail_got = got[i];
+                stats->fail_expected = expected;
+            }
+        }
+    }
+}
+
+static void* verify_worker(void* arg) {
+    verify_shard_t* shard = (verify_shard_t*)arg;
+    const verify_op_t* op = shard->op;
+    int32_t* a = malloc(BLOCK_SIZE * sizeof *a);
+    int32_t* b = malloc(BLOCK_SIZE * sizeof *b);
+    int32_t* got = malloc(BLOCK_SIZE * sizeof *got);
+    unsigned char skip[BLOCK_SIZE];
+
+    stats_init(&shard->stats);
+    if (a == NULL || b == NULL || got == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(2);
+    }
+
+    for (uint64_t first = shard->begin; first < shard->end; first += BLOCK_SIZE) {
+        size_t n = (shard->end - first < BLOCK_SIZE) ? (size_t)(shard->end - first) : BLOCK_SIZE;
+        if (op->unary) {
+            make_unary_inputs(a, first, n, shard->exhaustive);
+            for (size_t i = 0; i < n; i++) {
+                // Out-of-domain inputs may be undefined behaviour: replace them
+                skip[i] = op->domain != NULL && !op->domain(a[i]);
+            }
+            memcpy(b, a, n * sizeof *a);
+            for (size_t i = 0; i < n; i++) {
+                if (skip[i]) b[i] = 0;
+            }
+            op->unary(got, b, n);
+        } else {
+            make_binary_inputs(a, b, first, n);
+            memset(skip, 0, n);
+            op->binary(got, a, b, n);
+        }
+        check_block(shard, a, b, got, skip, first, n);
+    }
+
+    free(a);
+    free(b);
+    free(got);
+    return NULL;
+}
+
+static void stats_merge(verify_stats_t* total, const verify_stats_t* part) {
+    total->checked += part->checked;
+    total->skipped += part->skipped;
+    total->failures += part->failures;
+    for (size_t i = 0; i < BUCKETS; i++) total->histogram[i] += part->histogram[i];
+    if (part->max_error > total->max_error) {
+        total->max_error = part->max_error;
+        total->max_a = part->max_a;
+        total->max_b = part->max_b;
+    }
+    if (part->first_failure < total->first_failure) {
+        total->first_failure = part->first_failure;
+        total->fail_a = part->fail_a;
+        total->fail_b = part->fail_b;
+        total->fail_got = part->fail_got;
+        total->fail_expected = part->fail_expected;
+    }
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void print_input(const char* label, int32_t value, int is_float) {
+    if (is_float) {
+        printf("%s0x%08X (%.9g)", label, (unsigned)value, (double)bits_to_float(value));
+    } else {
+        printf("%s0x%08X (%.6f)", label, (unsigned)value, value / 65536.0);
+    }
+}
+
+// Verify one function over `count` inputs; returns 1 if it passed
+static int verify_op(const verify_op_t* op, const char* name, uint64_t count, int exhaustive, int threads) {
+    verify_shard_t* shards = calloc((size_t)threads, sizeof *shards);
+    pthread_t* ids = calloc((size_t)threads, sizeof *ids);
+    if (shards == NULL || ids == NULL) {
+        fprintf(stderr, "Out of memory\n");
+        exit(2);
+    }
+
+    double start = now_seconds();
+    for (int t = 0; t < threads; t++) {
+        shards[t].op = op;
+        shards[t].begin = count / (uint64_t)threads * (uint64_t)t;
+        shards[t].end = (t == threads - 1) ? count : count / (uint64_t)threads * (uint64_t)(t + 1);
+        shards[t].exhaustive = exhaustive;
+        if (pthread_create(&ids[t], NULL, verify_worker, &shards[t]) != 0) {
+            fprintf(stderr, "pthread_create failed\n");
+            exit(2);
+        }
+    }
+
+    verify_stats_t total;
+    stats_init(&total);
+    for (int t = 0; t < threads; t++) {
+        pthread_join(ids[t], NULL);
+        stats_merge(&total, &shards[t].stats);
+    }
+    double elapsed = now_seconds() - start;
+
+    // Float outputs are compared as bit patterns: error is in float ULPs
+    int float_in = op->unary == run_from_float || op->unary == run_from_float_n;
+    int passed = total.failures == 0;
+    printf("%-34s %s  %12llu inputs%s  max %.4f ULP (tolerance %.2f)  %.1f s\n", name,
+           passed ? "PASS" : "FAIL", (unsigned long long)total.checked, exhaustive ? " (all)" : "",
+           total.max_error, op->tolerance, elapsed);
+    if (total.skipped != 0) {
+        printf("    %llu inputs outside the domain skipped\n", (unsigned long long)total.skipped);
+    }
+    if (total.max_error > 0) {
+        print_input("    worst at ", total.max_a, float_in);
+        if (op->binary) print_input(", ", total.max_b, 0);
+        printf("\n    |error|:");
+        for (size_t i = 0; i < BUCKETS; i++) {
+            if (total.histogram[i] != 0) {
+                printf(" %s: %llu", bucket_names[i], (unsigned long long)total.histogram[i]);
+            }
+        }
+        printf("\n");
+    }
+    if (!passed) {
+        printf("    %llu failures; first at input #%llu: ", (unsigned long long)total.failures,
+               (unsigned long long)total.first_failure);
+        print_input("", total.fail_a, float_in);
+        if (op->binary) print_input(", ", total.fail_b, 0);
+        printf(" -> got 0x%08X, expected %.4f\n", (unsigned)total.fail_got, total.fail_expected);
+    }
+
+    free(shards);
+    free(ids);
+    return passed;
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(int argc, char** argv) {
+    uint64_t samples = 0;           // 0: full sweep / default pair count
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    const char* filter = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            samples = 1u << 24;
+        } else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) {
+            samples = strtoull(argv[++i], NULL, 0);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = strtoull(argv[++i], NULL, 0);
+        } else {
+            fprintf(stderr, "Usage: %s [--quick] [--samples N] [--threads N] [--filter TEXT] [--seed S]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+    if (threads < 1) threads = 1;
+
+    printf("Q15.16 verification - %d thread(s), seed %llu\n", threads, (unsigned long long)seed);
+    printf("Unary functions: %s; binary functions: %d edge pairs + %llu random pairs\n\n",
+           samples ? "random inputs" : "all 2^32 inputs", (int)EDGE_PAIRS,
+           (unsigned long long)(samples ? samples : (1u << 28)));
+
+    int failed = 0;
+    q1516_isa_t best = q1516_batch_isa();
+    for (size_t k = 0; k < OP_COUNT; k++) {
+        const verify_op_t* op = &ops[k];
+        if (filter != NULL && strstr(op->name, filter) == NULL) continue;
+
+        int exhaustive = op->unary != NULL && samples == 0;
+        uint64_t count = op->unary ? (samples ? samples : (uint64_t)1 << 32)
+                                   : EDGE_PAIRS + (samples ? samples : (uint64_t)1 << 28);
+        int last_isa = op->per_isa ? (int)best : Q1516_ISA_SCALAR;
+        for (int isa = Q1516_ISA_SCALAR; isa <= last_isa; isa++) {
+            char name[64];
+            q1516_batch_set_isa((q1516_isa_t)isa);
+            if (op->per_isa) {
+                snprintf(name, sizeof name, "%s [%s]", op->name, q1516_isa_name((q1516_isa_t)isa));
+            } else {
+                snprintf(name, sizeof name, "%s", op->name);
+            }
+            failed += !verify_op(op, name, count, exhaustive, threads);
+        }
+        q1516_batch_set_isa(best);
+    }
+
+    printf("\n%s\n", failed ? "VERIFICATION FAILED" : "All functions within tolerance");
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,732 @@
+#define _POSIX_C_SOURCE 200112L  // For clock_gettime() and pthreads
+#include "../include/state_machine.h"
+#include "../include/state_machine_executor.h"
+#include "../include/state_machine_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+// ========================
+// BENCHMARK CONFIGURATION
+// ========================
+#define BENCH_EVENTS 4096         // Length of the pre-generated event stream
+#define BENCH_MIN_SECONDS 0.2     // The stream is replayed for at least this long
+#define BENCH_MAX_STATES 1024
+#define BENCH_MAX_TRANSITIONS 32768
+#define EVENT_STRIDE 4099         // Event IDs are spread over the 16-bit range
+#define QUEUE_PRODUCERS 4
+#define QUEUE_EVENTS_PER_PRODUCER (1 << 20)
+#define QUEUE_CAPACITY 1024
+#define EXECUTOR_MACHINES 10000
+#define EXECUTOR_QUEUE_CAPACITY 16
+#define EXECUTOR_EVENTS (1 << 21)
+#define HSM_GROUPS 8               // Hierarchy bench: ROOT > 8 groups > 8 leaves each
+#define HSM_LEAVES 8
+#define BATCH_SIZES_MAX 256        // Batch bench: largest batch handed to sm_process_events
+#define TRACE_CAPACITY (1 << 16)   // Trace bench: records in the ring
+#define TRACE_BATCH 32
+#define TIMER_COUNT (1 << 20)      // Timer bench: armed at once on one wheel
+#define POOL_MAX_INSTANCES (1 << 22)   // Pool bench: largest pool
+#define POOL_MACHINES (1 << 16)        // Pool bench: state_machine_t each, for comparison
+#define POOL_EVENTS (1 << 16)          // Length of the (instance, event) stream
+#define TIMER_MACHINES 1024
+#define TIMER_MAX_DELAY_MS 600000  // Delays spread over 10 minutes of 1 ms ticks
+
+typedef struct {
+    uint16_t num_states;
+    uint16_t num_events;          // Events accepted by every state
+} bench_shape_t;
+
+// Table size = states x events. Up to SM_MAX_STATES/SM_MAX_TRANSITIONS the
+// index lives inside state_machine_t (sm_init), beyond it in an arena.
+static const bench_shape_t shapes[] = {
+    {2, 2}, {4, 4}, {16, 2}, {64, 8}, {256, 16}, {1024, 32}
+};
+
+#define NUM_SHAPES (sizeof(shapes) / sizeof(shapes[0]))
+
+static sm_state_tab_t states[BENCH_MAX_STATES];
+static sm_transition_tab_t transitions[BENCH_MAX_TRANSITIONS];
+static uint16_t arena[SM_ARENA_WORDS(BENCH_MAX_STATES, BENCH_MAX_TRANSITIONS)];
+static sm_event_t events[BENCH_EVENTS];
+static volatile uint32_t action_calls;
+
+// ========================
+// HELPERS
+// ========================
+
+static uint32_t xorshift_state = 2463534242u;
+
+static uint32_t next_random(void) {
+    xorshift_state ^= xorshift_state << 13;
+    xorshift_state ^= xorshift_state >> 17;
+    xorshift_state ^= xorshift_state << 5;
+    return xorshift_state;
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void count_action(state_machine_t *sm, sm_state_t from, sm_state_t to, sm_event_t event) {
+    (void)sm; (void)from; (void)to; (void)event;
+    action_calls++;
+}
+
+// Every state accepts every event; the e-th event moves state s to
+// (s + e + 1) % states. Rows are shuffled so the table is in no useful order.
+static uint16_t build_tables(const bench_shape_t *shape) {
+    uint16_t count = 0;
+    for (uint16_t s = 0; s < shape->num_states; s++) {
+        states[s].state = s;
+        states[s].on_entry = NULL;
+        states[s].on_exit = NULL;
+        states[s].name = "S";
+    }
+    for (uint16_t s = 0; s < shape->num_states; s++) {
+        for (uint16_t e = 0; e < shape->num_events; e++) {
+            transitions[count].from_state = s;
+            transitions[count].event = (sm_event_t)(e * EVENT_STRIDE);
+            transitions[count].to_state = (sm_state_t)((s + e + 1) % shape->num_states);
+            transitions[count].action = count_action;
+            count++;
+        }
+    }
+    for (uint16_t i = count; i > 1; i--) {
+        uint16_t j = (uint16_t)(next_random() % i);
+        sm_transition_tab_t tmp = transitions[i - 1];
+        transitions[i - 1] = transitions[j];
+        transitions[j] = tmp;
+    }
+    for (int i = 0; i < BENCH_EVENTS; i++) {
+        events[i] = (sm_event_t)((next_random() % shape->num_events) * EVENT_STRIDE);
+    }
+    return count;
+}
+
+// ========================
+// REFERENCE: LINEAR SCAN
+// ========================
+
+// The dispatch sm_process_event used before the index: one scan of the
+// transition table and two of the state table per event
+static const sm_state_tab_t *linear_find_state(const state_machine_t *sm, sm_state_t state) {
+    for (uint16_t i = 0; i < sm->num_states; i++) {
+        if (sm->state_table[i].state == state) return &sm->state_table[i];
+    }
+    return NULL;
+}
+
+static sm_result_t linear_process_event(state_machine_t *sm, sm_event_t event) {
+    const sm_transition_tab_t *transition = NULL;
+    for (uint16_t i = 0; i < sm->num_transitions; i++) {
+        if (sm->transition_table[i].from_state == sm->current_state && sm->transition_table[i].event == event) {
+            transition = &sm->transition_table[i];
+            break;
+        }
+    }
+    if (transition == NULL) {
+        sm->invalid_event_count++;
+        return SM_ERROR_INVALID_EVENT;
+    }
+    const sm_state_tab_t *old_state_def = linear_find_state(sm, sm->current_state);
+    if (old_state_def && old_state_def->on_exit) old_state_def->on_exit(sm, sm->current_state);
+    if (transition->action) transition->action(sm, transition->from_state, transition->to_state, event);
+    sm->current_state = transition->to_state;
+    sm->transition_count++;
+    const sm_state_tab_t *new_state_def = linear_find_state(sm, sm->current_state);
+    if (new_state_def && new_state_def->on_entry) new_state_def->on_entry(sm, sm->current_state);
+    return SM_SUCCESS;
+}
+
+// ========================
+// MEASUREMENT
+// ========================
+
+// Events per second, replaying the stream until BENCH_MIN_SECONDS have passed
+static double measure(state_machine_t *sm, sm_result_t (*process)(state_machine_t *, sm_event_t)) {
+    sm_reset(sm);
+    double start = now_seconds();
+    double elapsed;
+    unsigned long rounds = 0;
+    do {
+        for (int i = 0; i < BENCH_EVENTS; i++) {
+            process(sm, events[i]);
+        }
+        rounds++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return (double)rounds * BENCH_EVENTS / elapsed;
+}
+
+// Both dispatchers must walk through the same states
+static bool same_path(state_machine_t *sm) {
+    state_machine_t reference = *sm;
+    sm_reset(sm);
+    sm_reset(&reference);
+    for (int i = 0; i < BENCH_EVENTS; i++) {
+        if (sm_process_event(sm, events[i]) != linear_process_event(&reference, events[i]) ||
+            sm->current_state != reference.current_state) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void bench_dispatch(void) {
+    printf("Dispatch vs table size (%d-event stream, %.1f s per measurement)\n\n",
+           BENCH_EVENTS, BENCH_MIN_SECONDS);
+    printf("%-12s %-7s %-7s %-7s %15s %15s %9s\n",
+           "Transitions", "States", "Events", "Index", "Linear (Mev/s)", "Indexed (Mev/s)", "Speedup");
+
+    for (size_t i = 0; i < NUM_SHAPES; i++) {
+        state_machine_t sm;
+        uint16_t num_transitions = build_tables(&shapes[i]);
+        bool inline_index = shapes[i].num_states <= SM_MAX_STATES && num_transitions <= SM_MAX_TRANSITIONS;
+        sm_result_t result = inline_index
+            ? sm_init(&sm, "Bench", 0, states, shapes[i].num_states, transitions, num_transitions)
+            : sm_init_with_arena(&sm, "Bench", 0, states, shapes[i].num_states, transitions, num_transitions,
+                                 arena, sizeof(arena));
+        if (result != SM_SUCCESS) {
+            printf("sm_init failed: %d\n", result);
+            exit(1);
+        }
+        if (!same_path(&sm)) {
+            printf("Indexed dispatch disagrees with the linear scan (%u transitions)\n", num_transitions);
+            exit(1);
+        }
+
+        double linear = measure(&sm, linear_process_event);
+        double indexed = measure(&sm, sm_process_event);
+        printf("%-12u %-7u %-7u %-7s %15.2f %15.2f %8.2fx\n",
+               num_transitions, shapes[i].num_states, shapes[i].num_events, inline_index ? "inline" : "arena",
+               linear / 1e6, indexed / 1e6, indexed / linear);
+    }
+}
+
+// ========================
+// BATCHES
+// ========================
+
+static uint32_t batch_size;
+
+// Events per second through sm_process_events, batch_size events per call
+static double measure_batches(state_machine_t *sm) {
+    sm_reset(sm);
+    double start = now_seconds();
+    double elapsed;
+    unsigned long rounds = 0;
+    do {
+        for (int i = 0; i < BENCH_EVENTS; i += (int)batch_size) {
+            sm_process_events(sm, &events[i], batch_size, NULL);
+        }
+        rounds++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return (double)rounds * BENCH_EVENTS / elapsed;
+}
+
+static void bench_batches(void) {
+    static const bench_shape_t batch_shapes[] = {{4, 4}, {64, 8}};
+    static const uint32_t batch_sizes[] = {8, 32, BATCH_SIZES_MAX};
+    static sm_deferred_t calls[BATCH_SIZES_MAX];
+
+    printf("\nBatched dispatch: sm_process_events vs one sm_process_event per event\n\n");
+    printf("%-12s %-7s %15s %15s %15s\n", "Transitions", "Batch", "Single (Mev/s)", "Batch (Mev/s)", "Deferred (Mev/s)");
+
+    for (size_t i = 0; i < sizeof(batch_shapes) / sizeof(batch_shapes[0]); i++) {
+        state_machine_t sm;
+        uint16_t num_transitions = build_tables(&batch_shapes[i]);
+        if (sm_init_with_arena(&sm, "Batch", 0, states, batch_shapes[i].num_states, transitions, num_transitions,
+                               arena, sizeof(arena)) != SM_SUCCESS) {
+            printf("sm_init failed\n");
+            exit(1);
+        }
+        double single = measure(&sm, sm_process_event);
+
+        for (size_t j = 0; j < sizeof(batch_sizes) / sizeof(batch_sizes[0]); j++) {
+            batch_size = batch_sizes[j];
+            sm_set_deferred_callbacks(&sm, NULL, 0);
+            double batched = measure_batches(&sm);
+            sm_set_deferred_callbacks(&sm, calls, batch_size);
+            double deferred = measure_batches(&sm);
+            sm_set_deferred_callbacks(&sm, NULL, 0);
+            printf("%-12u %-7u %15.2f %15.2f %15.2f\n", num_transitions, batch_size,
+                   single / 1e6, batched / 1e6, deferred / 1e6);
+        }
+    }
+}
+
+// ========================
+// TRACING
+// ========================
+
+// Cost per event of tracing into a ring, per clock, one event per call and in batches
+static void bench_trace(void) {
+    static sm_trace_record_t records[TRACE_CAPACITY];
+    static const bench_shape_t shape = {64, 8};
+    static const struct {
+        const char *name;
+        sm_trace_clock_t clock;
+    } clocks[] = {{"cycles", SM_TRACE_CLOCK_CYCLES}, {"coarse", SM_TRACE_CLOCK_COARSE}};
+    sm_trace_ring_t ring;
+    state_machine_t sm;
+
+    uint16_t num_transitions = build_tables(&shape);
+    if (sm_init_with_arena(&sm, "Trace", 0, states, shape.num_states, transitions, num_transitions,
+                           arena, sizeof(arena)) != SM_SUCCESS) {
+        printf("sm_init failed\n");
+        exit(1);
+    }
+
+    printf("\nTracing: %u transitions, %d-record ring, batches of %d\n\n", num_transitions, TRACE_CAPACITY, TRACE_BATCH);
+    printf("%-10s %15s %15s %15s %15s\n", "Clock", "Single (Mev/s)", "ns/event added", "Batch (Mev/s)", "ns/event added");
+
+    batch_size = TRACE_BATCH;
+    double single = measure(&sm, sm_process_event);
+    double batched = measure_batches(&sm);
+    printf("%-10s %15.2f %15s %15.2f %15s\n", "off", single / 1e6, "-", batched / 1e6, "-");
+
+    for (size_t i = 0; i < sizeof(clocks) / sizeof(clocks[0]); i++) {
+        sm_trace_init(&ring, records, TRACE_CAPACITY, clocks[i].clock);
+        sm_trace_attach(&sm, &ring, 1);
+        double traced = measure(&sm, sm_process_event);
+        double traced_batches = measure_batches(&sm);
+        sm_trace_attach(&sm, NULL, 0);
+        printf("%-10s %15.2f %15.1f %15.2f %15.1f\n", clocks[i].name,
+               traced / 1e6, 1e9 / traced - 1e9 / single, traced_batches / 1e6, 1e9 / traced_batches - 1e9 / batched);
+    }
+}
+
+// ========================
+// METRICS (make bench METRICS=1)
+// ========================
+
+#ifdef SM_METRICS
+// Cost per event of recording dwell times, callback durations and hits
+static void bench_metrics(void) {
+    static const bench_shape_t shape = {64, 8};
+    static uint64_t metrics_arena[SM_METRICS_ARENA_SIZE(64, 64 * 8) / sizeof(uint64_t)];
+    sm_metrics_t metrics;
+    state_machine_t sm;
+
+    uint16_t num_transitions = build_tables(&shape);
+    if (sm_init_with_arena(&sm, "Metrics", 0, states, shape.num_states, transitions, num_transitions,
+                           arena, sizeof(arena)) != SM_SUCCESS) {
+        printf("sm_init failed\n");
+        exit(1);
+    }
+
+    double off = measure(&sm, sm_process_event);
+    sm_metrics_attach(&sm, &metrics, metrics_arena, sizeof(metrics_arena));
+    double on = measure(&sm, sm_process_event);
+    sm_transition_metrics_t first;
+    sm_metrics_get_transition(&sm, transitions[0].from_state, transitions[0].event, &first);
+    sm_metrics_attach(&sm, NULL, NULL, 0);
+
+    printf("\nMetrics: %u transitions, one action each\n\n", num_transitions);
+    printf("%-10s %15s %15s\n", "Metrics", "Single (Mev/s)", "ns/event added");
+    printf("%-10s %15.2f %15s\n", "off", off / 1e6, "-");
+    printf("%-10s %15.2f %15.1f\n", "on", on / 1e6, 1e9 / on - 1e9 / off);
+    printf("(first transition: %llu hits, action p50 %llu ns, p99 %llu ns)\n", (unsigned long long)first.hits,
+           (unsigned long long)sm_histogram_percentile(&first.action, 50),
+           (unsigned long long)sm_histogram_percentile(&first.action, 99));
+}
+#endif
+
+// ========================
+// HIERARCHY
+// ========================
+
+#define HSM_STATES (HSM_GROUPS * HSM_LEAVES + HSM_GROUPS + 1)
+#define HSM_ROOT (HSM_GROUPS * HSM_LEAVES + HSM_GROUPS)
+
+static sm_hierarchy_tab_t hierarchy[HSM_STATES];
+static uint16_t hierarchy_arena[4096];
+
+// Leaves 0..63 in groups 64..71 under ROOT. Event 0 moves to the next leaf of
+// the group (defined on each leaf), event 1 to the next group (on each group),
+// event 2 back to the start (on ROOT). The flat table spells out the same
+// moves on every leaf, with the target leaf resolved by hand.
+static uint16_t build_hierarchy(bool flat) {
+    uint16_t count = 0;
+    for (uint16_t s = 0; s < HSM_STATES; s++) {
+        states[s].state = s;
+        states[s].on_entry = NULL;
+        states[s].on_exit = NULL;
+        states[s].name = "S";
+    }
+    for (uint16_t leaf = 0; leaf < HSM_GROUPS * HSM_LEAVES; leaf++) {
+        uint16_t group = leaf / HSM_LEAVES;
+        sm_transition_tab_t next_leaf = {leaf, 0, (sm_state_t)(group * HSM_LEAVES + (leaf + 1) % HSM_LEAVES), count_action};
+        transitions[count++] = next_leaf;
+        if (flat) {
+            sm_transition_tab_t next_group = {leaf, 1, (sm_state_t)((group + 1) % HSM_GROUPS * HSM_LEAVES), count_action};
+            sm_transition_tab_t restart = {leaf, 2, 0, count_action};
+            transitions[count++] = next_group;
+            transitions[count++] = restart;
+        }
+        sm_hierarchy_tab_t node = {leaf, (sm_state_t)(HSM_GROUPS * HSM_LEAVES + group), SM_NO_STATE, 0};
+        hierarchy[leaf] = node;
+    }
+    for (uint16_t group = 0; group < HSM_GROUPS; group++) {
+        sm_state_t state = (sm_state_t)(HSM_GROUPS * HSM_LEAVES + group);
+        sm_transition_tab_t next_group = {state, 1, (sm_state_t)(HSM_GROUPS * HSM_LEAVES + (group + 1) % HSM_GROUPS), count_action};
+        sm_hierarchy_tab_t node = {state, HSM_ROOT, (sm_state_t)(group * HSM_LEAVES), 0};
+        if (!flat) transitions[count++] = next_group;
+        hierarchy[state] = node;
+    }
+    sm_transition_tab_t restart = {HSM_ROOT, 2, HSM_ROOT, count_action};
+    sm_hierarchy_tab_t root = {HSM_ROOT, SM_NO_STATE, HSM_GROUPS * HSM_LEAVES, 0};
+    if (!flat) transitions[count++] = restart;
+    hierarchy[HSM_ROOT] = root;
+    return count;
+}
+
+static void bench_hierarchy(void) {
+    printf("\nHierarchical vs flat table: %d leaves in %d groups, 3 events\n\n", HSM_GROUPS * HSM_LEAVES, HSM_GROUPS);
+    printf("%-12s %-12s %15s\n", "Table", "Transitions", "Mev/s");
+
+    for (int i = 0; i < BENCH_EVENTS; i++) {
+        events[i] = (sm_event_t)(next_random() % 16 < 13 ? 0 : 1 + next_random() % 2);
+    }
+
+    // The hierarchy gets its own copy of the tables, the flat machine uses the shared ones
+    static sm_state_tab_t hsm_states[HSM_STATES];
+    static sm_transition_tab_t hsm_transitions[HSM_STATES];
+    uint16_t num_transitions = build_hierarchy(false);
+    memcpy(hsm_states, states, sizeof(hsm_states));
+    memcpy(hsm_transitions, transitions, num_transitions * sizeof(sm_transition_tab_t));
+    sm_state_t initial = HSM_ROOT;
+    sm_hierarchy_def_t def = {hsm_states, HSM_STATES, hsm_transitions, num_transitions, hierarchy, HSM_STATES, &initial, 1};
+    state_machine_t hsm;
+    sm_result_t result = sm_init_hierarchical(&hsm, "Hierarchy", &def, hierarchy_arena, sizeof(hierarchy_arena));
+    if (result != SM_SUCCESS) {
+        printf("sm_init_hierarchical failed: %d\n", result);
+        exit(1);
+    }
+
+    state_machine_t flat_sm;
+    uint16_t flat_transitions = build_hierarchy(true);
+    if (sm_init_with_arena(&flat_sm, "Flat", 0, states, HSM_GROUPS * HSM_LEAVES, transitions, flat_transitions,
+                           arena, sizeof(arena)) != SM_SUCCESS) {
+        printf("sm_init failed\n");
+        exit(1);
+    }
+
+    sm_reset(&flat_sm);
+    sm_reset(&hsm);
+    for (int i = 0; i < BENCH_EVENTS; i++) {
+        sm_process_event(&flat_sm, events[i]);
+        sm_process_event(&hsm, events[i]);
+        if (flat_sm.current_state != hsm.current_state) {
+            printf("Hierarchical dispatch disagrees with the flat table\n");
+            exit(1);
+        }
+    }
+    double flat = measure(&flat_sm, sm_process_event);
+    double hierarchical = measure(&hsm, sm_process_event);
+
+    printf("%-12s %-12u %15.2f\n", "flat", flat_transitions, flat / 1e6);
+    printf("%-12s %-12u %15.2f\n", "hierarchy", num_transitions, hierarchical / 1e6);
+}
+
+// ========================
+// EVENT QUEUE VS MUTEX
+// ========================
+
+static state_machine_t shared_sm;
+static pthread_mutex_t shared_lock = PTHREAD_MUTEX_INITIALIZER;
+static sm_queue_slot_t queue_slots[QUEUE_CAPACITY];
+
+// Producers posting to the queue; a full queue is retried, not lost
+static void *post_events(void *arg) {
+    (void)arg;
+    for (int i = 0; i < QUEUE_EVENTS_PER_PRODUCER; i++) {
+        while (sm_post_event(&shared_sm, events[i % BENCH_EVENTS]) == SM_ERROR_QUEUE_FULL) {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// The alternative: every producer takes a lock and dispatches itself
+static void *process_locked(void *arg) {
+    (void)arg;
+    for (int i = 0; i < QUEUE_EVENTS_PER_PRODUCER; i++) {
+        pthread_mutex_lock(&shared_lock);
+        sm_process_event(&shared_sm, events[i % BENCH_EVENTS]);
+        pthread_mutex_unlock(&shared_lock);
+    }
+    return NULL;
+}
+
+static double run_producers(void *(*producer)(void *), bool drain) {
+    pthread_t threads[QUEUE_PRODUCERS];
+    uint32_t total = (uint32_t)QUEUE_PRODUCERS * QUEUE_EVENTS_PER_PRODUCER;
+    double start = now_seconds();
+    for (int i = 0; i < QUEUE_PRODUCERS; i++) {
+        pthread_create(&threads[i], NULL, producer, NULL);
+    }
+    // This thread owns the machine and drains the queue
+    uint32_t done = 0;
+    while (drain && done < total) {
+        uint32_t dispatched;
+        sm_dispatch_pending(&shared_sm, 0, &dispatched);
+        if (dispatched == 0) sched_yield();
+        done += dispatched;
+    }
+    for (int i = 0; i < QUEUE_PRODUCERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return (double)total / (now_seconds() - start);
+}
+
+static void bench_queue(void) {
+    printf("\n%d producer threads x %d events into one machine (queue capacity %d)\n\n",
+           QUEUE_PRODUCERS, QUEUE_EVENTS_PER_PRODUCER, QUEUE_CAPACITY);
+
+    bench_shape_t shape = {16, 2};
+    uint16_t num_transitions = build_tables(&shape);
+    sm_init(&shared_sm, "Shared", 0, states, shape.num_states, transitions, num_transitions);
+    double locked = run_producers(process_locked, false);
+
+    sm_init(&shared_sm, "Shared", 0, states, shape.num_states, transitions, num_transitions);
+    sm_queue_init(&shared_sm, queue_slots, QUEUE_CAPACITY);
+    double queued = run_producers(post_events, true);
+
+    sm_queue_stats_t stats;
+    sm_get_queue_stats(&shared_sm, &stats);
+    printf("%-34s %10.2f Mev/s\n", "Mutex + sm_process_event", locked / 1e6);
+    printf("%-34s %10.2f Mev/s\n", "sm_post_event + sm_dispatch_pending", queued / 1e6);
+    printf("Queue: %lu posted, %lu dispatched, max depth %lu, %lu full (retried)\n",
+           (unsigned long)stats.posted, (unsigned long)stats.dispatched,
+           (unsigned long)stats.max_depth, (unsigned long)stats.dropped);
+}
+
+// ========================
+// EXECUTOR
+// ========================
+
+static state_machine_t executor_sms[EXECUTOR_MACHINES];
+static sm_queue_slot_t executor_slots[EXECUTOR_MACHINES][EXECUTOR_QUEUE_CAPACITY];
+
+static void run_executor(uint32_t num_workers, const bench_shape_t *shape, uint16_t num_transitions) {
+    sm_executor_t executor;
+    size_t arena_size = sm_executor_arena_size(EXECUTOR_MACHINES, num_workers);
+    void *executor_arena = malloc(arena_size);
+    if (!executor_arena || sm_executor_init(&executor, EXECUTOR_MACHINES, num_workers, executor_arena, arena_size) != SM_SUCCESS) {
+        printf("sm_executor_init failed\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < EXECUTOR_MACHINES; i++) {
+        uint32_t id;
+        sm_init(&executor_sms[i], "Connection", 0, states, shape->num_states, transitions, num_transitions);
+        sm_queue_init(&executor_sms[i], executor_slots[i], EXECUTOR_QUEUE_CAPACITY);
+        sm_executor_add(&executor, &executor_sms[i], &id);
+    }
+
+    // One producer spreading events over the machines, like a network poller
+    sm_executor_start(&executor);
+    uint32_t full = 0;
+    for (uint32_t i = 0; i < EXECUTOR_EVENTS; i++) {
+        uint32_t id = (i * 7919u) % EXECUTOR_MACHINES;
+        while (sm_executor_post(&executor, id, events[i % BENCH_EVENTS]) == SM_ERROR_QUEUE_FULL) {
+            full++;
+            sched_yield();
+        }
+    }
+    sm_executor_stop(&executor);
+
+    sm_executor_stats_t stats;
+    sm_executor_get_stats(&executor, &stats);
+    uint64_t latency_sum = 0, latency_max = 0;
+    for (uint32_t id = 0; id < EXECUTOR_MACHINES; id++) {
+        sm_executor_machine_stats_t machine;
+        sm_executor_get_machine_stats(&executor, id, &machine);
+        latency_sum += machine.latency_avg_ns;
+        if (machine.latency_max_ns > latency_max) latency_max = machine.latency_max_ns;
+    }
+    printf("%-8u %12.2f %10llu %10llu %14.1f %14.1f %10lu\n",
+           num_workers, stats.events_per_second / 1e6,
+           (unsigned long long)stats.runs, (unsigned long long)stats.steals,
+           (double)latency_sum / EXECUTOR_MACHINES / 1e3, (double)latency_max / 1e3, (unsigned long)full);
+    free(executor_arena);
+}
+
+static void bench_executor(void) {
+    printf("\nExecutor: %d machines, %d events from one producer\n\n", EXECUTOR_MACHINES, EXECUTOR_EVENTS);
+    printf("%-8s %12s %10s %10s %14s %14s %10s\n",
+           "Workers", "Mev/s", "Runs", "Steals", "Avg lat (us)", "Max lat (us)", "Full");
+
+    bench_shape_t shape = {4, 4};
+    uint16_t num_transitions = build_tables(&shape);
+    uint32_t worker_counts[] = {1, 2, 4};
+    for (size_t i = 0; i < sizeof(worker_counts) / sizeof(worker_counts[0]); i++) {
+        run_executor(worker_counts[i], &shape, num_transitions);
+    }
+}
+
+// ========================
+// TIMER WHEEL
+// ========================
+
+static void bench_timers(void) {
+    printf("\nTimer wheel: %d timers on %d machines, 1 ms ticks, delays up to %d ms\n\n",
+           TIMER_COUNT, TIMER_MACHINES, TIMER_MAX_DELAY_MS);
+
+    // One state that turns every timeout into a counted self-transition
+    static const sm_state_tab_t timer_states[] = {{0, NULL, NULL, "WAITING"}};
+    static const sm_transition_tab_t timer_transitions[] = {{0, 0, 0, count_action}};
+    static state_machine_t timer_sms[TIMER_MACHINES];
+    for (int i = 0; i < TIMER_MACHINES; i++) {
+        sm_init(&timer_sms[i], "Session", 0, timer_states, 1, timer_transitions, 1);
+    }
+
+    sm_timer_wheel_t *wheel = malloc(sizeof(sm_timer_wheel_t));
+    size_t arena_size = sm_timer_arena_size(TIMER_COUNT);
+    void *timer_arena = malloc(arena_size);
+    uint32_t *delays = malloc(TIMER_COUNT * sizeof(uint32_t));
+    if (!wheel || !timer_arena || !delays || sm_timer_init(wheel, 1, TIMER_COUNT, timer_arena, arena_size) != SM_SUCCESS) {
+        printf("sm_timer_init failed\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < TIMER_COUNT; i++) {
+        uint32_t id;
+        sm_timer_create(wheel, &timer_sms[i % TIMER_MACHINES], &id);
+        delays[i] = 1 + next_random() % TIMER_MAX_DELAY_MS;
+    }
+
+    double start = now_seconds();
+    for (uint32_t i = 0; i < TIMER_COUNT; i++) sm_timer_arm(wheel, i, delays[i], 0);
+    double arm = now_seconds() - start;
+
+    // Cancel and re-arm every other timer, as a machine leaving a state early would
+    start = now_seconds();
+    for (uint32_t i = 0; i < TIMER_COUNT; i += 2) sm_timer_cancel(wheel, i);
+    double cancel = now_seconds() - start;
+    for (uint32_t i = 0; i < TIMER_COUNT; i += 2) sm_timer_arm(wheel, i, delays[i], 0);
+
+    uint32_t before = action_calls;
+    uint32_t expired;
+    start = now_seconds();
+    sm_timer_advance(wheel, TIMER_MAX_DELAY_MS, &expired);
+    double expire = now_seconds() - start;
+
+    sm_timer_stats_t stats;
+    sm_timer_get_stats(wheel, &stats);
+    if (expired != TIMER_COUNT || action_calls - before != TIMER_COUNT || stats.armed != 0) {
+        printf("Timer wheel lost timers: %u expired, %u armed\n", expired, stats.armed);
+        exit(1);
+    }
+    printf("%-28s %10.1f\n", "Arm (ns/timer)", arm * 1e9 / TIMER_COUNT);
+    printf("%-28s %10.1f\n", "Cancel (ns/timer)", cancel * 1e9 / (TIMER_COUNT / 2));
+    printf("%-28s %10.2f\n", "Expire + dispatch (M/s)", TIMER_COUNT / expire / 1e6);
+    printf("%-28s %10.2f\n", "Cascades per timer", (double)stats.cascaded / TIMER_COUNT);
+
+    free(delays);
+    free(timer_arena);
+    free(wheel);
+}
+
+// ========================
+// INSTANCE POOLS
+// ========================
+
+static uint32_t pool_ids[POOL_EVENTS];
+static sm_event_t pool_events[POOL_EVENTS];
+
+static void make_pool_stream(uint32_t num_instances) {
+    for (int i = 0; i < POOL_EVENTS; i++) {
+        pool_ids[i] = next_random() % num_instances;
+        pool_events[i] = events[i % BENCH_EVENTS];
+    }
+}
+
+static double measure_machines(state_machine_t *machines) {
+    double start = now_seconds();
+    double elapsed;
+    unsigned long rounds = 0;
+    do {
+        for (int i = 0; i < POOL_EVENTS; i++) {
+            sm_process_event(&machines[pool_ids[i]], pool_events[i]);
+        }
+        rounds++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return (double)rounds * POOL_EVENTS / elapsed;
+}
+
+static double measure_pool(sm_pool_t *pool) {
+    double start = now_seconds();
+    double elapsed;
+    unsigned long rounds = 0;
+    do {
+        sm_pool_process_event(pool, pool_ids, pool_events, POOL_EVENTS, NULL);
+        rounds++;
+        elapsed = now_seconds() - start;
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return (double)rounds * POOL_EVENTS / elapsed;
+}
+
+// Events to randomly chosen instances: a state_machine_t each vs one pool
+static void bench_pools(void) {
+    static const bench_shape_t shape = {4, 4};
+    static const uint32_t pool_sizes[] = {POOL_MACHINES, 1 << 20, POOL_MAX_INSTANCES};
+    static sm_type_t type;
+    static sm_pool_t pool;
+
+    uint16_t num_transitions = build_tables(&shape);
+    for (uint16_t i = 0; i < num_transitions; i++) {
+        transitions[i].action = NULL;
+    }
+    state_machine_t *machines = malloc(POOL_MACHINES * sizeof(state_machine_t));
+    void *pool_arena = malloc(SM_POOL_ARENA_SIZE(POOL_MAX_INSTANCES));
+    if (!machines || !pool_arena || sm_type_init(&type, "Pool", 0, states, shape.num_states, transitions, num_transitions, NULL, 0) != SM_SUCCESS) {
+        printf("Pool bench setup failed\n");
+        exit(1);
+    }
+
+    printf("\nInstance pools: %u transitions, no callbacks, events to random instances\n\n", num_transitions);
+    printf("%-10s %-18s %12s %12s %15s\n", "Instances", "Storage", "Bytes each", "Total (MB)", "Mev/s");
+
+    for (uint32_t i = 0; i < POOL_MACHINES; i++) {
+        sm_init(&machines[i], "Machine", 0, states, shape.num_states, transitions, num_transitions);
+    }
+    make_pool_stream(POOL_MACHINES);
+    double separate = measure_machines(machines);
+    printf("%-10u %-18s %12zu %12.1f %15.2f\n", POOL_MACHINES, "state_machine_t", sizeof(state_machine_t),
+           (double)POOL_MACHINES * sizeof(state_machine_t) / 1e6, separate / 1e6);
+
+    for (size_t i = 0; i < sizeof(pool_sizes) / sizeof(pool_sizes[0]); i++) {
+        sm_pool_init(&pool, &type, pool_sizes[i], pool_arena, SM_POOL_ARENA_SIZE(POOL_MAX_INSTANCES));
+        make_pool_stream(pool_sizes[i]);
+        double pooled = measure_pool(&pool);
+        printf("%-10u %-18s %12zu %12.1f %15.2f\n", pool_sizes[i], "pool", SM_POOL_ARENA_SIZE(1),
+               (double)SM_POOL_ARENA_SIZE(pool_sizes[i]) / 1e6, pooled / 1e6);
+    }
+
+    free(pool_arena);
+    free(machines);
+}
+
+int main(void) {
+    printf("State machine benchmark\n=======================\n\n");
+    bench_dispatch();
+    bench_batches();
+    bench_trace();
+#ifdef SM_METRICS
+    bench_metrics();
+#endif
+    bench_hierarchy();
+    bench_timers();
+    bench_pools();
+    bench_queue();
+    bench_executor();
+    printf("\n(%lu actions run)\n", (unsigned long)action_calls);
+    return 0;
+}
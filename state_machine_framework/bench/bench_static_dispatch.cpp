@@ -0,0 +1,112 @@
+#include "../include/state_machine_static.hpp"
+#include <array>
+#include <chrono>
+#include <cstdio>
+
+// ========================
+// BENCHMARK CONFIGURATION
+// ========================
+constexpr int BENCH_EVENTS = 4096;        // Length of the pre-generated event stream
+constexpr double BENCH_MIN_SECONDS = 0.2; // The stream is replayed for at least this long
+
+static volatile std::uint32_t action_calls;
+
+static void count_action(state_machine_t *, sm_state_t, sm_state_t, sm_event_t) {
+    action_calls = action_calls + 1;
+}
+
+// ========================
+// TABLES
+// ========================
+
+// Traffic light: 4 states, 11 transitions, as in exemples/traffic_light.c
+constexpr sm_state_tab_t traffic_states[] = {
+    {0, nullptr, nullptr, "RED"}, {1, nullptr, nullptr, "RED_YELLOW"},
+    {2, nullptr, nullptr, "GREEN"}, {3, nullptr, nullptr, "YELLOW"}
+};
+constexpr sm_transition_tab_t traffic_transitions[] = {
+    {0, 0, 1, count_action}, {1, 0, 2, count_action}, {2, 0, 3, count_action}, {3, 0, 0, count_action},
+    {1, 1, 0, count_action}, {2, 1, 0, count_action}, {3, 1, 0, count_action},
+    {0, 2, 0, count_action}, {1, 2, 0, count_action}, {2, 2, 0, count_action}, {3, 2, 0, count_action}
+};
+
+// Generated: every state accepts every event, event e moves s to (s + e + 1) % states
+template <std::size_t States>
+constexpr std::array<sm_state_tab_t, States> make_states() {
+    std::array<sm_state_tab_t, States> states{};
+    for (std::size_t s = 0; s < States; s++) states[s] = {static_cast<sm_state_t>(s), nullptr, nullptr, "S"};
+    return states;
+}
+template <std::size_t States, std::size_t Events>
+constexpr std::array<sm_transition_tab_t, States * Events> make_transitions() {
+    std::array<sm_transition_tab_t, States * Events> transitions{};
+    for (std::size_t s = 0; s < States; s++) {
+        for (std::size_t e = 0; e < Events; e++) {
+            transitions[s * Events + e] = {static_cast<sm_state_t>(s), static_cast<sm_event_t>(e),
+                                           static_cast<sm_state_t>((s + e + 1) % States), count_action};
+        }
+    }
+    return transitions;
+}
+constexpr auto grid_states = make_states<64>();
+constexpr auto grid_transitions = make_transitions<64, 8>();
+
+// ========================
+// MEASUREMENT
+// ========================
+
+static std::uint32_t xorshift_state = 2463534242u;
+
+static std::uint32_t next_random() {
+    xorshift_state ^= xorshift_state << 13;
+    xorshift_state ^= xorshift_state >> 17;
+    xorshift_state ^= xorshift_state << 5;
+    return xorshift_state;
+}
+
+// Events per second, replaying the stream until BENCH_MIN_SECONDS have passed
+template <typename Process>
+static double measure(state_machine_t *sm, const sm_event_t *events, Process process) {
+    using clock = std::chrono::steady_clock;
+    sm_reset(sm);
+    auto start = clock::now();
+    double elapsed;
+    unsigned long rounds = 0;
+    do {
+        for (int i = 0; i < BENCH_EVENTS; i++) process(sm, events[i]);
+        rounds++;
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < BENCH_MIN_SECONDS);
+    return static_cast<double>(rounds) * BENCH_EVENTS / elapsed;
+}
+
+template <typename Machine>
+static void run(const char *name, state_machine_t *sm, sm_event_t num_events) {
+    static sm_event_t events[BENCH_EVENTS];
+    for (int i = 0; i < BENCH_EVENTS; i++) events[i] = static_cast<sm_event_t>(next_random() % num_events);
+
+    double runtime = measure(sm, events, sm_process_event);
+    double compiled = measure(sm, events, Machine::process_event);
+    std::printf("%-22s %-12zu %16.2f %16.2f %8.2fx\n", name, Machine::num_transitions,
+                runtime / 1e6, compiled / 1e6, compiled / runtime);
+}
+
+int main() {
+    std::printf("Compile-time vs runtime dispatch (%d-event stream, %.1f s per measurement)\n\n",
+                BENCH_EVENTS, BENCH_MIN_SECONDS);
+    std::printf("%-22s %-12s %16s %16s %9s\n", "Table", "Transitions", "Runtime (Mev/s)", "Static (Mev/s)", "Speedup");
+
+    using traffic = sm::static_machine<traffic_states, traffic_transitions>;
+    state_machine_t traffic_sm;
+    traffic::init(&traffic_sm, "Traffic", 0);
+    run<traffic>("traffic light", &traffic_sm, 3);
+
+    using grid = sm::static_machine<grid_states, grid_transitions>;
+    static std::uint16_t grid_arena[SM_ARENA_WORDS(64, 64 * 8)];
+    state_machine_t grid_sm;
+    grid::init(&grid_sm, "Grid", 0, grid_arena, sizeof(grid_arena));
+    run<grid>("64 states x 8 events", &grid_sm, 8);
+
+    std::printf("\n(%lu actions run)\n", static_cast<unsigned long>(action_calls));
+    return 0;
+}
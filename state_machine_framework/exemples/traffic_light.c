@@ -1,8 +1,7 @@
 #include "../include/state_machine.h"
+#include "../include/state_machine_timer.h"
 #include <stdio.h>
-#include <unistd.h>  // For sleep()
 #include <stdlib.h>
-#include <time.h>
 
 // ========================
 // TRAFFIC LIGHT STATES
@@ -114,23 +113,26 @@ const sm_transition_tab_t traffic_transitions[] = {
     {TRAFFIC_YELLOW,     EVENT_RESET, TRAFFIC_RED,        reset_action}
 };
 
+// Timeout table: how long each light stays on in automatic mode
+const sm_timeout_tab_t traffic_timeouts[] = {
+    {TRAFFIC_RED,        RED_DURATION_SEC * 1000,        EVENT_TIMER_EXPIRED},
+    {TRAFFIC_RED_YELLOW, RED_YELLOW_DURATION_SEC * 1000, EVENT_TIMER_EXPIRED},
+    {TRAFFIC_GREEN,      GREEN_DURATION_SEC * 1000,      EVENT_TIMER_EXPIRED},
+    {TRAFFIC_YELLOW,     YELLOW_DURATION_SEC * 1000,     EVENT_TIMER_EXPIRED}
+};
+
 #define NUM_TRAFFIC_STATES (sizeof(traffic_states) / sizeof(traffic_states[0]))
 #define NUM_TRAFFIC_TRANSITIONS (sizeof(traffic_transitions) / sizeof(traffic_transitions[0]))
+#define NUM_TRAFFIC_TIMEOUTS (sizeof(traffic_timeouts) / sizeof(traffic_timeouts[0]))
+
+// Transition trace, dumped with 'd' and read back with build/sm_trace_decode
+#define TRACE_CAPACITY 4096
+#define TRACE_FILE "traffic_light.trace"
 
 // ========================
 // HELPER FUNCTIONS
 // ========================
 
-int get_state_duration(sm_state_t state) {
-    switch(state) {
-        case TRAFFIC_RED:        return RED_DURATION_SEC;
-        case TRAFFIC_RED_YELLOW: return RED_YELLOW_DURATION_SEC;
-        case TRAFFIC_GREEN:      return GREEN_DURATION_SEC;
-        case TRAFFIC_YELLOW:     return YELLOW_DURATION_SEC;
-        default:                 return 1;
-    }
-}
-
 void print_menu(void) {
     printf("\n=== Traffic Light Controller ===\n");
     printf("Commands:\n");
@@ -140,40 +142,56 @@ void print_menu(void) {
     printf("  s - Show status\n");
     printf("  l - Toggle logging\n");
     printf("  a - Automatic cylcle\n");
+    printf("  d - Dump transition trace to %s\n", TRACE_FILE);
+#ifdef SM_METRICS
+    printf("  m - Show dwell times and callback durations\n");
+#endif
     printf("  q - Quit\n");
     printf("================================\n");
 }
 
 void simulate_automatic_cycle(state_machine_t *traffic_sm) {
+    static sm_timer_t timer_arena[1];
+    sm_timer_wheel_t wheel;
+    sm_timer_loop_t loop;
+    uint32_t timer;
+
+    // The timeout table drives the lights: each transition arms the next timeout
+    if (sm_timer_init(&wheel, 10, 1, timer_arena, sizeof(timer_arena)) != SM_SUCCESS ||
+        sm_timer_loop_init(&loop, &wheel) != SM_SUCCESS) {
+        printf("Timer service unavailable\n");
+        return;
+    }
+    sm_timer_attach(&wheel, traffic_sm, traffic_timeouts, NUM_TRAFFIC_TIMEOUTS, &timer);
+
     printf("\n Starting automatic traffic light simulation for 30 seconds...\n");
     printf("Press Ctrl+C to stop and return to manual mode.\n\n");
-    
-    time_t start_time = time(NULL);
-    time_t last_transition = start_time;
-    
-    while ((time(NULL) - start_time) < 30) {  // Run for 30 seconds
-        sm_state_t current_state;
-        sm_get_current_state(traffic_sm, &current_state);
-        
-        int duration = get_state_duration(current_state);
-        
-        if ((time(NULL) - last_transition) >= duration) {
-            printf("\n Timer expired - triggering transition...\n");
-            sm_result_t result = sm_process_event(traffic_sm, EVENT_TIMER_EXPIRED);
-            
-            if (result == SM_SUCCESS) {
-                last_transition = time(NULL);
-            } else {
-                printf("Transition failed: %d\n", result);
-            }
-        }
-        
-        sleep(1);  // Check every second
+
+    sm_result_t result = sm_timer_loop_run(&loop, 30000);
+    if (result != SM_SUCCESS) {
+        printf("Timer loop failed: %d\n", result);
     }
-    
+
+    sm_timer_destroy(&wheel, timer);
+    sm_timer_loop_close(&loop);
     printf("\n Automatic simulation completed!\n");
 }
 
+void dump_trace(const sm_trace_ring_t *ring, state_machine_t *traffic_sm) {
+    FILE *out = fopen(TRACE_FILE, "wb");
+    if (!out) {
+        printf("Cannot open %s\n", TRACE_FILE);
+        return;
+    }
+    sm_result_t result = sm_trace_save(ring, &traffic_sm, 1, out);
+    fclose(out);
+    if (result != SM_SUCCESS) {
+        printf("Failed to write %s: %d\n", TRACE_FILE, result);
+        return;
+    }
+    printf("Trace written to %s (decode with build/sm_trace_decode %s)\n", TRACE_FILE, TRACE_FILE);
+}
+
 // ========================
 // MAIN FUNCTION
 // ========================
@@ -201,6 +219,19 @@ int main(void) {
     
     // Enable logging by default
     sm_set_logging(&traffic_sm, true);
+
+    // Keep the last TRACE_CAPACITY events in a trace ring
+    static sm_trace_record_t trace_records[TRACE_CAPACITY];
+    sm_trace_ring_t trace;
+    sm_trace_init(&trace, trace_records, TRACE_CAPACITY, SM_TRACE_CLOCK_CYCLES);
+    sm_trace_attach(&traffic_sm, &trace, 0);
+
+#ifdef SM_METRICS
+    // Built with make METRICS=1: record time in each light and callback durations
+    static uint64_t metrics_arena[SM_METRICS_ARENA_SIZE(NUM_TRAFFIC_STATES, NUM_TRAFFIC_TRANSITIONS) / sizeof(uint64_t)];
+    sm_metrics_t metrics;
+    sm_metrics_attach(&traffic_sm, &metrics, metrics_arena, sizeof(metrics_arena));
+#endif
     
     // Show initial status
     sm_print_status(&traffic_sm);
@@ -267,6 +298,18 @@ int main(void) {
                 print_menu();
                 break;
                 
+            case 'd':
+            case 'D':
+                dump_trace(&trace, &traffic_sm);
+                break;
+                
+#ifdef SM_METRICS
+            case 'm':
+            case 'M':
+                sm_metrics_print(&traffic_sm);
+                break;
+#endif
+                
             case 'h':
             case 'H':
                 print_menu();
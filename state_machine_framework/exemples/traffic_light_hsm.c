@@ -0,0 +1,166 @@
+#include "../include/state_machine.h"
+#include <stdio.h>
+
+// ========================
+// TRAFFIC LIGHT, HIERARCHICAL
+// ========================
+// traffic_light.c lists EMERGENCY_STOP and RESET once per light. Here the
+// lights are substates of OPERATING, which handles both events for all of
+// them. A second, orthogonal region tracks the pedestrian button while the
+// lights keep cycling.
+
+typedef enum {
+    TRAFFIC_RED = 0,
+    TRAFFIC_RED_YELLOW,
+    TRAFFIC_GREEN,
+    TRAFFIC_YELLOW,
+    TRAFFIC_OPERATING,      // Composite: the normal cycle
+    TRAFFIC_FLASHING,       // After an emergency stop, until reset
+    PEDESTRIAN_IDLE,        // Region 1
+    PEDESTRIAN_WAITING
+} traffic_state_t;
+
+typedef enum {
+    EVENT_TIMER_EXPIRED = 0,
+    EVENT_EMERGENCY_STOP,
+    EVENT_RESET,
+    EVENT_BUTTON_PRESSED
+} traffic_event_t;
+
+// ========================
+// ACTIONS
+// ========================
+
+static void on_light_entry(state_machine_t *sm, sm_state_t state) {
+    printf("   %s LIGHT ON\n", sm_get_state_name(sm, state));
+}
+
+static void on_operating_entry(state_machine_t *sm, sm_state_t state) {
+    (void)sm; (void)state;
+    printf("   Normal cycle started\n");
+}
+
+static void on_operating_exit(state_machine_t *sm, sm_state_t state) {
+    (void)sm; (void)state;
+    printf("   Normal cycle stopped\n");
+}
+
+static void on_flashing_entry(state_machine_t *sm, sm_state_t state) {
+    (void)sm; (void)state;
+    printf("   YELLOW FLASHING\n");
+}
+
+static void on_waiting_entry(state_machine_t *sm, sm_state_t state) {
+    (void)sm; (void)state;
+    printf("   WAIT signal on\n");
+}
+
+static void emergency_action(state_machine_t *sm, sm_state_t from, sm_state_t to, sm_event_t event) {
+    (void)sm; (void)from; (void)to; (void)event;
+    printf("EMERGENCY STOP ACTIVATED!\n");
+}
+
+static void reset_action(state_machine_t *sm, sm_state_t from, sm_state_t to, sm_event_t event) {
+    (void)sm; (void)from; (void)to; (void)event;
+    printf("Traffic light system reset\n");
+}
+
+// ========================
+// CONFIGURATION TABLES
+// ========================
+
+static const sm_state_tab_t traffic_states[] = {
+    {TRAFFIC_RED,        on_light_entry,     NULL,              "RED"},
+    {TRAFFIC_RED_YELLOW, on_light_entry,     NULL,              "RED_YELLOW"},
+    {TRAFFIC_GREEN,      on_light_entry,     NULL,              "GREEN"},
+    {TRAFFIC_YELLOW,     on_light_entry,     NULL,              "YELLOW"},
+    {TRAFFIC_OPERATING,  on_operating_entry, on_operating_exit, "OPERATING"},
+    {TRAFFIC_FLASHING,   on_flashing_entry,  NULL,              "FLASHING"},
+    {PEDESTRIAN_IDLE,    NULL,               NULL,              "PEDESTRIAN_IDLE"},
+    {PEDESTRIAN_WAITING, on_waiting_entry,   NULL,              "PEDESTRIAN_WAITING"}
+};
+
+// The lights live in OPERATING, which starts at RED; the pedestrian states are region 1
+static const sm_hierarchy_tab_t traffic_hierarchy[] = {
+    {TRAFFIC_OPERATING,  SM_NO_STATE,       TRAFFIC_RED, 0},
+    {TRAFFIC_RED,        TRAFFIC_OPERATING, SM_NO_STATE, 0},
+    {TRAFFIC_RED_YELLOW, TRAFFIC_OPERATING, SM_NO_STATE, 0},
+    {TRAFFIC_GREEN,      TRAFFIC_OPERATING, SM_NO_STATE, 0},
+    {TRAFFIC_YELLOW,     TRAFFIC_OPERATING, SM_NO_STATE, 0},
+    {PEDESTRIAN_IDLE,    SM_NO_STATE,       SM_NO_STATE, 1},
+    {PEDESTRIAN_WAITING, SM_NO_STATE,       SM_NO_STATE, 1}
+};
+
+static const sm_transition_tab_t traffic_transitions[] = {
+    // Normal traffic flow cycle
+    {TRAFFIC_RED,        EVENT_TIMER_EXPIRED,  TRAFFIC_RED_YELLOW, NULL},
+    {TRAFFIC_RED_YELLOW, EVENT_TIMER_EXPIRED,  TRAFFIC_GREEN,      NULL},
+    {TRAFFIC_GREEN,      EVENT_TIMER_EXPIRED,  TRAFFIC_YELLOW,     NULL},
+    {TRAFFIC_YELLOW,     EVENT_TIMER_EXPIRED,  TRAFFIC_RED,        NULL},
+
+    // One row each, shared by every light
+    {TRAFFIC_OPERATING,  EVENT_EMERGENCY_STOP, TRAFFIC_FLASHING,   emergency_action},
+    {TRAFFIC_OPERATING,  EVENT_RESET,          TRAFFIC_OPERATING,  reset_action},
+    {TRAFFIC_FLASHING,   EVENT_RESET,          TRAFFIC_OPERATING,  reset_action},
+
+    // Pedestrian region: a reset also clears a pending request
+    {PEDESTRIAN_IDLE,    EVENT_BUTTON_PRESSED, PEDESTRIAN_WAITING, NULL},
+    {PEDESTRIAN_WAITING, EVENT_RESET,          PEDESTRIAN_IDLE,    NULL}
+};
+
+static const sm_state_t traffic_initial_states[] = {TRAFFIC_OPERATING, PEDESTRIAN_IDLE};
+
+#define COUNT(table) (sizeof(table) / sizeof(table[0]))
+
+// ========================
+// MAIN FUNCTION
+// ========================
+
+int main(void) {
+    const sm_hierarchy_def_t traffic_def = {
+        traffic_states, COUNT(traffic_states),
+        traffic_transitions, COUNT(traffic_transitions),
+        traffic_hierarchy, COUNT(traffic_hierarchy),
+        traffic_initial_states, COUNT(traffic_initial_states)
+    };
+
+    static uint16_t arena[256];
+    size_t arena_size;
+    sm_result_t result = sm_hierarchy_arena_size(&traffic_def, &arena_size);
+    if (result != SM_SUCCESS || arena_size > sizeof(arena)) {
+        printf("Invalid traffic light definition: %d\n", result);
+        return 1;
+    }
+
+    state_machine_t traffic_sm;
+    printf("Initializing hierarchical traffic light (%lu arena bytes)...\n", (unsigned long)arena_size);
+    result = sm_init_hierarchical(&traffic_sm, "TrafficLight", &traffic_def, arena, sizeof(arena));
+    if (result != SM_SUCCESS) {
+        printf("Failed to initialize traffic light: %d\n", result);
+        return 1;
+    }
+
+    const struct {
+        sm_event_t event;
+        const char *name;
+    } script[] = {
+        {EVENT_TIMER_EXPIRED,  "timer"},
+        {EVENT_BUTTON_PRESSED, "button"},
+        {EVENT_TIMER_EXPIRED,  "timer"},
+        {EVENT_EMERGENCY_STOP, "emergency stop"},
+        {EVENT_TIMER_EXPIRED,  "timer"},
+        {EVENT_RESET,          "reset"},
+        {EVENT_TIMER_EXPIRED,  "timer"}
+    };
+    for (size_t i = 0; i < COUNT(script); i++) {
+        printf("\n-> %s\n", script[i].name);
+        if (sm_process_event(&traffic_sm, script[i].event) != SM_SUCCESS) {
+            printf("   No transition in any region\n");
+        }
+        printf("   Operating: %s\n", sm_is_in_state(&traffic_sm, TRAFFIC_OPERATING) ? "yes" : "no");
+    }
+
+    printf("\n");
+    sm_print_status(&traffic_sm);
+    return 0;
+}
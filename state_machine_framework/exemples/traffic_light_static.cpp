@@ -0,0 +1,88 @@
+#include "../include/state_machine_static.hpp"
+#include <cstdio>
+
+// ========================
+// TRAFFIC LIGHT, COMPILE-TIME DISPATCH
+// ========================
+// The tables of traffic_light.c, declared constexpr and dispatched through
+// sm::static_machine. A mistake in them (say RED_YELLOW -> GREEN listed
+// twice, or a typo'd state) is a compile error rather than a runtime surprise.
+
+enum : sm_state_t {
+    TRAFFIC_RED = 0,
+    TRAFFIC_RED_YELLOW,
+    TRAFFIC_GREEN,
+    TRAFFIC_YELLOW
+};
+
+enum : sm_event_t {
+    EVENT_TIMER_EXPIRED = 0,
+    EVENT_EMERGENCY_STOP,
+    EVENT_RESET
+};
+
+static void on_light_entry(state_machine_t *sm, sm_state_t state) {
+    std::printf("%s LIGHT ON\n", sm_get_state_name(sm, state));
+}
+
+static void emergency_action(state_machine_t *, sm_state_t, sm_state_t, sm_event_t) {
+    std::printf("EMERGENCY STOP ACTIVATED!\n");
+}
+
+static void reset_action(state_machine_t *, sm_state_t, sm_state_t, sm_event_t) {
+    std::printf("Traffic light system reset\n");
+}
+
+constexpr sm_state_tab_t traffic_states[] = {
+    {TRAFFIC_RED,        on_light_entry, nullptr, "RED"},
+    {TRAFFIC_RED_YELLOW, on_light_entry, nullptr, "RED_YELLOW"},
+    {TRAFFIC_GREEN,      on_light_entry, nullptr, "GREEN"},
+    {TRAFFIC_YELLOW,     on_light_entry, nullptr, "YELLOW"}
+};
+
+constexpr sm_transition_tab_t traffic_transitions[] = {
+    {TRAFFIC_RED,        EVENT_TIMER_EXPIRED,  TRAFFIC_RED_YELLOW, nullptr},
+    {TRAFFIC_RED_YELLOW, EVENT_TIMER_EXPIRED,  TRAFFIC_GREEN,      nullptr},
+    {TRAFFIC_GREEN,      EVENT_TIMER_EXPIRED,  TRAFFIC_YELLOW,     nullptr},
+    {TRAFFIC_YELLOW,     EVENT_TIMER_EXPIRED,  TRAFFIC_RED,        nullptr},
+
+    {TRAFFIC_RED_YELLOW, EVENT_EMERGENCY_STOP, TRAFFIC_RED,        emergency_action},
+    {TRAFFIC_GREEN,      EVENT_EMERGENCY_STOP, TRAFFIC_RED,        emergency_action},
+    {TRAFFIC_YELLOW,     EVENT_EMERGENCY_STOP, TRAFFIC_RED,        emergency_action},
+
+    {TRAFFIC_RED,        EVENT_RESET,          TRAFFIC_RED,        reset_action},
+    {TRAFFIC_RED_YELLOW, EVENT_RESET,          TRAFFIC_RED,        reset_action},
+    {TRAFFIC_GREEN,      EVENT_RESET,          TRAFFIC_RED,        reset_action},
+    {TRAFFIC_YELLOW,     EVENT_RESET,          TRAFFIC_RED,        reset_action}
+};
+
+using traffic_light = sm::static_machine<traffic_states, traffic_transitions>;
+
+// The intended flow, checked by the compiler
+static_assert(traffic_light::next_state(TRAFFIC_RED, EVENT_TIMER_EXPIRED) == TRAFFIC_RED_YELLOW);
+static_assert(traffic_light::next_state(TRAFFIC_YELLOW, EVENT_TIMER_EXPIRED) == TRAFFIC_RED);
+static_assert(traffic_light::next_state(TRAFFIC_GREEN, EVENT_EMERGENCY_STOP) == TRAFFIC_RED);
+static_assert(!traffic_light::has_transition(TRAFFIC_RED, EVENT_EMERGENCY_STOP), "RED ignores emergency stop");
+
+int main() {
+    state_machine_t traffic_sm;
+    if (traffic_light::init(&traffic_sm, "TrafficLight", TRAFFIC_RED) != SM_SUCCESS) {
+        std::printf("Failed to initialize traffic light\n");
+        return 1;
+    }
+
+    const sm_event_t script[] = {
+        EVENT_TIMER_EXPIRED, EVENT_TIMER_EXPIRED, EVENT_TIMER_EXPIRED, EVENT_TIMER_EXPIRED,
+        EVENT_TIMER_EXPIRED, EVENT_EMERGENCY_STOP, EVENT_EMERGENCY_STOP, EVENT_RESET
+    };
+    for (sm_event_t event : script) {
+        if (traffic_light::process_event(&traffic_sm, event) != SM_SUCCESS) {
+            std::printf("No transition for event %d from %s\n", event,
+                        sm_get_state_name(&traffic_sm, traffic_sm.current_state));
+        }
+    }
+
+    // Still a plain state_machine_t
+    sm_print_status(&traffic_sm);
+    return 0;
+}
@@ -6,9 +6,23 @@
 #include <string.h> //for memset
 #include <stdio.h> //for printf
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Largest tables sm_init can index in the storage built into state_machine_t.
+// Bigger machines (up to 65535 states and transitions) use sm_init_with_arena.
 #define SM_MAX_STATES 16
 #define SM_MAX_TRANSITIONS 32
 #define SM_MAX_ID_LENGTH 32
+#define SM_NO_INDEX 0xFFFF  // Missing entry in the dispatch index
+#define SM_NO_STATE 0xFFFF  // No parent / no initial substate in a hierarchy table
+#define SM_MAX_REGIONS 4    // Orthogonal regions of a hierarchical machine
+#define SM_MAX_DEPTH 16     // Nesting levels of a hierarchical machine, top-level states included
+
+// Dispatch index size for a machine, in uint16_t words and in bytes
+#define SM_ARENA_WORDS(num_states, num_transitions) (2 * (size_t)(num_states) + 1 + 3 * (size_t)(num_transitions))
+#define SM_ARENA_SIZE(num_states, num_transitions) (SM_ARENA_WORDS(num_states, num_transitions) * sizeof(uint16_t))
 
 typedef enum{
     SM_SUCCESS = 0,
@@ -16,12 +30,16 @@ typedef enum{
     SM_ERROR_INVALID_STATE,
     SM_ERROR_INVALID_EVENT,
     SM_ERROR_TABLE_FULL,
-    SM_ERROR_NOT_INITIALIZED
+    SM_ERROR_NOT_INITIALIZED,
+    SM_ERROR_QUEUE_FULL,
+    SM_ERROR_INVALID_SIZE,
+    SM_ERROR_SYSTEM                 // A system call failed, see errno
 } sm_result_t;
 
-typedef uint8_t sm_state_t;
-typedef uint8_t sm_event_t;
+typedef uint16_t sm_state_t;
+typedef uint16_t sm_event_t;
 typedef struct state_machine state_machine_t;
+typedef struct sm_pool sm_pool_t;
 
 typedef void (*sm_action_fn_t)(state_machine_t* sm, sm_state_t from, sm_state_t to, sm_event_t event);
 typedef void (*sm_state_fn_t)(state_machine_t *sm, sm_state_t state);
@@ -40,6 +58,135 @@ typedef struct{
     const char *name;
 } sm_state_tab_t;
 
+// Hierarchy of a state: states not listed are top-level leaves of region 0
+typedef struct{
+    sm_state_t state;
+    sm_state_t parent;      // Enclosing state, SM_NO_STATE at the top level
+    sm_state_t initial;     // Substate entered when a transition ends here, SM_NO_STATE for a leaf
+    uint8_t region;         // Orthogonal region of a top-level state; substates are in their parent's
+} sm_hierarchy_tab_t;
+
+// Everything sm_init_hierarchical needs besides the arena
+typedef struct{
+    const sm_state_tab_t *states;
+    uint16_t num_states;
+    const sm_transition_tab_t *transitions;
+    uint16_t num_transitions;
+    const sm_hierarchy_tab_t *hierarchy;
+    uint16_t num_hierarchy;
+    const sm_state_t *initial_states;   // Where each region starts, one per region
+    uint8_t num_regions;
+} sm_hierarchy_def_t;
+
+// A transition whose callbacks sm_process_events put off (see sm_set_deferred_callbacks)
+typedef struct{
+    uint16_t from_row;      // State row it left
+    uint16_t entry;         // Dispatch index entry it took
+} sm_deferred_t;
+
+// Bounded multi-producer / single-consumer event queue (see sm_queue_init)
+#define SM_CACHE_LINE 64
+#define SM_DISPATCH_BATCH 32        // Events sm_dispatch_pending takes off the queue at once
+
+typedef struct{
+    uint32_t sequence;              // Slot turn, owned by the queue
+    sm_event_t event;
+} sm_queue_slot_t;
+
+typedef struct{
+    sm_queue_slot_t *slots;         // Caller storage, NULL if no queue is attached
+    uint32_t mask;                  // Capacity - 1
+    uint8_t pad0[SM_CACHE_LINE];
+    uint32_t tail;                  // Next slot to claim; shared by producers
+    uint32_t max_depth;
+    uint32_t dropped;
+    uint8_t pad1[SM_CACHE_LINE];
+    uint32_t head;                  // Next slot to dispatch; consumer only
+} sm_event_queue_t;
+
+typedef struct{
+    uint32_t capacity;
+    uint32_t depth;                 // Events waiting (a snapshot while producers run)
+    uint32_t max_depth;             // Highest depth seen by sm_post_event
+    uint32_t posted;                // Accepted by sm_post_event
+    uint32_t dispatched;            // Taken off the queue by sm_dispatch_pending
+    uint32_t dropped;               // Rejected because the queue was full
+} sm_queue_stats_t;
+
+// Binary transition trace (see sm_trace_init): one record per event, written
+// by the thread running the machines, readable from any thread
+#define SM_TRACE_NO_TRANSITION 0x8000   // Flag in sm_trace_record_t.machine: the event was rejected
+#define SM_TRACE_MAGIC "SMTRACE1"       // First bytes of a file written by sm_trace_save
+
+typedef enum{
+    SM_TRACE_CLOCK_CYCLES = 0,      // CPU cycle counter (rdtsc on x86), CLOCK_MONOTONIC elsewhere
+    SM_TRACE_CLOCK_COARSE           // CLOCK_MONOTONIC_COARSE: cheaper to read, scheduler-tick resolution
+} sm_trace_clock_t;
+
+typedef struct{
+    uint64_t timestamp;             // Ticks of the ring's clock
+    uint16_t machine;               // Tag given to sm_trace_attach, | SM_TRACE_NO_TRANSITION
+    sm_state_t from;
+    sm_state_t to;                  // Same as from when the event was rejected
+    sm_event_t event;
+} sm_trace_record_t;
+
+typedef struct{
+    sm_trace_record_t *records;     // Caller storage
+    uint32_t mask;                  // Capacity - 1
+    sm_trace_clock_t clock;
+    uint64_t origin_ticks;          // Clock readings taken together by sm_trace_init,
+    uint64_t origin_ns;             // to turn ticks into time
+    uint8_t pad0[SM_CACHE_LINE];
+    uint64_t head;                  // Records ever written; the writer's, read by readers
+} sm_trace_ring_t;
+
+// Instrumentation, built only with -DSM_METRICS (see sm_metrics_attach): time
+// spent in each state, callback durations and hits per transition. Every
+// translation unit using the framework must agree on SM_METRICS, since it
+// changes state_machine_t; without it none of this exists.
+#ifdef SM_METRICS
+// Log-linear (HDR) histogram of nanoseconds: exact below 2^(SUB_BITS + 1),
+// then 2^SUB_BITS buckets per power of two, so a bucket is within 1/8 of its
+// values. Values from 2^(MAX_EXPONENT + 1) ns (about 36 minutes) on land in the last bucket.
+#define SM_HISTOGRAM_SUB_BITS 3
+#define SM_HISTOGRAM_MAX_EXPONENT 40
+#define SM_HISTOGRAM_BUCKETS (((SM_HISTOGRAM_MAX_EXPONENT - SM_HISTOGRAM_SUB_BITS) + 2) << SM_HISTOGRAM_SUB_BITS)
+
+typedef struct{
+    uint64_t count;
+    uint64_t sum;                   // ns
+    uint64_t min;
+    uint64_t max;
+    uint64_t buckets[SM_HISTOGRAM_BUCKETS];
+} sm_histogram_t;
+
+typedef struct{
+    sm_histogram_t dwell;           // Time in the state, recorded when it is left
+    sm_histogram_t on_entry;        // Callback durations
+    sm_histogram_t on_exit;
+    uint64_t rejected;              // Events with no transition from the state
+} sm_state_metrics_t;
+
+typedef struct{
+    sm_histogram_t action;
+    uint64_t hits;                  // Times its (state, event) pair was taken
+} sm_transition_metrics_t;
+
+typedef struct{
+    sm_state_metrics_t *states;             // In the arena, one per state table row
+    sm_transition_metrics_t *transitions;   // One per transition table row
+    uint64_t entered_ns;                    // When the current state was entered
+} sm_metrics_t;
+
+// Arena bytes sm_metrics_attach needs
+#define SM_METRICS_ARENA_SIZE(num_states, num_transitions) \
+    ((size_t)(num_states) * sizeof(sm_state_metrics_t) + (size_t)(num_transitions) * sizeof(sm_transition_metrics_t))
+#define SM_METRICS_ATTACHED(sm) ((sm)->metrics != NULL)
+#else
+#define SM_METRICS_ATTACHED(sm) false
+#endif
+
 struct state_machine{
     char id[SM_MAX_ID_LENGTH];
     bool initialized;
@@ -47,25 +194,93 @@ struct state_machine{
     sm_state_t initial_state;
 
     const sm_state_tab_t *state_table;
-    uint8_t num_states;
+    uint16_t num_states;
 
     const sm_transition_tab_t *transition_table;
-    uint8_t num_transitions;
+    uint16_t num_transitions;
 
     bool logging_enabled;
     uint32_t transition_count;
     uint32_t invalid_event_count;
+
+    // Dispatch index, built once by sm_init: transitions grouped by source
+    // state row and sorted by event (CSR), in `arena` or in inline_arena
+    uint16_t current_index;                                           // Row of current_state in state_table
+    uint16_t *arena;                                                  // Caller storage, NULL for inline_arena
+    uint16_t inline_arena[SM_ARENA_WORDS(SM_MAX_STATES, SM_MAX_TRANSITIONS)];
+    uint16_t num_entries;                                             // Index entries; num_transitions unless hierarchical
+
+    // Hierarchical machines only (sm_init_hierarchical): the active leaf of each
+    // region, region 0 mirrored in current_state/current_index
+    uint16_t *hierarchy;                                              // Exit/entry paths in the arena, NULL if flat
+    uint8_t num_regions;
+    uint16_t region_index[SM_MAX_REGIONS];
+    uint16_t region_initial[SM_MAX_REGIONS];
+
+    // Called with the new current_state after every transition into it (for
+    // hierarchical machines, region 0's) and after sm_reset, for services that
+    // follow the machine's state such as sm_timer_attach. NULL if none.
+    sm_state_fn_t on_state_change;
+    void *state_change_context;
+
+    // The pool this machine is the proxy of, see sm_pool_active. NULL otherwise.
+    sm_pool_t *pool;
+
+    // Transitions waiting for their callbacks, see sm_set_deferred_callbacks. NULL if off.
+    sm_deferred_t *deferred;
+    uint32_t deferred_capacity;
+
+    // Where processed events are traced, see sm_trace_attach. NULL if not traced.
+    sm_trace_ring_t *trace;
+    uint16_t trace_tag;
+
+#ifdef SM_METRICS
+    // Where dwell times, callback durations and hits go, see sm_metrics_attach. NULL if off.
+    sm_metrics_t *metrics;
+#endif
+
+    sm_event_queue_t queue;
 };
 
 
 // Core state machine api
 
-sm_result_t sm_init(state_machine_t *sm, const char *id, sm_state_t initial_state, const sm_state_tab_t *state_table, uint8_t num_states, const sm_transition_tab_t *transition_table, uint8_t num_transitions);
+sm_result_t sm_init(state_machine_t *sm, const char *id, sm_state_t initial_state, const sm_state_tab_t *state_table, uint16_t num_states, const sm_transition_tab_t *transition_table, uint16_t num_transitions);
+// Same as sm_init for machines of any size: the dispatch index lives in `arena`
+// (at least SM_ARENA_SIZE(num_states, num_transitions) bytes, aligned for uint16_t),
+// which must stay valid and untouched for the life of the machine
+sm_result_t sm_init_with_arena(state_machine_t *sm, const char *id, sm_state_t initial_state, const sm_state_tab_t *state_table, uint16_t num_states, const sm_transition_tab_t *transition_table, uint16_t num_transitions, void *arena, size_t arena_size);
 sm_result_t sm_reset(state_machine_t *sm);
 sm_result_t sm_process_event(state_machine_t *sm, sm_event_t event);
+// Same as sm_process_event on each of events[0 .. count - 1] in turn, with the
+// checks and index setup done once per batch (logging is looked at once, too).
+// `results` (may be NULL) receives each event's result. Returns
+// SM_ERROR_INVALID_EVENT if any event had no transition.
+sm_result_t sm_process_events(state_machine_t *sm, const sm_event_t *events, uint32_t count, sm_result_t *results);
+// Let sm_process_events move through a batch without running callbacks, noting
+// each transition in `calls`. When the batch ends, or the list is full, the
+// exit, action and entry callbacks of the noted transitions run in order,
+// then on_state_change once; by then the machine is already in the last
+// state reached. Flat machines only. NULL or a capacity of 0 turns it off.
+// Callbacks may call it too; the rest of the batch follows the new setting.
+sm_result_t sm_set_deferred_callbacks(state_machine_t *sm, sm_deferred_t *calls, uint32_t capacity);
+
+// Hierarchical machines: a state without a transition for an event falls back
+// to its parent's, and each orthogonal region runs its own active state.
+// Transitions always end in a leaf (a composite target enters its initial
+// substates) and stay within their region. Every event is offered to each
+// region in turn; SM_ERROR_INVALID_EVENT only if no region had a transition.
+// The exit/entry path of every transition is worked out here, once.
+
+// Arena bytes sm_init_hierarchical needs for `def`, or the reason it would reject it
+sm_result_t sm_hierarchy_arena_size(const sm_hierarchy_def_t *def, size_t *arena_size);
+sm_result_t sm_init_hierarchical(state_machine_t *sm, const char *id, const sm_hierarchy_def_t *def, void *arena, size_t arena_size);
 
 // queries
+// True for the active leaf of any region and for every state enclosing it
 bool sm_is_in_state(const state_machine_t *sm, sm_state_t state);
+// Active leaf of `region` (0 for flat machines)
+sm_result_t sm_get_region_state(const state_machine_t *sm, uint8_t region, sm_state_t *state);
 
 //logging and debugging
 const char *sm_get_state_name(const state_machine_t *sm, sm_state_t state);
@@ -75,4 +290,117 @@ void sm_print_status(const state_machine_t *sm);
 sm_result_t sm_get_current_state(const state_machine_t *sm, sm_state_t *current_state);
 sm_result_t sm_get_stats(const state_machine_t *sm, uint32_t *total_transitions, uint32_t *invalid_events);
 
+// Event queue: other threads post, the thread owning the machine dispatches.
+// sm_process_event, sm_reset and sm_dispatch_pending stay owner-thread only;
+// sm_post_event, sm_has_pending_events and sm_get_queue_stats may be called from any thread.
+
+// Attach a queue of `capacity` slots (a power of two, at least 2) to an
+// initialized machine. Call again after sm_init, which detaches it.
+sm_result_t sm_queue_init(state_machine_t *sm, sm_queue_slot_t *slots, uint32_t capacity);
+// Lock-free and non-blocking: SM_ERROR_QUEUE_FULL (and one more drop counted) if full
+sm_result_t sm_post_event(state_machine_t *sm, sm_event_t event);
+// Run queued events through sm_process_events in post order, taking them off the
+// queue SM_DISPATCH_BATCH at a time so producers get slots back before the
+// callbacks run. Stops after max_events (0 = until the queue is empty).
+// `dispatched` (may be NULL) receives the number of events run.
+sm_result_t sm_dispatch_pending(state_machine_t *sm, uint32_t max_events, uint32_t *dispatched);
+// True if sm_dispatch_pending would find an event (false without a queue)
+bool sm_has_pending_events(const state_machine_t *sm);
+sm_result_t sm_get_queue_stats(const state_machine_t *sm, sm_queue_stats_t *stats);
+
+// Transition trace: a ring of fixed-size binary records, cheap enough to leave
+// on. Every machine traced into a ring must run on the same thread (one ring
+// per machine or per thread); the oldest records are overwritten when full.
+// Events of one sm_process_events batch share a timestamp.
+
+// `capacity` records, a power of two, at least 2. Readers see the latest
+// capacity - 1: the slot after them may be in the middle of being rewritten.
+sm_result_t sm_trace_init(sm_trace_ring_t *ring, sm_trace_record_t *records, uint32_t capacity, sm_trace_clock_t clock);
+// Trace every event `sm` processes into `ring` under `tag` (below 0x8000); NULL stops tracing
+sm_result_t sm_trace_attach(state_machine_t *sm, sm_trace_ring_t *ring, uint16_t tag);
+// What the framework calls per event; usable for events dispatched some other way
+uint64_t sm_trace_now(const sm_trace_ring_t *ring);
+void sm_trace_write(sm_trace_ring_t *ring, uint64_t timestamp, uint16_t machine, sm_state_t from, sm_state_t to, sm_event_t event);
+// Copy up to max_records records from *cursor on, oldest first, and move the
+// cursor past them. Lock-free, from any thread: records overwritten before or
+// while they are copied are skipped. Start with a cursor of 0.
+sm_result_t sm_trace_read(const sm_trace_ring_t *ring, uint64_t *cursor, sm_trace_record_t *records, uint32_t max_records, uint32_t *count);
+// Write the records in the ring, with the ids and state names of `machines`,
+// in the format tools/sm_trace_decode.c reads. May run while the machines do.
+sm_result_t sm_trace_save(const sm_trace_ring_t *ring, state_machine_t *const *machines, uint16_t num_machines, FILE *out);
+
+// Instance pools: many instances of one machine type, for when a
+// state_machine_t each is too much. The type holds the tables and dispatch
+// index once; per instance, a pool keeps only its state and two counters,
+// each in its own array (10 bytes an instance). Instances have no id, queue,
+// hook, logging, trace or metrics of their own. A pool and its instances
+// belong to one thread.
+
+typedef struct{
+    state_machine_t machine;        // Tables and index; never processes events itself
+    bool has_callbacks;             // Any on_entry, on_exit or action in the tables
+} sm_type_t;
+
+struct sm_pool{
+    const sm_type_t *type;
+    uint32_t num_instances;
+    uint32_t *transition_count;     // Per instance, in the arena
+    uint32_t *invalid_event_count;
+    uint16_t *current_index;        // State table row of each instance's current state
+    state_machine_t proxy;          // What callbacks get, set to the instance they run for
+    uint32_t active;                // That instance, see sm_pool_active
+};
+
+// Arena bytes sm_pool_init needs
+#define SM_POOL_ARENA_SIZE(num_instances) ((size_t)(num_instances) * (2 * sizeof(uint32_t) + sizeof(uint16_t)))
+
+// Tables and index as sm_init (arena NULL) or sm_init_with_arena builds them,
+// without running any callback. Tables and arena must outlive the type's pools.
+sm_result_t sm_type_init(sm_type_t *type, const char *id, sm_state_t initial_state, const sm_state_tab_t *state_table, uint16_t num_states, const sm_transition_tab_t *transition_table, uint16_t num_transitions, void *arena, size_t arena_size);
+// Instances 0 .. num_instances - 1 in the initial state, whose on_entry runs for
+// each. The arena (SM_POOL_ARENA_SIZE bytes, aligned for uint32_t) holds the
+// instances; the pool must not be moved or copied after this.
+sm_result_t sm_pool_init(sm_pool_t *pool, const sm_type_t *type, uint32_t num_instances, void *arena, size_t arena_size);
+// events[i] to instance ids[i] for each i in turn, each with the same effect
+// as sm_process_event on a machine of its own. Instances a few events ahead
+// are prefetched while one runs. `results` (may be NULL) receives each result,
+// SM_ERROR_INVALID_STATE for an unknown id; returns the last failure, if any.
+// Callbacks must not process events on the pool.
+sm_result_t sm_pool_process_event(sm_pool_t *pool, const uint32_t *ids, const sm_event_t *events, uint32_t count, sm_result_t *results);
+// Same as sm_reset for one instance
+sm_result_t sm_pool_reset(sm_pool_t *pool, uint32_t id);
+sm_result_t sm_pool_get_state(const sm_pool_t *pool, uint32_t id, sm_state_t *state);
+sm_result_t sm_pool_get_stats(const sm_pool_t *pool, uint32_t id, uint32_t *total_transitions, uint32_t *invalid_events);
+// Instances currently in `state`
+uint32_t sm_pool_count_in_state(const sm_pool_t *pool, sm_state_t state);
+// From a callback: the pool and, in *id, the instance it runs for; NULL if
+// `sm` is a machine of its own
+sm_pool_t *sm_pool_active(const state_machine_t *sm, uint32_t *id);
+
+#ifdef SM_METRICS
+// Metrics: written by the thread running the machine with plain stores, so
+// they cost no atomic operations; the queries may run on any thread meanwhile
+// and see each counter either before or after an update. Flat machines only.
+// sm_process_events handles events one at a time while metrics are attached.
+
+// Start recording into `arena` (SM_METRICS_ARENA_SIZE bytes, aligned for uint64_t,
+// zeroed here), from now on. NULL stops recording; the arena keeps what was recorded.
+sm_result_t sm_metrics_attach(state_machine_t *sm, sm_metrics_t *metrics, void *arena, size_t arena_size);
+// Copies of what was recorded for a state, and for the transition taken on (from, event)
+sm_result_t sm_metrics_get_state(const state_machine_t *sm, sm_state_t state, sm_state_metrics_t *metrics);
+sm_result_t sm_metrics_get_transition(const state_machine_t *sm, sm_state_t from, sm_event_t event, sm_transition_metrics_t *metrics);
+// Smallest value at or above `percentile` (0..100) of the recorded values, 0 if none
+uint64_t sm_histogram_percentile(const sm_histogram_t *histogram, double percentile);
+void sm_metrics_print(const state_machine_t *sm);
+
+// What the framework calls
+uint64_t sm_metrics_now(void);
+void sm_metrics_count(uint64_t *counter);
+void sm_histogram_record(sm_histogram_t *histogram, uint64_t value);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
\ No newline at end of file
@@ -0,0 +1,126 @@
+#ifndef STATE_MACHINE_EXECUTOR_H
+#define STATE_MACHINE_EXECUTOR_H
+
+#include "state_machine.h"
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Runs many state machines on a pool of worker threads.
+//
+// Each machine keeps its own event queue (sm_queue_init). Posting through
+// sm_executor_post queues the event and, if the machine was idle, schedules
+// it: onto the posting worker's deque when called from a callback, onto a
+// shared injection queue otherwise. Idle workers steal from each other's
+// deques. A machine is never run by two workers at once, so its events are
+// processed one at a time in the order each producer posted them.
+
+#define SM_EXECUTOR_MAX_WORKERS 64
+#define SM_EXECUTOR_BUDGET 64       // Events a machine may run before yielding its worker
+
+typedef struct{
+    state_machine_t *machine;
+    uint32_t scheduled;             // 1 while queued for or running on a worker
+    uint64_t ready_ns;              // When it was last scheduled
+    uint64_t events;                // Dispatched by the executor
+    uint64_t runs;                  // Times a worker picked it up
+    uint64_t latency_total_ns;      // Scheduled -> picked up, summed over runs
+    uint64_t latency_max_ns;
+} sm_executor_machine_t;
+
+typedef struct{
+    uint32_t sequence;
+    uint32_t id;
+} sm_executor_slot_t;
+
+// Chase-Lev work-stealing deque of machine ids: the owner pushes and pops
+// at the bottom, thieves take from the top
+typedef struct{
+    uint32_t *items;
+    uint32_t mask;
+    uint8_t pad0[SM_CACHE_LINE];
+    int64_t top;
+    uint8_t pad1[SM_CACHE_LINE];
+    int64_t bottom;
+} sm_work_deque_t;
+
+typedef struct sm_executor sm_executor_t;
+
+typedef struct{
+    sm_executor_t *executor;
+    pthread_t thread;
+    uint32_t index;
+    uint32_t random;                // Victim choice when stealing
+    sm_work_deque_t deque;
+    uint64_t events;
+    uint64_t runs;
+    uint64_t steals;
+} sm_executor_worker_t;
+
+struct sm_executor{
+    sm_executor_machine_t *machines;
+    uint32_t num_machines;
+    uint32_t max_machines;
+
+    // Injection queue (bounded MPMC) for machines scheduled from outside the pool
+    sm_executor_slot_t *injection;
+    uint32_t mask;                  // Capacity - 1 of the injection queue and of each deque
+    uint8_t pad0[SM_CACHE_LINE];
+    uint32_t injection_tail;
+    uint8_t pad1[SM_CACHE_LINE];
+    uint32_t injection_head;
+    uint8_t pad2[SM_CACHE_LINE];
+
+    sm_executor_worker_t workers[SM_EXECUTOR_MAX_WORKERS];
+    uint32_t num_workers;
+
+    bool running;
+    uint32_t active;                // Machines currently scheduled
+    uint32_t sleepers;              // Workers parked on `wake`
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    uint64_t start_ns;
+    uint64_t stop_ns;
+};
+
+typedef struct{
+    uint64_t events;                // Dispatched by all workers
+    uint64_t runs;                  // Machine runs
+    uint64_t steals;                // Runs taken from another worker's deque
+    double elapsed_seconds;         // Since sm_executor_start (until stop, if stopped)
+    double events_per_second;
+} sm_executor_stats_t;
+
+typedef struct{
+    uint64_t events;
+    uint64_t runs;
+    uint64_t latency_avg_ns;        // Scheduled -> picked up by a worker
+    uint64_t latency_max_ns;
+    uint32_t pending;               // Events still in the machine's queue
+} sm_executor_machine_stats_t;
+
+// Arena bytes sm_executor_init needs for max_machines machines and num_workers workers
+size_t sm_executor_arena_size(uint32_t max_machines, uint32_t num_workers);
+sm_result_t sm_executor_init(sm_executor_t *executor, uint32_t max_machines, uint32_t num_workers, void *arena, size_t arena_size);
+// Register an initialized machine with an attached event queue, before sm_executor_start.
+// From then on drive it only through sm_executor_post.
+sm_result_t sm_executor_add(sm_executor_t *executor, state_machine_t *sm, uint32_t *id);
+// SM_ERROR_SYSTEM (errno set) if a worker thread cannot be created; the
+// workers started before it are joined and the executor stays stopped
+sm_result_t sm_executor_start(sm_executor_t *executor);
+// From any thread, including callbacks running on the pool.
+// SM_ERROR_QUEUE_FULL if the machine's queue is full.
+sm_result_t sm_executor_post(sm_executor_t *executor, uint32_t id, sm_event_t event);
+// Wait until every posted event has been dispatched, then join the workers
+sm_result_t sm_executor_stop(sm_executor_t *executor);
+
+sm_result_t sm_executor_get_stats(const sm_executor_t *executor, sm_executor_stats_t *stats);
+sm_result_t sm_executor_get_machine_stats(const sm_executor_t *executor, uint32_t id, sm_executor_machine_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
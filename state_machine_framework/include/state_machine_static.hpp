@@ -0,0 +1,221 @@
+#ifndef STATE_MACHINE_STATIC_HPP
+#define STATE_MACHINE_STATIC_HPP
+
+#include "state_machine.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+// Compile-time dispatch for state machines whose tables are constexpr (C++17).
+//
+//   constexpr sm_state_tab_t light_states[] = {...};
+//   constexpr sm_transition_tab_t light_transitions[] = {...};
+//   (or constexpr std::array<...>, e.g. built by a constexpr function)
+//   using light = sm::static_machine<light_states, light_transitions>;
+//
+//   light::init(&sm, "Light", RED);          // plain sm_init underneath
+//   light::process_event(&sm, EVENT_TIMER);  // same effect as sm_process_event
+//   static_assert(light::next_state(RED, EVENT_TIMER) == RED_YELLOW);
+//
+// The tables are checked while compiling: unknown states, a state listed
+// twice and two transitions for the same (state, event) pair do not build.
+// The dispatch table is built by the compiler, so process_event is an array
+// lookup with no search and no index in memory beyond a constant table.
+// The machine is an ordinary state_machine_t: status, names, stats, the
+// event queue and sm_process_event all keep working on it.
+
+namespace sm {
+
+// Largest event ID for which events map to dispatch columns by direct
+// indexing; machines with larger IDs use a binary search over their events
+constexpr std::size_t static_max_event_span = 1024;
+
+template <const auto& States, const auto& Transitions>
+class static_machine {
+public:
+    static constexpr std::size_t num_states = std::size(States);
+    static constexpr std::size_t num_transitions = std::size(Transitions);
+
+private:
+    static constexpr std::uint16_t none = SM_NO_INDEX;
+
+    static constexpr std::size_t row_of(sm_state_t state) {
+        for (std::size_t i = 0; i < num_states; i++) {
+            if (States[i].state == state) return i;
+        }
+        return none;
+    }
+
+    static constexpr bool states_unique() {
+        for (std::size_t i = 0; i < num_states; i++) {
+            if (row_of(States[i].state) != i) return false;
+        }
+        return true;
+    }
+
+    static constexpr bool transitions_known() {
+        for (std::size_t i = 0; i < num_transitions; i++) {
+            if (row_of(Transitions[i].from_state) == none || row_of(Transitions[i].to_state) == none) return false;
+        }
+        return true;
+    }
+
+    static constexpr bool transitions_unique() {
+        for (std::size_t i = 0; i < num_transitions; i++) {
+            for (std::size_t j = 0; j < i; j++) {
+                if (Transitions[i].from_state == Transitions[j].from_state &&
+                    Transitions[i].event == Transitions[j].event) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    static_assert(num_states > 0 && num_states < SM_NO_INDEX, "state table must have 1..65534 states");
+    static_assert(num_transitions < SM_NO_INDEX, "transition table must have fewer than 65535 rows");
+    static_assert(states_unique(), "a state is listed twice in the state table");
+    static_assert(transitions_known(), "a transition starts or ends in a state missing from the state table");
+    static_assert(transitions_unique(), "two transitions for the same (state, event) pair");
+
+    // Distinct events, ascending; column c + 1 of the dispatch table is events[c],
+    // column 0 stays empty for events no transition uses
+    static constexpr std::size_t count_events() {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < num_transitions; i++) {
+            bool seen = false;
+            for (std::size_t j = 0; j < i; j++) seen = seen || Transitions[j].event == Transitions[i].event;
+            if (!seen) count++;
+        }
+        return count;
+    }
+    static constexpr std::size_t num_events = count_events();
+
+    static constexpr std::array<sm_event_t, num_events> make_events() {
+        std::array<sm_event_t, num_events> events{};
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < num_transitions; i++) {
+            sm_event_t event = Transitions[i].event;
+            std::size_t at = 0;
+            while (at < count && events[at] < event) at++;
+            if (at < count && events[at] == event) continue;
+            for (std::size_t k = count; k > at; k--) events[k] = events[k - 1];
+            events[at] = event;
+            count++;
+        }
+        return events;
+    }
+    static constexpr std::array<sm_event_t, num_events> events = make_events();
+
+    static constexpr std::size_t event_span = num_events ? std::size_t(events[num_events - 1]) + 1 : 0;
+    static constexpr bool direct_columns = event_span <= static_max_event_span;
+
+    static constexpr std::size_t search_column(sm_event_t event) {
+        std::size_t lo = 0, hi = num_events;
+        while (lo < hi) {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (events[mid] < event) lo = mid + 1;
+            else hi = mid;
+        }
+        return (lo < num_events && events[lo] == event) ? lo + 1 : 0;
+    }
+
+    static constexpr std::array<std::uint16_t, direct_columns ? event_span : 0> make_columns() {
+        std::array<std::uint16_t, direct_columns ? event_span : 0> columns{};
+        for (std::size_t e = 0; e < columns.size(); e++) {
+            columns[e] = static_cast<std::uint16_t>(search_column(static_cast<sm_event_t>(e)));
+        }
+        return columns;
+    }
+    static constexpr auto columns = make_columns();
+
+    // [column][state row] -> transition index, none if no transition
+    static constexpr std::array<std::uint16_t, (num_events + 1) * num_states> make_dispatch() {
+        std::array<std::uint16_t, (num_events + 1) * num_states> dispatch{};
+        for (auto& slot : dispatch) slot = none;
+        for (std::size_t i = 0; i < num_transitions; i++) {
+            std::size_t column = search_column(Transitions[i].event);
+            dispatch[column * num_states + row_of(Transitions[i].from_state)] = static_cast<std::uint16_t>(i);
+        }
+        return dispatch;
+    }
+    static constexpr auto dispatch = make_dispatch();
+
+    // Transition index -> state row of its to_state
+    static constexpr std::array<std::uint16_t, num_transitions> make_targets() {
+        std::array<std::uint16_t, num_transitions> targets{};
+        for (std::size_t i = 0; i < num_transitions; i++) {
+            targets[i] = static_cast<std::uint16_t>(row_of(Transitions[i].to_state));
+        }
+        return targets;
+    }
+    static constexpr auto targets = make_targets();
+
+    static constexpr std::size_t column_of(sm_event_t event) {
+        if constexpr (direct_columns) {
+            return event < event_span ? columns[event] : 0;
+        } else {
+            return search_column(event);
+        }
+    }
+
+public:
+    // Compile-time queries, e.g. for static_assert on the intended flow
+    static constexpr bool has_transition(sm_state_t from, sm_event_t event) {
+        std::size_t row = row_of(from);
+        return row != none && dispatch[column_of(event) * num_states + row] != none;
+    }
+    // Target of (from, event), or `from` itself if there is no such transition
+    static constexpr sm_state_t next_state(sm_state_t from, sm_event_t event) {
+        return has_transition(from, event)
+            ? Transitions[dispatch[column_of(event) * num_states + row_of(from)]].to_state
+            : from;
+    }
+
+    // sm_init with these tables; for more than SM_MAX_STATES/SM_MAX_TRANSITIONS pass an arena
+    static sm_result_t init(state_machine_t* sm, const char* id, sm_state_t initial_state) {
+        return sm_init(sm, id, initial_state, std::data(States), static_cast<std::uint16_t>(num_states),
+                       std::data(Transitions), static_cast<std::uint16_t>(num_transitions));
+    }
+    static sm_result_t init(state_machine_t* sm, const char* id, sm_state_t initial_state, void* arena,
+                            std::size_t arena_size) {
+        return sm_init_with_arena(sm, id, initial_state, std::data(States), static_cast<std::uint16_t>(num_states),
+                                  std::data(Transitions), static_cast<std::uint16_t>(num_transitions), arena, arena_size);
+    }
+
+    // Same contract as sm_process_event. A machine set up with other tables,
+    // as a hierarchy, with an on_state_change hook, tracing, metrics or logging
+    // on, is handed to sm_process_event itself.
+    static sm_result_t process_event(state_machine_t* sm, sm_event_t event) {
+        if (!sm) return SM_ERROR_NULL_POINTER;
+        if (!sm->initialized) return SM_ERROR_NOT_INITIALIZED;
+        if (sm->state_table != std::data(States) || sm->transition_table != std::data(Transitions) ||
+            sm->hierarchy || sm->on_state_change || sm->trace || SM_METRICS_ATTACHED(sm) ||
+            sm->logging_enabled) {
+            return sm_process_event(sm, event);
+        }
+
+        std::uint16_t index = dispatch[column_of(event) * num_states + sm->current_index];
+        if (index == none) {
+            sm->invalid_event_count++;
+            return SM_ERROR_INVALID_EVENT;
+        }
+        const sm_transition_tab_t& transition = Transitions[index];
+        const sm_state_tab_t& old_state_def = States[sm->current_index];
+        if (old_state_def.on_exit) old_state_def.on_exit(sm, sm->current_state);
+        if (transition.action) transition.action(sm, transition.from_state, transition.to_state, transition.event);
+
+        sm->current_state = transition.to_state;
+        sm->current_index = targets[index];
+        sm->transition_count++;
+
+        const sm_state_tab_t& new_state_def = States[sm->current_index];
+        if (new_state_def.on_entry) new_state_def.on_entry(sm, sm->current_state);
+        return SM_SUCCESS;
+    }
+};
+
+} // namespace sm
+
+#endif
@@ -0,0 +1,132 @@
+#ifndef STATE_MACHINE_TIMER_H
+#define STATE_MACHINE_TIMER_H
+
+#include "state_machine.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Timeouts for many state machines on one hierarchical timer wheel.
+//
+// A timer belongs to a machine and, when it expires, runs its event through
+// sm_process_event. sm_timer_attach gives a machine a timer that follows its
+// state: every transition re-arms it from the machine's timeout table, or
+// leaves it idle if the new state has no timeout. Arming and cancelling are
+// O(1); expiry costs O(1) per timer plus one move per wheel level it falls
+// through. The wheel, its machines and the loop driving it belong to one thread.
+
+#define SM_TIMER_LEVELS 4           // Levels of the wheel; together they span 2^32 ticks
+#define SM_TIMER_SLOTS 256          // Slots per level
+#define SM_TIMER_NONE 0xFFFFFFFFu   // No timer (list terminator)
+
+// Timeout of a state: after timeout_ms in `state`, `event` is processed
+typedef struct{
+    sm_state_t state;
+    uint32_t timeout_ms;
+    sm_event_t event;
+} sm_timeout_tab_t;
+
+typedef struct sm_timer_wheel sm_timer_wheel_t;
+
+typedef struct{
+    uint32_t next;                  // Neighbours in its wheel slot, or the free list
+    uint32_t prev;
+    uint16_t slot;                  // Wheel slot it is linked in, or idle/free
+    sm_event_t event;               // Processed by `machine` when it expires
+    uint16_t num_timeouts;
+    uint64_t expires;               // Tick
+    state_machine_t *machine;
+    const sm_timeout_tab_t *timeouts;   // Set by sm_timer_attach
+    sm_timer_wheel_t *wheel;            // Set by sm_timer_attach
+} sm_timer_t;
+
+struct sm_timer_wheel{
+    sm_timer_t *timers;             // Caller storage
+    uint32_t max_timers;
+    uint32_t num_timers;            // Ever handed out; freed ones go on free_list
+    uint32_t free_list;
+    uint32_t num_free;
+    uint32_t tick_ms;
+    uint64_t now;                   // Current tick
+    uint32_t heads[SM_TIMER_LEVELS * SM_TIMER_SLOTS];       // Slot lists
+    uint64_t occupied[SM_TIMER_LEVELS * SM_TIMER_SLOTS / 64];  // Non-empty slots
+    uint32_t armed;
+    uint32_t max_armed;
+    uint64_t expired;
+    uint64_t cascaded;              // Moves to a lower level
+};
+
+typedef struct{
+    uint32_t timers;                // In use
+    uint32_t armed;
+    uint32_t max_armed;
+    uint64_t expired;
+    uint64_t cascaded;
+    uint64_t now;                   // Current tick
+} sm_timer_stats_t;
+
+// Arena bytes sm_timer_init needs for max_timers timers
+size_t sm_timer_arena_size(uint32_t max_timers);
+// tick_ms is the resolution: delays are rounded up to whole ticks
+sm_result_t sm_timer_init(sm_timer_wheel_t *wheel, uint32_t tick_ms, uint32_t max_timers, void *arena, size_t arena_size);
+
+// A timer injecting events into `sm`. SM_ERROR_TABLE_FULL if all max_timers are in use.
+sm_result_t sm_timer_create(sm_timer_wheel_t *wheel, state_machine_t *sm, uint32_t *id);
+// Expire after delay_ms (at least one tick) with `event`; an armed timer is moved
+sm_result_t sm_timer_arm(sm_timer_wheel_t *wheel, uint32_t id, uint32_t delay_ms, sm_event_t event);
+sm_result_t sm_timer_cancel(sm_timer_wheel_t *wheel, uint32_t id);
+// Cancel and free the timer; an attached machine stops following its timeouts
+sm_result_t sm_timer_destroy(sm_timer_wheel_t *wheel, uint32_t id);
+
+// A timer that follows an initialized machine's current_state through
+// `timeouts`, armed now for the state it is in. The table must outlive the
+// timer. Takes over the machine's on_state_change hook until sm_timer_destroy.
+sm_result_t sm_timer_attach(sm_timer_wheel_t *wheel, state_machine_t *sm, const sm_timeout_tab_t *timeouts, uint16_t num_timeouts, uint32_t *id);
+
+// Move the wheel to tick `now`, expiring every timer due by then in order.
+// `expired` (may be NULL) receives the number of timers that expired.
+sm_result_t sm_timer_advance(sm_timer_wheel_t *wheel, uint64_t now, uint32_t *expired);
+// Earliest tick at which sm_timer_advance has work to do; false if nothing is armed
+bool sm_timer_next_tick(const sm_timer_wheel_t *wheel, uint64_t *tick);
+sm_result_t sm_timer_get_stats(const sm_timer_wheel_t *wheel, sm_timer_stats_t *stats);
+
+// Event loop: one timerfd, set to the wheel's next tick, and any other file
+// descriptors, in one epoll set (Linux; elsewhere the loop returns
+// SM_ERROR_SYSTEM). The wheel's clock only runs inside sm_timer_loop_run:
+// timers armed between runs count from the start of the next run.
+
+#define SM_TIMER_LOOP_MAX_WATCHES 8
+
+typedef void (*sm_fd_fn_t)(int fd, void *context);
+
+typedef struct{
+    int fd;
+    sm_fd_fn_t on_readable;
+    void *context;
+} sm_timer_watch_t;
+
+typedef struct{
+    sm_timer_wheel_t *wheel;
+    int epoll_fd;
+    int timer_fd;
+    uint64_t origin_ns;             // Monotonic time of tick 0 for the current run
+    bool running;
+    sm_timer_watch_t watches[SM_TIMER_LOOP_MAX_WATCHES];
+    uint32_t num_watches;
+} sm_timer_loop_t;
+
+sm_result_t sm_timer_loop_init(sm_timer_loop_t *loop, sm_timer_wheel_t *wheel);
+// Call on_readable from the loop whenever `fd` has input
+sm_result_t sm_timer_loop_watch(sm_timer_loop_t *loop, int fd, sm_fd_fn_t on_readable, void *context);
+// Run for duration_ms, or until sm_timer_loop_stop if 0
+sm_result_t sm_timer_loop_run(sm_timer_loop_t *loop, uint32_t duration_ms);
+// From a callback running on the loop: return from sm_timer_loop_run
+void sm_timer_loop_stop(sm_timer_loop_t *loop);
+void sm_timer_loop_close(sm_timer_loop_t *loop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
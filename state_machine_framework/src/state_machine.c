@@ -1,53 +1,433 @@
 #include "state_machine.h"
 
+// Dispatch index layout in the arena, all uint16_t words:
+//   row_start[num_states + 1]        row r owns entries row_start[r] .. row_start[r + 1] - 1
+//   state_order[num_states]          state rows sorted by state value
+//   row_event[num_transitions]       event of each entry, ascending within a row
+//   row_transition[num_transitions]  entry -> transition_table index
+//   row_target[num_transitions]      entry -> state row of its to_state
+typedef struct{
+    uint16_t *row_start;
+    uint16_t *state_order;
+    sm_event_t *row_event;
+    uint16_t *row_transition;
+    uint16_t *row_target;
+} sm_index_t;
+
+// Hierarchical machines keep more in the arena, after the dispatch index:
+//   parent[num_states]               state row -> row of its parent, SM_NO_INDEX at the top
+//   initial[num_states]              state row -> row of its initial substate, SM_NO_INDEX for a leaf
+//   chain_start[num_states + 1]      row r's ancestor chain is chain[chain_start[r] .. chain_start[r + 1] - 1]
+//   row_exits[num_entries]           states an entry exits: the first ones of the current leaf's chain
+//   row_enters[num_entries]          states it enters: the first ones of the target leaf's chain, in reverse
+//   own_start[num_states + 1]        transitions defined on each state itself (CSR, sorted by event)
+//   own[num_transitions]
+//   chain[]                          each row, then its parent, up to its top-level state
+typedef struct{
+    uint16_t *parent;
+    uint16_t *initial;
+    uint16_t *chain_start;
+    uint16_t *row_exits;
+    uint16_t *row_enters;
+    uint16_t *own_start;
+    uint16_t *own;
+    uint16_t *chain;
+} sm_hierarchy_t;
+
+// Rows shorter than this are scanned, longer ones binary searched first
+#define SM_LINEAR_SEARCH_MAX 8
+// sm_pool_process_event prefetches the instance this many events ahead
+#define SM_POOL_PREFETCH 8
+
+typedef uint32_t (*sm_sort_key_fn_t)(const state_machine_t *sm, uint16_t item);
+
 //helper
-static bool is_valid_state(state_machine_t* sm, sm_state_t state){
-    if (!sm || !sm->state_table) return false;
-    for (uint8_t i = 0; i < sm->num_states; i++){
+static sm_index_t get_index(const state_machine_t *sm){
+    uint16_t *base = sm->arena ? sm->arena : (uint16_t *)sm->inline_arena;
+    sm_index_t index;
+    index.row_start = base;
+    index.state_order = index.row_start + sm->num_states + 1;
+    index.row_event = index.state_order + sm->num_states;
+    index.row_transition = index.row_event + sm->num_entries;
+    index.row_target = index.row_transition + sm->num_entries;
+    return index;
+}
+static sm_hierarchy_t get_hierarchy(const state_machine_t *sm){
+    sm_hierarchy_t tree;
+    tree.parent = sm->hierarchy;
+    tree.initial = tree.parent + sm->num_states;
+    tree.chain_start = tree.initial + sm->num_states;
+    tree.row_exits = tree.chain_start + sm->num_states + 1;
+    tree.row_enters = tree.row_exits + sm->num_entries;
+    tree.own_start = tree.row_enters + sm->num_entries;
+    tree.own = tree.own_start + sm->num_states + 1;
+    tree.chain = tree.own + sm->num_transitions;
+    return tree;
+}
+// Binary search of state_order; the first row wins if a state is listed twice
+static uint16_t search_state_order(const state_machine_t *sm, const uint16_t *state_order, sm_state_t state){
+    uint32_t lo = 0, hi = sm->num_states;
+    while (lo < hi){
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (sm->state_table[state_order[mid]].state < state) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo < sm->num_states && sm->state_table[state_order[lo]].state == state)
+        return state_order[lo];
+    return SM_NO_INDEX;
+}
+static uint16_t find_state_index(const state_machine_t* sm, sm_state_t state){
+    if (!sm || !sm->state_table) return SM_NO_INDEX;
+    if (sm->initialized) return search_state_order(sm, get_index(sm).state_order, state);
+    for (uint16_t i = 0; i < sm->num_states; i++){
         if(sm->state_table[i].state == state)
-            return true;
+            return i;
     }
-        return false;
+        return SM_NO_INDEX;
 }
 static const sm_state_tab_t* find_state_def(const state_machine_t* sm, sm_state_t state){
-    if(!sm || !sm->state_table) return NULL;
-    for (uint8_t i = 0; i < sm->num_states; i++){
-        if(sm->state_table[i].state == state){
-            return &sm->state_table[i];
-        }
+    uint16_t index = find_state_index(sm, state);
+    if(index == SM_NO_INDEX) return NULL;
+    return &sm->state_table[index];
+}
+// Entry of `event` in state row `row`, or SM_NO_INDEX
+static uint16_t find_entry(const sm_index_t *index, uint16_t row, sm_event_t event){
+    uint32_t lo = index->row_start[row];
+    uint32_t end = index->row_start[row + 1];
+    uint32_t hi = end;
+    while (hi - lo > SM_LINEAR_SEARCH_MAX){
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (index->row_event[mid] < event) lo = mid + 1;
+        else hi = mid;
+    }
+    // Count the smaller events instead of stopping at the first match: the
+    // loop length is then the row length, which predicts well, not the event
+    uint32_t below = lo;
+    for (uint32_t i = lo; i < hi; i++){
+        below += index->row_event[i] < event;
+    }
+    if (below < end && index->row_event[below] == event) return (uint16_t)below;
+    return SM_NO_INDEX;
+}
+
+// Keys are unique (value << 16 | position), so heapsort gives the same order
+// a stable sort would: ties keep table order and the first row wins
+static uint32_t state_key(const state_machine_t *sm, uint16_t row){
+    return ((uint32_t)sm->state_table[row].state << 16) | row;
+}
+static uint32_t transition_key(const state_machine_t *sm, uint16_t transition){
+    return ((uint32_t)sm->transition_table[transition].event << 16) | transition;
+}
+static void sift_down(const state_machine_t *sm, uint16_t *items, uint32_t root, uint32_t count, sm_sort_key_fn_t key){
+    while (2 * root + 1 < count){
+        uint32_t child = 2 * root + 1;
+        if (child + 1 < count && key(sm, items[child + 1]) > key(sm, items[child])) child++;
+        if (key(sm, items[root]) >= key(sm, items[child])) return;
+        uint16_t tmp = items[root];
+        items[root] = items[child];
+        items[child] = tmp;
+        root = child;
+    }
+}
+static void sort_by_key(const state_machine_t *sm, uint16_t *items, uint32_t count, sm_sort_key_fn_t key){
+    for (uint32_t i = count / 2; i-- > 0;){
+        sift_down(sm, items, i, count, key);
+    }
+    for (uint32_t end = count; end-- > 1;){
+        uint16_t tmp = items[0];
+        items[0] = items[end];
+        items[end] = tmp;
+        sift_down(sm, items, 0, end, key);
     }
-    return NULL;
 }
-static const sm_transition_tab_t *find_transition_def(const state_machine_t *sm,sm_state_t state, sm_event_t event){
-    //look for where the state corresponds to current state
-    //then check if event corresponds
-    if(!sm || !sm->transition_table) return NULL; 
-    for (uint8_t i = 0; i < sm->num_transitions; i++){
-        if((sm->transition_table[i].from_state == state) && (sm->transition_table[i].event == event)){
-            return &sm->transition_table[i];
+
+static void sort_state_order(const state_machine_t *sm, uint16_t *state_order){
+    for (uint16_t i = 0; i < sm->num_states; i++){
+        state_order[i] = i;
+    }
+    sort_by_key(sm, state_order, sm->num_states, state_key);
+}
+
+// Group the transitions by source state row (CSR in row_start/items), each
+// row sorted by event: a counting sort by row, then a sort of each row
+static sm_result_t group_by_row(const state_machine_t *sm, const uint16_t *state_order, uint16_t *row_start, uint16_t *items){
+    uint16_t num_states = sm->num_states;
+    uint16_t num_transitions = sm->num_transitions;
+
+    // Rows are counted in row_start[row + 1], turned into start offsets,
+    // advanced while placing, then shifted back by one
+    memset(row_start, 0, ((size_t)num_states + 1) * sizeof(uint16_t));
+    for (uint16_t i = 0; i < num_transitions; i++){
+        const sm_transition_tab_t *transition = &sm->transition_table[i];
+        uint16_t from = search_state_order(sm, state_order, transition->from_state);
+        uint16_t to = search_state_order(sm, state_order, transition->to_state);
+        if(from == SM_NO_INDEX || to == SM_NO_INDEX){
+            return SM_ERROR_INVALID_STATE;
         }
+        row_start[from + 1]++;
+    }
+    for (uint32_t row = 0; row < num_states; row++){
+        row_start[row + 1] += row_start[row];
+    }
+    for (uint16_t i = 0; i < num_transitions; i++){
+        uint16_t from = search_state_order(sm, state_order, sm->transition_table[i].from_state);
+        items[row_start[from]++] = i;
+    }
+    for (uint32_t row = num_states; row > 0; row--){
+        row_start[row] = row_start[row - 1];
+    }
+    row_start[0] = 0;
+
+    for (uint32_t row = 0; row < num_states; row++){
+        uint16_t first = row_start[row];
+        sort_by_key(sm, &items[first], (uint32_t)row_start[row + 1] - first, transition_key);
+    }
+    return SM_SUCCESS;
+}
+
+// Build the CSR index used by sm_process_event, without allocating.
+// O(T log T) for T transitions.
+static sm_result_t build_dispatch_index(state_machine_t *sm){
+    sm_index_t index = get_index(sm);
+
+    sort_state_order(sm, index.state_order);
+    sm_result_t result = group_by_row(sm, index.state_order, index.row_start, index.row_transition);
+    if (result != SM_SUCCESS){
+        return result;
+    }
+    for (uint16_t i = 0; i < sm->num_transitions; i++){
+        const sm_transition_tab_t *transition = &sm->transition_table[index.row_transition[i]];
+        index.row_event[i] = transition->event;
+        index.row_target[i] = search_state_order(sm, index.state_order, transition->to_state);
+    }
+    return SM_SUCCESS;
+}
+
+// Hierarchy checks on the raw definition, before any index exists: linear
+// lookups, O(states x depth x (hierarchy rows + transitions)), once per machine
+static uint16_t def_row(const sm_hierarchy_def_t *def, sm_state_t state){
+    for (uint16_t i = 0; i < def->num_states; i++){
+        if (def->states[i].state == state) return i;
+    }
+    return SM_NO_INDEX;
+}
+static const sm_hierarchy_tab_t *def_node(const sm_hierarchy_def_t *def, sm_state_t state){
+    for (uint16_t i = 0; i < def->num_hierarchy; i++){
+        if (def->hierarchy[i].state == state) return &def->hierarchy[i];
     }
     return NULL;
 }
+static sm_state_t def_parent(const sm_hierarchy_def_t *def, sm_state_t state){
+    const sm_hierarchy_tab_t *node = def_node(def, state);
+    return node ? node->parent : SM_NO_STATE;
+}
+// Region of a state's top-level ancestor; the hierarchy must be free of cycles
+static uint8_t def_region(const sm_hierarchy_def_t *def, sm_state_t state){
+    while (def_parent(def, state) != SM_NO_STATE) state = def_parent(def, state);
+    const sm_hierarchy_tab_t *node = def_node(def, state);
+    return node ? node->region : 0;
+}
 
-//core
-sm_result_t sm_init(state_machine_t *sm, const char *id, sm_state_t initial_state, const sm_state_tab_t *state_table, uint8_t num_states, const sm_transition_tab_t * transition_table, uint8_t num_transitions){
-    if(sm == NULL){
+// Validate a hierarchical definition and size its index: entries (an upper
+// bound, since a state may override an event of its parent) and chain words
+static sm_result_t measure_hierarchy(const sm_hierarchy_def_t *def, uint32_t *num_entries, uint32_t *chain_words){
+    if (!def->states || !def->transitions || !def->initial_states || (def->num_hierarchy && !def->hierarchy)){
         return SM_ERROR_NULL_POINTER;
     }
+    if (def->num_states == 0 || def->num_states == SM_NO_INDEX || def->num_regions == 0 || def->num_regions > SM_MAX_REGIONS){
+        return SM_ERROR_INVALID_STATE;
+    }
 
-    if(id == NULL || state_table == NULL || transition_table == NULL){
-        return SM_ERROR_NULL_POINTER;
+    for (uint16_t i = 0; i < def->num_states; i++){
+        if (def_row(def, def->states[i].state) != i) return SM_ERROR_INVALID_STATE;     // Listed twice
+    }
+    for (uint16_t i = 0; i < def->num_hierarchy; i++){
+        const sm_hierarchy_tab_t *node = &def->hierarchy[i];
+        if (def_row(def, node->state) == SM_NO_INDEX || def_node(def, node->state) != node){
+            return SM_ERROR_INVALID_STATE;
+        }
+        if (node->parent != SM_NO_STATE){
+            // Only composite states, which know where to start, can have substates
+            const sm_hierarchy_tab_t *parent = def_node(def, node->parent);
+            if (!parent || parent->initial == SM_NO_STATE) return SM_ERROR_INVALID_STATE;
+        } else if (node->region >= def->num_regions){
+            return SM_ERROR_INVALID_STATE;
+        }
+        if (node->initial != SM_NO_STATE && def_parent(def, node->initial) != node->state){
+            return SM_ERROR_INVALID_STATE;
+        }
     }
 
-    if(num_states == 0 || num_states > SM_MAX_STATES){
-        return SM_ERROR_INVALID_STATE;
+    uint32_t entries = 0, chain = 0;
+    for (uint16_t i = 0; i < def->num_states; i++){
+        sm_state_t state = def->states[i].state;
+        uint32_t depth = 1;
+        for (sm_state_t up = def_parent(def, state); up != SM_NO_STATE; up = def_parent(def, up)){
+            if (++depth > SM_MAX_DEPTH) return SM_ERROR_INVALID_STATE;  // Too deep, or a cycle
+        }
+        chain += depth;
+
+        const sm_hierarchy_tab_t *node = def_node(def, state);
+        if (node && node->initial != SM_NO_STATE) continue;
+        // A leaf's row holds its own transitions and those of every state enclosing it
+        for (sm_state_t up = state; up != SM_NO_STATE; up = def_parent(def, up)){
+            for (uint16_t t = 0; t < def->num_transitions; t++){
+                entries += def->transitions[t].from_state == up;
+            }
+        }
     }
 
-    if(num_transitions >SM_MAX_TRANSITIONS){
+    for (uint16_t t = 0; t < def->num_transitions; t++){
+        const sm_transition_tab_t *transition = &def->transitions[t];
+        if (def_row(def, transition->from_state) == SM_NO_INDEX || def_row(def, transition->to_state) == SM_NO_INDEX ||
+            def_region(def, transition->from_state) != def_region(def, transition->to_state)){
+            return SM_ERROR_INVALID_STATE;
+        }
+    }
+    for (uint8_t region = 0; region < def->num_regions; region++){
+        sm_state_t state = def->initial_states[region];
+        if (def_row(def, state) == SM_NO_INDEX || def_region(def, state) != region){
+            return SM_ERROR_INVALID_STATE;
+        }
+    }
+
+    if (entries > 0xFFFF || chain > 0xFFFF){
         return SM_ERROR_TABLE_FULL;
     }
+    *num_entries = entries;
+    *chain_words = chain;
+    return SM_SUCCESS;
+}
+static size_t hierarchy_arena_words(const sm_hierarchy_def_t *def, uint32_t num_entries, uint32_t chain_words){
+    size_t num_states = def->num_states;
+    return SM_ARENA_WORDS(num_states, num_entries) + 4 * num_states + 2 + 2 * (size_t)num_entries +
+           def->num_transitions + chain_words;
+}
+
+//helper
+static uint16_t chain_length(const sm_hierarchy_t *tree, uint16_t row){
+    return (uint16_t)(tree->chain_start[row + 1] - tree->chain_start[row]);
+}
+// Position of `row` in a chain, or the chain length if it is not there
+static uint16_t chain_position(const sm_hierarchy_t *tree, uint16_t chain_row, uint16_t row){
+    const uint16_t *chain = &tree->chain[tree->chain_start[chain_row]];
+    uint16_t length = chain_length(tree, chain_row);
+    uint16_t position = 0;
+    while (position < length && chain[position] != row) position++;
+    return position;
+}
+static uint16_t initial_leaf(const sm_hierarchy_t *tree, uint16_t row){
+    while (tree->initial[row] != SM_NO_INDEX) row = tree->initial[row];
+    return row;
+}
+// on_exit for the first `count` states of `row`'s chain, innermost first
+static inline void exit_states(state_machine_t *sm, const sm_hierarchy_t *tree, uint16_t row, uint16_t count){
+    const uint16_t *chain = &tree->chain[tree->chain_start[row]];
+    for (uint16_t i = 0; i < count; i++){
+        const sm_state_tab_t *state_def = &sm->state_table[chain[i]];
+        if (state_def->on_exit) state_def->on_exit(sm, state_def->state);
+    }
+}
+// on_entry for the first `count` states of `row`'s chain, outermost first
+static inline void enter_states(state_machine_t *sm, const sm_hierarchy_t *tree, uint16_t row, uint16_t count){
+    const uint16_t *chain = &tree->chain[tree->chain_start[row]];
+    for (uint16_t i = count; i-- > 0;){
+        const sm_state_tab_t *state_def = &sm->state_table[chain[i]];
+        if (state_def->on_entry) state_def->on_entry(sm, state_def->state);
+    }
+}
+
+// Fill in entry `entry` of leaf row `row` for a transition defined on `source`
+// (row itself or an ancestor). The transition leaves everything below its
+// domain, the lowest state strictly enclosing both source and target, so a
+// transition to self or to an enclosing state exits and re-enters it.
+static void add_entry(state_machine_t *sm, const sm_index_t *index, const sm_hierarchy_t *tree, uint16_t row, uint16_t source, uint16_t transition, uint32_t entry){
+    const sm_transition_tab_t *def = &sm->transition_table[transition];
+    uint16_t target = search_state_order(sm, index->state_order, def->to_state);
+    uint16_t leaf = initial_leaf(tree, target);
+
+    uint16_t domain = tree->parent[source];
+    while (domain != SM_NO_INDEX && (domain == target || chain_position(tree, target, domain) == chain_length(tree, target))){
+        domain = tree->parent[domain];
+    }
+
+    index->row_event[entry] = def->event;
+    index->row_transition[entry] = transition;
+    index->row_target[entry] = leaf;
+    tree->row_exits[entry] = chain_position(tree, row, domain);
+    tree->row_enters[entry] = chain_position(tree, leaf, domain);
+}
+
+// Build the index of a checked hierarchical definition: every leaf gets one
+// row holding its own transitions and, for events it does not handle itself,
+// those of the states enclosing it (the nearest one wins). Composite states
+// are never current and keep an empty row.
+static void build_hierarchy_index(state_machine_t *sm, const sm_hierarchy_def_t *def){
+    sm_index_t index = get_index(sm);
+    sm_hierarchy_t tree = get_hierarchy(sm);
+    uint16_t num_states = sm->num_states;
+
+    sort_state_order(sm, index.state_order);
+    group_by_row(sm, index.state_order, tree.own_start, tree.own);
+
+    for (uint16_t row = 0; row < num_states; row++){
+        tree.parent[row] = SM_NO_INDEX;
+        tree.initial[row] = SM_NO_INDEX;
+    }
+    for (uint16_t i = 0; i < def->num_hierarchy; i++){
+        const sm_hierarchy_tab_t *node = &def->hierarchy[i];
+        uint16_t row = search_state_order(sm, index.state_order, node->state);
+        if (node->parent != SM_NO_STATE) tree.parent[row] = search_state_order(sm, index.state_order, node->parent);
+        if (node->initial != SM_NO_STATE) tree.initial[row] = search_state_order(sm, index.state_order, node->initial);
+    }
+
+    uint16_t words = 0;
+    for (uint16_t row = 0; row < num_states; row++){
+        tree.chain_start[row] = words;
+        for (uint16_t up = row; up != SM_NO_INDEX; up = tree.parent[up]){
+            tree.chain[words++] = up;
+        }
+    }
+    tree.chain_start[num_states] = words;
+
+    // Merge the event-sorted own rows along each leaf's chain
+    uint32_t entry = 0;
+    for (uint16_t row = 0; row < num_states; row++){
+        index.row_start[row] = (uint16_t)entry;
+        if (tree.initial[row] != SM_NO_INDEX) continue;
+
+        const uint16_t *chain = &tree.chain[tree.chain_start[row]];
+        uint16_t depth = chain_length(&tree, row);
+        uint32_t next[SM_MAX_DEPTH];
+        for (uint16_t level = 0; level < depth; level++){
+            next[level] = tree.own_start[chain[level]];
+        }
+        for (;;){
+            uint32_t event = 0x10000;
+            uint16_t nearest = 0;
+            for (uint16_t level = 0; level < depth; level++){
+                if (next[level] < tree.own_start[chain[level] + 1] &&
+                    sm->transition_table[tree.own[next[level]]].event < event){
+                    event = sm->transition_table[tree.own[next[level]]].event;
+                    nearest = level;
+                }
+            }
+            if (event == 0x10000) break;
+
+            add_entry(sm, &index, &tree, row, chain[nearest], tree.own[next[nearest]], entry++);
+            for (uint16_t level = 0; level < depth; level++){
+                while (next[level] < tree.own_start[chain[level] + 1] &&
+                       sm->transition_table[tree.own[next[level]]].event == event){
+                    next[level]++;
+                }
+            }
+        }
+    }
+    index.row_start[num_states] = (uint16_t)entry;
+}
 
+//core
+static void setup_machine(state_machine_t *sm, const char *id, sm_state_t initial_state, const sm_state_tab_t *state_table, uint16_t num_states, const sm_transition_tab_t *transition_table, uint16_t num_transitions, uint16_t *arena){
     memset(sm, 0, sizeof(state_machine_t));
 
     strncpy(sm->id, id, SM_MAX_ID_LENGTH - 1);
@@ -59,19 +439,44 @@ sm_result_t sm_init(state_machine_t *sm, const char *id, sm_state_t initial_stat
     sm->num_states = num_states;
     sm->transition_table = transition_table;
     sm->num_transitions = num_transitions;
+    sm->num_entries = num_transitions;
+    sm->num_regions = 1;
+    sm->arena = arena;
 
     sm->logging_enabled = false;
     sm->transition_count = 0;
     sm->invalid_event_count = 0;
+}
+// Tables and index, up to the machine being ready; no callback runs
+static sm_result_t build_machine(state_machine_t *sm, const char *id, sm_state_t initial_state, const sm_state_tab_t *state_table, uint16_t num_states, const sm_transition_tab_t *transition_table, uint16_t num_transitions, uint16_t *arena){
+    if(num_states == 0 || num_states == SM_NO_INDEX){
+        return SM_ERROR_INVALID_STATE;
+    }
+
+    setup_machine(sm, id, initial_state, state_table, num_states, transition_table, num_transitions, arena);
+
+    sm_result_t result = build_dispatch_index(sm);
 
-    if (!is_valid_state(sm, initial_state)){
+    if (result != SM_SUCCESS){
+        return result;
+    }
+
+    sm->current_index = search_state_order(sm, get_index(sm).state_order, initial_state);
+    if (sm->current_index == SM_NO_INDEX){
         return SM_ERROR_INVALID_STATE;
     }
 
     sm->initialized = true;
+    return SM_SUCCESS;
+}
+static sm_result_t init_machine(state_machine_t *sm, const char *id, sm_state_t initial_state, const sm_state_tab_t *state_table, uint16_t num_states, const sm_transition_tab_t *transition_table, uint16_t num_transitions, uint16_t *arena){
+    sm_result_t result = build_machine(sm, id, initial_state, state_table, num_states, transition_table, num_transitions, arena);
+    if (result != SM_SUCCESS){
+        return result;
+    }
 
-    const sm_state_tab_t *state_def = find_state_def(sm, initial_state);
-    if (state_def && state_def->on_entry) {
+    const sm_state_tab_t *state_def = &sm->state_table[sm->current_index];
+    if (state_def->on_entry) {
         state_def->on_entry(sm, initial_state);
     } 
 
@@ -82,29 +487,149 @@ sm_result_t sm_init(state_machine_t *sm, const char *id, sm_state_t initial_stat
 
     return SM_SUCCESS;
 }
+sm_result_t sm_init(state_machine_t *sm, const char *id, sm_state_t initial_state, const sm_state_tab_t *state_table, uint16_t num_states, const sm_transition_tab_t * transition_table, uint16_t num_transitions){
+    if(sm == NULL){
+        return SM_ERROR_NULL_POINTER;
+    }
+
+    if(id == NULL || state_table == NULL || transition_table == NULL){
+        return SM_ERROR_NULL_POINTER;
+    }
+
+    if(num_states == 0 || num_states > SM_MAX_STATES){
+        return SM_ERROR_INVALID_STATE;
+    }
+
+    if(num_transitions >SM_MAX_TRANSITIONS){
+        return SM_ERROR_TABLE_FULL;
+    }
+
+    return init_machine(sm, id, initial_state, state_table, num_states, transition_table, num_transitions, NULL);
+}
+sm_result_t sm_init_with_arena(state_machine_t *sm, const char *id, sm_state_t initial_state, const sm_state_tab_t *state_table, uint16_t num_states, const sm_transition_tab_t *transition_table, uint16_t num_transitions, void *arena, size_t arena_size){
+    if(sm == NULL || arena == NULL){
+        return SM_ERROR_NULL_POINTER;
+    }
+
+    if(id == NULL || state_table == NULL || transition_table == NULL){
+        return SM_ERROR_NULL_POINTER;
+    }
+
+    if(arena_size < SM_ARENA_SIZE(num_states, num_transitions)){
+        return SM_ERROR_TABLE_FULL;
+    }
+
+    return init_machine(sm, id, initial_state, state_table, num_states, transition_table, num_transitions, (uint16_t *)arena);
+}
+sm_result_t sm_hierarchy_arena_size(const sm_hierarchy_def_t *def, size_t *arena_size){
+    if(def == NULL || arena_size == NULL){
+        return SM_ERROR_NULL_POINTER;
+    }
+
+    uint32_t num_entries, chain_words;
+    sm_result_t result = measure_hierarchy(def, &num_entries, &chain_words);
+    if (result != SM_SUCCESS){
+        return result;
+    }
+
+    *arena_size = hierarchy_arena_words(def, num_entries, chain_words) * sizeof(uint16_t);
+    return SM_SUCCESS;
+}
+sm_result_t sm_init_hierarchical(state_machine_t *sm, const char *id, const sm_hierarchy_def_t *def, void *arena, size_t arena_size){
+    if(sm == NULL || id == NULL || def == NULL || arena == NULL){
+        return SM_ERROR_NULL_POINTER;
+    }
+
+    uint32_t num_entries, chain_words;
+    sm_result_t result = measure_hierarchy(def, &num_entries, &chain_words);
+    if (result != SM_SUCCESS){
+        return result;
+    }
+    if (arena_size < hierarchy_arena_words(def, num_entries, chain_words) * sizeof(uint16_t)){
+        return SM_ERROR_TABLE_FULL;
+    }
+
+    setup_machine(sm, id, def->initial_states[0], def->states, def->num_states, def->transitions, def->num_transitions, (uint16_t *)arena);
+    sm->num_entries = (uint16_t)num_entries;
+    sm->num_regions = def->num_regions;
+    sm->hierarchy = (uint16_t *)arena + SM_ARENA_WORDS(def->num_states, num_entries);
+    build_hierarchy_index(sm, def);
+
+    sm_index_t index = get_index(sm);
+    sm_hierarchy_t tree = get_hierarchy(sm);
+    for (uint8_t region = 0; region < sm->num_regions; region++){
+        uint16_t row = search_state_order(sm, index.state_order, def->initial_states[region]);
+        sm->region_initial[region] = initial_leaf(&tree, row);
+        sm->region_index[region] = sm->region_initial[region];
+    }
+    sm->current_index = sm->region_index[0];
+    sm->current_state = sm->state_table[sm->current_index].state;
+    sm->initial_state = sm->current_state;
+
+    sm->initialized = true;
+
+    for (uint8_t region = 0; region < sm->num_regions; region++){
+        uint16_t row = sm->region_index[region];
+        enter_states(sm, &tree, row, chain_length(&tree, row));
+    }
+
+    return SM_SUCCESS;
+}
+// Every region back to its initial leaf, leaving and entering whole chains
+static void reset_regions(state_machine_t *sm){
+    sm_hierarchy_t tree = get_hierarchy(sm);
+    for (uint8_t region = 0; region < sm->num_regions; region++){
+        uint16_t row = sm->region_index[region];
+        uint16_t initial = sm->region_initial[region];
+        if (row == initial) continue;
+
+        exit_states(sm, &tree, row, chain_length(&tree, row));
+        sm->region_index[region] = initial;
+        if (region == 0){
+            sm->current_index = initial;
+            sm->current_state = sm->initial_state;
+        }
+        enter_states(sm, &tree, initial, chain_length(&tree, initial));
+    }
+}
 sm_result_t sm_reset(state_machine_t *sm){
     if(!sm) return SM_ERROR_NULL_POINTER; 
     if(!sm->initialized) return SM_ERROR_NOT_INITIALIZED;
 
     sm_state_t old_state = sm->current_state;
 
-    if(old_state != sm->initial_state){
-        const sm_state_tab_t *current_state_def = find_state_def(sm, old_state);
-        if(current_state_def && current_state_def->on_exit){
-            current_state_def->on_exit(sm, old_state);
+    if(sm->hierarchy){
+        reset_regions(sm);
+    }else{
+#ifdef SM_METRICS
+        if(sm->metrics && old_state != sm->initial_state){
+            uint64_t now = sm_metrics_now();
+            sm_histogram_record(&sm->metrics->states[sm->current_index].dwell, now - sm->metrics->entered_ns);
+            sm->metrics->entered_ns = now;
+        }
+#endif
+        if(old_state != sm->initial_state){
+            const sm_state_tab_t *current_state_def = find_state_def(sm, old_state);
+            if(current_state_def && current_state_def->on_exit){
+                current_state_def->on_exit(sm, old_state);
+            }
         }
-    }
 
-    sm->current_state = sm->initial_state;
-    sm->transition_count = 0;
-    sm->invalid_event_count = 0;
+        sm->current_state = sm->initial_state;
+        sm->current_index = find_state_index(sm, sm->initial_state);
 
-    if(old_state != sm->initial_state){
-        const sm_state_tab_t *initial_state_def = find_state_def(sm, sm->initial_state);
-        if(initial_state_def && initial_state_def->on_entry){
-            initial_state_def->on_entry(sm, sm->initial_state);
+        if(old_state != sm->initial_state){
+            const sm_state_tab_t *initial_state_def = find_state_def(sm, sm->initial_state);
+            if(initial_state_def && initial_state_def->on_entry){
+                initial_state_def->on_entry(sm, sm->initial_state);
+            }
         }
     }
+    sm->transition_count = 0;
+    sm->invalid_event_count = 0;
+    if(sm->on_state_change){
+        sm->on_state_change(sm, sm->current_state);
+    }
 
     if(sm->logging_enabled){
         printf("[SM:%s] Reset from %s to %s\n", sm->id, sm_get_state_name(sm, old_state),
@@ -113,16 +638,134 @@ sm_result_t sm_reset(state_machine_t *sm){
 
     return SM_SUCCESS;
 }
+// Each region's leaf row already holds the transitions inherited from its
+// parents, and each entry knows how far up to exit and down to enter
+static sm_result_t process_hierarchical(state_machine_t *sm, sm_event_t event){
+    sm_index_t dispatch = get_index(sm);
+    sm_hierarchy_t tree = get_hierarchy(sm);
+    bool handled = false;
+
+    for (uint8_t region = 0; region < sm->num_regions; region++){
+        uint16_t row = sm->region_index[region];
+        uint16_t entry = find_entry(&dispatch, row, event);
+        if (entry == SM_NO_INDEX) continue;
+
+        const sm_transition_tab_t *transition = &sm->transition_table[dispatch.row_transition[entry]];
+        uint16_t target = dispatch.row_target[entry];
+        if (sm->trace){
+            sm_trace_write(sm->trace, sm_trace_now(sm->trace), sm->trace_tag,
+                           sm->state_table[row].state, sm->state_table[target].state, event);
+        }
+        exit_states(sm, &tree, row, tree.row_exits[entry]);
+        if (transition->action){
+            transition->action(sm, transition->from_state, transition->to_state, transition->event);
+        }
+
+        sm->region_index[region] = target;
+        if (region == 0){
+            sm->current_index = target;
+            sm->current_state = sm->state_table[target].state;
+        }
+        sm->transition_count++;
+        enter_states(sm, &tree, target, tree.row_enters[entry]);
+        if (region == 0 && sm->on_state_change){
+            sm->on_state_change(sm, sm->current_state);
+        }
+
+        if (sm->logging_enabled){
+            printf("[SM:%s] Transition: %s -> %s (event: %d)\n", sm->id,
+                   sm_get_state_name(sm, sm->state_table[row].state),
+                   sm_get_state_name(sm, sm->state_table[target].state), event);
+        }
+        handled = true;
+    }
+
+    if (!handled){
+        sm->invalid_event_count++;
+        if (sm->trace){
+            sm_trace_write(sm->trace, sm_trace_now(sm->trace), sm->trace_tag | SM_TRACE_NO_TRANSITION,
+                           sm->current_state, sm->current_state, event);
+        }
+        return SM_ERROR_INVALID_EVENT;
+    }
+    return SM_SUCCESS;
+}
+#ifdef SM_METRICS
+static uint64_t record_since(sm_histogram_t *histogram, uint64_t mark){
+    uint64_t now = sm_metrics_now();
+    sm_histogram_record(histogram, now - mark);
+    return now;
+}
+// sm_process_event's transition with each callback timed: the state left is
+// charged with its dwell time and the transition with a hit
+static sm_result_t process_measured(state_machine_t *sm, const sm_index_t *dispatch, uint16_t entry, sm_event_t event){
+    sm_metrics_t *metrics = sm->metrics;
+    uint16_t from_row = sm->current_index;
+    uint16_t transition_row = dispatch->row_transition[entry];
+    const sm_transition_tab_t *transition = &sm->transition_table[transition_row];
+    const sm_state_tab_t *old_state_def = &sm->state_table[from_row];
+
+    uint64_t mark = record_since(&metrics->states[from_row].dwell, metrics->entered_ns);
+    sm_metrics_count(&metrics->transitions[transition_row].hits);
+    if(old_state_def->on_exit){
+        old_state_def->on_exit(sm, sm->current_state);
+        mark = record_since(&metrics->states[from_row].on_exit, mark);
+    }
+    if(transition->action){
+        transition->action(sm, transition->from_state, transition->to_state, transition->event);
+        mark = record_since(&metrics->transitions[transition_row].action, mark);
+    }
+
+    sm->current_state = transition->to_state;
+    sm->current_index = dispatch->row_target[entry];
+    sm->transition_count++;
+
+    const sm_state_tab_t *new_state_def = &sm->state_table[sm->current_index];
+    if(new_state_def->on_entry){
+        new_state_def->on_entry(sm, sm->current_state);
+        mark = record_since(&metrics->states[sm->current_index].on_entry, mark);
+    }
+    metrics->entered_ns = mark;
+    if(sm->on_state_change){
+        sm->on_state_change(sm, sm->current_state);
+    }
+
+    if (sm->logging_enabled) {
+        printf("[SM:%s] Transition: %s -> %s (event: %d)\n", sm->id,
+               sm_get_state_name(sm, old_state_def->state), sm_get_state_name(sm, sm->current_state), event);
+    }
+    return SM_SUCCESS;
+}
+#endif
 sm_result_t sm_process_event(state_machine_t* sm, sm_event_t event){
     //check sm is not null
     if(!sm) return SM_ERROR_NULL_POINTER;
-    const sm_transition_tab_t *transition = find_transition_def(sm, sm->current_state, event);
-    if(transition == NULL){
+    if(!sm->initialized) return SM_ERROR_NOT_INITIALIZED;
+    if(sm->hierarchy) return process_hierarchical(sm, event);
+
+    //search only the current state's row of the index built by sm_init
+    sm_index_t dispatch = get_index(sm);
+    uint16_t entry = find_entry(&dispatch, sm->current_index, event);
+    if(entry == SM_NO_INDEX){
         sm->invalid_event_count++;
+        if(sm->trace){
+            sm_trace_write(sm->trace, sm_trace_now(sm->trace), sm->trace_tag | SM_TRACE_NO_TRANSITION,
+                           sm->current_state, sm->current_state, event);
+        }
+#ifdef SM_METRICS
+        if(sm->metrics) sm_metrics_count(&sm->metrics->states[sm->current_index].rejected);
+#endif
         return SM_ERROR_INVALID_EVENT;  
     }  
-    const sm_state_tab_t *old_state_def = find_state_def(sm, sm->current_state);
-    if(old_state_def && old_state_def->on_exit){
+    const sm_transition_tab_t *transition = &sm->transition_table[dispatch.row_transition[entry]];
+    const sm_state_tab_t *old_state_def = &sm->state_table[sm->current_index];
+    if(sm->trace){
+        sm_trace_write(sm->trace, sm_trace_now(sm->trace), sm->trace_tag, sm->current_state, transition->to_state, event);
+    }
+#ifdef SM_METRICS
+    if(sm->metrics) return process_measured(sm, &dispatch, entry, event);
+#endif
+    if(old_state_def->on_exit){
         old_state_def->on_exit(sm, sm->current_state);
     }
     //do transition action
@@ -131,19 +774,23 @@ sm_result_t sm_process_event(state_machine_t* sm, sm_event_t event){
     }
 
     sm->current_state = transition->to_state;
+    sm->current_index = dispatch.row_target[entry];
     sm->transition_count++;
 
     //do on entry to new state action 
-    const sm_state_tab_t *new_state_def = find_state_def(sm, sm->current_state);
-    if(new_state_def && new_state_def->on_entry){
+    const sm_state_tab_t *new_state_def = &sm->state_table[sm->current_index];
+    if(new_state_def->on_entry){
         new_state_def->on_entry(sm, sm->current_state);
     }
+    if(sm->on_state_change){
+        sm->on_state_change(sm, sm->current_state);
+    }
 
     // Log transition if logging is enabled
     if (sm->logging_enabled) {
         printf("[SM:%s] Transition: %s -> %s (event: %d)\n", 
                sm->id, 
-               old_state_def->name, 
+               sm_get_state_name(sm, old_state_def->state), 
                sm_get_state_name(sm, sm->current_state),
                event);
     }
@@ -152,10 +799,352 @@ sm_result_t sm_process_event(state_machine_t* sm, sm_event_t event){
     //return error
 }
 
+// Callbacks of the transitions noted by process_deferred, in order. The list is
+// detached meanwhile so a callback processing events runs them right away; it
+// is put back only if no callback called sm_set_deferred_callbacks.
+static void flush_deferred(state_machine_t *sm, const sm_index_t *dispatch, uint32_t count){
+    sm_deferred_t *calls = sm->deferred;
+    uint32_t capacity = sm->deferred_capacity;
+    sm->deferred = NULL;
+    for (uint32_t i = 0; i < count; i++){
+        const sm_state_tab_t *old_state_def = &sm->state_table[calls[i].from_row];
+        const sm_transition_tab_t *transition = &sm->transition_table[dispatch->row_transition[calls[i].entry]];
+        const sm_state_tab_t *new_state_def = &sm->state_table[dispatch->row_target[calls[i].entry]];
+        if(old_state_def->on_exit){
+            old_state_def->on_exit(sm, old_state_def->state);
+        }
+        if(transition->action){
+            transition->action(sm, transition->from_state, transition->to_state, transition->event);
+        }
+        if(new_state_def->on_entry){
+            new_state_def->on_entry(sm, new_state_def->state);
+        }
+    }
+    if(count && sm->on_state_change){
+        sm->on_state_change(sm, sm->current_state);
+    }
+    if(!sm->deferred && sm->deferred_capacity == capacity){
+        sm->deferred = calls;
+    }
+}
+// Only the lookups per event, in locals; the machine is brought up to date
+// before each flush, since callbacks may look at it
+static sm_result_t process_deferred(state_machine_t *sm, const sm_index_t *dispatch, const sm_event_t *events, uint32_t count, sm_result_t *results, uint64_t stamp){
+    sm_deferred_t *calls = sm->deferred;
+    uint32_t capacity = sm->deferred_capacity;
+    sm_result_t status = SM_SUCCESS;
+    uint16_t row = sm->current_index;
+    uint32_t noted = 0, invalid = 0;
+
+    for (uint32_t i = 0; i < count; i++){
+        if(noted == capacity){
+            sm->current_index = row;
+            sm->current_state = sm->state_table[row].state;
+            sm->transition_count += noted;
+            sm->invalid_event_count += invalid;
+            flush_deferred(sm, dispatch, noted);
+            noted = invalid = 0;
+            row = sm->current_index;
+
+            //the callbacks may have swapped the list or turned deferral off
+            calls = sm->deferred;
+            capacity = sm->deferred_capacity;
+            if(!calls){
+                sm_result_t rest = sm_process_events(sm, &events[i], count - i, results ? &results[i] : NULL);
+                return rest != SM_SUCCESS ? rest : status;
+            }
+        }
+
+        uint16_t entry = find_entry(dispatch, row, events[i]);
+        if(entry == SM_NO_INDEX){
+            invalid++;
+            status = SM_ERROR_INVALID_EVENT;
+            if(results) results[i] = SM_ERROR_INVALID_EVENT;
+            if(sm->trace){
+                sm_state_t state = sm->state_table[row].state;
+                sm_trace_write(sm->trace, stamp, sm->trace_tag | SM_TRACE_NO_TRANSITION, state, state, events[i]);
+            }
+            continue;
+        }
+        calls[noted].from_row = row;
+        calls[noted].entry = entry;
+        noted++;
+        if(sm->trace){
+            sm_trace_write(sm->trace, stamp, sm->trace_tag, sm->state_table[row].state,
+                           sm->state_table[dispatch->row_target[entry]].state, events[i]);
+        }
+        row = dispatch->row_target[entry];
+        if(results) results[i] = SM_SUCCESS;
+    }
+
+    sm->current_index = row;
+    sm->current_state = sm->state_table[row].state;
+    sm->transition_count += noted;
+    sm->invalid_event_count += invalid;
+    flush_deferred(sm, dispatch, noted);
+    return status;
+}
+sm_result_t sm_process_events(state_machine_t *sm, const sm_event_t *events, uint32_t count, sm_result_t *results){
+    if(!sm || (!events && count)) return SM_ERROR_NULL_POINTER;
+    if(!sm->initialized) return SM_ERROR_NOT_INITIALIZED;
+
+    sm_result_t status = SM_SUCCESS;
+    if(sm->hierarchy || sm->logging_enabled || SM_METRICS_ATTACHED(sm)){
+        for (uint32_t i = 0; i < count; i++){
+            sm_result_t result = sm_process_event(sm, events[i]);
+            if(results) results[i] = result;
+            if(result != SM_SUCCESS) status = result;
+        }
+        return status;
+    }
+
+    //one clock reading stamps the whole batch
+    sm_index_t dispatch = get_index(sm);
+    uint64_t stamp = sm->trace ? sm_trace_now(sm->trace) : 0;
+    if(sm->deferred) return process_deferred(sm, &dispatch, events, count, results, stamp);
+
+    const sm_state_tab_t *states = sm->state_table;
+    const sm_transition_tab_t *transitions = sm->transition_table;
+    for (uint32_t i = 0; i < count; i++){
+        uint16_t entry = find_entry(&dispatch, sm->current_index, events[i]);
+        if(entry == SM_NO_INDEX){
+            sm->invalid_event_count++;
+            status = SM_ERROR_INVALID_EVENT;
+            if(results) results[i] = SM_ERROR_INVALID_EVENT;
+            if(sm->trace){
+                sm_trace_write(sm->trace, stamp, sm->trace_tag | SM_TRACE_NO_TRANSITION,
+                               sm->current_state, sm->current_state, events[i]);
+            }
+            continue;
+        }
+        const sm_transition_tab_t *transition = &transitions[dispatch.row_transition[entry]];
+        const sm_state_tab_t *old_state_def = &states[sm->current_index];
+        if(sm->trace){
+            sm_trace_write(sm->trace, stamp, sm->trace_tag, sm->current_state, transition->to_state, events[i]);
+        }
+        if(old_state_def->on_exit){
+            old_state_def->on_exit(sm, sm->current_state);
+        }
+        if(transition->action){
+            transition->action(sm, transition->from_state, transition->to_state, transition->event);
+        }
+
+        sm->current_state = transition->to_state;
+        sm->current_index = dispatch.row_target[entry];
+        sm->transition_count++;
+
+        const sm_state_tab_t *new_state_def = &states[sm->current_index];
+        if(new_state_def->on_entry){
+            new_state_def->on_entry(sm, sm->current_state);
+        }
+        if(sm->on_state_change){
+            sm->on_state_change(sm, sm->current_state);
+        }
+        if(results) results[i] = SM_SUCCESS;
+    }
+    return status;
+}
+sm_result_t sm_set_deferred_callbacks(state_machine_t *sm, sm_deferred_t *calls, uint32_t capacity){
+    if(!sm) return SM_ERROR_NULL_POINTER;
+    if(!sm->initialized) return SM_ERROR_NOT_INITIALIZED;
+    if(sm->hierarchy) return SM_ERROR_INVALID_STATE;
+
+    sm->deferred = capacity ? calls : NULL;
+    sm->deferred_capacity = sm->deferred ? capacity : 0;
+    return SM_SUCCESS;
+}
+
+// instance pools
+// A pool instance's transition with its callbacks, which get the pool's proxy
+// machine set to the instance
+static void pool_transition(sm_pool_t *pool, uint32_t id, const sm_index_t *dispatch, uint16_t entry){
+    state_machine_t *proxy = &pool->proxy;
+    uint16_t row = pool->current_index[id];
+    const sm_transition_tab_t *transition = &proxy->transition_table[dispatch->row_transition[entry]];
+    const sm_state_tab_t *old_state_def = &proxy->state_table[row];
+
+    pool->active = id;
+    proxy->current_index = row;
+    proxy->current_state = old_state_def->state;
+    if(old_state_def->on_exit){
+        old_state_def->on_exit(proxy, proxy->current_state);
+    }
+    if(transition->action){
+        transition->action(proxy, transition->from_state, transition->to_state, transition->event);
+    }
+
+    pool->current_index[id] = dispatch->row_target[entry];
+    pool->transition_count[id]++;
+    proxy->current_index = dispatch->row_target[entry];
+    proxy->current_state = transition->to_state;
+
+    const sm_state_tab_t *new_state_def = &proxy->state_table[proxy->current_index];
+    if(new_state_def->on_entry){
+        new_state_def->on_entry(proxy, proxy->current_state);
+    }
+}
+static void pool_enter(sm_pool_t *pool, uint32_t id, sm_state_fn_t callback){
+    pool->active = id;
+    pool->proxy.current_index = pool->current_index[id];
+    pool->proxy.current_state = pool->proxy.state_table[pool->proxy.current_index].state;
+    callback(&pool->proxy, pool->proxy.current_state);
+}
+sm_result_t sm_type_init(sm_type_t *type, const char *id, sm_state_t initial_state, const sm_state_tab_t *state_table, uint16_t num_states, const sm_transition_tab_t *transition_table, uint16_t num_transitions, void *arena, size_t arena_size){
+    if(!type || !id || !state_table || !transition_table) return SM_ERROR_NULL_POINTER;
+    if(arena){
+        if(arena_size < SM_ARENA_SIZE(num_states, num_transitions)) return SM_ERROR_TABLE_FULL;
+    }else{
+        if(num_states == 0 || num_states > SM_MAX_STATES) return SM_ERROR_INVALID_STATE;
+        if(num_transitions > SM_MAX_TRANSITIONS) return SM_ERROR_TABLE_FULL;
+    }
+
+    memset(type, 0, sizeof(sm_type_t));
+    sm_result_t result = build_machine(&type->machine, id, initial_state, state_table, num_states, transition_table, num_transitions, (uint16_t *)arena);
+    if(result != SM_SUCCESS) return result;
+
+    for (uint16_t i = 0; i < num_states; i++){
+        if(state_table[i].on_entry || state_table[i].on_exit) type->has_callbacks = true;
+    }
+    for (uint16_t i = 0; i < num_transitions; i++){
+        if(transition_table[i].action) type->has_callbacks = true;
+    }
+    return SM_SUCCESS;
+}
+sm_result_t sm_pool_init(sm_pool_t *pool, const sm_type_t *type, uint32_t num_instances, void *arena, size_t arena_size){
+    if(!pool || !type || (!arena && num_instances)) return SM_ERROR_NULL_POINTER;
+    if(!type->machine.initialized) return SM_ERROR_NOT_INITIALIZED;
+    if(arena_size < SM_POOL_ARENA_SIZE(num_instances)) return SM_ERROR_INVALID_SIZE;
+
+    memset(pool, 0, sizeof(sm_pool_t));
+    pool->type = type;
+    pool->num_instances = num_instances;
+    pool->transition_count = (uint32_t *)arena;
+    pool->invalid_event_count = pool->transition_count + num_instances;
+    pool->current_index = (uint16_t *)(pool->invalid_event_count + num_instances);
+    memset(arena, 0, 2 * sizeof(uint32_t) * (size_t)num_instances);
+
+    uint16_t initial = type->machine.current_index;
+    for (uint32_t id = 0; id < num_instances; id++){
+        pool->current_index[id] = initial;
+    }
+    pool->proxy = type->machine;
+    pool->proxy.pool = pool;
+
+    sm_state_fn_t on_entry = type->machine.state_table[initial].on_entry;
+    for (uint32_t id = 0; on_entry && id < num_instances; id++){
+        pool_enter(pool, id, on_entry);
+    }
+    return SM_SUCCESS;
+}
+sm_result_t sm_pool_process_event(sm_pool_t *pool, const uint32_t *ids, const sm_event_t *events, uint32_t count, sm_result_t *results){
+    if(!pool || ((!ids || !events) && count)) return SM_ERROR_NULL_POINTER;
+    if(!pool->type) return SM_ERROR_NOT_INITIALIZED;
+
+    //instances are scattered over the arrays: fetch the next ones while this one runs
+    sm_index_t dispatch = get_index(&pool->proxy);
+    bool callbacks = pool->type->has_callbacks;
+    uint16_t *rows = pool->current_index;
+    uint32_t *transitions = pool->transition_count;
+    uint32_t num_instances = pool->num_instances;
+    sm_result_t status = SM_SUCCESS;
+
+    for (uint32_t i = 0; i < count; i++){
+        if(i + SM_POOL_PREFETCH < count && ids[i + SM_POOL_PREFETCH] < num_instances){
+            __builtin_prefetch(&rows[ids[i + SM_POOL_PREFETCH]], 1);
+            __builtin_prefetch(&transitions[ids[i + SM_POOL_PREFETCH]], 1);
+        }
+
+        uint32_t id = ids[i];
+        sm_result_t result = SM_SUCCESS;
+        if(id >= num_instances){
+            result = SM_ERROR_INVALID_STATE;
+        }else{
+            uint16_t entry = find_entry(&dispatch, rows[id], events[i]);
+            if(entry == SM_NO_INDEX){
+                pool->invalid_event_count[id]++;
+                result = SM_ERROR_INVALID_EVENT;
+            }else if(callbacks){
+                pool_transition(pool, id, &dispatch, entry);
+            }else{
+                rows[id] = dispatch.row_target[entry];
+                transitions[id]++;
+            }
+        }
+        if(results) results[i] = result;
+        if(result != SM_SUCCESS) status = result;
+    }
+    return status;
+}
+sm_result_t sm_pool_reset(sm_pool_t *pool, uint32_t id){
+    if(!pool) return SM_ERROR_NULL_POINTER;
+    if(!pool->type) return SM_ERROR_NOT_INITIALIZED;
+    if(id >= pool->num_instances) return SM_ERROR_INVALID_STATE;
+
+    const state_machine_t *type = &pool->type->machine;
+    uint16_t row = pool->current_index[id];
+    if(row != type->current_index){
+        if(type->state_table[row].on_exit) pool_enter(pool, id, type->state_table[row].on_exit);
+        pool->current_index[id] = type->current_index;
+        if(type->state_table[type->current_index].on_entry){
+            pool_enter(pool, id, type->state_table[type->current_index].on_entry);
+        }
+    }
+    pool->transition_count[id] = 0;
+    pool->invalid_event_count[id] = 0;
+    return SM_SUCCESS;
+}
+sm_result_t sm_pool_get_state(const sm_pool_t *pool, uint32_t id, sm_state_t *state){
+    if(!pool || !state) return SM_ERROR_NULL_POINTER;
+    if(!pool->type) return SM_ERROR_NOT_INITIALIZED;
+    if(id >= pool->num_instances) return SM_ERROR_INVALID_STATE;
+
+    *state = pool->proxy.state_table[pool->current_index[id]].state;
+    return SM_SUCCESS;
+}
+sm_result_t sm_pool_get_stats(const sm_pool_t *pool, uint32_t id, uint32_t *total_transitions, uint32_t *invalid_events){
+    if(!pool || !total_transitions || !invalid_events) return SM_ERROR_NULL_POINTER;
+    if(!pool->type) return SM_ERROR_NOT_INITIALIZED;
+    if(id >= pool->num_instances) return SM_ERROR_INVALID_STATE;
+
+    *total_transitions = pool->transition_count[id];
+    *invalid_events = pool->invalid_event_count[id];
+    return SM_SUCCESS;
+}
+uint32_t sm_pool_count_in_state(const sm_pool_t *pool, sm_state_t state){
+    if(!pool || !pool->type) return 0;
+    uint16_t row = find_state_index(&pool->type->machine, state);
+    if(row == SM_NO_INDEX) return 0;
+
+    //one pass over a dense uint16_t array, which the compiler vectorizes
+    const uint16_t *rows = pool->current_index;
+    uint32_t count = 0;
+    for (uint32_t id = 0; id < pool->num_instances; id++){
+        count += rows[id] == row;
+    }
+    return count;
+}
+sm_pool_t *sm_pool_active(const state_machine_t *sm, uint32_t *id){
+    if(!sm) return NULL;
+    sm_pool_t *pool = sm->pool;
+    if(!pool || &pool->proxy != sm) return NULL;
+    if(id) *id = pool->active;
+    return pool;
+}
+
 // utility
 bool sm_is_in_state(const state_machine_t *sm, sm_state_t state) {
     if (!sm) return false;
-    return (sm->current_state == state);  // ✅ Simplified
+    if (!sm->hierarchy) return (sm->current_state == state);  // ✅ Simplified
+
+    sm_hierarchy_t tree = get_hierarchy(sm);
+    for (uint8_t region = 0; region < sm->num_regions; region++) {
+        uint16_t row = sm->region_index[region];
+        const uint16_t *chain = &tree.chain[tree.chain_start[row]];
+        for (uint16_t i = 0; i < chain_length(&tree, row); i++) {
+            if (sm->state_table[chain[i]].state == state) return true;
+        }
+    }
+    return false;
 }
 
 
@@ -183,12 +1172,22 @@ void sm_print_status(const state_machine_t *sm) {
     printf("ID: %s\n", sm->id);
     printf("Initialized: %s\n", sm->initialized ? "Yes" : "No");
     printf("Current State: %s\n", sm_get_state_name(sm, sm->current_state));
+    for (uint8_t region = 1; region < sm->num_regions; region++) {
+        printf("Region %u State: %s\n", (unsigned)region,
+               sm_get_state_name(sm, sm->state_table[sm->region_index[region]].state));
+    }
     printf("Initial State: %s\n", sm_get_state_name(sm, sm->initial_state));
     printf("Number of States: %d\n", sm->num_states);
     printf("Number of Transitions: %d\n", sm->num_transitions);
     printf("Logging Enabled: %s\n", sm->logging_enabled ? "Yes" : "No");
     printf("Transition Count: %lu\n", (unsigned long)sm->transition_count);
     printf("Invalid Event Count: %lu\n", (unsigned long)sm->invalid_event_count);
+    sm_queue_stats_t queue_stats;
+    if (sm_get_queue_stats(sm, &queue_stats) == SM_SUCCESS) {
+        printf("Event Queue: %lu/%lu pending (max %lu), %lu dropped\n",
+               (unsigned long)queue_stats.depth, (unsigned long)queue_stats.capacity,
+               (unsigned long)queue_stats.max_depth, (unsigned long)queue_stats.dropped);
+    }
     printf("============================\n");
 }
 sm_result_t sm_get_current_state(const state_machine_t *sm, sm_state_t *current_state) {
@@ -204,6 +1203,23 @@ sm_result_t sm_get_current_state(const state_machine_t *sm, sm_state_t *current_
     return SM_SUCCESS;
 }
 
+sm_result_t sm_get_region_state(const state_machine_t *sm, uint8_t region, sm_state_t *state) {
+    if (!sm || !state) {
+        return SM_ERROR_NULL_POINTER;
+    }
+
+    if (!sm->initialized) {
+        return SM_ERROR_NOT_INITIALIZED;
+    }
+
+    if (region >= sm->num_regions) {
+        return SM_ERROR_INVALID_STATE;
+    }
+
+    *state = region ? sm->state_table[sm->region_index[region]].state : sm->current_state;
+    return SM_SUCCESS;
+}
+
 sm_result_t sm_get_stats(const state_machine_t *sm, uint32_t *total_transitions, uint32_t *invalid_events) {
     if (!sm || !total_transitions || !invalid_events) {
         return SM_ERROR_NULL_POINTER;
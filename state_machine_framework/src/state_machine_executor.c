@@ -0,0 +1,378 @@
+#define _POSIX_C_SOURCE 200112L  // For clock_gettime() and nanosleep()
+#include "state_machine_executor.h"
+#include <errno.h>
+#include <time.h>
+
+// Scheduling protocol. A machine's `scheduled` flag goes 0 -> 1 exactly
+// once per wake-up, by whoever wins the CAS after posting an event, and that
+// winner puts the machine's id on one queue or deque. The worker that pops
+// the id runs up to SM_EXECUTOR_BUDGET events, clears the flag, then looks
+// at the event queue again: a producer that posted meanwhile either saw the
+// flag still set (and the worker now sees its event) or sees it cleared and
+// schedules the machine itself. Both sides use sequentially consistent
+// operations on the flag, so one of the two always notices.
+
+#define SM_EXECUTOR_EMPTY 0xFFFFFFFFu
+
+// Worker the current thread belongs to, if any
+static __thread sm_executor_worker_t *current_worker;
+
+//helper
+static uint64_t now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+static uint32_t queue_capacity(uint32_t max_machines){
+    uint32_t capacity = 2;
+    while (capacity < max_machines) capacity <<= 1;
+    return capacity;
+}
+
+// Injection queue: bounded MPMC (Vyukov). It holds each machine at most
+// once and has a slot per machine, so a push never finds it full.
+static void injection_push(sm_executor_t *ex, uint32_t id){
+    uint32_t pos = __atomic_load_n(&ex->injection_tail, __ATOMIC_RELAXED);
+    sm_executor_slot_t *slot;
+    for (;;){
+        slot = &ex->injection[pos & ex->mask];
+        int32_t diff = (int32_t)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - pos);
+        if(diff == 0){
+            if(__atomic_compare_exchange_n(&ex->injection_tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+        } else {
+            pos = __atomic_load_n(&ex->injection_tail, __ATOMIC_RELAXED);
+        }
+    }
+    slot->id = id;
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+}
+static uint32_t injection_pop(sm_executor_t *ex){
+    uint32_t pos = __atomic_load_n(&ex->injection_head, __ATOMIC_RELAXED);
+    for (;;){
+        sm_executor_slot_t *slot = &ex->injection[pos & ex->mask];
+        int32_t diff = (int32_t)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - (pos + 1));
+        if(diff == 0){
+            if(__atomic_compare_exchange_n(&ex->injection_head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                uint32_t id = slot->id;
+                __atomic_store_n(&slot->sequence, pos + ex->mask + 1, __ATOMIC_RELEASE);
+                return id;
+            }
+        } else if(diff < 0){
+            return SM_EXECUTOR_EMPTY;
+        } else {
+            pos = __atomic_load_n(&ex->injection_head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Chase-Lev deque (Le et al., "Correct and Efficient Work-Stealing for Weak
+// Memory Models", fixed size). Like the injection queue it cannot overflow.
+static void deque_push(sm_work_deque_t *deque, uint32_t id){
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->items[bottom & deque->mask], id, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+}
+static uint32_t deque_pop(sm_work_deque_t *deque){
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+    if(top > bottom){
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+        return SM_EXECUTOR_EMPTY;
+    }
+    uint32_t id = __atomic_load_n(&deque->items[bottom & deque->mask], __ATOMIC_RELAXED);
+    if(top == bottom){
+        //last item: race the thieves for it
+        if(!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)){
+            id = SM_EXECUTOR_EMPTY;
+        }
+        __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    }
+    return id;
+}
+static uint32_t deque_steal(sm_work_deque_t *deque){
+    int64_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+    if(top >= bottom) return SM_EXECUTOR_EMPTY;
+    uint32_t id = __atomic_load_n(&deque->items[top & deque->mask], __ATOMIC_RELAXED);
+    if(!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)){
+        return SM_EXECUTOR_EMPTY;
+    }
+    return id;
+}
+
+static bool work_visible(sm_executor_t *ex){
+    if(__atomic_load_n(&ex->injection_head, __ATOMIC_SEQ_CST) != __atomic_load_n(&ex->injection_tail, __ATOMIC_SEQ_CST)){
+        return true;
+    }
+    for (uint32_t i = 0; i < ex->num_workers; i++){
+        sm_work_deque_t *deque = &ex->workers[i].deque;
+        if(__atomic_load_n(&deque->top, __ATOMIC_SEQ_CST) < __atomic_load_n(&deque->bottom, __ATOMIC_SEQ_CST)){
+            return true;
+        }
+    }
+    return false;
+}
+static void wake_one(sm_executor_t *ex){
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(__atomic_load_n(&ex->sleepers, __ATOMIC_SEQ_CST) > 0){
+        pthread_mutex_lock(&ex->lock);
+        pthread_cond_signal(&ex->wake);
+        pthread_mutex_unlock(&ex->lock);
+    }
+}
+// Called by the winner of the 0 -> 1 flag CAS
+static void schedule(sm_executor_t *ex, uint32_t id, bool to_injection){
+    sm_executor_machine_t *entry = &ex->machines[id];
+    __atomic_fetch_add(&ex->active, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->ready_ns, now_ns(), __ATOMIC_RELAXED);
+    sm_executor_worker_t *worker = current_worker;
+    if(!to_injection && worker && worker->executor == ex){
+        deque_push(&worker->deque, id);
+    } else {
+        injection_push(ex, id);
+    }
+    wake_one(ex);
+}
+static bool try_schedule(sm_executor_t *ex, uint32_t id, bool to_injection){
+    uint32_t idle = 0;
+    if(!__atomic_compare_exchange_n(&ex->machines[id].scheduled, &idle, 1, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)){
+        return false;
+    }
+    schedule(ex, id, to_injection);
+    return true;
+}
+
+static void run_machine(sm_executor_worker_t *worker, uint32_t id){
+    sm_executor_t *ex = worker->executor;
+    sm_executor_machine_t *entry = &ex->machines[id];
+
+    uint64_t latency = now_ns() - __atomic_load_n(&entry->ready_ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->latency_total_ns, entry->latency_total_ns + latency, __ATOMIC_RELAXED);
+    if(latency > entry->latency_max_ns){
+        __atomic_store_n(&entry->latency_max_ns, latency, __ATOMIC_RELAXED);
+    }
+
+    uint32_t dispatched = 0;
+    sm_dispatch_pending(entry->machine, SM_EXECUTOR_BUDGET, &dispatched);
+    __atomic_store_n(&entry->events, entry->events + dispatched, __ATOMIC_RELAXED);
+    __atomic_store_n(&entry->runs, entry->runs + 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&worker->events, worker->events + dispatched, __ATOMIC_RELAXED);
+    __atomic_store_n(&worker->runs, worker->runs + 1, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&entry->scheduled, 0, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    if(sm_has_pending_events(entry->machine)){
+        //back of the shared queue, so a busy machine cannot starve the others
+        try_schedule(ex, id, true);
+    }
+    //only now, so `active` never reads 0 while this machine still has work
+    __atomic_fetch_sub(&ex->active, 1, __ATOMIC_RELEASE);
+}
+
+static uint32_t find_work(sm_executor_worker_t *worker){
+    sm_executor_t *ex = worker->executor;
+    uint32_t id = deque_pop(&worker->deque);
+    if(id != SM_EXECUTOR_EMPTY) return id;
+    id = injection_pop(ex);
+    if(id != SM_EXECUTOR_EMPTY) return id;
+
+    //steal, starting from a random victim
+    worker->random ^= worker->random << 13;
+    worker->random ^= worker->random >> 17;
+    worker->random ^= worker->random << 5;
+    for (uint32_t i = 0; i < ex->num_workers; i++){
+        sm_executor_worker_t *victim = &ex->workers[(worker->random + i) % ex->num_workers];
+        if(victim == worker) continue;
+        id = deque_steal(&victim->deque);
+        if(id != SM_EXECUTOR_EMPTY){
+            __atomic_store_n(&worker->steals, worker->steals + 1, __ATOMIC_RELAXED);
+            return id;
+        }
+    }
+    return SM_EXECUTOR_EMPTY;
+}
+
+static void *worker_main(void *arg){
+    sm_executor_worker_t *worker = (sm_executor_worker_t *)arg;
+    sm_executor_t *ex = worker->executor;
+    current_worker = worker;
+
+    while (__atomic_load_n(&ex->running, __ATOMIC_ACQUIRE)){
+        uint32_t id = find_work(worker);
+        if(id != SM_EXECUTOR_EMPTY){
+            run_machine(worker, id);
+            continue;
+        }
+        //park; a producer that pushed after our check will see sleepers > 0
+        pthread_mutex_lock(&ex->lock);
+        __atomic_fetch_add(&ex->sleepers, 1, __ATOMIC_SEQ_CST);
+        if(!work_visible(ex) && __atomic_load_n(&ex->running, __ATOMIC_ACQUIRE)){
+            pthread_cond_wait(&ex->wake, &ex->lock);
+        }
+        __atomic_fetch_sub(&ex->sleepers, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&ex->lock);
+    }
+    current_worker = NULL;
+    return NULL;
+}
+
+// Wake the first `count` workers out of their loop and wait for them
+static void join_workers(sm_executor_t *ex, uint32_t count){
+    pthread_mutex_lock(&ex->lock);
+    __atomic_store_n(&ex->running, false, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&ex->wake);
+    pthread_mutex_unlock(&ex->lock);
+    for (uint32_t i = 0; i < count; i++){
+        pthread_join(ex->workers[i].thread, NULL);
+    }
+}
+
+//core
+size_t sm_executor_arena_size(uint32_t max_machines, uint32_t num_workers){
+    size_t capacity = queue_capacity(max_machines);
+    return (size_t)max_machines * sizeof(sm_executor_machine_t)
+         + capacity * sizeof(sm_executor_slot_t)
+         + (size_t)num_workers * capacity * sizeof(uint32_t);
+}
+
+sm_result_t sm_executor_init(sm_executor_t *executor, uint32_t max_machines, uint32_t num_workers, void *arena, size_t arena_size){
+    if(!executor || !arena) return SM_ERROR_NULL_POINTER;
+    if(max_machines == 0 || max_machines > 0x80000000u || num_workers == 0 || num_workers > SM_EXECUTOR_MAX_WORKERS){
+        return SM_ERROR_INVALID_SIZE;
+    }
+    if(arena_size < sm_executor_arena_size(max_machines, num_workers)){
+        return SM_ERROR_TABLE_FULL;
+    }
+
+    memset(executor, 0, sizeof(*executor));
+    uint32_t capacity = queue_capacity(max_machines);
+    uint8_t *cursor = (uint8_t *)arena;
+
+    executor->machines = (sm_executor_machine_t *)cursor;
+    cursor += (size_t)max_machines * sizeof(sm_executor_machine_t);
+    executor->injection = (sm_executor_slot_t *)cursor;
+    cursor += (size_t)capacity * sizeof(sm_executor_slot_t);
+    for (uint32_t i = 0; i < capacity; i++){
+        executor->injection[i].sequence = i;
+    }
+    executor->mask = capacity - 1;
+    executor->max_machines = max_machines;
+
+    for (uint32_t i = 0; i < num_workers; i++){
+        sm_executor_worker_t *worker = &executor->workers[i];
+        worker->executor = executor;
+        worker->index = i;
+        worker->random = 2463534242u + i * 2654435761u;
+        worker->deque.items = (uint32_t *)cursor;
+        worker->deque.mask = capacity - 1;
+        cursor += (size_t)capacity * sizeof(uint32_t);
+    }
+    executor->num_workers = num_workers;
+
+    pthread_mutex_init(&executor->lock, NULL);
+    pthread_cond_init(&executor->wake, NULL);
+    return SM_SUCCESS;
+}
+
+sm_result_t sm_executor_add(sm_executor_t *executor, state_machine_t *sm, uint32_t *id){
+    if(!executor || !sm || !id) return SM_ERROR_NULL_POINTER;
+    if(!sm->initialized || !sm->queue.slots) return SM_ERROR_NOT_INITIALIZED;
+    if(executor->running) return SM_ERROR_INVALID_STATE;
+    if(executor->num_machines == executor->max_machines) return SM_ERROR_TABLE_FULL;
+
+    *id = executor->num_machines++;
+    memset(&executor->machines[*id], 0, sizeof(sm_executor_machine_t));
+    executor->machines[*id].machine = sm;
+    return SM_SUCCESS;
+}
+
+sm_result_t sm_executor_start(sm_executor_t *executor){
+    if(!executor) return SM_ERROR_NULL_POINTER;
+    if(!executor->machines) return SM_ERROR_NOT_INITIALIZED;
+    if(executor->running) return SM_ERROR_INVALID_STATE;
+
+    executor->start_ns = now_ns();
+    executor->stop_ns = 0;
+    __atomic_store_n(&executor->running, true, __ATOMIC_RELEASE);
+    for (uint32_t i = 0; i < executor->num_workers; i++){
+        int error = pthread_create(&executor->workers[i].thread, NULL, worker_main, &executor->workers[i]);
+        if(error != 0){
+            //nothing is scheduled yet, so the ones already started can go right away
+            join_workers(executor, i);
+            executor->start_ns = 0;
+            errno = error;
+            return SM_ERROR_SYSTEM;
+        }
+    }
+
+    //machines that had events before the start
+    for (uint32_t id = 0; id < executor->num_machines; id++){
+        if(sm_has_pending_events(executor->machines[id].machine)) try_schedule(executor, id, true);
+    }
+    return SM_SUCCESS;
+}
+
+sm_result_t sm_executor_post(sm_executor_t *executor, uint32_t id, sm_event_t event){
+    if(!executor) return SM_ERROR_NULL_POINTER;
+    if(id >= executor->num_machines) return SM_ERROR_INVALID_STATE;
+
+    sm_result_t result = sm_post_event(executor->machines[id].machine, event);
+    if(result != SM_SUCCESS) return result;
+    if(__atomic_load_n(&executor->running, __ATOMIC_ACQUIRE)){
+        try_schedule(executor, id, false);
+    }
+    return SM_SUCCESS;
+}
+
+sm_result_t sm_executor_stop(sm_executor_t *executor){
+    if(!executor) return SM_ERROR_NULL_POINTER;
+    if(!executor->running) return SM_ERROR_NOT_INITIALIZED;
+
+    //let the workers finish what was posted, then wake and join them
+    struct timespec pause = {0, 100000};
+    while (__atomic_load_n(&executor->active, __ATOMIC_ACQUIRE) != 0){
+        nanosleep(&pause, NULL);
+    }
+    join_workers(executor, executor->num_workers);
+    executor->stop_ns = now_ns();
+    return SM_SUCCESS;
+}
+
+sm_result_t sm_executor_get_stats(const sm_executor_t *executor, sm_executor_stats_t *stats){
+    if(!executor || !stats) return SM_ERROR_NULL_POINTER;
+    if(!executor->machines) return SM_ERROR_NOT_INITIALIZED;
+
+    memset(stats, 0, sizeof(*stats));
+    for (uint32_t i = 0; i < executor->num_workers; i++){
+        const sm_executor_worker_t *worker = &executor->workers[i];
+        stats->events += __atomic_load_n(&worker->events, __ATOMIC_RELAXED);
+        stats->runs += __atomic_load_n(&worker->runs, __ATOMIC_RELAXED);
+        stats->steals += __atomic_load_n(&worker->steals, __ATOMIC_RELAXED);
+    }
+    if(executor->start_ns != 0){
+        uint64_t end = executor->stop_ns ? executor->stop_ns : now_ns();
+        stats->elapsed_seconds = (double)(end - executor->start_ns) * 1e-9;
+    }
+    if(stats->elapsed_seconds > 0){
+        stats->events_per_second = (double)stats->events / stats->elapsed_seconds;
+    }
+    return SM_SUCCESS;
+}
+
+sm_result_t sm_executor_get_machine_stats(const sm_executor_t *executor, uint32_t id, sm_executor_machine_stats_t *stats){
+    if(!executor || !stats) return SM_ERROR_NULL_POINTER;
+    if(id >= executor->num_machines) return SM_ERROR_INVALID_STATE;
+
+    const sm_executor_machine_t *entry = &executor->machines[id];
+    sm_queue_stats_t queue_stats;
+    stats->events = __atomic_load_n(&entry->events, __ATOMIC_RELAXED);
+    stats->runs = __atomic_load_n(&entry->runs, __ATOMIC_RELAXED);
+    stats->latency_max_ns = __atomic_load_n(&entry->latency_max_ns, __ATOMIC_RELAXED);
+    stats->latency_avg_ns = stats->runs ? __atomic_load_n(&entry->latency_total_ns, __ATOMIC_RELAXED) / stats->runs : 0;
+    stats->pending = (sm_get_queue_stats(entry->machine, &queue_stats) == SM_SUCCESS) ? queue_stats.depth : 0;
+    return SM_SUCCESS;
+}
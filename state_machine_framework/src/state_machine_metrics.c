@@ -0,0 +1,183 @@
+#define _POSIX_C_SOURCE 200809L  // For clock_gettime()
+#include "state_machine.h"
+
+#ifdef SM_METRICS
+#include <time.h>
+
+// Only the thread running the machine writes, so an update is a relaxed load
+// and a relaxed store: no read-modify-write, yet a reader on another thread
+// never sees a torn counter.
+//
+// Bucket b of a histogram, for b >= 2^(SUB_BITS + 1):
+//   exponent e = (b >> SUB_BITS) + SUB_BITS - 1
+//   values (m << (e - SUB_BITS)) .. ((m + 1) << (e - SUB_BITS)) - 1, m = 2^SUB_BITS + (b & (2^SUB_BITS - 1))
+// Below that, bucket b holds the value b.
+
+#define SM_HISTOGRAM_LINEAR (2u << SM_HISTOGRAM_SUB_BITS)
+#define SM_HISTOGRAM_LIMIT ((uint64_t)2 << SM_HISTOGRAM_MAX_EXPONENT)
+
+//helper
+static inline uint64_t load(const uint64_t *counter){
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+static inline void store(uint64_t *counter, uint64_t value){
+    __atomic_store_n(counter, value, __ATOMIC_RELAXED);
+}
+static uint32_t bucket_of(uint64_t value){
+    if(value >= SM_HISTOGRAM_LIMIT) value = SM_HISTOGRAM_LIMIT - 1;
+    if(value < SM_HISTOGRAM_LINEAR) return (uint32_t)value;
+    uint32_t exponent = 63u - (uint32_t)__builtin_clzll(value);
+    uint32_t shift = exponent - SM_HISTOGRAM_SUB_BITS;
+    return (shift << SM_HISTOGRAM_SUB_BITS) + (uint32_t)(value >> shift);
+}
+static uint64_t bucket_top(uint32_t bucket){
+    if(bucket < SM_HISTOGRAM_LINEAR) return bucket;
+    uint32_t shift = (bucket >> SM_HISTOGRAM_SUB_BITS) - 1;
+    uint64_t mantissa = (1u << SM_HISTOGRAM_SUB_BITS) | (bucket & ((1u << SM_HISTOGRAM_SUB_BITS) - 1));
+    return ((mantissa + 1) << shift) - 1;
+}
+static void copy_histogram(sm_histogram_t *to, const sm_histogram_t *from){
+    to->count = load(&from->count);
+    to->sum = load(&from->sum);
+    to->min = load(&from->min);
+    to->max = load(&from->max);
+    for (uint32_t i = 0; i < SM_HISTOGRAM_BUCKETS; i++){
+        to->buckets[i] = load(&from->buckets[i]);
+    }
+}
+static const char *format_ns(char *text, size_t size, uint64_t ns){
+    if(ns < 1000) snprintf(text, size, "%lluns", (unsigned long long)ns);
+    else if(ns < 1000000) snprintf(text, size, "%.1fus", (double)ns / 1e3);
+    else if(ns < 1000000000) snprintf(text, size, "%.1fms", (double)ns / 1e6);
+    else snprintf(text, size, "%.2fs", (double)ns / 1e9);
+    return text;
+}
+static int find_state_row(const state_machine_t *sm, sm_state_t state){
+    for (uint16_t i = 0; i < sm->num_states; i++){
+        if(sm->state_table[i].state == state) return i;
+    }
+    return -1;
+}
+
+//core
+uint64_t sm_metrics_now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+void sm_metrics_count(uint64_t *counter){
+    store(counter, load(counter) + 1);
+}
+void sm_histogram_record(sm_histogram_t *histogram, uint64_t value){
+    uint64_t count = load(&histogram->count);
+    if(count == 0 || value < load(&histogram->min)) store(&histogram->min, value);
+    if(value > load(&histogram->max)) store(&histogram->max, value);
+    store(&histogram->sum, load(&histogram->sum) + value);
+    sm_metrics_count(&histogram->buckets[bucket_of(value)]);
+    store(&histogram->count, count + 1);
+}
+uint64_t sm_histogram_percentile(const sm_histogram_t *histogram, double percentile){
+    if(!histogram || histogram->count == 0) return 0;
+    if(percentile < 0) percentile = 0;
+    if(percentile > 100) percentile = 100;
+
+    uint64_t wanted = (uint64_t)(percentile / 100.0 * (double)histogram->count + 0.5);
+    if(wanted == 0) wanted = 1;
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < SM_HISTOGRAM_BUCKETS; i++){
+        seen += histogram->buckets[i];
+        if(seen >= wanted){
+            //the last bucket also holds everything past the range
+            uint64_t top = i == SM_HISTOGRAM_BUCKETS - 1 ? histogram->max : bucket_top(i);
+            return top < histogram->max ? top : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+sm_result_t sm_metrics_attach(state_machine_t *sm, sm_metrics_t *metrics, void *arena, size_t arena_size){
+    if(!sm || (metrics && !arena)) return SM_ERROR_NULL_POINTER;
+    if(!sm->initialized) return SM_ERROR_NOT_INITIALIZED;
+    if(sm->hierarchy) return SM_ERROR_INVALID_STATE;
+    if(!metrics){
+        sm->metrics = NULL;
+        return SM_SUCCESS;
+    }
+    if(arena_size < SM_METRICS_ARENA_SIZE(sm->num_states, sm->num_transitions)) return SM_ERROR_INVALID_SIZE;
+
+    memset(arena, 0, SM_METRICS_ARENA_SIZE(sm->num_states, sm->num_transitions));
+    metrics->states = (sm_state_metrics_t *)arena;
+    metrics->transitions = (sm_transition_metrics_t *)(metrics->states + sm->num_states);
+    metrics->entered_ns = sm_metrics_now();
+    sm->metrics = metrics;
+    return SM_SUCCESS;
+}
+sm_result_t sm_metrics_get_state(const state_machine_t *sm, sm_state_t state, sm_state_metrics_t *metrics){
+    if(!sm || !metrics) return SM_ERROR_NULL_POINTER;
+    if(!sm->initialized || !sm->metrics) return SM_ERROR_NOT_INITIALIZED;
+    int row = find_state_row(sm, state);
+    if(row < 0) return SM_ERROR_INVALID_STATE;
+
+    const sm_state_metrics_t *recorded = &sm->metrics->states[row];
+    copy_histogram(&metrics->dwell, &recorded->dwell);
+    copy_histogram(&metrics->on_entry, &recorded->on_entry);
+    copy_histogram(&metrics->on_exit, &recorded->on_exit);
+    metrics->rejected = load(&recorded->rejected);
+    return SM_SUCCESS;
+}
+sm_result_t sm_metrics_get_transition(const state_machine_t *sm, sm_state_t from, sm_event_t event, sm_transition_metrics_t *metrics){
+    if(!sm || !metrics) return SM_ERROR_NULL_POINTER;
+    if(!sm->initialized || !sm->metrics) return SM_ERROR_NOT_INITIALIZED;
+
+    for (uint16_t i = 0; i < sm->num_transitions; i++){
+        if(sm->transition_table[i].from_state == from && sm->transition_table[i].event == event){
+            const sm_transition_metrics_t *recorded = &sm->metrics->transitions[i];
+            copy_histogram(&metrics->action, &recorded->action);
+            metrics->hits = load(&recorded->hits);
+            return SM_SUCCESS;
+        }
+    }
+    return SM_ERROR_INVALID_EVENT;
+}
+void sm_metrics_print(const state_machine_t *sm){
+    if(!sm || !sm->initialized || !sm->metrics){
+        printf("Metrics: not recorded\n");
+        return;
+    }
+
+    sm_state_metrics_t state;
+    sm_transition_metrics_t transition;
+    char p50[16], p99[16], max[16], entry[16], leave[16];
+
+    printf("=== State Machine Metrics: %s ===\n", sm->id);
+    printf("%-16s %8s %10s %10s %10s %10s %10s %9s\n",
+           "State", "Visits", "Dwell p50", "p99", "max", "Entry p99", "Exit p99", "Rejected");
+    for (uint16_t i = 0; i < sm->num_states; i++){
+        sm_state_t id = sm->state_table[i].state;
+        sm_metrics_get_state(sm, id, &state);
+        printf("%-16s %8llu %10s %10s %10s %10s %10s %9llu\n", sm_get_state_name(sm, id),
+               (unsigned long long)state.dwell.count,
+               format_ns(p50, sizeof(p50), sm_histogram_percentile(&state.dwell, 50)),
+               format_ns(p99, sizeof(p99), sm_histogram_percentile(&state.dwell, 99)),
+               format_ns(max, sizeof(max), state.dwell.max),
+               format_ns(entry, sizeof(entry), sm_histogram_percentile(&state.on_entry, 99)),
+               format_ns(leave, sizeof(leave), sm_histogram_percentile(&state.on_exit, 99)),
+               (unsigned long long)state.rejected);
+    }
+
+    printf("%-38s %8s %10s %10s %10s\n", "Transition", "Hits", "Action p50", "p99", "max");
+    for (uint16_t i = 0; i < sm->num_transitions; i++){
+        const sm_transition_tab_t *row = &sm->transition_table[i];
+        char name[64];
+        snprintf(name, sizeof(name), "%s --%d--> %s", sm_get_state_name(sm, row->from_state), row->event,
+                 sm_get_state_name(sm, row->to_state));
+        sm_metrics_get_transition(sm, row->from_state, row->event, &transition);
+        printf("%-38s %8llu %10s %10s %10s\n", name, (unsigned long long)transition.hits,
+               format_ns(p50, sizeof(p50), sm_histogram_percentile(&transition.action, 50)),
+               format_ns(p99, sizeof(p99), sm_histogram_percentile(&transition.action, 99)),
+               format_ns(max, sizeof(max), transition.action.max));
+    }
+    printf("============================\n");
+}
+#else
+typedef int sm_metrics_disabled_t;  // ISO C wants something in a translation unit
+#endif
@@ -0,0 +1,135 @@
+#include "state_machine.h"
+
+// Bounded MPSC queue after Dmitry Vyukov's bounded MPMC queue: each slot's
+// sequence says whose turn it is, so a producer claims a slot with one CAS
+// on tail and publishes it with one store, and the single consumer needs
+// no atomic read-modify-write at all.
+//
+//   sequence == pos            slot free for the producer claiming pos
+//   sequence == pos + 1        event for pos written, ready to dispatch
+//   sequence == pos + capacity slot released, free for the next lap
+//
+// Positions are free-running uint32_t; differences are taken as int32_t.
+
+//helper
+static void note_depth(sm_event_queue_t *queue, uint32_t depth){
+    uint32_t seen = __atomic_load_n(&queue->max_depth, __ATOMIC_RELAXED);
+    while (depth > seen &&
+           !__atomic_compare_exchange_n(&queue->max_depth, &seen, depth, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+    }
+}
+
+//core
+sm_result_t sm_queue_init(state_machine_t *sm, sm_queue_slot_t *slots, uint32_t capacity){
+    if(!sm || !slots) return SM_ERROR_NULL_POINTER;
+    if(!sm->initialized) return SM_ERROR_NOT_INITIALIZED;
+    if(capacity < 2 || capacity > 0x80000000u || (capacity & (capacity - 1)) != 0){
+        return SM_ERROR_INVALID_SIZE;
+    }
+
+    sm_event_queue_t *queue = &sm->queue;
+    memset(queue, 0, sizeof(*queue));
+    for (uint32_t i = 0; i < capacity; i++){
+        slots[i].sequence = i;
+        slots[i].event = 0;
+    }
+    queue->mask = capacity - 1;
+    __atomic_store_n(&queue->slots, slots, __ATOMIC_RELEASE);
+    return SM_SUCCESS;
+}
+
+sm_result_t sm_post_event(state_machine_t *sm, sm_event_t event){
+    if(!sm) return SM_ERROR_NULL_POINTER;
+    sm_event_queue_t *queue = &sm->queue;
+    sm_queue_slot_t *slots = __atomic_load_n(&queue->slots, __ATOMIC_ACQUIRE);
+    if(!slots) return SM_ERROR_NOT_INITIALIZED;
+
+    uint32_t pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    sm_queue_slot_t *slot;
+    for (;;){
+        slot = &slots[pos & queue->mask];
+        int32_t diff = (int32_t)(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) - pos);
+        if(diff == 0){
+            //slot is free: claim it, or retry from the tail another producer moved
+            if(__atomic_compare_exchange_n(&queue->tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)){
+                break;
+            }
+        } else if(diff < 0){
+            //still holds the event from one lap ago: full
+            __atomic_fetch_add(&queue->dropped, 1, __ATOMIC_RELAXED);
+            return SM_ERROR_QUEUE_FULL;
+        } else {
+            pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->event = event;
+    __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+    //the consumer may already be past pos by now, or the head read stale: only
+    //a positive difference is a depth, and never more than the queue holds
+    int32_t depth = (int32_t)(pos + 1 - __atomic_load_n(&queue->head, __ATOMIC_RELAXED));
+    if(depth > 0) note_depth(queue, (uint32_t)depth > queue->mask + 1 ? queue->mask + 1 : (uint32_t)depth);
+    return SM_SUCCESS;
+}
+
+sm_result_t sm_dispatch_pending(state_machine_t *sm, uint32_t max_events, uint32_t *dispatched){
+    if(dispatched) *dispatched = 0;
+    if(!sm) return SM_ERROR_NULL_POINTER;
+    if(!sm->initialized || !sm->queue.slots) return SM_ERROR_NOT_INITIALIZED;
+
+    sm_event_queue_t *queue = &sm->queue;
+    uint32_t capacity = queue->mask + 1;
+    uint32_t total = 0;
+
+    while (max_events == 0 || total < max_events){
+        //take up to one batch off the queue and release the slots at once
+        sm_event_t batch[SM_DISPATCH_BATCH];
+        uint32_t limit = SM_DISPATCH_BATCH;
+        if(max_events != 0 && max_events - total < limit) limit = max_events - total;
+
+        uint32_t head = queue->head;
+        uint32_t count = 0;
+        while (count < limit){
+            sm_queue_slot_t *slot = &queue->slots[head & queue->mask];
+            if(__atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE) != head + 1) break;
+            batch[count++] = slot->event;
+            __atomic_store_n(&slot->sequence, head + capacity, __ATOMIC_RELEASE);
+            head++;
+        }
+        __atomic_store_n(&queue->head, head, __ATOMIC_RELAXED);
+        if(count == 0) break;
+
+        //events with no transition are counted by sm_process_events, as usual
+        sm_process_events(sm, batch, count, NULL);
+        total += count;
+    }
+
+    if(dispatched) *dispatched = total;
+    return SM_SUCCESS;
+}
+
+bool sm_has_pending_events(const state_machine_t *sm){
+    if(!sm) return false;
+    const sm_event_queue_t *queue = &sm->queue;
+    const sm_queue_slot_t *slots = __atomic_load_n(&queue->slots, __ATOMIC_ACQUIRE);
+    if(!slots) return false;
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    return __atomic_load_n(&slots[head & queue->mask].sequence, __ATOMIC_ACQUIRE) == head + 1;
+}
+
+sm_result_t sm_get_queue_stats(const state_machine_t *sm, sm_queue_stats_t *stats){
+    if(!sm || !stats) return SM_ERROR_NULL_POINTER;
+    const sm_event_queue_t *queue = &sm->queue;
+    if(!__atomic_load_n(&queue->slots, __ATOMIC_ACQUIRE)) return SM_ERROR_NOT_INITIALIZED;
+
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    stats->capacity = queue->mask + 1;
+    int32_t depth = (int32_t)(tail - head);     //read apart, so clamped the same way
+    stats->depth = depth < 0 ? 0 : (uint32_t)depth > queue->mask + 1 ? queue->mask + 1 : (uint32_t)depth;
+    stats->max_depth = __atomic_load_n(&queue->max_depth, __ATOMIC_RELAXED);
+    stats->posted = tail;
+    stats->dispatched = head;
+    stats->dropped = __atomic_load_n(&queue->dropped, __ATOMIC_RELAXED);
+    return SM_SUCCESS;
+}
@@ -0,0 +1,418 @@
+#define _POSIX_C_SOURCE 200809L  // For clock_gettime()
+#include "state_machine_timer.h"
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
+
+// Wheel layout. Level L has 256 slots of 256^L ticks each. A timer due at
+// tick e, placed at tick now, goes to the lowest level whose span holds
+// e - now, in slot (e >> 8L) & 255. Level L's slot s is emptied at the next
+// tick T aligned to 256^L with (T >> 8L) & 255 == s: its timers are placed
+// again from T, landing on a lower level. Level 0's slot for a tick holds
+// exactly the timers due then; nothing armed at that tick can join them, as
+// every delay is at least one tick.
+
+#define SM_TIMER_BITS 8
+#define SM_TIMER_IDLE 0xFFFF                                   // Created, not armed
+#define SM_TIMER_FREE 0xFFFE                                   // On the free list
+#define SM_TIMER_WORDS (SM_TIMER_SLOTS / 64)                   // Bitmap words per level
+
+//helper
+static uint64_t level_span(unsigned level){
+    return (uint64_t)1 << (SM_TIMER_BITS * (level + 1));
+}
+static void set_occupied(sm_timer_wheel_t *wheel, uint16_t slot){
+    wheel->occupied[slot / 64] |= (uint64_t)1 << (slot % 64);
+}
+static void clear_occupied(sm_timer_wheel_t *wheel, uint16_t slot){
+    wheel->occupied[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+}
+static void link_timer(sm_timer_wheel_t *wheel, uint32_t id, uint16_t slot){
+    sm_timer_t *timer = &wheel->timers[id];
+    timer->slot = slot;
+    timer->prev = SM_TIMER_NONE;
+    timer->next = wheel->heads[slot];
+    if (timer->next != SM_TIMER_NONE) wheel->timers[timer->next].prev = id;
+    wheel->heads[slot] = id;
+    set_occupied(wheel, slot);
+}
+static void unlink_timer(sm_timer_wheel_t *wheel, uint32_t id){
+    sm_timer_t *timer = &wheel->timers[id];
+    if (timer->prev != SM_TIMER_NONE){
+        wheel->timers[timer->prev].next = timer->next;
+    }else{
+        wheel->heads[timer->slot] = timer->next;
+        if (timer->next == SM_TIMER_NONE) clear_occupied(wheel, timer->slot);
+    }
+    if (timer->next != SM_TIMER_NONE) wheel->timers[timer->next].prev = timer->prev;
+    timer->slot = SM_TIMER_IDLE;
+}
+// Slot for a timer due at `expires`, seen from wheel->now (expires > now, or == now while advancing)
+static uint16_t place_slot(const sm_timer_wheel_t *wheel, uint64_t expires){
+    uint64_t delta = expires - wheel->now;
+    unsigned level = 0;
+    while (level < SM_TIMER_LEVELS - 1 && delta >= level_span(level)) level++;
+    return (uint16_t)(level * SM_TIMER_SLOTS + ((expires >> (SM_TIMER_BITS * level)) & (SM_TIMER_SLOTS - 1)));
+}
+// First occupied slot of a level at or after `from`, wrapping around; -1 if the level is empty
+static int next_occupied(const uint64_t *bits, unsigned from){
+    unsigned word = from / 64;
+    uint64_t mask = bits[word] & (~(uint64_t)0 << (from % 64));
+    for (unsigned i = 0; i <= SM_TIMER_WORDS; i++){
+        if (mask) return (int)(word * 64 + (unsigned)__builtin_ctzll(mask));
+        word = (word + 1) % SM_TIMER_WORDS;
+        mask = bits[word];
+    }
+    return -1;
+}
+static bool valid_timer(const sm_timer_wheel_t *wheel, uint32_t id){
+    return id < wheel->num_timers && wheel->timers[id].slot != SM_TIMER_FREE;
+}
+static const sm_timeout_tab_t *find_timeout(const sm_timer_t *timer, sm_state_t state){
+    for (uint16_t i = 0; i < timer->num_timeouts; i++){
+        if (timer->timeouts[i].state == state) return &timer->timeouts[i];
+    }
+    return NULL;
+}
+
+//core
+size_t sm_timer_arena_size(uint32_t max_timers){
+    return (size_t)max_timers * sizeof(sm_timer_t);
+}
+sm_result_t sm_timer_init(sm_timer_wheel_t *wheel, uint32_t tick_ms, uint32_t max_timers, void *arena, size_t arena_size){
+    if (!wheel || !arena) return SM_ERROR_NULL_POINTER;
+    if (tick_ms == 0 || max_timers == 0 || max_timers >= SM_TIMER_NONE) return SM_ERROR_INVALID_SIZE;
+    if (arena_size < sm_timer_arena_size(max_timers)) return SM_ERROR_INVALID_SIZE;
+
+    memset(wheel, 0, sizeof(sm_timer_wheel_t));
+    wheel->timers = (sm_timer_t *)arena;
+    wheel->max_timers = max_timers;
+    wheel->free_list = SM_TIMER_NONE;
+    wheel->tick_ms = tick_ms;
+    for (uint32_t slot = 0; slot < SM_TIMER_LEVELS * SM_TIMER_SLOTS; slot++) wheel->heads[slot] = SM_TIMER_NONE;
+    return SM_SUCCESS;
+}
+sm_result_t sm_timer_create(sm_timer_wheel_t *wheel, state_machine_t *sm, uint32_t *id){
+    if (!wheel || !sm || !id) return SM_ERROR_NULL_POINTER;
+
+    uint32_t new_id;
+    if (wheel->free_list != SM_TIMER_NONE){
+        new_id = wheel->free_list;
+        wheel->free_list = wheel->timers[new_id].next;
+        wheel->num_free--;
+    }else if (wheel->num_timers < wheel->max_timers){
+        new_id = wheel->num_timers++;
+    }else{
+        return SM_ERROR_TABLE_FULL;
+    }
+
+    sm_timer_t *timer = &wheel->timers[new_id];
+    memset(timer, 0, sizeof(sm_timer_t));
+    timer->next = timer->prev = SM_TIMER_NONE;
+    timer->slot = SM_TIMER_IDLE;
+    timer->machine = sm;
+    *id = new_id;
+    return SM_SUCCESS;
+}
+sm_result_t sm_timer_arm(sm_timer_wheel_t *wheel, uint32_t id, uint32_t delay_ms, sm_event_t event){
+    if (!wheel) return SM_ERROR_NULL_POINTER;
+    if (!valid_timer(wheel, id)) return SM_ERROR_INVALID_STATE;
+
+    sm_timer_t *timer = &wheel->timers[id];
+    if (timer->slot != SM_TIMER_IDLE){
+        unlink_timer(wheel, id);
+    }else{
+        wheel->armed++;
+        if (wheel->armed > wheel->max_armed) wheel->max_armed = wheel->armed;
+    }
+
+    uint64_t ticks = ((uint64_t)delay_ms + wheel->tick_ms - 1) / wheel->tick_ms;
+    timer->expires = wheel->now + (ticks ? ticks : 1);
+    timer->event = event;
+    link_timer(wheel, id, place_slot(wheel, timer->expires));
+    return SM_SUCCESS;
+}
+sm_result_t sm_timer_cancel(sm_timer_wheel_t *wheel, uint32_t id){
+    if (!wheel) return SM_ERROR_NULL_POINTER;
+    if (!valid_timer(wheel, id)) return SM_ERROR_INVALID_STATE;
+
+    if (wheel->timers[id].slot != SM_TIMER_IDLE){
+        unlink_timer(wheel, id);
+        wheel->armed--;
+    }
+    return SM_SUCCESS;
+}
+sm_result_t sm_timer_destroy(sm_timer_wheel_t *wheel, uint32_t id){
+    sm_result_t result = sm_timer_cancel(wheel, id);
+    if (result != SM_SUCCESS) return result;
+
+    sm_timer_t *timer = &wheel->timers[id];
+    if (timer->timeouts && timer->machine->state_change_context == timer){
+        timer->machine->on_state_change = NULL;
+        timer->machine->state_change_context = NULL;
+    }
+    timer->slot = SM_TIMER_FREE;
+    timer->next = wheel->free_list;
+    wheel->free_list = id;
+    wheel->num_free++;
+    return SM_SUCCESS;
+}
+
+// on_state_change hook of an attached machine: restart its timer for the new state
+static void follow_state(state_machine_t *sm, sm_state_t state){
+    sm_timer_t *timer = (sm_timer_t *)sm->state_change_context;
+    sm_timer_wheel_t *wheel = timer->wheel;
+    uint32_t id = (uint32_t)(timer - wheel->timers);
+
+    const sm_timeout_tab_t *timeout = find_timeout(timer, state);
+    if (timeout){
+        sm_timer_arm(wheel, id, timeout->timeout_ms, timeout->event);
+    }else{
+        sm_timer_cancel(wheel, id);
+    }
+}
+sm_result_t sm_timer_attach(sm_timer_wheel_t *wheel, state_machine_t *sm, const sm_timeout_tab_t *timeouts, uint16_t num_timeouts, uint32_t *id){
+    if (!wheel || !sm || !timeouts || !id) return SM_ERROR_NULL_POINTER;
+    if (!sm->initialized) return SM_ERROR_NOT_INITIALIZED;
+
+    sm_result_t result = sm_timer_create(wheel, sm, id);
+    if (result != SM_SUCCESS) return result;
+
+    sm_timer_t *timer = &wheel->timers[*id];
+    timer->timeouts = timeouts;
+    timer->num_timeouts = num_timeouts;
+    timer->wheel = wheel;
+    sm->on_state_change = follow_state;
+    sm->state_change_context = timer;
+    follow_state(sm, sm->current_state);
+    return SM_SUCCESS;
+}
+
+bool sm_timer_next_tick(const sm_timer_wheel_t *wheel, uint64_t *tick){
+    if (!wheel || !tick || wheel->armed == 0) return false;
+
+    bool found = false;
+    for (unsigned level = 0; level < SM_TIMER_LEVELS; level++){
+        unsigned shift = SM_TIMER_BITS * level;
+        uint64_t position = wheel->now >> shift;
+        unsigned from = (unsigned)((position + 1) & (SM_TIMER_SLOTS - 1));
+        int slot = next_occupied(&wheel->occupied[level * SM_TIMER_WORDS], from);
+        if (slot < 0) continue;
+
+        // Offsets 1..256: the current slot itself comes round again last
+        uint64_t offset = (((unsigned)slot - from) & (SM_TIMER_SLOTS - 1)) + 1;
+        uint64_t when = (position + offset) << shift;
+        if (!found || when < *tick) *tick = when;
+        found = true;
+    }
+    return found;
+}
+// Everything due at wheel->now: lower the higher levels' slots that come
+// round at this tick, then expire level 0's slot
+static uint32_t run_tick(sm_timer_wheel_t *wheel){
+    uint64_t now = wheel->now;
+    for (unsigned level = SM_TIMER_LEVELS - 1; level > 0; level--){
+        unsigned shift = SM_TIMER_BITS * level;
+        if (now & (((uint64_t)1 << shift) - 1)) continue;
+
+        uint16_t slot = (uint16_t)(level * SM_TIMER_SLOTS + ((now >> shift) & (SM_TIMER_SLOTS - 1)));
+        uint32_t id = wheel->heads[slot];
+        wheel->heads[slot] = SM_TIMER_NONE;
+        clear_occupied(wheel, slot);
+        while (id != SM_TIMER_NONE){
+            uint32_t next = wheel->timers[id].next;
+            link_timer(wheel, id, place_slot(wheel, wheel->timers[id].expires));
+            wheel->cascaded++;
+            id = next;
+        }
+    }
+
+    // Machines may arm and cancel timers from their callbacks, these included
+    uint16_t slot = (uint16_t)(now & (SM_TIMER_SLOTS - 1));
+    uint32_t expired = 0;
+    uint32_t id;
+    while ((id = wheel->heads[slot]) != SM_TIMER_NONE){
+        sm_timer_t *timer = &wheel->timers[id];
+        unlink_timer(wheel, id);
+        wheel->armed--;
+        wheel->expired++;
+        expired++;
+        sm_process_event(timer->machine, timer->event);
+    }
+    return expired;
+}
+sm_result_t sm_timer_advance(sm_timer_wheel_t *wheel, uint64_t now, uint32_t *expired){
+    if (!wheel) return SM_ERROR_NULL_POINTER;
+
+    uint32_t count = 0;
+    uint64_t tick;
+    while (sm_timer_next_tick(wheel, &tick) && tick <= now){
+        wheel->now = tick;
+        count += run_tick(wheel);
+    }
+    if (now > wheel->now) wheel->now = now;
+
+    if (expired) *expired = count;
+    return SM_SUCCESS;
+}
+sm_result_t sm_timer_get_stats(const sm_timer_wheel_t *wheel, sm_timer_stats_t *stats){
+    if (!wheel || !stats) return SM_ERROR_NULL_POINTER;
+
+    stats->timers = wheel->num_timers - wheel->num_free;
+    stats->armed = wheel->armed;
+    stats->max_armed = wheel->max_armed;
+    stats->expired = wheel->expired;
+    stats->cascaded = wheel->cascaded;
+    stats->now = wheel->now;
+    return SM_SUCCESS;
+}
+
+// ========================
+// EVENT LOOP
+// ========================
+
+#ifdef __linux__
+
+#define SM_TIMER_LOOP_TIMER_TAG SM_TIMER_LOOP_MAX_WATCHES  // epoll tag of the timerfd
+
+//helper
+static uint64_t now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+// Absolute CLOCK_MONOTONIC wake-up, or disarmed if `when` is 0
+static sm_result_t set_wakeup(sm_timer_loop_t *loop, uint64_t when){
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = (time_t)(when / 1000000000u);
+    spec.it_value.tv_nsec = (long)(when % 1000000000u);
+    if (when && spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0) spec.it_value.tv_nsec = 1;
+    if (timerfd_settime(loop->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL) != 0) return SM_ERROR_SYSTEM;
+    return SM_SUCCESS;
+}
+
+//core
+sm_result_t sm_timer_loop_init(sm_timer_loop_t *loop, sm_timer_wheel_t *wheel){
+    if (!loop || !wheel) return SM_ERROR_NULL_POINTER;
+
+    memset(loop, 0, sizeof(sm_timer_loop_t));
+    loop->wheel = wheel;
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    loop->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (loop->epoll_fd < 0 || loop->timer_fd < 0){
+        sm_timer_loop_close(loop);
+        return SM_ERROR_SYSTEM;
+    }
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = SM_TIMER_LOOP_TIMER_TAG;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, loop->timer_fd, &event) != 0){
+        sm_timer_loop_close(loop);
+        return SM_ERROR_SYSTEM;
+    }
+    return SM_SUCCESS;
+}
+sm_result_t sm_timer_loop_watch(sm_timer_loop_t *loop, int fd, sm_fd_fn_t on_readable, void *context){
+    if (!loop || !on_readable) return SM_ERROR_NULL_POINTER;
+    if (loop->num_watches >= SM_TIMER_LOOP_MAX_WATCHES) return SM_ERROR_TABLE_FULL;
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.u32 = loop->num_watches;
+    if (epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) return SM_ERROR_SYSTEM;
+
+    sm_timer_watch_t *watch = &loop->watches[loop->num_watches++];
+    watch->fd = fd;
+    watch->on_readable = on_readable;
+    watch->context = context;
+    return SM_SUCCESS;
+}
+sm_result_t sm_timer_loop_run(sm_timer_loop_t *loop, uint32_t duration_ms){
+    if (!loop) return SM_ERROR_NULL_POINTER;
+
+    sm_timer_wheel_t *wheel = loop->wheel;
+    uint64_t tick_ns = (uint64_t)wheel->tick_ms * 1000000u;
+    uint64_t start = now_ns();
+    uint64_t deadline = duration_ms ? start + (uint64_t)duration_ms * 1000000u : 0;
+    loop->origin_ns = start - wheel->now * tick_ns;
+    loop->running = true;
+
+    sm_result_t result = SM_SUCCESS;
+    while (loop->running){
+        uint64_t now = now_ns();
+        if (deadline && now > deadline) now = deadline;
+        sm_timer_advance(wheel, (now - loop->origin_ns) / tick_ns, NULL);
+        if (!loop->running || (deadline && now == deadline)) break;
+
+        uint64_t tick;
+        uint64_t wakeup = sm_timer_next_tick(wheel, &tick) ? loop->origin_ns + tick * tick_ns : 0;
+        if (deadline && (wakeup == 0 || wakeup > deadline)) wakeup = deadline;
+        result = set_wakeup(loop, wakeup);
+        if (result != SM_SUCCESS) break;
+
+        struct epoll_event events[SM_TIMER_LOOP_MAX_WATCHES + 1];
+        int ready = epoll_wait(loop->epoll_fd, events, SM_TIMER_LOOP_MAX_WATCHES + 1, -1);
+        if (ready < 0){
+            if (errno == EINTR) continue;
+            result = SM_ERROR_SYSTEM;
+            break;
+        }
+        for (int i = 0; i < ready; i++){
+            uint32_t tag = events[i].data.u32;
+            if (tag == SM_TIMER_LOOP_TIMER_TAG){
+                uint64_t expirations;
+                ssize_t bytes = read(loop->timer_fd, &expirations, sizeof(expirations));
+                (void)bytes;  // EAGAIN if the wheel moved the wake-up since
+            }else{
+                sm_timer_watch_t *watch = &loop->watches[tag];
+                watch->on_readable(watch->fd, watch->context);
+            }
+        }
+    }
+
+    loop->running = false;
+    return result;
+}
+void sm_timer_loop_stop(sm_timer_loop_t *loop){
+    if (loop) loop->running = false;
+}
+void sm_timer_loop_close(sm_timer_loop_t *loop){
+    if (!loop) return;
+    if (loop->timer_fd >= 0) close(loop->timer_fd);
+    if (loop->epoll_fd >= 0) close(loop->epoll_fd);
+    loop->timer_fd = loop->epoll_fd = -1;
+}
+
+#else
+
+sm_result_t sm_timer_loop_init(sm_timer_loop_t *loop, sm_timer_wheel_t *wheel){
+    if (!loop || !wheel) return SM_ERROR_NULL_POINTER;
+    memset(loop, 0, sizeof(sm_timer_loop_t));
+    loop->wheel = wheel;
+    loop->epoll_fd = loop->timer_fd = -1;
+    return SM_ERROR_SYSTEM;
+}
+sm_result_t sm_timer_loop_watch(sm_timer_loop_t *loop, int fd, sm_fd_fn_t on_readable, void *context){
+    (void)loop; (void)fd; (void)on_readable; (void)context;
+    return SM_ERROR_SYSTEM;
+}
+sm_result_t sm_timer_loop_run(sm_timer_loop_t *loop, uint32_t duration_ms){
+    (void)loop; (void)duration_ms;
+    return SM_ERROR_SYSTEM;
+}
+void sm_timer_loop_stop(sm_timer_loop_t *loop){
+    if (loop) loop->running = false;
+}
+void sm_timer_loop_close(sm_timer_loop_t *loop){
+    (void)loop;
+}
+
+#endif
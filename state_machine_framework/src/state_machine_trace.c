@@ -0,0 +1,177 @@
+#define _POSIX_C_SOURCE 200809L  // For clock_gettime()
+#include "state_machine.h"
+#include <time.h>
+
+// The ring is written by one thread and read by any, as a seqlock with head
+// for the sequence: a record is filled in, then head is published with a
+// release store. Record fields are relaxed atomics on both sides. A reader
+// copies records below head, then looks at head again; the writer may have
+// been filling in any record from head - capacity on meanwhile, so copies of
+// those are dropped. The writer's release fence before the fields pairs with
+// the reader's acquire fence after its copy: a reader that saw any field of
+// a newer record then sees the head that record is written at.
+//
+// File written by sm_trace_save, host byte order:
+//   char magic[8]                    SM_TRACE_MAGIC
+//   uint32_t clock, num_machines
+//   uint64_t origin_ticks, origin_ns   clock readings at sm_trace_init...
+//   uint64_t saved_ticks, saved_ns     ...and at sm_trace_save, to scale ticks
+//   uint64_t first, head             ring positions of the first record saved and of the end
+//   per machine: uint16_t tag, num_states; char id[SM_MAX_ID_LENGTH];
+//                per state: uint16_t state, name_length; char name[name_length]
+//   sm_trace_record_t records[]      up to the end of the file
+
+#define SM_TRACE_SAVE_CHUNK 256
+
+//helper
+#if defined(__x86_64__) || defined(__i386__)
+static inline uint64_t read_cycles(void){
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+}
+#else
+static inline uint64_t read_cycles(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+static uint64_t read_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+static bool write_bytes(FILE *out, const void *data, size_t size){
+    return fwrite(data, 1, size, out) == size;
+}
+static bool write_u16(FILE *out, uint16_t value){
+    return write_bytes(out, &value, sizeof(value));
+}
+static bool write_u32(FILE *out, uint32_t value){
+    return write_bytes(out, &value, sizeof(value));
+}
+static bool write_u64(FILE *out, uint64_t value){
+    return write_bytes(out, &value, sizeof(value));
+}
+static bool write_machine(FILE *out, const state_machine_t *sm){
+    char id[SM_MAX_ID_LENGTH];
+    memset(id, 0, sizeof(id));
+    memcpy(id, sm->id, strlen(sm->id));
+    if(!write_u16(out, sm->trace_tag) || !write_u16(out, sm->num_states) || !write_bytes(out, id, sizeof(id))) return false;
+
+    for (uint16_t i = 0; i < sm->num_states; i++){
+        sm_state_t state = sm->state_table[i].state;
+        const char *name = sm_get_state_name(sm, state);
+        uint16_t length = (uint16_t)strlen(name);
+        if(!write_u16(out, state) || !write_u16(out, length) || !write_bytes(out, name, length)) return false;
+    }
+    return true;
+}
+
+//core
+sm_result_t sm_trace_init(sm_trace_ring_t *ring, sm_trace_record_t *records, uint32_t capacity, sm_trace_clock_t clock){
+    if(!ring || !records) return SM_ERROR_NULL_POINTER;
+    if(capacity < 2 || capacity > 0x80000000u || (capacity & (capacity - 1)) != 0){
+        return SM_ERROR_INVALID_SIZE;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->records = records;
+    ring->mask = capacity - 1;
+    ring->clock = clock;
+    ring->origin_ticks = sm_trace_now(ring);
+    ring->origin_ns = read_ns();
+    return SM_SUCCESS;
+}
+sm_result_t sm_trace_attach(state_machine_t *sm, sm_trace_ring_t *ring, uint16_t tag){
+    if(!sm) return SM_ERROR_NULL_POINTER;
+    if(!sm->initialized) return SM_ERROR_NOT_INITIALIZED;
+    if(tag & SM_TRACE_NO_TRANSITION) return SM_ERROR_INVALID_SIZE;
+
+    sm->trace = ring;
+    sm->trace_tag = tag;
+    return SM_SUCCESS;
+}
+uint64_t sm_trace_now(const sm_trace_ring_t *ring){
+    if(ring->clock == SM_TRACE_CLOCK_COARSE){
+        struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+        return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+    }
+    return read_cycles();
+}
+void sm_trace_write(sm_trace_ring_t *ring, uint64_t timestamp, uint16_t machine, sm_state_t from, sm_state_t to, sm_event_t event){
+    uint64_t head = ring->head;
+    sm_trace_record_t *record = &ring->records[head & ring->mask];
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    __atomic_store_n(&record->timestamp, timestamp, __ATOMIC_RELAXED);
+    __atomic_store_n(&record->machine, machine, __ATOMIC_RELAXED);
+    __atomic_store_n(&record->from, from, __ATOMIC_RELAXED);
+    __atomic_store_n(&record->to, to, __ATOMIC_RELAXED);
+    __atomic_store_n(&record->event, event, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+}
+sm_result_t sm_trace_read(const sm_trace_ring_t *ring, uint64_t *cursor, sm_trace_record_t *records, uint32_t max_records, uint32_t *count){
+    if(count) *count = 0;
+    if(!ring || !cursor || (!records && max_records)) return SM_ERROR_NULL_POINTER;
+
+    uint64_t capacity = (uint64_t)ring->mask + 1;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t from = *cursor;
+    if(from > head) from = head;
+    if(head - from > capacity) from = head - capacity;
+    uint64_t copied = head - from;
+    if(copied > max_records) copied = max_records;
+
+    for (uint64_t i = 0; i < copied; i++){
+        const sm_trace_record_t *record = &ring->records[(from + i) & ring->mask];
+        records[i].timestamp = __atomic_load_n(&record->timestamp, __ATOMIC_RELAXED);
+        records[i].machine = __atomic_load_n(&record->machine, __ATOMIC_RELAXED);
+        records[i].from = __atomic_load_n(&record->from, __ATOMIC_RELAXED);
+        records[i].to = __atomic_load_n(&record->to, __ATOMIC_RELAXED);
+        records[i].event = __atomic_load_n(&record->event, __ATOMIC_RELAXED);
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    //records at or below now - capacity may have been rewritten under the copy
+    uint64_t now = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint64_t torn = 0;
+    if(now + 1 > from + capacity) torn = now + 1 - capacity - from;
+    if(torn > copied) torn = copied;
+    if(torn) memmove(records, records + torn, (size_t)(copied - torn) * sizeof(sm_trace_record_t));
+
+    *cursor = from + copied;
+    if(count) *count = (uint32_t)(copied - torn);
+    return SM_SUCCESS;
+}
+sm_result_t sm_trace_save(const sm_trace_ring_t *ring, state_machine_t *const *machines, uint16_t num_machines, FILE *out){
+    if(!ring || !out || (!machines && num_machines)) return SM_ERROR_NULL_POINTER;
+
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+    uint64_t capacity = (uint64_t)ring->mask + 1;
+    uint64_t cursor = head >= capacity ? head - capacity + 1 : 0;
+
+    bool ok = write_bytes(out, SM_TRACE_MAGIC, 8) &&
+              write_u32(out, (uint32_t)ring->clock) && write_u32(out, num_machines) &&
+              write_u64(out, ring->origin_ticks) && write_u64(out, ring->origin_ns) &&
+              write_u64(out, sm_trace_now(ring)) && write_u64(out, read_ns()) &&
+              write_u64(out, cursor) && write_u64(out, head);
+    for (uint16_t i = 0; ok && i < num_machines; i++){
+        ok = machines[i] && write_machine(out, machines[i]);
+    }
+
+    //only what was in the ring when the save began
+    sm_trace_record_t chunk[SM_TRACE_SAVE_CHUNK];
+    while (ok && cursor < head){
+        uint32_t limit = head - cursor < SM_TRACE_SAVE_CHUNK ? (uint32_t)(head - cursor) : SM_TRACE_SAVE_CHUNK;
+        uint32_t count;
+        sm_trace_read(ring, &cursor, chunk, limit, &count);
+        ok = write_bytes(out, chunk, count * sizeof(sm_trace_record_t));
+    }
+    return ok ? SM_SUCCESS : SM_ERROR_SYSTEM;
+}
@@ -0,0 +1,53 @@
+#ifndef TEST_COMMON_H
+#define TEST_COMMON_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+// Shared by the test programs in tests/: each one prints a line per check,
+// then the totals, and exits non-zero if anything failed (see make test).
+
+static int tests_run = 0;
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST_ASSERT(condition, test_name) do { \
+    tests_run++; \
+    if (condition) { \
+        tests_passed++; \
+        printf("✓ PASS: %s\n", test_name); \
+    } else { \
+        tests_failed++; \
+        printf("✗ FAIL: %s (%s:%d)\n", test_name, __FILE__, __LINE__); \
+    } \
+} while (0)
+
+#define COUNT(table) (sizeof(table) / sizeof(table[0]))
+
+static inline void print_section(const char *section_name) {
+    printf("\n=== %s ===\n", section_name);
+}
+
+static inline int print_results(void) {
+    print_section("TEST RESULTS");
+    printf("Tests run: %d\n", tests_run);
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    return tests_failed == 0 ? 0 : 1;
+}
+
+// Same generator as the benchmarks, reseedable so every run is the same
+static uint32_t xorshift_state = 2463534242u;
+
+static inline void seed_random(uint32_t seed) {
+    xorshift_state = seed ? seed : 2463534242u;
+}
+
+static inline uint32_t next_random(void) {
+    xorshift_state ^= xorshift_state << 13;
+    xorshift_state ^= xorshift_state >> 17;
+    xorshift_state ^= xorshift_state << 5;
+    return xorshift_state;
+}
+
+#endif
@@ -0,0 +1,129 @@
+#define _POSIX_C_SOURCE 200112L  // For sched_yield()
+#include "../include/state_machine_executor.h"
+#include "test_common.h"
+#include <sched.h>
+
+/**
+ * @file test_executor.c
+ * @brief Executor: the main thread feeds half the machines, whose callbacks
+ * post on to the other half from the workers. Every machine must see each
+ * event once and in the order its one producer posted them.
+ */
+
+#define NUM_MACHINES 64
+#define HALF (NUM_MACHINES / 2)
+#define EVENTS_PER_MACHINE 2000
+#define QUEUE_CAPACITY 2048         // Holds everything a callback posts, so callbacks never wait
+#define SEQUENCE_MASK 15            // Event = sequence number mod 16
+
+static sm_state_tab_t executor_states[] = {{0, NULL, NULL, "ONLY"}};
+static sm_transition_tab_t executor_transitions[SEQUENCE_MASK + 1];
+static state_machine_t machines[NUM_MACHINES];
+static sm_queue_slot_t slots[NUM_MACHINES][QUEUE_CAPACITY];
+static uint32_t ids[NUM_MACHINES];
+static sm_executor_t executor;
+
+// Written only by the worker running the machine; read after sm_executor_stop
+static uint32_t received[NUM_MACHINES];
+static bool in_order[NUM_MACHINES];
+static uint32_t forward_failed[HALF];
+
+static void on_event(state_machine_t *sm, sm_state_t from, sm_state_t to, sm_event_t event) {
+    (void)from; (void)to;
+    uint32_t m = (uint32_t)(sm - machines);
+    in_order[m] = in_order[m] && event == (received[m] & SEQUENCE_MASK);
+    received[m]++;
+
+    // First half: pass it on from the worker, onto that worker's deque
+    if (m < HALF) {
+        if (sm_executor_post(&executor, ids[m + HALF], event) != SM_SUCCESS) forward_failed[m]++;
+        // Now and then leave the CPU with work on this worker's deque, so
+        // the others get to steal it even on a single core
+        if ((received[m] & 31) == 0) sched_yield();
+    }
+}
+
+static void run(uint32_t num_workers) {
+    char section[64];
+    snprintf(section, sizeof(section), "%u WORKER%s", num_workers, num_workers == 1 ? "" : "S");
+    print_section(section);
+
+    static uint8_t arena[1 << 20];
+    TEST_ASSERT(sm_executor_arena_size(NUM_MACHINES, num_workers) <= sizeof(arena) &&
+                sm_executor_init(&executor, NUM_MACHINES, num_workers, arena, sizeof(arena)) == SM_SUCCESS,
+                "sm_executor_init");
+    for (uint16_t e = 0; e <= SEQUENCE_MASK; e++) {
+        executor_transitions[e].from_state = 0;
+        executor_transitions[e].event = e;
+        executor_transitions[e].to_state = 0;
+        executor_transitions[e].action = on_event;
+    }
+    bool added = true;
+    for (uint32_t m = 0; m < NUM_MACHINES; m++) {
+        sm_init(&machines[m], "M", 0, executor_states, 1, executor_transitions, COUNT(executor_transitions));
+        sm_queue_init(&machines[m], slots[m], QUEUE_CAPACITY);
+        added = added && sm_executor_add(&executor, &machines[m], &ids[m]) == SM_SUCCESS && ids[m] == m;
+        received[m] = 0;
+        in_order[m] = true;
+        if (m < HALF) forward_failed[m] = 0;
+    }
+    TEST_ASSERT(added, "sm_executor_add");
+
+    // A few events before the start, the rest while the workers run
+    for (uint32_t m = 0; m < HALF; m++) sm_executor_post(&executor, ids[m], 0);
+    TEST_ASSERT(sm_executor_start(&executor) == SM_SUCCESS, "sm_executor_start");
+    TEST_ASSERT(sm_executor_start(&executor) == SM_ERROR_INVALID_STATE, "Started twice: refused");
+    uint32_t refused = 0;
+    for (uint32_t i = 1; i < EVENTS_PER_MACHINE; i++) {
+        for (uint32_t m = 0; m < HALF; m++) {
+            while (sm_executor_post(&executor, ids[m], (sm_event_t)(i & SEQUENCE_MASK)) == SM_ERROR_QUEUE_FULL) {
+                refused++;
+                sched_yield();
+            }
+        }
+    }
+    TEST_ASSERT(sm_executor_stop(&executor) == SM_SUCCESS, "sm_executor_stop");
+
+    bool all_received = true, ordered = true, none_pending = true;
+    uint32_t failed = 0;
+    uint64_t machine_events = 0;
+    for (uint32_t m = 0; m < NUM_MACHINES; m++) {
+        all_received = all_received && received[m] == EVENTS_PER_MACHINE;
+        ordered = ordered && in_order[m];
+        if (m < HALF) failed += forward_failed[m];
+        sm_executor_machine_stats_t machine;
+        sm_executor_get_machine_stats(&executor, ids[m], &machine);
+        none_pending = none_pending && machine.pending == 0 && machine.events == EVENTS_PER_MACHINE;
+        machine_events += machine.events;
+    }
+    sm_executor_stats_t stats;
+    sm_executor_get_stats(&executor, &stats);
+    printf("   %llu events in %llu runs, %llu steals, %u posts refused while full\n",
+           (unsigned long long)stats.events, (unsigned long long)stats.runs, (unsigned long long)stats.steals,
+           refused);
+
+    TEST_ASSERT(failed == 0, "Every post from a callback accepted");
+    TEST_ASSERT(all_received && none_pending, "Every event dispatched exactly once, nothing left queued");
+    TEST_ASSERT(ordered, "Each machine's events in the order they were posted");
+    TEST_ASSERT(stats.events == (uint64_t)NUM_MACHINES * EVENTS_PER_MACHINE && machine_events == stats.events,
+                "Worker and machine counters add up");
+    if (num_workers == 1) {
+        TEST_ASSERT(stats.steals == 0, "Nobody to steal from");
+    } else {
+        TEST_ASSERT(stats.steals > 0, "Idle workers steal from the busy ones");
+    }
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(void) {
+    printf("State Machine Framework - Executor Tests\n");
+    printf("========================================\n");
+
+    run(1);
+    run(4);
+
+    return print_results();
+}
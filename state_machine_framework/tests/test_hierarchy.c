@@ -0,0 +1,194 @@
+#include "../include/state_machine.h"
+#include "test_common.h"
+
+/**
+ * @file test_hierarchy.c
+ * @brief Hierarchical machines: exit/entry order along the state tree,
+ * inherited and overridden transitions, and orthogonal regions.
+ *
+ * Region 0:  A (initial A1) > A1 (initial A11) > A11, A12
+ *                           > A2
+ *            B
+ * Region 1:  X, Y
+ */
+
+typedef enum {
+    STATE_A = 1, STATE_A1, STATE_A11, STATE_A12, STATE_A2, STATE_B, STATE_X, STATE_Y
+} test_state_t;
+
+typedef enum {
+    EVENT_NEXT = 0,     // A11 -> A12 (inside A1), X <-> Y in region 1
+    EVENT_LEAVE,        // A -> B, overridden by A11 -> A2
+    EVENT_BACK,         // B -> A, enters A's initial substates
+    EVENT_RESTART,      // A1 -> A1: exits and re-enters A1
+    EVENT_ONLY_Y        // Y -> X, nothing in region 0
+} test_event_t;
+
+// Callbacks write "x:A11 a:A11 n:A12 " style lines
+static char trace[512];
+
+static void append(const char *kind, state_machine_t *sm, sm_state_t state) {
+    size_t used = strlen(trace);
+    snprintf(trace + used, sizeof(trace) - used, "%s:%s ", kind, sm_get_state_name(sm, state));
+}
+static void on_exit_state(state_machine_t *sm, sm_state_t state) {
+    append("x", sm, state);
+}
+static void on_entry_state(state_machine_t *sm, sm_state_t state) {
+    append("n", sm, state);
+}
+static void on_action(state_machine_t *sm, sm_state_t from, sm_state_t to, sm_event_t event) {
+    (void)to; (void)event;
+    append("a", sm, from);
+}
+
+static const sm_state_tab_t hsm_states[] = {
+    {STATE_A,   on_entry_state, on_exit_state, "A"},
+    {STATE_A1,  on_entry_state, on_exit_state, "A1"},
+    {STATE_A11, on_entry_state, on_exit_state, "A11"},
+    {STATE_A12, on_entry_state, on_exit_state, "A12"},
+    {STATE_A2,  on_entry_state, on_exit_state, "A2"},
+    {STATE_B,   on_entry_state, on_exit_state, "B"},
+    {STATE_X,   on_entry_state, on_exit_state, "X"},
+    {STATE_Y,   on_entry_state, on_exit_state, "Y"}
+};
+
+static const sm_hierarchy_tab_t hsm_tree[] = {
+    {STATE_A,   SM_NO_STATE, STATE_A1,    0},
+    {STATE_A1,  STATE_A,     STATE_A11,   0},
+    {STATE_A11, STATE_A1,    SM_NO_STATE, 0},
+    {STATE_A12, STATE_A1,    SM_NO_STATE, 0},
+    {STATE_A2,  STATE_A,     SM_NO_STATE, 0},
+    {STATE_X,   SM_NO_STATE, SM_NO_STATE, 1},
+    {STATE_Y,   SM_NO_STATE, SM_NO_STATE, 1}
+};
+
+static const sm_transition_tab_t hsm_transitions[] = {
+    {STATE_A11, EVENT_NEXT,    STATE_A12, on_action},
+    {STATE_A,   EVENT_LEAVE,   STATE_B,   on_action},
+    {STATE_A11, EVENT_LEAVE,   STATE_A2,  on_action},
+    {STATE_B,   EVENT_BACK,    STATE_A,   on_action},
+    {STATE_A1,  EVENT_RESTART, STATE_A1,  on_action},
+    {STATE_X,   EVENT_NEXT,    STATE_Y,   on_action},
+    {STATE_Y,   EVENT_NEXT,    STATE_X,   on_action},
+    {STATE_Y,   EVENT_ONLY_Y,  STATE_X,   on_action}
+};
+
+static const sm_state_t hsm_initial[] = {STATE_A, STATE_X};
+
+static const sm_hierarchy_def_t hsm_def = {
+    hsm_states, COUNT(hsm_states),
+    hsm_transitions, COUNT(hsm_transitions),
+    hsm_tree, COUNT(hsm_tree),
+    hsm_initial, COUNT(hsm_initial)
+};
+
+static uint16_t hsm_arena[512];
+
+// Run one event and compare the callbacks it made
+static bool step(state_machine_t *sm, sm_event_t event, sm_result_t expected_result, const char *expected_trace) {
+    trace[0] = '\0';
+    sm_result_t result = sm_process_event(sm, event);
+    if (result != expected_result || strcmp(trace, expected_trace) != 0) {
+        printf("   event %d: result %d, callbacks \"%s\", expected \"%s\"\n", event, result, trace, expected_trace);
+        return false;
+    }
+    return true;
+}
+
+static bool regions_are(const state_machine_t *sm, sm_state_t region0, sm_state_t region1) {
+    sm_state_t first, second;
+    return sm_get_region_state(sm, 0, &first) == SM_SUCCESS && sm_get_region_state(sm, 1, &second) == SM_SUCCESS &&
+           first == region0 && second == region1 && sm->current_state == region0;
+}
+
+// =============================================================================
+// EXIT / ENTRY ORDER
+// =============================================================================
+
+static void test_exit_entry_order(state_machine_t *sm) {
+    print_section("EXIT / ENTRY ORDER");
+
+    trace[0] = '\0';
+    size_t arena_size = 0;
+    TEST_ASSERT(sm_hierarchy_arena_size(&hsm_def, &arena_size) == SM_SUCCESS && arena_size <= sizeof(hsm_arena),
+                "Arena size of the test hierarchy");
+    TEST_ASSERT(sm_init_hierarchical(sm, "hsm", &hsm_def, hsm_arena, sizeof(hsm_arena)) == SM_SUCCESS,
+                "sm_init_hierarchical");
+    TEST_ASSERT(strcmp(trace, "n:A n:A1 n:A11 n:X ") == 0, "Init enters each region's chain, outermost first");
+    TEST_ASSERT(regions_are(sm, STATE_A11, STATE_X), "Init: A11 and X");
+    TEST_ASSERT(sm_is_in_state(sm, STATE_A) && sm_is_in_state(sm, STATE_A1) && sm_is_in_state(sm, STATE_A11) &&
+                !sm_is_in_state(sm, STATE_A12) && !sm_is_in_state(sm, STATE_B) && sm_is_in_state(sm, STATE_X),
+                "sm_is_in_state covers the enclosing states");
+
+    TEST_ASSERT(step(sm, EVENT_LEAVE, SM_SUCCESS, "x:A11 x:A1 a:A11 n:A2 "),
+                "A11's own LEAVE overrides A's, leaves only up to A");
+    TEST_ASSERT(regions_are(sm, STATE_A2, STATE_X), "LEAVE from A11: A2");
+
+    TEST_ASSERT(step(sm, EVENT_LEAVE, SM_SUCCESS, "x:A2 x:A a:A n:B "), "LEAVE inherited from A: exits leaf first");
+    TEST_ASSERT(step(sm, EVENT_BACK, SM_SUCCESS, "x:B a:B n:A n:A1 n:A11 "),
+                "Transition to a composite enters its initial substates");
+    TEST_ASSERT(step(sm, EVENT_NEXT, SM_SUCCESS, "x:A11 a:A11 n:A12 x:X a:X n:Y "),
+                "Sibling transition stays inside A1; region 1 runs after region 0");
+    TEST_ASSERT(regions_are(sm, STATE_A12, STATE_Y), "NEXT: A12 and Y");
+
+    TEST_ASSERT(step(sm, EVENT_RESTART, SM_SUCCESS, "x:A12 x:A1 a:A1 n:A1 n:A11 "),
+                "Self-transition on a composite exits and re-enters it");
+    TEST_ASSERT(step(sm, EVENT_LEAVE, SM_SUCCESS, "x:A11 x:A1 a:A11 n:A2 "), "Back to A2");
+    TEST_ASSERT(step(sm, EVENT_NEXT, SM_SUCCESS, "x:Y a:Y n:X "), "Region 0 has no NEXT in A2, region 1 does");
+}
+
+// =============================================================================
+// ORTHOGONAL REGIONS
+// =============================================================================
+
+static void test_regions(state_machine_t *sm) {
+    print_section("ORTHOGONAL REGIONS");
+
+    uint32_t total = 0, invalid = 0;
+    sm_get_stats(sm, &total, &invalid);
+    TEST_ASSERT(step(sm, EVENT_ONLY_Y, SM_ERROR_INVALID_EVENT, ""), "No region handles ONLY_Y in (A2, X)");
+    uint32_t after_total = 0, after_invalid = 0;
+    sm_get_stats(sm, &after_total, &after_invalid);
+    TEST_ASSERT(after_total == total && after_invalid == invalid + 1, "Unhandled event counted once");
+
+    TEST_ASSERT(step(sm, EVENT_NEXT, SM_SUCCESS, "x:X a:X n:Y "), "Region 1 alone: X -> Y");
+    TEST_ASSERT(step(sm, EVENT_ONLY_Y, SM_SUCCESS, "x:Y a:Y n:X "), "Region 1 alone: Y -> X");
+    TEST_ASSERT(regions_are(sm, STATE_A2, STATE_X), "Region 0 untouched by region 1's transitions");
+
+    sm_state_t state;
+    TEST_ASSERT(sm_get_region_state(sm, 2, &state) != SM_SUCCESS, "Region past num_regions rejected");
+
+    trace[0] = '\0';
+    TEST_ASSERT(sm_reset(sm) == SM_SUCCESS && strcmp(trace, "x:A2 x:A n:A n:A1 n:A11 ") == 0,
+                "sm_reset leaves and re-enters the whole chain of a moved region only");
+    TEST_ASSERT(regions_are(sm, STATE_A11, STATE_X), "sm_reset: A11 and X");
+
+    sm_deferred_t calls[4];
+    TEST_ASSERT(sm_set_deferred_callbacks(sm, calls, COUNT(calls)) == SM_ERROR_INVALID_STATE,
+                "Deferred callbacks are for flat machines only");
+
+    // A batch goes through sm_process_event, so it takes the same paths
+    static const sm_event_t batch[] = {EVENT_NEXT, EVENT_LEAVE, EVENT_ONLY_Y, EVENT_BACK};
+    sm_result_t results[COUNT(batch)];
+    trace[0] = '\0';
+    TEST_ASSERT(sm_process_events(sm, batch, COUNT(batch), results) == SM_SUCCESS &&
+                strcmp(trace, "x:A11 a:A11 n:A12 x:X a:X n:Y x:A12 x:A1 x:A a:A n:B x:Y a:Y n:X "
+                              "x:B a:B n:A n:A1 n:A11 ") == 0,
+                "sm_process_events on a hierarchical machine");
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(void) {
+    printf("State Machine Framework - Hierarchy Tests\n");
+    printf("=========================================\n");
+
+    static state_machine_t sm;
+    test_exit_entry_order(&sm);
+    test_regions(&sm);
+
+    return print_results();
+}
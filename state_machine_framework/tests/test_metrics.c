@@ -0,0 +1,168 @@
+#include "../include/state_machine.h"
+#include "test_common.h"
+#include <stdlib.h>
+
+/**
+ * @file test_metrics.c
+ * @brief Metrics histograms: bucket bounds, percentiles against the exact
+ * values, and what sm_process_event records. make test builds this one with
+ * -DSM_METRICS, whatever METRICS is set to.
+ */
+
+#ifndef SM_METRICS
+#error "test_metrics.c needs -DSM_METRICS"
+#endif
+
+#define RANDOM_VALUES 100000
+
+static int compare_values(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// =============================================================================
+// BUCKET BOUNDS
+// =============================================================================
+
+// The 50th percentile of {value, far larger} is the top of value's bucket
+static uint64_t bucket_top_of(uint64_t value) {
+    static sm_histogram_t histogram;
+    memset(&histogram, 0, sizeof(histogram));
+    sm_histogram_record(&histogram, value);
+    sm_histogram_record(&histogram, (uint64_t)1 << 60);
+    return sm_histogram_percentile(&histogram, 50);
+}
+
+static void test_bucket_bounds(void) {
+    print_section("BUCKET BOUNDS");
+
+    bool exact = true;
+    for (uint64_t value = 0; value < (2u << SM_HISTOGRAM_SUB_BITS); value++) {
+        exact = exact && bucket_top_of(value) == value;
+    }
+    TEST_ASSERT(exact, "Values below 2^(SUB_BITS + 1) have a bucket each");
+
+    // Every bucket edge and the values next to it, short of the last bucket,
+    // which also holds everything past the range (checked below)
+    bool within = true, monotonic = true;
+    uint64_t previous = 0;
+    uint64_t last_edge = (uint64_t)15 << (SM_HISTOGRAM_MAX_EXPONENT - SM_HISTOGRAM_SUB_BITS);
+    for (uint32_t exponent = SM_HISTOGRAM_SUB_BITS + 1; exponent <= SM_HISTOGRAM_MAX_EXPONENT; exponent++) {
+        for (uint64_t mantissa = 8; mantissa < 16; mantissa++) {
+            uint64_t edge = mantissa << (exponent - SM_HISTOGRAM_SUB_BITS);
+            for (int delta = -1; delta <= 1 && edge + (uint64_t)(int64_t)delta < last_edge; delta++) {
+                uint64_t value = edge + (uint64_t)(int64_t)delta;
+                uint64_t top = bucket_top_of(value);
+                within = within && top >= value && top - value <= value >> SM_HISTOGRAM_SUB_BITS;
+                monotonic = monotonic && top >= previous;
+                previous = top;
+            }
+        }
+    }
+    TEST_ASSERT(within, "Bucket top is within 1/8 above each value");
+    TEST_ASSERT(monotonic, "Bucket tops grow with the value");
+
+    static sm_histogram_t overflow;
+    sm_histogram_record(&overflow, (uint64_t)1 << 50);
+    sm_histogram_record(&overflow, last_edge);
+    TEST_ASSERT(sm_histogram_percentile(&overflow, 100) == (uint64_t)1 << 50 &&
+                sm_histogram_percentile(&overflow, 50) == (uint64_t)1 << 50,
+                "Past the range: the last bucket reports the maximum");
+}
+
+// =============================================================================
+// PERCENTILES
+// =============================================================================
+
+static void test_percentiles(void) {
+    print_section("PERCENTILES");
+
+    static sm_histogram_t empty;
+    TEST_ASSERT(sm_histogram_percentile(&empty, 50) == 0 && sm_histogram_percentile(NULL, 50) == 0,
+                "No values: 0");
+
+    static sm_histogram_t histogram;
+    static uint64_t values[RANDOM_VALUES];
+    seed_random(6);
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < RANDOM_VALUES; i++) {
+        // Two clusters three orders of magnitude apart
+        values[i] = (uint64_t)(next_random() % 1000000) * (i % 3 ? 1 : 1000);
+        sum += values[i];
+        sm_histogram_record(&histogram, values[i]);
+    }
+    qsort(values, RANDOM_VALUES, sizeof(values[0]), compare_values);
+    TEST_ASSERT(histogram.count == RANDOM_VALUES && histogram.sum == sum && histogram.min == values[0] &&
+                histogram.max == values[RANDOM_VALUES - 1], "Count, sum, min and max");
+
+    static const double percentiles[] = {0.1, 1, 10, 50, 66, 90, 99, 99.9};
+    bool bounded = true;
+    for (size_t k = 0; k < COUNT(percentiles); k++) {
+        uint64_t exact = values[(size_t)(percentiles[k] / 100 * RANDOM_VALUES + 0.5) - 1];
+        uint64_t reported = sm_histogram_percentile(&histogram, percentiles[k]);
+        bool ok = reported >= exact && reported - exact <= exact / 8 + 1;
+        if (!ok) {
+            printf("   p%g: exact %llu, reported %llu\n", percentiles[k], (unsigned long long)exact,
+                   (unsigned long long)reported);
+        }
+        bounded = bounded && ok;
+    }
+    TEST_ASSERT(bounded, "Percentiles at or above the exact value, by at most 1/8");
+    TEST_ASSERT(sm_histogram_percentile(&histogram, 100) == histogram.max &&
+                sm_histogram_percentile(&histogram, 150) == histogram.max, "p100 (and beyond) is the maximum");
+    TEST_ASSERT(sm_histogram_percentile(&histogram, 0) == sm_histogram_percentile(&histogram, -5) &&
+                sm_histogram_percentile(&histogram, 0) <= histogram.min + histogram.min / 8 + 1,
+                "p0 (and below) is the minimum's bucket");
+}
+
+// =============================================================================
+// MACHINE METRICS
+// =============================================================================
+
+static const sm_state_tab_t metric_states[] = {{0, NULL, NULL, "A"}, {1, NULL, NULL, "B"}};
+static const sm_transition_tab_t metric_transitions[] = {{0, 1, 1, NULL}, {1, 2, 0, NULL}};
+static uint64_t metric_arena[SM_METRICS_ARENA_SIZE(2, 2) / sizeof(uint64_t)];
+
+static void test_machine_metrics(void) {
+    print_section("MACHINE METRICS");
+
+    state_machine_t sm;
+    sm_metrics_t metrics;
+    sm_state_metrics_t state;
+    sm_transition_metrics_t transition;
+    sm_init(&sm, "metrics", 0, metric_states, 2, metric_transitions, 2);
+    TEST_ASSERT(sm_metrics_get_state(&sm, 0, &state) == SM_ERROR_NOT_INITIALIZED, "Nothing recorded before attach");
+    TEST_ASSERT(sm_metrics_attach(&sm, &metrics, metric_arena, sizeof(metric_arena) - 1) == SM_ERROR_INVALID_SIZE,
+                "Short arena rejected");
+    TEST_ASSERT(sm_metrics_attach(&sm, &metrics, metric_arena, sizeof(metric_arena)) == SM_SUCCESS, "Attach");
+
+    // A -> B, rejected in B, B -> A, A -> B, rejected in B
+    static const sm_event_t events[] = {1, 1, 2, 1, 7};
+    sm_process_events(&sm, events, COUNT(events), NULL);
+    sm_metrics_get_state(&sm, 0, &state);
+    TEST_ASSERT(state.dwell.count == 2 && state.rejected == 0, "A: left twice, nothing rejected");
+    sm_metrics_get_state(&sm, 1, &state);
+    TEST_ASSERT(state.dwell.count == 1 && state.rejected == 2, "B: left once, two events rejected");
+    sm_metrics_get_transition(&sm, 0, 1, &transition);
+    TEST_ASSERT(transition.hits == 2 && transition.action.count == 0, "A -> B taken twice, no action timed");
+    TEST_ASSERT(sm_metrics_get_transition(&sm, 0, 9, &transition) == SM_ERROR_INVALID_EVENT, "Unknown transition");
+
+    sm_reset(&sm);
+    sm_metrics_get_state(&sm, 1, &state);
+    TEST_ASSERT(state.dwell.count == 2, "sm_reset ends the dwell in B");
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(void) {
+    printf("State Machine Framework - Metrics Tests\n");
+    printf("=======================================\n");
+
+    test_bucket_bounds();
+    test_percentiles();
+    test_machine_metrics();
+
+    return print_results();
+}
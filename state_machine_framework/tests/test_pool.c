@@ -0,0 +1,160 @@
+#include "../include/state_machine.h"
+#include "test_common.h"
+
+/**
+ * @file test_pool.c
+ * @brief Instance pools against one state_machine_t per instance: the same
+ * results, states, counters and callbacks for the same (instance, event) stream.
+ */
+
+#define NUM_INSTANCES 200
+#define STREAM_LENGTH 5000
+#define ROUNDS 20
+#define LOG_SIZE 200000
+
+typedef struct {
+    uint32_t instance;
+    char kind;                      // 'x' on_exit, 'a' action, 'n' on_entry
+    sm_state_t state;
+    sm_state_t current;             // What the callback saw as current_state
+} pool_log_t;
+
+static pool_log_t logs[2][LOG_SIZE];   // [0] pool, [1] separate machines
+static uint32_t log_length[2];
+static state_machine_t machines[NUM_INSTANCES];
+
+static void append(state_machine_t *sm, char kind, sm_state_t state) {
+    uint32_t instance = 0;
+    int which = sm_pool_active(sm, &instance) ? 0 : 1;
+    if (which == 1) instance = (uint32_t)(sm - machines);
+    if (log_length[which] < LOG_SIZE) {
+        pool_log_t *line = &logs[which][log_length[which]++];
+        line->instance = instance;
+        line->kind = kind;
+        line->state = state;
+        line->current = sm->current_state;
+    }
+}
+static void log_exit(state_machine_t *sm, sm_state_t state) {
+    append(sm, 'x', state);
+}
+static void log_entry(state_machine_t *sm, sm_state_t state) {
+    append(sm, 'n', state);
+}
+static void log_action(state_machine_t *sm, sm_state_t from, sm_state_t to, sm_event_t event) {
+    (void)to; (void)event;
+    append(sm, 'a', from);
+}
+
+static sm_state_tab_t pool_states[5];
+static sm_transition_tab_t pool_transitions[12];
+
+static void build_tables(bool callbacks) {
+    for (uint16_t i = 0; i < COUNT(pool_states); i++) {
+        pool_states[i].state = (sm_state_t)(10 + i);
+        pool_states[i].on_entry = callbacks ? log_entry : NULL;
+        pool_states[i].on_exit = callbacks ? log_exit : NULL;
+        pool_states[i].name = "S";
+    }
+    for (uint16_t i = 0; i < COUNT(pool_transitions); i++) {
+        pool_transitions[i].from_state = (sm_state_t)(10 + i % 5);
+        pool_transitions[i].event = (sm_event_t)(i % 4);
+        pool_transitions[i].to_state = (sm_state_t)(10 + (i * 3) % 5);
+        pool_transitions[i].action = callbacks ? log_action : NULL;
+    }
+}
+
+static void test_pool_matches_machines(bool callbacks) {
+    print_section(callbacks ? "POOL VS MACHINES (CALLBACKS)" : "POOL VS MACHINES (NO CALLBACKS)");
+
+    build_tables(callbacks);
+    log_length[0] = log_length[1] = 0;
+
+    static sm_type_t type;
+    static sm_pool_t pool;
+    static uint32_t pool_arena[SM_POOL_ARENA_SIZE(NUM_INSTANCES) / sizeof(uint32_t) + 1];
+    TEST_ASSERT(sm_type_init(&type, "T", 12, pool_states, COUNT(pool_states), pool_transitions,
+                             COUNT(pool_transitions), NULL, 0) == SM_SUCCESS && type.has_callbacks == callbacks,
+                "sm_type_init");
+    TEST_ASSERT(sm_pool_init(&pool, &type, NUM_INSTANCES, pool_arena, SM_POOL_ARENA_SIZE(NUM_INSTANCES) - 1) ==
+                SM_ERROR_INVALID_SIZE, "sm_pool_init rejects a short arena");
+    TEST_ASSERT(sm_pool_init(&pool, &type, NUM_INSTANCES, pool_arena, sizeof(pool_arena)) == SM_SUCCESS,
+                "sm_pool_init");
+    for (uint32_t i = 0; i < NUM_INSTANCES; i++) {
+        sm_init(&machines[i], "M", 12, pool_states, COUNT(pool_states), pool_transitions, COUNT(pool_transitions));
+    }
+    TEST_ASSERT(sm_pool_count_in_state(&pool, 12) == NUM_INSTANCES, "Every instance starts in the initial state");
+
+    static uint32_t ids[STREAM_LENGTH];
+    static sm_event_t events[STREAM_LENGTH];
+    static sm_result_t results[STREAM_LENGTH];
+    bool same_results = true;
+    seed_random(callbacks ? 3 : 4);
+    for (uint32_t round = 0; round < ROUNDS; round++) {
+        // A few ids past the end, which the pool rejects
+        for (uint32_t i = 0; i < STREAM_LENGTH; i++) {
+            ids[i] = next_random() % (NUM_INSTANCES + 2);
+            events[i] = (sm_event_t)(next_random() % 5);
+        }
+        sm_pool_process_event(&pool, ids, events, STREAM_LENGTH, results);
+        for (uint32_t i = 0; i < STREAM_LENGTH; i++) {
+            sm_result_t expected = ids[i] >= NUM_INSTANCES ? SM_ERROR_INVALID_STATE
+                                                           : sm_process_event(&machines[ids[i]], events[i]);
+            same_results = same_results && expected == results[i];
+        }
+        if (round == ROUNDS / 2) {
+            for (uint32_t i = 0; i < NUM_INSTANCES; i += 7) {
+                sm_pool_reset(&pool, i);
+                sm_reset(&machines[i]);
+            }
+        }
+    }
+    TEST_ASSERT(same_results, "Same result for every event");
+
+    bool same_state = true, same_stats = true;
+    uint32_t in_states = 0;
+    for (uint32_t i = 0; i < NUM_INSTANCES; i++) {
+        sm_state_t state;
+        uint32_t pool_total, pool_invalid, total, invalid;
+        sm_pool_get_state(&pool, i, &state);
+        sm_pool_get_stats(&pool, i, &pool_total, &pool_invalid);
+        sm_get_stats(&machines[i], &total, &invalid);
+        same_state = same_state && state == machines[i].current_state;
+        same_stats = same_stats && pool_total == total && pool_invalid == invalid;
+    }
+    for (sm_state_t state = 10; state < 15; state++) in_states += sm_pool_count_in_state(&pool, state);
+    TEST_ASSERT(same_state, "Same state for every instance");
+    TEST_ASSERT(same_stats, "Same counters for every instance");
+    TEST_ASSERT(in_states == NUM_INSTANCES, "sm_pool_count_in_state adds up to the pool size");
+
+    bool same_log = log_length[0] == log_length[1] && log_length[0] < LOG_SIZE;
+    for (uint32_t i = 0; same_log && i < log_length[0]; i++) {
+        same_log = logs[0][i].instance == logs[1][i].instance && logs[0][i].kind == logs[1][i].kind &&
+                   logs[0][i].state == logs[1][i].state && logs[0][i].current == logs[1][i].current;
+    }
+    TEST_ASSERT(same_log && (log_length[0] > 0) == callbacks,
+                "Same callbacks, instances and current states, in the same order");
+
+    uint32_t id = 0;
+    TEST_ASSERT(sm_pool_active(&machines[0], &id) == NULL && sm_pool_active(&pool.proxy, &id) == &pool,
+                "sm_pool_active tells the proxy from a machine of its own");
+    pool.proxy.state_change_context = &type;   // As a state-change hook would
+    TEST_ASSERT(sm_pool_active(&pool.proxy, &id) == &pool, "sm_pool_active does not depend on the hook context");
+    sm_state_t state;
+    TEST_ASSERT(sm_pool_get_state(&pool, NUM_INSTANCES, &state) == SM_ERROR_INVALID_STATE &&
+                sm_pool_reset(&pool, NUM_INSTANCES) == SM_ERROR_INVALID_STATE, "Unknown instance rejected");
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(void) {
+    printf("State Machine Framework - Instance Pool Tests\n");
+    printf("=============================================\n");
+
+    test_pool_matches_machines(false);
+    test_pool_matches_machines(true);
+
+    return print_results();
+}
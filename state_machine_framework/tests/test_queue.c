@@ -0,0 +1,195 @@
+#define _POSIX_C_SOURCE 200112L  // For pthreads and sched_yield()
+#include "../include/state_machine.h"
+#include "test_common.h"
+#include <pthread.h>
+#include <sched.h>
+
+/**
+ * @file test_queue.c
+ * @brief Event queue: post order, full queue and counters on one thread,
+ * then several producers against the dispatching thread with a small queue.
+ */
+
+#define PRODUCERS 4
+#define EVENTS_PER_PRODUCER 200000
+#define STRESS_CAPACITY 8
+#define SEQUENCE_BITS 4             // Event = producer << SEQUENCE_BITS | sequence number mod 16
+
+static sm_state_tab_t queue_states[] = {{0, NULL, NULL, "ONLY"}};
+static sm_transition_tab_t queue_transitions[PRODUCERS << SEQUENCE_BITS];
+static uint16_t queue_arena[SM_ARENA_WORDS(1, PRODUCERS << SEQUENCE_BITS)];
+static state_machine_t sm;
+
+// What the dispatching thread saw
+static sm_event_t received[64];
+static uint32_t num_received;
+static uint32_t next_sequence[PRODUCERS];
+static uint32_t per_producer[PRODUCERS];
+static bool in_order;
+
+static void on_event(state_machine_t *machine, sm_state_t from, sm_state_t to, sm_event_t event) {
+    (void)machine; (void)from; (void)to;
+    if (num_received < COUNT(received)) received[num_received] = event;
+    num_received++;
+
+    uint32_t producer = event >> SEQUENCE_BITS;
+    uint32_t sequence = event & ((1u << SEQUENCE_BITS) - 1);
+    in_order = in_order && sequence == (next_sequence[producer] & ((1u << SEQUENCE_BITS) - 1));
+    next_sequence[producer]++;
+    per_producer[producer]++;
+}
+
+static void setup(sm_queue_slot_t *slots, uint32_t capacity) {
+    for (uint16_t i = 0; i < COUNT(queue_transitions); i++) {
+        queue_transitions[i].from_state = 0;
+        queue_transitions[i].event = i;
+        queue_transitions[i].to_state = 0;
+        queue_transitions[i].action = on_event;
+    }
+    sm_init_with_arena(&sm, "queue", 0, queue_states, 1, queue_transitions, COUNT(queue_transitions),
+                       queue_arena, sizeof(queue_arena));
+    sm_queue_init(&sm, slots, capacity);
+    num_received = 0;
+    in_order = true;
+    for (uint32_t p = 0; p < PRODUCERS; p++) next_sequence[p] = per_producer[p] = 0;
+}
+
+// =============================================================================
+// ONE THREAD
+// =============================================================================
+
+static void test_single_thread(void) {
+    print_section("ONE THREAD");
+
+    static sm_queue_slot_t slots[4];
+    setup(slots, 4);
+    TEST_ASSERT(sm_queue_init(&sm, slots, 3) == SM_ERROR_INVALID_SIZE &&
+                sm_queue_init(&sm, slots, 1) == SM_ERROR_INVALID_SIZE, "Capacity must be a power of two, at least 2");
+    TEST_ASSERT(!sm_has_pending_events(&sm), "Empty queue");
+
+    bool posted = true;
+    for (sm_event_t e = 0; e < 4; e++) posted = posted && sm_post_event(&sm, e) == SM_SUCCESS;
+    TEST_ASSERT(posted && sm_has_pending_events(&sm), "Four events fill a queue of four");
+    TEST_ASSERT(sm_post_event(&sm, 9) == SM_ERROR_QUEUE_FULL, "A fifth one is refused");
+
+    sm_queue_stats_t stats;
+    sm_get_queue_stats(&sm, &stats);
+    TEST_ASSERT(stats.capacity == 4 && stats.depth == 4 && stats.max_depth == 4 && stats.posted == 4 &&
+                stats.dispatched == 0 && stats.dropped == 1, "Stats of a full queue");
+
+    uint32_t dispatched = 0;
+    TEST_ASSERT(sm_dispatch_pending(&sm, 3, &dispatched) == SM_SUCCESS && dispatched == 3, "max_events honoured");
+    TEST_ASSERT(sm_dispatch_pending(&sm, 0, &dispatched) == SM_SUCCESS && dispatched == 1, "Rest of the queue");
+    TEST_ASSERT(num_received == 4 && received[0] == 0 && received[1] == 1 && received[2] == 2 && received[3] == 3,
+                "Dispatched in post order");
+
+    // Around the ring a few times
+    bool wrapped = true;
+    for (uint32_t lap = 0; lap < 10; lap++) {
+        wrapped = wrapped && sm_post_event(&sm, (sm_event_t)(lap & 15)) == SM_SUCCESS &&
+                  sm_post_event(&sm, (sm_event_t)((lap + 1) & 15)) == SM_SUCCESS &&
+                  sm_dispatch_pending(&sm, 0, &dispatched) == SM_SUCCESS && dispatched == 2;
+    }
+    sm_get_queue_stats(&sm, &stats);
+    TEST_ASSERT(wrapped && stats.depth == 0 && stats.max_depth == 4 && stats.posted == 24 && stats.dispatched == 24,
+                "Wraparound keeps depth and counters straight");
+
+    state_machine_t no_queue;
+    sm_init(&no_queue, "plain", 0, queue_states, 1, queue_transitions, 1);
+    TEST_ASSERT(sm_post_event(&no_queue, 0) == SM_ERROR_NOT_INITIALIZED &&
+                sm_dispatch_pending(&no_queue, 0, NULL) == SM_ERROR_NOT_INITIALIZED, "No queue attached");
+}
+
+// =============================================================================
+// MULTIPLE PRODUCERS
+// =============================================================================
+
+static uint32_t refused[PRODUCERS];
+static uint32_t producers_done;
+static uint32_t worst_depth;
+
+// Highest depth any thread read from the stats
+static void note_worst(const sm_queue_stats_t *stats) {
+    uint32_t depth = stats->depth > stats->max_depth ? stats->depth : stats->max_depth;
+    uint32_t seen = __atomic_load_n(&worst_depth, __ATOMIC_RELAXED);
+    while (depth > seen &&
+           !__atomic_compare_exchange_n(&worst_depth, &seen, depth, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+static void *producer(void *arg) {
+    uint32_t id = (uint32_t)(uintptr_t)arg;
+    for (uint32_t i = 0; i < EVENTS_PER_PRODUCER; i++) {
+        sm_event_t event = (sm_event_t)(id << SEQUENCE_BITS | (i & ((1u << SEQUENCE_BITS) - 1)));
+        while (sm_post_event(&sm, event) == SM_ERROR_QUEUE_FULL) {
+            refused[id]++;
+            sched_yield();
+        }
+        // Stats may be read from any thread, while the others post and dispatch
+        if ((i & 255) == 0) {
+            sm_queue_stats_t stats;
+            sm_get_queue_stats(&sm, &stats);
+            note_worst(&stats);
+        }
+    }
+    __atomic_fetch_add(&producers_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void test_multiple_producers(void) {
+    print_section("MULTIPLE PRODUCERS");
+
+    static sm_queue_slot_t slots[STRESS_CAPACITY];
+    setup(slots, STRESS_CAPACITY);
+
+    pthread_t threads[PRODUCERS];
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        pthread_create(&threads[p], NULL, producer, (void *)(uintptr_t)p);
+    }
+
+    // The dispatching thread; reads the stats between batches as well
+    uint32_t total = 0, dispatched = 0;
+    sm_queue_stats_t stats;
+    while (__atomic_load_n(&producers_done, __ATOMIC_ACQUIRE) < PRODUCERS || sm_has_pending_events(&sm)) {
+        sm_dispatch_pending(&sm, 0, &dispatched);
+        total += dispatched;
+        sm_get_queue_stats(&sm, &stats);
+        note_worst(&stats);
+        if (dispatched == 0) sched_yield();
+    }
+    for (uint32_t p = 0; p < PRODUCERS; p++) pthread_join(threads[p], NULL);
+    sm_dispatch_pending(&sm, 0, &dispatched);
+    total += dispatched;
+
+    uint32_t dropped = 0;
+    bool all_arrived = true;
+    for (uint32_t p = 0; p < PRODUCERS; p++) {
+        dropped += refused[p];
+        all_arrived = all_arrived && per_producer[p] == EVENTS_PER_PRODUCER;
+    }
+    sm_get_queue_stats(&sm, &stats);
+    printf("   %u events, %u refused while full, max depth %u of %u\n", total, dropped, stats.max_depth,
+           stats.capacity);
+
+    TEST_ASSERT(worst_depth <= STRESS_CAPACITY && stats.max_depth <= STRESS_CAPACITY,
+                "Reported depth never above the capacity");
+    TEST_ASSERT(stats.posted == stats.dispatched && stats.posted == PRODUCERS * EVENTS_PER_PRODUCER &&
+                total == stats.posted && stats.depth == 0, "Posted == dispatched, nothing left behind");
+    TEST_ASSERT(all_arrived && num_received == total, "Every accepted event dispatched once");
+    TEST_ASSERT(in_order, "Each producer's events in the order it posted them");
+    TEST_ASSERT(stats.dropped == dropped, "Every refusal counted as a drop");
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(void) {
+    printf("State Machine Framework - Event Queue Tests\n");
+    printf("===========================================\n");
+
+    test_single_thread();
+    test_multiple_producers();
+
+    return print_results();
+}
@@ -0,0 +1,320 @@
+#include "../include/state_machine.h"
+#include "test_common.h"
+
+/**
+ * @file test_state_machine.c
+ * @brief Flat machines: the CSR dispatch index against a linear scan of the
+ * transition table, and sm_process_events with deferred callbacks against
+ * sm_process_event one event at a time.
+ */
+
+#define MAX_STATES 64
+#define MAX_TRANSITIONS 1024
+#define RANDOM_EVENTS 20000
+
+static sm_state_tab_t states[MAX_STATES];
+static sm_transition_tab_t transitions[MAX_TRANSITIONS];
+static uint16_t arena[SM_ARENA_WORDS(MAX_STATES, MAX_TRANSITIONS)];
+
+// =============================================================================
+// REFERENCE
+// =============================================================================
+
+// What the framework did before the index: the first row of the table that
+// matches wins
+static const sm_transition_tab_t *linear_scan(sm_state_t state, sm_event_t event, uint16_t num_transitions) {
+    for (uint16_t i = 0; i < num_transitions; i++) {
+        if (transitions[i].from_state == state && transitions[i].event == event) return &transitions[i];
+    }
+    return NULL;
+}
+
+// Random table: sparse state values, events from a small or a wide range,
+// duplicate (state, event) rows and states with no transitions at all
+static void random_table(uint16_t num_states, uint16_t num_transitions, uint32_t num_events) {
+    for (uint16_t i = 0; i < num_states; i++) {
+        states[i].state = (sm_state_t)(i * 37 + 5);
+        states[i].on_entry = NULL;
+        states[i].on_exit = NULL;
+        states[i].name = "S";
+    }
+    for (uint16_t i = 0; i < num_transitions; i++) {
+        transitions[i].from_state = states[next_random() % num_states].state;
+        transitions[i].event = (sm_event_t)(next_random() % num_events);
+        transitions[i].to_state = states[next_random() % num_states].state;
+        transitions[i].action = NULL;
+    }
+}
+
+// =============================================================================
+// CSR DISPATCH
+// =============================================================================
+
+static void test_dispatch_matches_linear_scan(void) {
+    print_section("CSR DISPATCH VS LINEAR SCAN");
+
+    // Short rows (linear search in find_entry), long rows (binary search
+    // first), and wide event ranges where most lookups miss
+    static const struct {
+        uint16_t num_states;
+        uint16_t num_transitions;
+        uint32_t num_events;
+    } shapes[] = {
+        {1, 1, 2}, {4, 12, 4}, {16, 32, 8}, {8, 256, 64}, {64, 1024, 40000}, {3, 600, 300}
+    };
+
+    seed_random(1);
+    for (size_t s = 0; s < COUNT(shapes); s++) {
+        random_table(shapes[s].num_states, shapes[s].num_transitions, shapes[s].num_events);
+
+        state_machine_t sm;
+        bool inline_index = shapes[s].num_states <= SM_MAX_STATES && shapes[s].num_transitions <= SM_MAX_TRANSITIONS;
+        sm_result_t init = inline_index
+            ? sm_init(&sm, "csr", states[0].state, states, shapes[s].num_states, transitions, shapes[s].num_transitions)
+            : sm_init_with_arena(&sm, "csr", states[0].state, states, shapes[s].num_states, transitions,
+                                 shapes[s].num_transitions, arena, sizeof(arena));
+
+        bool same = init == SM_SUCCESS;
+        sm_state_t expected = states[0].state;
+        uint32_t expected_transitions = 0, expected_invalid = 0;
+        for (uint32_t i = 0; same && i < RANDOM_EVENTS; i++) {
+            // Mostly events the table uses, some just past its range
+            sm_event_t event = (sm_event_t)(next_random() % (shapes[s].num_events + 2));
+            const sm_transition_tab_t *transition = linear_scan(expected, event, shapes[s].num_transitions);
+            sm_result_t result = sm_process_event(&sm, event);
+            if (transition) {
+                expected = transition->to_state;
+                expected_transitions++;
+            } else {
+                expected_invalid++;
+            }
+            same = result == (transition ? SM_SUCCESS : SM_ERROR_INVALID_EVENT) && sm.current_state == expected;
+        }
+        uint32_t total = 0, invalid = 0;
+        sm_get_stats(&sm, &total, &invalid);
+
+        char name[96];
+        snprintf(name, sizeof(name), "%u states, %u transitions, %u events: same results and states%s",
+                 shapes[s].num_states, shapes[s].num_transitions, shapes[s].num_events, inline_index ? "" : " (arena)");
+        TEST_ASSERT(same && total == expected_transitions && invalid == expected_invalid, name);
+    }
+
+    // sm_process_events over the same stream ends where sm_process_event does
+    random_table(16, 32, 8);
+    state_machine_t one, batch;
+    sm_init(&one, "one", states[0].state, states, 16, transitions, 32);
+    sm_init(&batch, "batch", states[0].state, states, 16, transitions, 32);
+    static sm_event_t stream[RANDOM_EVENTS];
+    static sm_result_t results[RANDOM_EVENTS];
+    for (uint32_t i = 0; i < RANDOM_EVENTS; i++) stream[i] = (sm_event_t)(next_random() % 10);
+    sm_process_events(&batch, stream, RANDOM_EVENTS, results);
+    bool same = true;
+    for (uint32_t i = 0; i < RANDOM_EVENTS; i++) same = same && sm_process_event(&one, stream[i]) == results[i];
+    TEST_ASSERT(same && one.current_state == batch.current_state &&
+                one.transition_count == batch.transition_count && one.invalid_event_count == batch.invalid_event_count,
+                "sm_process_events matches sm_process_event event by event");
+
+    // Table checks
+    state_machine_t sm;
+    transitions[0].to_state = 9999;
+    TEST_ASSERT(sm_init(&sm, "bad", states[0].state, states, 16, transitions, 32) == SM_ERROR_INVALID_STATE,
+                "sm_init rejects a transition to an unknown state");
+    TEST_ASSERT(sm_init_with_arena(&sm, "small", states[0].state, states, 16, transitions, 32, arena,
+                                   SM_ARENA_SIZE(16, 32) - 1) == SM_ERROR_TABLE_FULL,
+                "sm_init_with_arena rejects a short arena");
+}
+
+// =============================================================================
+// DEFERRED CALLBACKS
+// =============================================================================
+
+// Every callback appends one line; the two machines must write the same log
+#define LOG_SIZE 65536
+
+typedef struct {
+    char kind;                      // 'x' on_exit, 'a' action, 'n' on_entry
+    sm_state_t state;               // State left or entered, from_state for actions
+    sm_event_t event;
+} callback_log_t;
+
+static callback_log_t logs[2][LOG_SIZE];
+static uint32_t log_length[2];
+static uint32_t state_changes[2];
+static state_machine_t *deferred_sm;
+
+static void append(state_machine_t *sm, char kind, sm_state_t state, sm_event_t event) {
+    int which = sm == deferred_sm;
+    if (log_length[which] < LOG_SIZE) {
+        callback_log_t *line = &logs[which][log_length[which]++];
+        line->kind = kind;
+        line->state = state;
+        line->event = event;
+    }
+}
+static void log_exit(state_machine_t *sm, sm_state_t state) {
+    append(sm, 'x', state, 0);
+}
+static void log_entry(state_machine_t *sm, sm_state_t state) {
+    append(sm, 'n', state, 0);
+}
+static void log_action(state_machine_t *sm, sm_state_t from, sm_state_t to, sm_event_t event) {
+    (void)to;
+    append(sm, 'a', from, event);
+}
+static void count_state_change(state_machine_t *sm, sm_state_t state) {
+    (void)state;
+    state_changes[sm == deferred_sm]++;
+}
+
+static void test_deferred_callbacks(void) {
+    print_section("DEFERRED CALLBACKS");
+
+    seed_random(2);
+    random_table(12, 32, 6);
+    for (uint16_t i = 0; i < 12; i++) {
+        states[i].on_entry = log_entry;
+        states[i].on_exit = log_exit;
+    }
+    for (uint16_t i = 0; i < 32; i++) transitions[i].action = log_action;
+
+    static state_machine_t direct, deferred;
+    deferred_sm = &deferred;
+    sm_init(&direct, "direct", states[0].state, states, 12, transitions, 32);
+    sm_init(&deferred, "deferred", states[0].state, states, 12, transitions, 32);
+    direct.on_state_change = count_state_change;
+    deferred.on_state_change = count_state_change;
+    log_length[0] = log_length[1] = 0;
+
+    // A list shorter than most batches, so it fills up and flushes mid-batch
+    sm_deferred_t calls[5];
+    TEST_ASSERT(sm_set_deferred_callbacks(&deferred, calls, COUNT(calls)) == SM_SUCCESS, "deferred callbacks on");
+
+    static sm_event_t stream[4000];
+    static sm_result_t results[4000];
+    for (uint32_t i = 0; i < COUNT(stream); i++) stream[i] = (sm_event_t)(next_random() % 7);
+
+    bool same_results = true;
+    uint32_t flushes_expected = 0;
+    for (uint32_t done = 0; done < COUNT(stream);) {
+        uint32_t batch = 1 + next_random() % 40;
+        if (batch > COUNT(stream) - done) batch = (uint32_t)COUNT(stream) - done;
+        sm_process_events(&deferred, &stream[done], batch, results);
+
+        uint32_t taken = 0;
+        for (uint32_t i = 0; i < batch; i++) {
+            sm_result_t result = sm_process_event(&direct, stream[done + i]);
+            same_results = same_results && result == results[i];
+            if (result == SM_SUCCESS && ++taken == COUNT(calls)) {
+                flushes_expected++;
+                taken = 0;
+            }
+        }
+        if (taken) flushes_expected++;
+        done += batch;
+    }
+
+    bool same_log = log_length[0] == log_length[1] && log_length[0] < LOG_SIZE;
+    for (uint32_t i = 0; same_log && i < log_length[0]; i++) {
+        same_log = logs[0][i].kind == logs[1][i].kind && logs[0][i].state == logs[1][i].state &&
+                   logs[0][i].event == logs[1][i].event;
+    }
+    TEST_ASSERT(same_results, "Deferred batches: same results as one event at a time");
+    TEST_ASSERT(same_log && log_length[0] > 0, "Deferred batches: exit, action and entry callbacks in the same order");
+    TEST_ASSERT(deferred.current_state == direct.current_state && deferred.transition_count == direct.transition_count &&
+                deferred.invalid_event_count == direct.invalid_event_count,
+                "Deferred batches: same final state and counters");
+    TEST_ASSERT(state_changes[1] == flushes_expected && state_changes[0] == direct.transition_count,
+                "on_state_change once per flush instead of once per transition");
+    TEST_ASSERT(sm_set_deferred_callbacks(&deferred, NULL, 0) == SM_SUCCESS && deferred.deferred == NULL,
+                "deferred callbacks off");
+
+    for (uint16_t i = 0; i < 12; i++) {
+        states[i].on_entry = NULL;
+        states[i].on_exit = NULL;
+    }
+}
+
+// A callback of the deferred machine calling sm_set_deferred_callbacks after
+// `switch_after` actions
+static sm_deferred_t *switch_to;
+static uint32_t switch_capacity;
+static uint32_t switch_after;
+
+static void switching_action(state_machine_t *sm, sm_state_t from, sm_state_t to, sm_event_t event) {
+    log_action(sm, from, to, event);
+    if (sm == deferred_sm && switch_after && --switch_after == 0) {
+        sm_set_deferred_callbacks(sm, switch_to, switch_capacity);
+    }
+}
+
+// Run one long batch with the switch happening in the middle of it
+static bool batch_with_switch(sm_deferred_t *to, uint32_t capacity) {
+    static state_machine_t direct, deferred;
+    deferred_sm = &deferred;
+    sm_init(&direct, "direct", states[0].state, states, 12, transitions, 32);
+    sm_init(&deferred, "deferred", states[0].state, states, 12, transitions, 32);
+    log_length[0] = log_length[1] = 0;
+
+    static sm_deferred_t calls[4];
+    sm_set_deferred_callbacks(&deferred, calls, COUNT(calls));
+    switch_to = to;
+    switch_capacity = capacity;
+    switch_after = 6;
+
+    static sm_event_t stream[400];
+    static sm_result_t results[COUNT(stream)];
+    for (uint32_t i = 0; i < COUNT(stream); i++) stream[i] = (sm_event_t)(next_random() % 7);
+    sm_process_events(&deferred, stream, COUNT(stream), results);
+
+    bool same = switch_after == 0;
+    for (uint32_t i = 0; i < COUNT(stream); i++) same = same && sm_process_event(&direct, stream[i]) == results[i];
+    same = same && log_length[0] == log_length[1] && deferred.current_state == direct.current_state &&
+           deferred.transition_count == direct.transition_count;
+    for (uint32_t i = 0; same && i < log_length[0]; i++) {
+        same = logs[0][i].kind == logs[1][i].kind && logs[0][i].state == logs[1][i].state &&
+               logs[0][i].event == logs[1][i].event;
+    }
+    return same;
+}
+
+static void test_deferred_set_from_callback(void) {
+    print_section("DEFERRED CALLBACKS SET FROM A CALLBACK");
+
+    seed_random(7);
+    random_table(12, 32, 6);
+    for (uint16_t i = 0; i < 12; i++) {
+        states[i].on_entry = log_entry;
+        states[i].on_exit = log_exit;
+    }
+    for (uint16_t i = 0; i < 32; i++) transitions[i].action = switching_action;
+
+    static sm_deferred_t smaller[2];
+    TEST_ASSERT(batch_with_switch(smaller, COUNT(smaller)), "Switch to a shorter list: same callbacks and results");
+    TEST_ASSERT(deferred_sm->deferred == smaller && deferred_sm->deferred_capacity == COUNT(smaller),
+                "The list set by the callback is kept");
+
+    TEST_ASSERT(batch_with_switch(NULL, 0), "Deferral turned off: same callbacks and results");
+    TEST_ASSERT(deferred_sm->deferred == NULL && deferred_sm->deferred_capacity == 0,
+                "Deferral stays off after the batch");
+
+    for (uint16_t i = 0; i < 12; i++) {
+        states[i].on_entry = NULL;
+        states[i].on_exit = NULL;
+    }
+    for (uint16_t i = 0; i < 32; i++) transitions[i].action = NULL;
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(void) {
+    printf("State Machine Framework - Dispatch Tests\n");
+    printf("========================================\n");
+
+    test_dispatch_matches_linear_scan();
+    test_deferred_callbacks();
+    test_deferred_set_from_callback();
+
+    return print_results();
+}
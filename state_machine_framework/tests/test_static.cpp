@@ -0,0 +1,265 @@
+#include "../include/state_machine_static.hpp"
+#include "test_common.h"
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+
+/**
+ * @file test_static.cpp
+ * @brief Compile-time dispatch against sm_process_event: the same results,
+ * states, counters and callbacks for the same event stream, with direct and
+ * binary-search event columns, and the hand-off to sm_process_event when the
+ * machine has a hook, a trace, logging or tables of its own.
+ */
+
+#define STREAM_LENGTH 20000
+#define LOG_SIZE 100000
+#define NUM_STATES 6
+
+typedef struct {
+    char kind;                      // 'x' on_exit, 'a' action, 'n' on_entry
+    sm_state_t state;
+    sm_state_t current;             // What the callback saw as current_state
+    sm_event_t event;               // Actions only
+} static_log_t;
+
+static static_log_t logs[2][LOG_SIZE];   // [0] static_machine, [1] sm_process_event
+static uint32_t log_length[2];
+static state_machine_t machines[2];
+
+static void append(state_machine_t *sm, char kind, sm_state_t state, sm_event_t event) {
+    int which = (sm == &machines[0]) ? 0 : 1;
+    if (log_length[which] < LOG_SIZE) {
+        static_log_t *line = &logs[which][log_length[which]++];
+        line->kind = kind;
+        line->state = state;
+        line->current = sm->current_state;
+        line->event = event;
+    }
+}
+static void log_exit(state_machine_t *sm, sm_state_t state) {
+    append(sm, 'x', state, 0);
+}
+static void log_entry(state_machine_t *sm, sm_state_t state) {
+    append(sm, 'n', state, 0);
+}
+static void log_action(state_machine_t *sm, sm_state_t from, sm_state_t to, sm_event_t event) {
+    (void)to;
+    append(sm, 'a', from, event);
+}
+
+// =============================================================================
+// TABLES
+// =============================================================================
+
+// States 10..15; state s accepts every event but the (s % N)-th, and the
+// c-th event moves it to 10 + (7s + 3c + 1) % NUM_STATES
+constexpr std::array<sm_state_tab_t, NUM_STATES> make_states() {
+    std::array<sm_state_tab_t, NUM_STATES> states{};
+    for (std::size_t s = 0; s < NUM_STATES; s++) {
+        states[s] = {static_cast<sm_state_t>(10 + s), log_entry, log_exit, "S"};
+    }
+    return states;
+}
+template <std::size_t N>
+constexpr std::array<sm_transition_tab_t, NUM_STATES * (N - 1)> make_transitions(const sm_event_t (&events)[N]) {
+    std::array<sm_transition_tab_t, NUM_STATES * (N - 1)> transitions{};
+    std::size_t count = 0;
+    for (std::size_t s = 0; s < NUM_STATES; s++) {
+        for (std::size_t c = 0; c < N; c++) {
+            if (c == s % N) continue;
+            transitions[count++] = {static_cast<sm_state_t>(10 + s), events[c],
+                                    static_cast<sm_state_t>(10 + (7 * s + 3 * c + 1) % NUM_STATES), log_action};
+        }
+    }
+    return transitions;
+}
+
+// Event IDs below static_max_event_span: columns found by direct indexing
+constexpr sm_event_t direct_events[] = {9, 0, 3, 7, 1};
+constexpr auto direct_states = make_states();
+constexpr auto direct_transitions = make_transitions(direct_events);
+using direct_machine = sm::static_machine<direct_states, direct_transitions>;
+
+// An event ID past static_max_event_span: columns found by binary search
+constexpr sm_event_t sparse_events[] = {700, 5, 65000, 3000};
+constexpr auto sparse_states = make_states();
+constexpr auto sparse_transitions = make_transitions(sparse_events);
+using sparse_machine = sm::static_machine<sparse_states, sparse_transitions>;
+
+// Events no transition uses: gaps between the IDs, and IDs above the largest
+constexpr sm_event_t direct_unknown[] = {2, 5, 8, 10, 1023, 65535};
+constexpr sm_event_t sparse_unknown[] = {0, 6, 1024, 2999, 65001, 65535};
+
+static_assert(direct_machine::next_state(10, 0) == 14 && direct_machine::next_state(11, 9) == 12);
+static_assert(sparse_machine::next_state(10, 5) == 14 && sparse_machine::next_state(11, 700) == 12);
+static_assert(!direct_machine::has_transition(10, 2) && !direct_machine::has_transition(10, 10) &&
+              !direct_machine::has_transition(10, 65535) && !direct_machine::has_transition(10, 9) &&
+              !direct_machine::has_transition(9, 0),
+              "gaps, IDs above the span, the event a state skips and unknown states have no transition");
+static_assert(!sparse_machine::has_transition(10, 0) && !sparse_machine::has_transition(10, 2999) &&
+              !sparse_machine::has_transition(10, 65535) && !sparse_machine::has_transition(10, 700),
+              "gaps, IDs above the span and the event a state skips have no transition");
+
+// =============================================================================
+// SAME BEHAVIOR AS SM_PROCESS_EVENT
+// =============================================================================
+
+template <typename Machine, const auto& States, const auto& Transitions, std::size_t N, std::size_t U>
+static void test_matches_process_event(const char *section, const sm_event_t (&events)[N],
+                                       const sm_event_t (&unknown)[U], uint32_t seed) {
+    print_section(section);
+
+    log_length[0] = log_length[1] = 0;
+    TEST_ASSERT(Machine::init(&machines[0], "static", 12) == SM_SUCCESS &&
+                sm_init(&machines[1], "runtime", 12, std::data(States), COUNT(States), std::data(Transitions),
+                        COUNT(Transitions)) == SM_SUCCESS, "Machine::init and sm_init");
+
+    // One event in four unknown; a reset now and then
+    bool same_results = true, same_states = true, all_results = true;
+    seed_random(seed);
+    for (uint32_t i = 0; i < STREAM_LENGTH; i++) {
+        if (i % 997 == 996) {
+            sm_reset(&machines[0]);
+            sm_reset(&machines[1]);
+        }
+        uint32_t pick = next_random();
+        sm_event_t event = (pick & 3) ? events[(pick >> 2) % N] : unknown[(pick >> 2) % U];
+        sm_result_t result = Machine::process_event(&machines[0], event);
+        sm_result_t expected = sm_process_event(&machines[1], event);
+        same_results = same_results && result == expected;
+        all_results = all_results && (result == SM_SUCCESS || result == SM_ERROR_INVALID_EVENT);
+        same_states = same_states && machines[0].current_state == machines[1].current_state &&
+                      machines[0].current_index == machines[1].current_index;
+    }
+    TEST_ASSERT(same_results && all_results, "Same result for every event");
+    TEST_ASSERT(same_states, "Same state after every event");
+
+    uint32_t total[2], invalid[2];
+    sm_get_stats(&machines[0], &total[0], &invalid[0]);
+    sm_get_stats(&machines[1], &total[1], &invalid[1]);
+    TEST_ASSERT(total[0] == total[1] && invalid[0] == invalid[1] && total[0] > 0 && invalid[0] > 0,
+                "Same transition and invalid event counters");
+
+    bool same_log = log_length[0] == log_length[1] && log_length[0] > 0 && log_length[0] < LOG_SIZE;
+    for (uint32_t i = 0; same_log && i < log_length[0]; i++) {
+        same_log = logs[0][i].kind == logs[1][i].kind && logs[0][i].state == logs[1][i].state &&
+                   logs[0][i].current == logs[1][i].current && logs[0][i].event == logs[1][i].event;
+    }
+    TEST_ASSERT(same_log, "Same callbacks and current states, in the same order");
+
+    // Unknown events from every state: rejected, counted, nothing called
+    bool rejected = true;
+    for (std::size_t s = 0; s < NUM_STATES; s++) {
+        Machine::init(&machines[0], "static", static_cast<sm_state_t>(10 + s));
+        log_length[0] = 0;
+        for (sm_event_t event : unknown) {
+            rejected = rejected && Machine::process_event(&machines[0], event) == SM_ERROR_INVALID_EVENT &&
+                       !Machine::has_transition(static_cast<sm_state_t>(10 + s), event);
+        }
+        rejected = rejected && machines[0].current_state == 10 + s && machines[0].invalid_event_count == U &&
+                   machines[0].transition_count == 0 && log_length[0] == 0;
+    }
+    TEST_ASSERT(rejected, "Unknown events and IDs above the span rejected from every state");
+}
+
+// =============================================================================
+// HAND-OFF TO SM_PROCESS_EVENT
+// =============================================================================
+
+static uint32_t state_changes;
+static sm_state_t last_change;
+
+static void on_change(state_machine_t *sm, sm_state_t state) {
+    (void)sm;
+    state_changes++;
+    last_change = state;
+}
+
+static void test_fallback(void) {
+    print_section("HAND-OFF TO SM_PROCESS_EVENT");
+
+    state_machine_t &sm = machines[0];
+
+    // on_state_change: only sm_process_event calls it
+    direct_machine::init(&sm, "hook", 10);
+    sm.on_state_change = on_change;
+    state_changes = 0;
+    TEST_ASSERT(direct_machine::process_event(&sm, 0) == SM_SUCCESS && sm.current_state == 14 &&
+                state_changes == 1 && last_change == 14, "State-change hook called");
+
+    // Trace: one record per event, rejected ones flagged
+    static sm_trace_record_t storage[8], records[8];
+    sm_trace_ring_t ring;
+    uint64_t cursor = 0;
+    uint32_t count = 0;
+    sm_trace_init(&ring, storage, COUNT(storage), SM_TRACE_CLOCK_COARSE);
+    direct_machine::init(&sm, "traced", 10);
+    sm_trace_attach(&sm, &ring, 3);
+    direct_machine::process_event(&sm, 0);
+    direct_machine::process_event(&sm, 2);
+    sm_trace_read(&ring, &cursor, records, COUNT(records), &count);
+    TEST_ASSERT(count == 2 && records[0].machine == 3 && records[0].from == 10 && records[0].to == 14 &&
+                records[0].event == 0 && records[1].machine == (3 | SM_TRACE_NO_TRANSITION) &&
+                records[1].event == 2, "Events traced");
+
+    // Logging: the transition is printed; stdout goes to a file meanwhile
+    direct_machine::init(&sm, "logged", 10);
+    std::FILE *captured = std::tmpfile();
+    std::fflush(stdout);
+    int saved_stdout = dup(fileno(stdout));
+    dup2(fileno(captured), fileno(stdout));
+    sm_set_logging(&sm, true);
+    sm_result_t logged = direct_machine::process_event(&sm, 0);
+    std::fflush(stdout);
+    dup2(saved_stdout, fileno(stdout));
+    close(saved_stdout);
+    char output[512] = {0};
+    std::rewind(captured);
+    std::size_t length = std::fread(output, 1, sizeof(output) - 1, captured);
+    output[length] = '\0';
+    std::fclose(captured);
+    TEST_ASSERT(logged == SM_SUCCESS && sm.current_state == 14 && std::strstr(output, "Transition") != NULL,
+                "Transition logged");
+
+    // Tables of its own: a copy with one target changed is what counts
+    static sm_state_tab_t foreign_states[NUM_STATES];
+    static sm_transition_tab_t foreign_transitions[COUNT(direct_transitions)];
+    std::copy(direct_states.begin(), direct_states.end(), foreign_states);
+    std::copy(direct_transitions.begin(), direct_transitions.end(), foreign_transitions);
+    foreign_transitions[0].to_state = 15;      // 10 --0--> 15 instead of 14
+    sm_init(&sm, "foreign", 10, foreign_states, COUNT(foreign_states), foreign_transitions,
+            COUNT(foreign_transitions));
+    log_length[0] = 0;
+    TEST_ASSERT(direct_machine::process_event(&sm, 0) == SM_SUCCESS && sm.current_state == 15 &&
+                direct_machine::next_state(10, 0) == 14 && log_length[0] == 3,
+                "A machine with other tables dispatched through them");
+
+    // Same tables again: back on the compile-time path, hook and all off
+    direct_machine::init(&sm, "plain", 10);
+    state_changes = 0;
+    TEST_ASSERT(direct_machine::process_event(&sm, 0) == SM_SUCCESS && sm.current_state == 14 &&
+                state_changes == 0, "No hook, trace or logging left on a fresh machine");
+
+    state_machine_t uninitialized = {};
+    TEST_ASSERT(direct_machine::process_event(NULL, 9) == SM_ERROR_NULL_POINTER &&
+                direct_machine::process_event(&uninitialized, 9) == SM_ERROR_NOT_INITIALIZED,
+                "NULL and uninitialized machines refused");
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(void) {
+    printf("State Machine Framework - Compile-Time Dispatch Tests\n");
+    printf("=====================================================\n");
+
+    test_matches_process_event<direct_machine, direct_states, direct_transitions>(
+        "DIRECT COLUMNS VS SM_PROCESS_EVENT", direct_events, direct_unknown, 5);
+    test_matches_process_event<sparse_machine, sparse_states, sparse_transitions>(
+        "BINARY SEARCH COLUMNS VS SM_PROCESS_EVENT", sparse_events, sparse_unknown, 6);
+    test_fallback();
+
+    return print_results();
+}
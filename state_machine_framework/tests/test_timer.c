@@ -0,0 +1,194 @@
+#include "../include/state_machine_timer.h"
+#include "test_common.h"
+
+/**
+ * @file test_timer.c
+ * @brief Timer wheel: each timer expires at its exact tick, including those
+ * that cascade down from the upper levels, and a random arm/cancel/advance
+ * workload agrees with a plain array of deadlines.
+ */
+
+#define NUM_MACHINES 2000
+#define NUM_EVENTS 32
+#define RANDOM_ROUNDS 20000
+
+static sm_state_tab_t timer_states[] = {{0, NULL, NULL, "IDLE"}};
+static sm_transition_tab_t timer_transitions[NUM_EVENTS];
+static state_machine_t machines[NUM_MACHINES];
+static sm_timer_t timer_arena[NUM_MACHINES];
+static sm_timer_wheel_t wheel;
+static uint32_t timer_ids[NUM_MACHINES];
+
+// Reference: the deadline of each machine's timer
+static uint64_t deadline[NUM_MACHINES];
+static bool armed[NUM_MACHINES];
+static sm_event_t armed_event[NUM_MACHINES];
+static uint32_t fired;
+static bool fired_on_time;
+static uint64_t last_fired_tick;
+
+static void on_expired(state_machine_t *sm, sm_state_t from, sm_state_t to, sm_event_t event) {
+    (void)from; (void)to;
+    uint32_t i = (uint32_t)(sm - machines);
+    fired_on_time = fired_on_time && armed[i] && deadline[i] == wheel.now && armed_event[i] == event &&
+                    wheel.now >= last_fired_tick;
+    last_fired_tick = wheel.now;
+    armed[i] = false;
+    fired++;
+}
+
+static void arm(uint32_t i, uint32_t delay, sm_event_t event) {
+    sm_timer_arm(&wheel, timer_ids[i], delay, event);
+    deadline[i] = wheel.now + (delay ? delay : 1);
+    armed[i] = true;
+    armed_event[i] = event;
+}
+
+static void setup(void) {
+    for (uint16_t e = 0; e < NUM_EVENTS; e++) {
+        timer_transitions[e].from_state = 0;
+        timer_transitions[e].event = e;
+        timer_transitions[e].to_state = 0;
+        timer_transitions[e].action = on_expired;
+    }
+    sm_timer_init(&wheel, 1, NUM_MACHINES, timer_arena, sizeof(timer_arena));
+    for (uint32_t i = 0; i < NUM_MACHINES; i++) {
+        sm_init(&machines[i], "timed", 0, timer_states, 1, timer_transitions, NUM_EVENTS);
+        sm_timer_create(&wheel, &machines[i], &timer_ids[i]);
+        armed[i] = false;
+    }
+    fired = 0;
+    fired_on_time = true;
+    last_fired_tick = 0;
+}
+
+// =============================================================================
+// EXPIRY AND CASCADE
+// =============================================================================
+
+static void test_expiry_and_cascade(void) {
+    print_section("EXPIRY AND CASCADE");
+
+    TEST_ASSERT(sm_timer_arena_size(NUM_MACHINES) <= sizeof(timer_arena), "Arena size");
+    setup();
+
+    // Level boundaries are at 2^8, 2^16 and 2^24 ticks
+    static const uint32_t delays[] = {
+        0, 1, 2, 255, 256, 257, 511, 512, 1000, 65535, 65536, 65537, 70000, 131072,
+        (1u << 24) - 1, 1u << 24, (1u << 24) + 1, (1u << 24) + 65536 + 300, 100000000u, 0xFFFFFFFFu
+    };
+    for (uint32_t i = 0; i < COUNT(delays); i++) arm(i, delays[i], (sm_event_t)(i % NUM_EVENTS));
+
+    sm_timer_stats_t stats;
+    sm_timer_get_stats(&wheel, &stats);
+    TEST_ASSERT(stats.armed == COUNT(delays), "All timers armed");
+
+    // Stop one tick before each deadline, then on it
+    bool early = false, on_time = true;
+    for (uint32_t i = 0; i < COUNT(delays); i++) {
+        if (!armed[i]) continue;    // Same tick as the one before
+        uint64_t due = deadline[i];
+        if (due - 1 > wheel.now) {
+            sm_timer_advance(&wheel, due - 1, NULL);
+            early = early || !armed[i];
+        }
+        uint64_t next = 0;
+        on_time = on_time && sm_timer_next_tick(&wheel, &next) && next <= due;
+        sm_timer_advance(&wheel, due, NULL);
+        on_time = on_time && !armed[i];
+    }
+    sm_timer_get_stats(&wheel, &stats);
+    uint64_t next = 0;
+    TEST_ASSERT(!early, "No timer expires before its tick");
+    TEST_ASSERT(on_time && fired_on_time && fired == COUNT(delays), "Every timer expires on its tick, in order");
+    TEST_ASSERT(stats.armed == 0 && stats.expired == COUNT(delays) && !sm_timer_next_tick(&wheel, &next),
+                "Wheel empty afterwards");
+    TEST_ASSERT(stats.cascaded >= 10, "Timers beyond the first level cascaded down");
+
+    // One jump over everything: still one by one, in deadline order
+    setup();
+    for (uint32_t i = 0; i < COUNT(delays); i++) arm(i, delays[i], (sm_event_t)(i % NUM_EVENTS));
+    uint32_t expired = 0;
+    sm_timer_advance(&wheel, (uint64_t)1 << 33, &expired);
+    TEST_ASSERT(expired == COUNT(delays) && fired_on_time && fired == COUNT(delays),
+                "A single long advance expires every timer on its own tick, in order");
+
+    // Cancel, re-arm
+    setup();
+    arm(0, 70000, 1);
+    arm(1, 300, 2);
+    sm_timer_cancel(&wheel, timer_ids[0]);
+    armed[0] = false;
+    arm(1, 1u << 20, 3);
+    sm_timer_advance(&wheel, 1u << 21, &expired);
+    TEST_ASSERT(expired == 1 && fired_on_time && !armed[1], "Cancelled timer never fires, re-armed timer fires once");
+}
+
+// =============================================================================
+// RANDOM WORKLOAD
+// =============================================================================
+
+static void test_random_workload(void) {
+    print_section("RANDOM WORKLOAD");
+
+    setup();
+    seed_random(5);
+    bool next_ok = true, armed_ok = true, none_late = true;
+    for (uint32_t round = 0; round < RANDOM_ROUNDS; round++) {
+        uint32_t op = next_random() % 10;
+        uint32_t i = next_random() % NUM_MACHINES;
+        if (op < 5) {
+            // Delays on every level of the wheel
+            uint32_t kind = next_random() % 4;
+            uint32_t delay = kind == 0 ? next_random() % 300
+                           : kind == 1 ? next_random() % 70000
+                           : kind == 2 ? next_random() % 20000000
+                           : next_random();
+            arm(i, delay, (sm_event_t)(next_random() % NUM_EVENTS));
+        } else if (op < 7) {
+            sm_timer_cancel(&wheel, timer_ids[i]);
+            armed[i] = false;
+        } else {
+            uint64_t step = next_random() % 4 == 0 ? next_random() % 5000000 : next_random() % 500;
+            uint64_t target = wheel.now + step;
+            sm_timer_advance(&wheel, target, NULL);
+            for (uint32_t j = 0; j < NUM_MACHINES; j++) none_late = none_late && !(armed[j] && deadline[j] <= target);
+        }
+
+        uint64_t earliest = UINT64_MAX, next = 0;
+        uint32_t count = 0;
+        for (uint32_t j = 0; j < NUM_MACHINES; j++) {
+            if (!armed[j]) continue;
+            count++;
+            if (deadline[j] < earliest) earliest = deadline[j];
+        }
+        bool has_next = sm_timer_next_tick(&wheel, &next);
+        next_ok = next_ok && has_next == (count > 0) && (!count || (next <= earliest && next > wheel.now));
+        sm_timer_stats_t stats;
+        sm_timer_get_stats(&wheel, &stats);
+        armed_ok = armed_ok && stats.armed == count;
+    }
+    sm_timer_advance(&wheel, wheel.now + ((uint64_t)1 << 33), NULL);
+    bool drained = true;
+    for (uint32_t j = 0; j < NUM_MACHINES; j++) drained = drained && !armed[j];
+
+    TEST_ASSERT(fired_on_time, "Every expiry on its deadline, with its event, in tick order");
+    TEST_ASSERT(none_late, "Nothing due is left after an advance");
+    TEST_ASSERT(next_ok, "sm_timer_next_tick never later than the earliest deadline");
+    TEST_ASSERT(armed_ok, "Armed count matches the reference");
+    TEST_ASSERT(drained && fired > 0, "Everything expires eventually");
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(void) {
+    printf("State Machine Framework - Timer Wheel Tests\n");
+    printf("===========================================\n");
+
+    test_expiry_and_cascade();
+    test_random_workload();
+
+    return print_results();
+}
@@ -0,0 +1,258 @@
+#define _POSIX_C_SOURCE 200809L  // For pthreads and popen()
+#include "../include/state_machine.h"
+#include "test_common.h"
+#include <pthread.h>
+#include <sched.h>
+
+/**
+ * @file test_trace.c
+ * @brief Trace ring: sm_trace_read cursors across wraparound, what a traced
+ * machine records, a reader and sm_trace_save racing the writer, and a saved
+ * file through build/sm_trace_decode.
+ */
+
+#define SMALL_CAPACITY 16
+#define RACE_CAPACITY 64
+#define RACE_RECORDS 2000000
+#define TRACE_FILE "build/test_trace.trace"
+#define DECODE_COMMAND "build/sm_trace_decode " TRACE_FILE
+
+// Records whose fields all derive from the timestamp, so a torn copy shows
+static void write_numbered(sm_trace_ring_t *ring, uint64_t n) {
+    sm_trace_write(ring, n, 1, (sm_state_t)n, (sm_state_t)~n, (sm_event_t)(n >> 16));
+}
+static bool numbered(const sm_trace_record_t *record) {
+    return record->machine == 1 && record->from == (sm_state_t)record->timestamp &&
+           record->to == (sm_state_t)~record->timestamp && record->event == (sm_event_t)(record->timestamp >> 16);
+}
+
+// =============================================================================
+// READ AND WRAPAROUND
+// =============================================================================
+
+static void test_read(void) {
+    print_section("READ AND WRAPAROUND");
+
+    static sm_trace_record_t storage[SMALL_CAPACITY];
+    static sm_trace_record_t out[64];
+    sm_trace_ring_t ring;
+    uint64_t cursor = 0;
+    uint32_t count = 0;
+    TEST_ASSERT(sm_trace_init(&ring, storage, 12, SM_TRACE_CLOCK_COARSE) == SM_ERROR_INVALID_SIZE,
+                "Capacity must be a power of two");
+    sm_trace_init(&ring, storage, SMALL_CAPACITY, SM_TRACE_CLOCK_COARSE);
+    TEST_ASSERT(sm_trace_read(&ring, &cursor, out, 64, &count) == SM_SUCCESS && count == 0 && cursor == 0,
+                "Empty ring");
+
+    for (uint64_t n = 0; n < 5; n++) write_numbered(&ring, n);
+    sm_trace_read(&ring, &cursor, out, 3, &count);
+    TEST_ASSERT(count == 3 && cursor == 3 && out[0].timestamp == 0 && out[2].timestamp == 2 && numbered(&out[1]),
+                "max_records honoured, oldest first");
+    sm_trace_read(&ring, &cursor, out, 64, &count);
+    TEST_ASSERT(count == 2 && cursor == 5 && out[0].timestamp == 3 && out[1].timestamp == 4, "Cursor picks up after them");
+
+    // 40 in all: the reader fell behind by more than the ring holds
+    for (uint64_t n = 5; n < 40; n++) write_numbered(&ring, n);
+    sm_trace_read(&ring, &cursor, out, 64, &count);
+    bool consecutive = true;
+    for (uint32_t i = 0; i < count; i++) consecutive = consecutive && numbered(&out[i]) && out[i].timestamp == 25 + i;
+    TEST_ASSERT(count == SMALL_CAPACITY - 1 && consecutive && cursor == 40,
+                "After a wrap: the latest capacity - 1 records, older ones skipped");
+    TEST_ASSERT(sm_trace_read(&ring, &cursor, out, 64, &count) == SM_SUCCESS && count == 0 && cursor == 40,
+                "Nothing new, cursor unchanged");
+
+    uint64_t ahead = 1000;
+    sm_trace_read(&ring, &ahead, out, 64, &count);
+    TEST_ASSERT(count == 0 && ahead == 40, "A cursor past the head is brought back to it");
+}
+
+// =============================================================================
+// TRACED MACHINE
+// =============================================================================
+
+static const sm_state_tab_t trace_states[] = {{1, NULL, NULL, "IDLE"}, {2, NULL, NULL, "BUSY"}};
+static const sm_transition_tab_t trace_transitions[] = {{1, 10, 2, NULL}, {2, 11, 1, NULL}};
+
+static void test_traced_machine(void) {
+    print_section("TRACED MACHINE");
+
+    static sm_trace_record_t storage[SMALL_CAPACITY];
+    static sm_trace_record_t out[SMALL_CAPACITY];
+    sm_trace_ring_t ring;
+    state_machine_t sm;
+    sm_trace_init(&ring, storage, SMALL_CAPACITY, SM_TRACE_CLOCK_CYCLES);
+    sm_init(&sm, "worker", 1, trace_states, 2, trace_transitions, 2);
+    TEST_ASSERT(sm_trace_attach(&sm, &ring, SM_TRACE_NO_TRANSITION) == SM_ERROR_INVALID_SIZE,
+                "Tags with the top bit set are refused");
+    sm_trace_attach(&sm, &ring, 7);
+
+    // IDLE -> BUSY, rejected in BUSY, then a batch: BUSY -> IDLE, rejected in IDLE
+    uint64_t before = sm_trace_now(&ring);
+    sm_process_event(&sm, 10);
+    sm_process_event(&sm, 10);
+    static const sm_event_t batch[] = {11, 11};
+    sm_process_events(&sm, batch, COUNT(batch), NULL);
+
+    uint64_t cursor = 0;
+    uint32_t count = 0;
+    sm_trace_read(&ring, &cursor, out, SMALL_CAPACITY, &count);
+    TEST_ASSERT(count == 4, "One record per event");
+    TEST_ASSERT(out[0].machine == 7 && out[0].from == 1 && out[0].to == 2 && out[0].event == 10 &&
+                out[1].machine == (7 | SM_TRACE_NO_TRANSITION) && out[1].from == 2 && out[1].to == 2 &&
+                out[2].machine == 7 && out[2].from == 2 && out[2].to == 1 && out[2].event == 11 &&
+                out[3].machine == (7 | SM_TRACE_NO_TRANSITION) && out[3].from == 1,
+                "Transitions and rejected events recorded as processed");
+    TEST_ASSERT(out[0].timestamp >= before && out[1].timestamp >= out[0].timestamp &&
+                out[2].timestamp >= out[1].timestamp && out[3].timestamp == out[2].timestamp,
+                "Timestamps in order, one per batch");
+}
+
+// =============================================================================
+// CONCURRENT READER
+// =============================================================================
+
+static sm_trace_record_t race_storage[RACE_CAPACITY];
+static sm_trace_ring_t race_ring;
+static uint32_t writer_done;
+
+static void *writer(void *arg) {
+    (void)arg;
+    for (uint64_t n = 0; n < RACE_RECORDS; n++) write_numbered(&race_ring, n);
+    __atomic_store_n(&writer_done, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static void test_concurrent_reader(void) {
+    print_section("CONCURRENT READER");
+
+    sm_trace_init(&race_ring, race_storage, RACE_CAPACITY, SM_TRACE_CLOCK_COARSE);
+    writer_done = 0;
+    pthread_t thread;
+    pthread_create(&thread, NULL, writer, NULL);
+
+    // Every record copied must be whole, and records come out in order
+    static sm_trace_record_t out[RACE_CAPACITY];
+    uint64_t cursor = 0, received = 0, next = 0, reads = 0;
+    bool whole = true, ordered = true;
+    while (!__atomic_load_n(&writer_done, __ATOMIC_ACQUIRE)) {
+        uint32_t count = 0;
+        sm_trace_read(&race_ring, &cursor, out, RACE_CAPACITY, &count);
+        for (uint32_t i = 0; i < count; i++) {
+            whole = whole && numbered(&out[i]);
+            ordered = ordered && out[i].timestamp >= next && out[i].timestamp < cursor;
+            next = out[i].timestamp + 1;
+        }
+        received += count;
+        reads++;
+    }
+    pthread_join(thread, NULL);
+
+    // One save while the writer runs: the records in the file are whole too
+    FILE *file = fopen(TRACE_FILE, "wb");
+    sm_trace_init(&race_ring, race_storage, RACE_CAPACITY, SM_TRACE_CLOCK_COARSE);
+    writer_done = 0;
+    pthread_create(&thread, NULL, writer, NULL);
+    while (__atomic_load_n(&race_ring.head, __ATOMIC_ACQUIRE) < RACE_CAPACITY) sched_yield();
+    sm_result_t saved = file ? sm_trace_save(&race_ring, NULL, 0, file) : SM_ERROR_SYSTEM;
+    pthread_join(thread, NULL);
+    if (file) fclose(file);
+
+    // Header with no machines: magic, two uint32_t and six uint64_t
+    uint64_t in_file = 0;
+    bool file_whole = true;
+    file = fopen(TRACE_FILE, "rb");
+    if (file && fseek(file, 8 + 2 * 4 + 6 * 8, SEEK_SET) == 0) {
+        sm_trace_record_t record;
+        uint64_t previous = 0;
+        while (fread(&record, sizeof(record), 1, file) == 1) {
+            file_whole = file_whole && numbered(&record) && (!in_file || record.timestamp > previous);
+            previous = record.timestamp;
+            in_file++;
+        }
+    }
+    if (file) fclose(file);
+    printf("   %llu reads, %llu of %u records copied; %llu records in the save\n", (unsigned long long)reads,
+           (unsigned long long)received, RACE_RECORDS, (unsigned long long)in_file);
+
+    TEST_ASSERT(received > 0 && whole, "No torn record handed out");
+    TEST_ASSERT(ordered, "Records in write order, below the cursor");
+    TEST_ASSERT(saved == SM_SUCCESS && file_whole && in_file > 0 && in_file < RACE_CAPACITY, "Saving while writing: whole records only");
+}
+
+// =============================================================================
+// SAVE AND DECODE
+// =============================================================================
+
+static void test_save_and_decode(void) {
+    print_section("SAVE AND DECODE");
+
+    static sm_trace_record_t storage[SMALL_CAPACITY];
+    sm_trace_ring_t ring;
+    state_machine_t sm;
+    sm_trace_init(&ring, storage, SMALL_CAPACITY, SM_TRACE_CLOCK_COARSE);
+    sm_init(&sm, "worker", 1, trace_states, 2, trace_transitions, 2);
+    sm_trace_attach(&sm, &ring, 3);
+
+    // 40 events, so the ring has wrapped: 10 11 10 11 ... with every fifth rejected
+    for (uint32_t i = 0; i < 40; i++) sm_process_event(&sm, (sm_event_t)(i % 5 == 4 ? 12 : 10 + (i & 1)));
+
+    state_machine_t *machines[] = {&sm};
+    FILE *file = fopen(TRACE_FILE, "wb");
+    TEST_ASSERT(file && sm_trace_save(&ring, machines, 1, file) == SM_SUCCESS, "sm_trace_save");
+    if (file) fclose(file);
+
+    // The decoder prints what logging would have, after a time prefix
+    static sm_trace_record_t out[SMALL_CAPACITY];
+    uint64_t cursor = 0;
+    uint32_t count = 0, lines = 0;
+    sm_trace_read(&ring, &cursor, out, SMALL_CAPACITY, &count);
+
+    bool same = true;
+    char line[256], expected[256];
+    FILE *decoded = popen(DECODE_COMMAND, "r");
+    while (decoded && fgets(line, sizeof(line), decoded)) {
+        if (lines < count) {
+            const sm_trace_record_t *record = &out[lines];
+            if (record->machine & SM_TRACE_NO_TRANSITION) {
+                snprintf(expected, sizeof(expected), "[SM:worker] No transition from %s (event: %d)\n",
+                         sm_get_state_name(&sm, record->from), record->event);
+            } else {
+                snprintf(expected, sizeof(expected), "[SM:worker] Transition: %s -> %s (event: %d)\n",
+                         sm_get_state_name(&sm, record->from), sm_get_state_name(&sm, record->to), record->event);
+            }
+            const char *text = strstr(line, "] ");
+            same = same && strncmp(line, "[+", 2) == 0 && text && strcmp(text + 2, expected) == 0;
+        } else {
+            snprintf(expected, sizeof(expected), "%u records, %u older ones overwritten before the save\n",
+                     count, 40 - count);
+            same = same && lines == count && strcmp(line, expected) == 0;
+        }
+        lines++;
+    }
+    int status = decoded ? pclose(decoded) : -1;
+    TEST_ASSERT(count == SMALL_CAPACITY - 1 && status == 0 && lines == count + 1 && same,
+                "sm_trace_decode prints each record as logging would, then the totals");
+
+    decoded = popen("build/sm_trace_decode tests/test_trace.c 2>/dev/null", "r");
+    while (decoded && fgets(line, sizeof(line), decoded)) {
+    }
+    status = decoded ? pclose(decoded) : 0;
+    TEST_ASSERT(status != 0, "sm_trace_decode refuses a file that is not a trace");
+    remove(TRACE_FILE);
+}
+
+// =============================================================================
+// MAIN
+// =============================================================================
+
+int main(void) {
+    printf("State Machine Framework - Trace Tests\n");
+    printf("=====================================\n");
+
+    test_read();
+    test_traced_machine();
+    test_concurrent_reader();
+    test_save_and_decode();
+
+    return print_results();
+}
@@ -0,0 +1,161 @@
+#include "../include/state_machine.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Offline decoder for files written by sm_trace_save: prints each record as
+// the line the framework logs for it with logging enabled, prefixed with the
+// time since sm_trace_init.
+//
+//   sm_trace_decode traffic_light.trace
+
+typedef struct{
+    sm_state_t state;
+    char *name;
+} decode_state_t;
+
+typedef struct{
+    uint16_t tag;
+    uint16_t num_states;
+    char id[SM_MAX_ID_LENGTH];
+    decode_state_t *states;
+} decode_machine_t;
+
+typedef struct{
+    uint32_t clock;
+    uint32_t num_machines;
+    uint64_t origin_ticks;
+    uint64_t origin_ns;
+    uint64_t saved_ticks;
+    uint64_t saved_ns;
+    uint64_t first;
+    uint64_t head;
+    decode_machine_t *machines;
+} decode_trace_t;
+
+//helper
+static bool read_bytes(FILE *in, void *data, size_t size){
+    return fread(data, 1, size, in) == size;
+}
+static bool read_u16(FILE *in, uint16_t *value){
+    return read_bytes(in, value, sizeof(*value));
+}
+static bool read_u32(FILE *in, uint32_t *value){
+    return read_bytes(in, value, sizeof(*value));
+}
+static bool read_u64(FILE *in, uint64_t *value){
+    return read_bytes(in, value, sizeof(*value));
+}
+static bool read_machine(FILE *in, decode_machine_t *machine){
+    if(!read_u16(in, &machine->tag) || !read_u16(in, &machine->num_states) ||
+       !read_bytes(in, machine->id, sizeof(machine->id))) return false;
+    machine->id[SM_MAX_ID_LENGTH - 1] = '\0';
+
+    machine->states = calloc(machine->num_states ? machine->num_states : 1, sizeof(decode_state_t));
+    if(!machine->states) return false;
+    for (uint16_t i = 0; i < machine->num_states; i++){
+        uint16_t length;
+        if(!read_u16(in, &machine->states[i].state) || !read_u16(in, &length)) return false;
+        machine->states[i].name = malloc((size_t)length + 1);
+        if(!machine->states[i].name || !read_bytes(in, machine->states[i].name, length)) return false;
+        machine->states[i].name[length] = '\0';
+    }
+    return true;
+}
+static bool read_header(FILE *in, decode_trace_t *trace){
+    char magic[8];
+    if(!read_bytes(in, magic, sizeof(magic)) || memcmp(magic, SM_TRACE_MAGIC, sizeof(magic)) != 0) return false;
+    if(!read_u32(in, &trace->clock) || !read_u32(in, &trace->num_machines) ||
+       !read_u64(in, &trace->origin_ticks) || !read_u64(in, &trace->origin_ns) ||
+       !read_u64(in, &trace->saved_ticks) || !read_u64(in, &trace->saved_ns) ||
+       !read_u64(in, &trace->first) || !read_u64(in, &trace->head)) return false;
+
+    trace->machines = calloc(trace->num_machines ? trace->num_machines : 1, sizeof(decode_machine_t));
+    if(!trace->machines) return false;
+    for (uint32_t i = 0; i < trace->num_machines; i++){
+        if(!read_machine(in, &trace->machines[i])) return false;
+    }
+    return true;
+}
+static void free_trace(decode_trace_t *trace){
+    for (uint32_t i = 0; trace->machines && i < trace->num_machines; i++){
+        for (uint16_t s = 0; trace->machines[i].states && s < trace->machines[i].num_states; s++){
+            free(trace->machines[i].states[s].name);
+        }
+        free(trace->machines[i].states);
+    }
+    free(trace->machines);
+}
+static const decode_machine_t *find_machine(const decode_trace_t *trace, uint16_t tag){
+    for (uint32_t i = 0; i < trace->num_machines; i++){
+        if(trace->machines[i].tag == tag) return &trace->machines[i];
+    }
+    return NULL;
+}
+// Same fallback as sm_get_state_name
+static const char *state_name(const decode_machine_t *machine, sm_state_t state){
+    for (uint16_t i = 0; machine && i < machine->num_states; i++){
+        if(machine->states[i].state == state) return machine->states[i].name;
+    }
+    return "UNKNOWN";
+}
+// Seconds per tick of the ring's clock, from the two pairs of readings in the header
+static double tick_seconds(const decode_trace_t *trace){
+    if(trace->clock == SM_TRACE_CLOCK_COARSE || trace->saved_ticks <= trace->origin_ticks ||
+       trace->saved_ns <= trace->origin_ns){
+        return 1e-9;
+    }
+    return (double)(trace->saved_ns - trace->origin_ns) / (double)(trace->saved_ticks - trace->origin_ticks) * 1e-9;
+}
+
+//core
+int main(int argc, char **argv){
+    if(argc != 2){
+        fprintf(stderr, "Usage: %s <trace file>\n", argv[0]);
+        return 2;
+    }
+    FILE *in = fopen(argv[1], "rb");
+    if(!in){
+        perror(argv[1]);
+        return 1;
+    }
+
+    decode_trace_t trace;
+    memset(&trace, 0, sizeof(trace));
+    if(!read_header(in, &trace)){
+        fprintf(stderr, "%s: not a trace written by sm_trace_save\n", argv[1]);
+        free_trace(&trace);
+        fclose(in);
+        return 1;
+    }
+
+    double scale = tick_seconds(&trace);
+    uint64_t decoded = 0;
+    sm_trace_record_t record;
+    while (read_bytes(in, &record, sizeof(record))){
+        uint16_t tag = (uint16_t)(record.machine & ~SM_TRACE_NO_TRANSITION);
+        const decode_machine_t *machine = find_machine(&trace, tag);
+        char unknown[SM_MAX_ID_LENGTH];
+        const char *id = machine ? machine->id : unknown;
+        if(!machine) snprintf(unknown, sizeof(unknown), "#%u", (unsigned)tag);
+
+        double seconds = (double)(int64_t)(record.timestamp - trace.origin_ticks) * scale;
+        printf("[+%.6f s] ", seconds);
+        if(record.machine & SM_TRACE_NO_TRANSITION){
+            printf("[SM:%s] No transition from %s (event: %d)\n", id, state_name(machine, record.from), record.event);
+        } else {
+            printf("[SM:%s] Transition: %s -> %s (event: %d)\n", id,
+                   state_name(machine, record.from), state_name(machine, record.to), record.event);
+        }
+        decoded++;
+    }
+
+    uint64_t saved = trace.head - trace.first;
+    printf("%llu records", (unsigned long long)decoded);
+    if(trace.first) printf(", %llu older ones overwritten before the save", (unsigned long long)trace.first);
+    if(decoded < saved) printf(", %llu overwritten while saving", (unsigned long long)(saved - decoded));
+    printf("\n");
+
+    free_trace(&trace);
+    fclose(in);
+    return 0;
+}